@@ -83,6 +83,14 @@ static void recalculate_pool_size(void)
     ogs_app()->pool.subscription =
         ogs_app()->pool.nf * NF_SERVICE_PER_NF_INSTANCE;
 
+    /*
+     * One entry per target NF type and discovery option,
+     * the oldest one is evicted when the pool is exhausted
+     */
+#define DISCOVERY_CACHE_PER_NF_INSTANCE 8
+    ogs_app()->pool.discovery_cache =
+        ogs_app()->pool.nf * DISCOVERY_CACHE_PER_NF_INSTANCE;
+
     ogs_app()->pool.gtp_node = ogs_app()->pool.nf;
     if (global_conf.max.gtp_peer)
         ogs_app()->pool.gtp_node = global_conf.max.gtp_peer;
@@ -109,6 +117,10 @@ int ogs_app_global_conf_prepare(void)
 {
     global_conf.sockopt.no_delay = true;
 
+#define SBI_CLIENT_IDLE_HANDLE      32      /* Cached CURL easy handles */
+
+    global_conf.sbi.client.idle_handle = SBI_CLIENT_IDLE_HANDLE;
+
 #define MAX_NUM_OF_UE               1024    /* Num of UEs */
 #define MAX_NUM_OF_PEER             64      /* Num of Peer */
 
@@ -266,6 +278,9 @@ int ogs_app_parse_global_conf(ogs_yaml_iter_t *parent)
                             "no_time_zone_information")) {
                     global_conf.parameter.no_time_zone_information =
                         ogs_yaml_iter_bool(&parameter_iter);
+                } else if (!strcmp(parameter_key, "use_timer_wheel")) {
+                    global_conf.parameter.use_timer_wheel =
+                        ogs_yaml_iter_bool(&parameter_iter);
                 } else
                     ogs_warn("unknown key `%s`", parameter_key);
             }
@@ -287,6 +302,51 @@ int ogs_app_parse_global_conf(ogs_yaml_iter_t *parent)
                 } else
                     ogs_warn("unknown key `%s`", sockopt_key);
             }
+        } else if (!strcmp(global_key, "sbi")) {
+            ogs_yaml_iter_t sbi_iter;
+            ogs_yaml_iter_recurse(&global_iter, &sbi_iter);
+            while (ogs_yaml_iter_next(&sbi_iter)) {
+                const char *sbi_key = ogs_yaml_iter_key(&sbi_iter);
+                ogs_assert(sbi_key);
+                if (!strcmp(sbi_key, "client")) {
+                    ogs_yaml_iter_t client_iter;
+                    ogs_yaml_iter_recurse(&sbi_iter, &client_iter);
+                    while (ogs_yaml_iter_next(&client_iter)) {
+                        const char *client_key =
+                            ogs_yaml_iter_key(&client_iter);
+                        const char *v = ogs_yaml_iter_value(&client_iter);
+                        ogs_assert(client_key);
+                        if (!strcmp(client_key, "max_concurrent_streams")) {
+                            if (v) global_conf.sbi.client.
+                                max_concurrent_streams = atoi(v);
+                        } else if (!strcmp(client_key,
+                                    "max_host_connections")) {
+                            if (v) global_conf.sbi.client.
+                                max_host_connections = atoi(v);
+                        } else if (!strcmp(client_key, "idle_handle")) {
+                            if (v) global_conf.sbi.client.
+                                idle_handle = atoi(v);
+                        } else
+                            ogs_warn("unknown key `%s`", client_key);
+                    }
+                } else
+                    ogs_warn("unknown key `%s`", sbi_key);
+            }
+        } else if (!strcmp(global_key, "dbi")) {
+            ogs_yaml_iter_t dbi_iter;
+            ogs_yaml_iter_recurse(&global_iter, &dbi_iter);
+            while (ogs_yaml_iter_next(&dbi_iter)) {
+                const char *dbi_key = ogs_yaml_iter_key(&dbi_iter);
+                ogs_assert(dbi_key);
+                if (!strcmp(dbi_key, "worker")) {
+                    const char *v = ogs_yaml_iter_value(&dbi_iter);
+                    if (v) global_conf.dbi.worker = atoi(v);
+                } else if (!strcmp(dbi_key, "cache")) {
+                    const char *v = ogs_yaml_iter_value(&dbi_iter);
+                    if (v) global_conf.dbi.cache = atoi(v);
+                } else
+                    ogs_warn("unknown key `%s`", dbi_key);
+            }
         } else if (!strcmp(global_key, "max")) {
             ogs_yaml_iter_t max_iter;
             ogs_yaml_iter_recurse(&global_iter, &max_iter);
@@ -441,6 +501,13 @@ static int local_conf_prepare(void)
     /* 86400 seconds = 1 day */
     local_conf.time.subscription.validity_duration = 86400;
 
+    /*
+     * Discovery cache : 30 seconds if the NRF omits validityPeriod,
+     * 5 seconds for an empty SearchResult (0 disables caching)
+     */
+    local_conf.time.discovery.validity_duration = 30;
+    local_conf.time.discovery.negative_duration = 5;
+
     /*
      * Message Wait Duration : 10 seconds (Default)
      *
@@ -600,6 +667,30 @@ int ogs_app_parse_local_conf(const char *local)
                                 } else
                                     ogs_warn("unknown key `%s`", sbi_key);
                             }
+                        } else if (!strcmp(time_key, "discovery")) {
+                            ogs_yaml_iter_t sbi_iter;
+                            ogs_yaml_iter_recurse(&time_iter, &sbi_iter);
+
+                            while (ogs_yaml_iter_next(&sbi_iter)) {
+                                const char *sbi_key =
+                                    ogs_yaml_iter_key(&sbi_iter);
+                                ogs_assert(sbi_key);
+
+                                if (!strcmp(sbi_key, "validity")) {
+                                    const char *v =
+                                        ogs_yaml_iter_value(&sbi_iter);
+                                    if (v)
+                                        local_conf.time.discovery.
+                                            validity_duration = atoi(v);
+                                } else if (!strcmp(sbi_key, "negative")) {
+                                    const char *v =
+                                        ogs_yaml_iter_value(&sbi_iter);
+                                    if (v)
+                                        local_conf.time.discovery.
+                                            negative_duration = atoi(v);
+                                } else
+                                    ogs_warn("unknown key `%s`", sbi_key);
+                            }
                         } else if (!strcmp(time_key, "message")) {
                             ogs_yaml_iter_t msg_iter;
                             ogs_yaml_iter_recurse(&time_iter, &msg_iter);
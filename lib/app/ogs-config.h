@@ -75,6 +75,8 @@ typedef struct ogs_global_conf_s {
 
         int no_pfcp_rr_select;
         int no_time_zone_information;
+
+        int use_timer_wheel;
     } parameter;
 
     struct {
@@ -89,6 +91,19 @@ typedef struct ogs_global_conf_s {
         int l_linger;
     } sockopt;
 
+    struct {
+        struct {
+            int max_concurrent_streams;
+            int max_host_connections;
+            int idle_handle;
+        } client;
+    } sbi;
+
+    struct {
+        int worker; /* Subscriber DB worker threads (0: synchronous) */
+        int cache;  /* Cached subscribers (0: disabled) */
+    } dbi;
+
     ogs_pkbuf_config_t pkbuf_config;
 
 } ogs_app_global_conf_t;
@@ -103,6 +118,10 @@ typedef struct ogs_local_conf_s {
         struct {
             int validity_duration;
         } subscription;
+        struct {
+            int validity_duration;
+            int negative_duration;
+        } discovery;
 
         struct {
             ogs_time_t duration;
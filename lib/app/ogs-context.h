@@ -69,6 +69,7 @@ typedef struct ogs_app_context_s {
         uint64_t event;
         uint64_t socket;
         uint64_t subscription;
+        uint64_t discovery_cache;
         uint64_t xact;
         uint64_t stream;
 
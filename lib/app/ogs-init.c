@@ -93,6 +93,7 @@ int ogs_app_initialize(
      * Stage 3 : Initialize Default Memory Pool
      */
     ogs_pkbuf_default_create(&ogs_global_conf()->pkbuf_config);
+    ogs_event_init();
 
     /**************************************************************************
      * Stage 4 : Setup LOG Module
@@ -159,7 +160,9 @@ int ogs_app_initialize(
      */
     ogs_app()->queue = ogs_queue_create(ogs_app()->pool.event);
     ogs_assert(ogs_app()->queue);
-    ogs_app()->timer_mgr = ogs_timer_mgr_create(ogs_app()->pool.timer);
+    ogs_app()->timer_mgr = ogs_timer_mgr_create_backend(ogs_app()->pool.timer,
+            ogs_global_conf()->parameter.use_timer_wheel ?
+                OGS_TIMER_BACKEND_WHEEL : OGS_TIMER_BACKEND_RBTREE);
     ogs_assert(ogs_app()->timer_mgr);
     ogs_app()->pollset = ogs_pollset_create(ogs_app()->pool.socket);
     ogs_assert(ogs_app()->pollset);
@@ -172,6 +175,7 @@ void ogs_app_terminate(void)
     ogs_app_config_final();
     ogs_app_context_final();
 
+    ogs_event_final();
     ogs_pkbuf_default_destroy();
 
     ogs_core_terminate();
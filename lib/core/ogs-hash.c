@@ -34,39 +34,89 @@
 
 #include "ogs-core.h"
 
-typedef struct ogs_hash_entry_t ogs_hash_entry_t;
-struct ogs_hash_entry_t {
-    ogs_hash_entry_t    *next;
+/*
+ * Open addressing with linear probing. A removed entry leaves a tombstone
+ * so that probe sequences and running iterators stay valid.
+ *
+ * When the table gets too full, a larger one is allocated and the entries
+ * are moved over a few slots at a time by the following insertions,
+ * instead of all at once. Until then, lookups also probe the old table.
+ * Only the insertion of a new key moves entries, so removing entries or
+ * looking them up while iterating is safe, as before.
+ */
+typedef struct ogs_hash_entry_t {
     unsigned int        hash;
-    const void          *key;
     int                 klen;
+    const void          *key;   /* NULL : empty, &tombstone : removed */
     const void          *val;
-};
+} ogs_hash_entry_t;
+
+typedef struct ogs_hash_table_t {
+    ogs_hash_entry_t    *entry;
+    unsigned int        max;    /* 2^n - 1 */
+    unsigned int        used;   /* Live entries and tombstones */
+} ogs_hash_table_t;
 
 struct ogs_hash_index_t {
     ogs_hash_t          *ht;
-    ogs_hash_entry_t    *this, *next;
+    ogs_hash_table_t    *table;
+    ogs_hash_entry_t    *this;
     unsigned int        index;
 };
 
 struct ogs_hash_t {
-    ogs_hash_entry_t    **array;
+    ogs_hash_table_t    table;
+    ogs_hash_table_t    old;    /* Being moved into 'table' */
+    unsigned int        migrate;
     ogs_hash_index_t    iterator;  /* For ogs_hash_first(NULL, ...) */
-    unsigned int        count, max, seed;
+    unsigned int        count, seed;
     ogs_hashfunc_t      hash_func;
-    ogs_hash_entry_t    *free;  /* List of recycled entries */
 };
 
 #define INITIAL_MAX 15 /* tunable == 2^n - 1 */
 
-static ogs_hash_entry_t **alloc_array(ogs_hash_t *ht, unsigned int max)
+/* Slots of the old table moved by each insertion */
+#define MIGRATE_STEP 16
+
+static const char tombstone;
+#define TOMBSTONE ((const void *)&tombstone)
+
+#define ENTRY_IS_LIVE(he) ((he)->key && (he)->key != TOMBSTONE)
+
+/* Resize once 3/4 of the slots are in use */
+#define TABLE_IS_FULL(t) ((t)->used >= (t)->max - ((t)->max >> 2))
+
+/*
+ * ogs_calloc() would clear the whole table at once. With calloc(), large
+ * tables come as zero pages from the kernel and are touched lazily.
+ */
+static void alloc_table(ogs_hash_table_t *table, unsigned int max)
 {
-    ogs_hash_entry_t **ptr = ogs_calloc(1, sizeof(*ht->array) * (max + 1));
-    ogs_assert(ptr);
-    return ptr;
+    table->entry = calloc(max + 1, sizeof(ogs_hash_entry_t));
+    ogs_assert(table->entry);
+    table->max = max;
+    table->used = 0;
 }
 
-ogs_hash_t *ogs_hash_make(void)
+static void free_table(ogs_hash_table_t *table)
+{
+    if (table->entry)
+        free(table->entry);
+    memset(table, 0, sizeof(*table));
+}
+
+/* Smallest 2^n - 1 that keeps 'num' entries under half full */
+static unsigned int max_for_size(unsigned int num)
+{
+    unsigned int max = INITIAL_MAX;
+
+    while (max < num * 2 && max < 0x7fffffff)
+        max = max * 2 + 1;
+
+    return max;
+}
+
+ogs_hash_t *ogs_hash_make_size(unsigned int size)
 {
     ogs_hash_t *ht;
     ogs_time_t now = ogs_get_monotonic_time();
@@ -76,18 +126,22 @@ ogs_hash_t *ogs_hash_make(void)
         ogs_error("ogs_malloc() failed");
         return NULL;
     }
+    memset(ht, 0, sizeof(*ht));
 
-    ht->free = NULL;
     ht->count = 0;
-    ht->max = INITIAL_MAX;
     ht->seed = (unsigned int)((now >> 32) ^ now ^ 
                               (uintptr_t)ht ^ (uintptr_t)&now) - 1;
-    ht->array = alloc_array(ht, ht->max);
+    alloc_table(&ht->table, max_for_size(size));
     ht->hash_func = NULL;
 
     return ht;
 }
 
+ogs_hash_t *ogs_hash_make(void)
+{
+    return ogs_hash_make_size(0);
+}
+
 ogs_hash_t *ogs_hash_make_custom(ogs_hashfunc_t hash_func)
 {
     ogs_hash_t *ht = ogs_hash_make();
@@ -101,22 +155,11 @@ ogs_hash_t *ogs_hash_make_custom(ogs_hashfunc_t hash_func)
 
 void ogs_hash_destroy(ogs_hash_t *ht)
 {
-    ogs_hash_entry_t *he = NULL, *next_he = NULL;
-
     ogs_assert(ht);
-    ogs_assert(ht->array);
-
-    ogs_hash_clear(ht);
+    ogs_assert(ht->table.entry);
 
-    he = ht->free;
-    while(he) {
-        next_he = he->next;
-
-        ogs_free(he);
-        he = next_he;
-    }
-
-    ogs_free(ht->array);
+    free_table(&ht->old);
+    free_table(&ht->table);
     ogs_free(ht);
 }
 
@@ -124,15 +167,21 @@ ogs_hash_index_t *ogs_hash_next(ogs_hash_index_t *hi)
 {
     ogs_assert(hi);
 
-    hi->this = hi->next;
-    while (!hi->this) {
-        if (hi->index > hi->ht->max)
+    for ( ;; ) {
+        ogs_hash_table_t *table = hi->table;
+
+        while (hi->index <= table->max) {
+            hi->this = &table->entry[hi->index++];
+            if (ENTRY_IS_LIVE(hi->this))
+                return hi;
+        }
+
+        if (table != &hi->ht->table || !hi->ht->old.entry)
             return NULL;
 
-        hi->this = hi->ht->array[hi->index++];
+        hi->table = &hi->ht->old;
+        hi->index = 0;
     }
-    hi->next = hi->this->next;
-    return hi;
 }
 
 ogs_hash_index_t *ogs_hash_first(ogs_hash_t *ht)
@@ -144,9 +193,9 @@ ogs_hash_index_t *ogs_hash_first(ogs_hash_t *ht)
     hi = &ht->iterator;
 
     hi->ht = ht;
+    hi->table = &ht->table;
     hi->index = 0;
     hi->this = NULL;
-    hi->next = NULL;
     return ogs_hash_next(hi);
 }
 
@@ -184,24 +233,6 @@ void *ogs_hash_this_val(ogs_hash_index_t *hi)
     return val;
 }
 
-static void expand_array(ogs_hash_t *ht)
-{
-    ogs_hash_index_t *hi;
-    ogs_hash_entry_t **new_array;
-    unsigned int new_max;
-
-    new_max = ht->max * 2 + 1;
-    new_array = alloc_array(ht, new_max);
-    for (hi = ogs_hash_first(ht); hi; hi = ogs_hash_next(hi)) {
-        unsigned int i = hi->this->hash & new_max;
-        hi->this->next = new_array[i];
-        new_array[i] = hi->this;
-    }
-    ogs_free(ht->array);
-    ht->array = new_array;
-    ht->max = new_max;
-}
-
 static unsigned int hashfunc_default(
         const char *char_key, int *klen, unsigned int hash)
 {
@@ -262,60 +293,187 @@ static unsigned int hashfunc_default(
     return hash;
 }
 
+#define HASH_MUL 0x9e3779b97f4a7c15ULL
+
+static uint64_t hash_fmix64(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/*
+ * Keys in the NF contexts are mostly short binary values (TEID, SEID,
+ * IPv4/IPv6 address, GUTI) or IMSI/SUPI strings. They are consumed
+ * 8 bytes at a time instead of byte by byte.
+ */
+static unsigned int hashfunc_fast(
+        const char *char_key, int *klen, unsigned int seed)
+{
+    const unsigned char *p = (const unsigned char *)char_key;
+    uint64_t h, v;
+    int len;
+
+    if (*klen == OGS_HASH_KEY_STRING)
+        *klen = strlen(char_key);
+    len = *klen;
+
+    h = seed ^ ((uint64_t)len * HASH_MUL);
+    while (len >= 8) {
+        memcpy(&v, p, 8);
+        h = (h ^ hash_fmix64(v)) * HASH_MUL;
+        p += 8;
+        len -= 8;
+    }
+    if (len) {
+        v = 0;
+        memcpy(&v, p, len);
+        h = (h ^ hash_fmix64(v)) * HASH_MUL;
+    }
+
+    return (unsigned int)(hash_fmix64(h) >> 32);
+}
+
 unsigned int ogs_hashfunc_default(const char *char_key, int *klen)
 {
     return hashfunc_default(char_key, klen, 0);
 }
 
-static ogs_hash_entry_t **find_entry(ogs_hash_t *ht,
-        const void *key, int klen, const void *val, const char *file_line)
+static unsigned int hash_of(ogs_hash_t *ht, const void *key, int *klen)
 {
-    ogs_hash_entry_t **hep, *he;
     unsigned int hash;
 
-    if (ht->hash_func)
-        hash = ht->hash_func(key, &klen);
-    else
-        hash = hashfunc_default(key, &klen, ht->seed);
-
-    /* scan linked list */
-    for (hep = &ht->array[hash & ht->max], he = *hep;
-         he; hep = &he->next, he = *hep) {
-        if (he->hash == hash
-            && he->klen == klen
-            && memcmp(he->key, key, klen) == 0)
+    if (!ht->hash_func)
+        return hashfunc_fast(key, klen, ht->seed);
+
+    /* A custom function may not spread the low bits used for the index */
+    hash = ht->hash_func(key, klen);
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+/*
+ * Returns the entry holding the key, or NULL. If 'slot' is given, it is
+ * set to where the key would be inserted into 'table'.
+ */
+static ogs_hash_entry_t *probe(ogs_hash_table_t *table,
+        unsigned int hash, const void *key, int klen,
+        ogs_hash_entry_t **slot)
+{
+    ogs_hash_entry_t *he, *reuse = NULL;
+    unsigned int i;
+
+    for (i = hash & table->max;; i = (i + 1) & table->max) {
+        he = &table->entry[i];
+        if (!he->key)
             break;
+        if (he->key == TOMBSTONE) {
+            if (!reuse)
+                reuse = he;
+            continue;
+        }
+        if (he->hash == hash && he->klen == klen &&
+            memcmp(he->key, key, klen) == 0)
+            return he;
     }
-    if (he || !val)
-        return hep;
 
-    /* add a new entry for non-NULL values */
-    if ((he = ht->free) != NULL)
-        ht->free = he->next;
-    else {
-        he = ogs_malloc(sizeof(*he));
-        ogs_assert(he);
+    if (slot)
+        *slot = reuse ? reuse : he;
+
+    return NULL;
+}
+
+static ogs_hash_entry_t *find_entry(ogs_hash_t *ht,
+        unsigned int hash, const void *key, int klen)
+{
+    ogs_hash_entry_t *he;
+
+    he = probe(&ht->table, hash, key, klen, NULL);
+    if (!he && ht->old.entry)
+        he = probe(&ht->old, hash, key, klen, NULL);
+
+    return he;
+}
+
+static void put_entry(ogs_hash_table_t *table, ogs_hash_entry_t *slot,
+        unsigned int hash, const void *key, int klen, const void *val)
+{
+    if (!slot->key)
+        table->used++;
+
+    slot->hash = hash;
+    slot->key = key;
+    slot->klen = klen;
+    slot->val = val;
+}
+
+static void migrate(ogs_hash_t *ht, unsigned int num)
+{
+    ogs_hash_entry_t *he, *slot;
+
+    while (num-- && ht->migrate <= ht->old.max) {
+        he = &ht->old.entry[ht->migrate++];
+        if (!ENTRY_IS_LIVE(he))
+            continue;
+
+        probe(&ht->table, he->hash, he->key, he->klen, &slot);
+        put_entry(&ht->table, slot, he->hash, he->key, he->klen, he->val);
+
+        /* Keep the probe sequence of the old table for other lookups */
+        he->key = TOMBSTONE;
     }
-    he->next = NULL;
-    he->hash = hash;
-    he->key  = key;
-    he->klen = klen;
-    he->val  = val;
-    *hep = he;
+
+    if (ht->migrate > ht->old.max)
+        free_table(&ht->old);
+}
+
+static void grow(ogs_hash_t *ht)
+{
+    /* Not expected since every insertion moves MIGRATE_STEP slots */
+    if (ht->old.entry)
+        migrate(ht, ht->old.max + 1);
+
+    /* A table full of tombstones is only cleaned, not enlarged */
+    ht->old = ht->table;
+    alloc_table(&ht->table,
+            ht->count * 2 > ht->old.max ? ht->old.max * 2 + 1 : ht->old.max);
+    ht->migrate = 0;
+
+    migrate(ht, MIGRATE_STEP);
+}
+
+static void insert_entry(ogs_hash_t *ht,
+        unsigned int hash, const void *key, int klen, const void *val)
+{
+    ogs_hash_entry_t *slot;
+
+    if (ht->old.entry)
+        migrate(ht, MIGRATE_STEP);
+    else if (TABLE_IS_FULL(&ht->table))
+        grow(ht);
+
+    probe(&ht->table, hash, key, klen, &slot);
+    put_entry(&ht->table, slot, hash, key, klen, val);
     ht->count++;
-    return hep;
 }
 
 void *ogs_hash_get_debug(ogs_hash_t *ht,
         const void *key, int klen, const char *file_line)
 {
     ogs_hash_entry_t *he;
+    unsigned int hash;
 
     ogs_assert(ht);
     ogs_assert(key);
     ogs_assert(klen);
 
-    he = *find_entry(ht, key, klen, NULL, file_line);
+    hash = hash_of(ht, key, &klen);
+    he = find_entry(ht, hash, key, klen);
     if (he)
         return (void *)he->val;
     else
@@ -325,29 +483,27 @@ void *ogs_hash_get_debug(ogs_hash_t *ht,
 void ogs_hash_set_debug(ogs_hash_t *ht,
         const void *key, int klen, const void *val, const char *file_line)
 {
-    ogs_hash_entry_t **hep;
+    ogs_hash_entry_t *he;
+    unsigned int hash;
 
     ogs_assert(ht);
     ogs_assert(key);
     ogs_assert(klen);
 
-    hep = find_entry(ht, key, klen, val, file_line);
-    if (*hep) {
+    hash = hash_of(ht, key, &klen);
+    he = find_entry(ht, hash, key, klen);
+    if (he) {
         if (!val) {
             /* delete entry */
-            ogs_hash_entry_t *old = *hep;
-            *hep = (*hep)->next;
-            old->next = ht->free;
-            ht->free = old;
+            he->key = TOMBSTONE;
+            he->val = NULL;
             --ht->count;
         } else {
             /* replace entry */
-            (*hep)->val = val;
-            /* check that the collision rate isn't too high */
-            if (ht->count > ht->max) {
-                expand_array(ht);
-            }
+            he->val = val;
         }
+    } else if (val) {
+        insert_entry(ht, hash, key, klen, val);
     }
     /* else key not present and val==NULL */
 }
@@ -355,19 +511,20 @@ void ogs_hash_set_debug(ogs_hash_t *ht,
 void *ogs_hash_get_or_set_debug(ogs_hash_t *ht,
         const void *key, int klen, const void *val, const char *file_line)
 {
-    ogs_hash_entry_t **hep;
+    ogs_hash_entry_t *he;
+    unsigned int hash;
 
     ogs_assert(ht);
     ogs_assert(key);
     ogs_assert(klen);
 
-    hep = find_entry(ht, key, klen, val, file_line);
-    if (*hep) {
-        val = (*hep)->val;
-        /* check that the collision rate isn't too high */
-        if (ht->count > ht->max) {
-            expand_array(ht);
-        }
+    hash = hash_of(ht, key, &klen);
+    he = find_entry(ht, hash, key, klen);
+    if (he)
+        return (void *)he->val;
+
+    if (val) {
+        insert_entry(ht, hash, key, klen, val);
         return (void *)val;
     }
     /* else key not present and val==NULL */
@@ -382,12 +539,13 @@ unsigned int ogs_hash_count(ogs_hash_t *ht)
 
 void ogs_hash_clear(ogs_hash_t *ht)
 {
-    ogs_hash_index_t *hi;
-
     ogs_assert(ht);
 
-    for (hi = ogs_hash_first(ht); hi; hi = ogs_hash_next(hi))
-        ogs_hash_set(ht, hi->this->key, hi->this->klen, NULL);
+    free_table(&ht->old);
+    memset(ht->table.entry, 0,
+            (ht->table.max + 1) * sizeof(ogs_hash_entry_t));
+    ht->table.used = 0;
+    ht->count = 0;
 }
 
 /* This is basically the following...
@@ -406,9 +564,9 @@ int ogs_hash_do(ogs_hash_do_callback_fn_t *comp,
     int rv, dorv  = 1;
 
     hix.ht    = (ogs_hash_t *)ht;
+    hix.table = &hix.ht->table;
     hix.index = 0;
     hix.this  = NULL;
-    hix.next  = NULL;
 
     if ((hi = ogs_hash_next(&hix))) {
         /* Scan the entire table */
@@ -422,3 +580,59 @@ int ogs_hash_do(ogs_hash_do_callback_fn_t *comp,
     }
     return dorv;
 }
+
+void ogs_hash_chain_add(ogs_hash_t *ht,
+        ogs_hash_chain_t *node, const void *key, int klen)
+{
+    ogs_hash_chain_t *head = NULL;
+
+    ogs_assert(ht);
+    ogs_assert(node);
+    ogs_assert(key);
+
+    node->next = NULL;
+    node->key = key;
+    node->klen = klen;
+
+    head = ogs_hash_get(ht, key, klen);
+    if (!head) {
+        ogs_hash_set(ht, key, klen, node);
+        return;
+    }
+
+    while (head->next)
+        head = head->next;
+    head->next = node;
+}
+
+void ogs_hash_chain_remove(ogs_hash_t *ht, ogs_hash_chain_t *node)
+{
+    ogs_hash_chain_t *head = NULL, *next = NULL;
+
+    ogs_assert(ht);
+    ogs_assert(node);
+
+    /* Not added */
+    if (!node->key)
+        return;
+
+    head = ogs_hash_get(ht, node->key, node->klen);
+    if (head == node) {
+        /* The entry refers to this node's key, so drop it first */
+        ogs_hash_set(ht, node->key, node->klen, NULL);
+        next = node->next;
+        if (next)
+            ogs_hash_set(ht, next->key, next->klen, next);
+    } else {
+        for (; head; head = head->next) {
+            if (head->next == node) {
+                head->next = node->next;
+                break;
+            }
+        }
+    }
+
+    node->next = NULL;
+    node->key = NULL;
+    node->klen = 0;
+}
@@ -51,6 +51,8 @@ typedef unsigned int (*ogs_hashfunc_t)(const char *key, int *klen);
 unsigned int ogs_hashfunc_default(const char *key, int *klen);
 
 ogs_hash_t *ogs_hash_make(void);
+/* Pre-sized for 'size' entries, e.g. the configured pool size */
+ogs_hash_t *ogs_hash_make_size(unsigned int size);
 ogs_hash_t *ogs_hash_make_custom(ogs_hashfunc_t ogs_hash_func);
 void ogs_hash_destroy(ogs_hash_t *ht);
 
@@ -84,6 +86,22 @@ typedef int (ogs_hash_do_callback_fn_t)(
 int ogs_hash_do(ogs_hash_do_callback_fn_t *comp,
         void *rec, const ogs_hash_t *ht);
 
+/*
+ * Objects that may share a key, e.g. an id reused while an older context
+ * still holds it. The hash maps the key to the first node added, the
+ * others are chained behind it. `key` must stay valid and unchanged
+ * until the node is removed.
+ */
+typedef struct ogs_hash_chain_s {
+    struct ogs_hash_chain_s *next;
+    const void *key;
+    int klen;
+} ogs_hash_chain_t;
+
+void ogs_hash_chain_add(ogs_hash_t *ht,
+        ogs_hash_chain_t *node, const void *key, int klen);
+void ogs_hash_chain_remove(ogs_hash_t *ht, ogs_hash_chain_t *node);
+
 
 #ifdef __cplusplus
 }
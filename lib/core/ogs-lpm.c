@@ -0,0 +1,324 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-core.h"
+
+#define OGS_LPM_INITIAL_SIZE 64
+#define OGS_LPM_MAX_PREFIXLEN 128
+
+typedef struct ogs_lpm_entry_s {
+    uint32_t addr[4];
+    uint32_t hash;
+    uint8_t prefixlen;
+    bool used;
+    void *data;
+} ogs_lpm_entry_t;
+
+struct ogs_lpm_s {
+    int family;
+    int maxlen;
+    int words;
+
+    ogs_lpm_entry_t *table;
+    unsigned int size;
+    unsigned int count;
+
+    unsigned int num_of_prefix[OGS_LPM_MAX_PREFIXLEN+1];
+    uint8_t prefixlen[OGS_LPM_MAX_PREFIXLEN+1];
+    int num_of_prefixlen;
+};
+
+static ogs_inline uint32_t prefix_mask(int prefixlen, int word)
+{
+    int bits = prefixlen - word * 32;
+
+    if (bits <= 0)
+        return 0;
+    if (bits >= 32)
+        return 0xffffffff;
+    return htobe32(0xffffffff << (32 - bits));
+}
+
+static ogs_inline void prefix_apply(ogs_lpm_t *lpm,
+        uint32_t *out, const void *addr, int prefixlen)
+{
+    int i;
+
+    memset(out, 0, sizeof(uint32_t) * 4);
+    memcpy(out, addr, lpm->words * sizeof(uint32_t));
+    for (i = 0; i < lpm->words; i++)
+        out[i] &= prefix_mask(prefixlen, i);
+}
+
+static ogs_inline uint32_t prefix_hash(
+        ogs_lpm_t *lpm, const uint32_t *addr, int prefixlen)
+{
+    uint32_t h = (uint32_t)prefixlen * 0x9e3779b9;
+    int i;
+
+    for (i = 0; i < lpm->words; i++) {
+        h ^= addr[i];
+        h *= 0x85ebca6b;
+        h ^= h >> 13;
+    }
+
+    h ^= h >> 16;
+    h *= 0x7feb352d;
+    h ^= h >> 15;
+    h *= 0x846ca68b;
+    h ^= h >> 16;
+
+    return h;
+}
+
+static ogs_inline ogs_lpm_entry_t *prefix_probe(ogs_lpm_t *lpm,
+        const uint32_t *addr, int prefixlen, uint32_t hash)
+{
+    unsigned int mask = lpm->size - 1;
+    unsigned int i = hash & mask;
+
+    while (lpm->table[i].used) {
+        ogs_lpm_entry_t *entry = &lpm->table[i];
+
+        if (entry->hash == hash && entry->prefixlen == prefixlen &&
+            memcmp(entry->addr, addr, lpm->words * sizeof(uint32_t)) == 0)
+            return entry;
+
+        i = (i + 1) & mask;
+    }
+
+    return NULL;
+}
+
+static void update_prefixlen(ogs_lpm_t *lpm)
+{
+    int i;
+
+    lpm->num_of_prefixlen = 0;
+    for (i = lpm->maxlen; i >= 0; i--) {
+        if (lpm->num_of_prefix[i])
+            lpm->prefixlen[lpm->num_of_prefixlen++] = i;
+    }
+}
+
+static void insert_entry(ogs_lpm_entry_t *table,
+        unsigned int size, ogs_lpm_entry_t *entry)
+{
+    unsigned int mask = size - 1;
+    unsigned int i = entry->hash & mask;
+
+    while (table[i].used)
+        i = (i + 1) & mask;
+
+    table[i] = *entry;
+}
+
+static int expand_table(ogs_lpm_t *lpm)
+{
+    ogs_lpm_entry_t *table = NULL;
+    unsigned int size, i;
+
+    size = lpm->size * 2;
+    table = ogs_calloc(size, sizeof(ogs_lpm_entry_t));
+    if (!table) {
+        ogs_error("ogs_calloc() failed");
+        return OGS_ERROR;
+    }
+
+    for (i = 0; i < lpm->size; i++) {
+        if (lpm->table[i].used)
+            insert_entry(table, size, &lpm->table[i]);
+    }
+
+    ogs_free(lpm->table);
+    lpm->table = table;
+    lpm->size = size;
+
+    return OGS_OK;
+}
+
+ogs_lpm_t *ogs_lpm_create(int family)
+{
+    ogs_lpm_t *lpm = NULL;
+
+    ogs_assert(family == AF_INET || family == AF_INET6);
+
+    lpm = ogs_calloc(1, sizeof(*lpm));
+    if (!lpm) {
+        ogs_error("ogs_calloc() failed");
+        return NULL;
+    }
+
+    lpm->family = family;
+    lpm->maxlen = family == AF_INET ? 32 : OGS_LPM_MAX_PREFIXLEN;
+    lpm->words = lpm->maxlen / 32;
+
+    lpm->size = OGS_LPM_INITIAL_SIZE;
+    lpm->table = ogs_calloc(lpm->size, sizeof(ogs_lpm_entry_t));
+    if (!lpm->table) {
+        ogs_error("ogs_calloc() failed");
+        ogs_free(lpm);
+        return NULL;
+    }
+
+    return lpm;
+}
+
+void ogs_lpm_destroy(ogs_lpm_t *lpm)
+{
+    ogs_assert(lpm);
+
+    ogs_free(lpm->table);
+    ogs_free(lpm);
+}
+
+int ogs_lpm_add(ogs_lpm_t *lpm, const void *addr, int prefixlen, void *data)
+{
+    ogs_lpm_entry_t entry, *found = NULL;
+
+    ogs_assert(lpm);
+    ogs_assert(addr);
+    ogs_assert(data);
+
+    if (prefixlen < 0 || prefixlen > lpm->maxlen) {
+        ogs_error("Invalid prefix length [%d]", prefixlen);
+        return OGS_ERROR;
+    }
+
+    memset(&entry, 0, sizeof(entry));
+    prefix_apply(lpm, entry.addr, addr, prefixlen);
+    entry.prefixlen = prefixlen;
+    entry.hash = prefix_hash(lpm, entry.addr, prefixlen);
+
+    found = prefix_probe(lpm, entry.addr, prefixlen, entry.hash);
+    if (found) {
+        found->data = data;
+        return OGS_OK;
+    }
+
+    /* Keep the load factor at or below 1/2 */
+    if ((lpm->count + 1) * 2 > lpm->size) {
+        if (expand_table(lpm) != OGS_OK)
+            return OGS_ERROR;
+    }
+
+    entry.used = true;
+    entry.data = data;
+    insert_entry(lpm->table, lpm->size, &entry);
+    lpm->count++;
+
+    if (lpm->num_of_prefix[prefixlen]++ == 0)
+        update_prefixlen(lpm);
+
+    return OGS_OK;
+}
+
+int ogs_lpm_delete(ogs_lpm_t *lpm, const void *addr, int prefixlen)
+{
+    uint32_t key[4];
+    ogs_lpm_entry_t *found = NULL;
+    unsigned int mask, hole, i;
+
+    ogs_assert(lpm);
+    ogs_assert(addr);
+
+    if (prefixlen < 0 || prefixlen > lpm->maxlen) {
+        ogs_error("Invalid prefix length [%d]", prefixlen);
+        return OGS_ERROR;
+    }
+
+    prefix_apply(lpm, key, addr, prefixlen);
+    found = prefix_probe(lpm, key,
+            prefixlen, prefix_hash(lpm, key, prefixlen));
+    if (!found)
+        return OGS_ERROR;
+
+    /* Backward-shift deletion keeps every probe chain unbroken */
+    mask = lpm->size - 1;
+    hole = found - lpm->table;
+    i = hole;
+    for ( ;; ) {
+        unsigned int home;
+
+        i = (i + 1) & mask;
+        if (!lpm->table[i].used)
+            break;
+
+        home = lpm->table[i].hash & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            lpm->table[hole] = lpm->table[i];
+            hole = i;
+        }
+    }
+    memset(&lpm->table[hole], 0, sizeof(ogs_lpm_entry_t));
+    lpm->count--;
+
+    if (--lpm->num_of_prefix[prefixlen] == 0)
+        update_prefixlen(lpm);
+
+    return OGS_OK;
+}
+
+void *ogs_lpm_find(ogs_lpm_t *lpm, const void *addr, int prefixlen)
+{
+    uint32_t key[4];
+    ogs_lpm_entry_t *found = NULL;
+
+    ogs_assert(lpm);
+    ogs_assert(addr);
+
+    if (prefixlen < 0 || prefixlen > lpm->maxlen)
+        return NULL;
+    if (!lpm->num_of_prefix[prefixlen])
+        return NULL;
+
+    prefix_apply(lpm, key, addr, prefixlen);
+    found = prefix_probe(lpm, key,
+            prefixlen, prefix_hash(lpm, key, prefixlen));
+
+    return found ? found->data : NULL;
+}
+
+void *ogs_lpm_lookup(ogs_lpm_t *lpm, const void *addr)
+{
+    uint32_t key[4];
+    ogs_lpm_entry_t *found = NULL;
+    int i;
+
+    ogs_assert(lpm);
+    ogs_assert(addr);
+
+    for (i = 0; i < lpm->num_of_prefixlen; i++) {
+        int prefixlen = lpm->prefixlen[i];
+
+        prefix_apply(lpm, key, addr, prefixlen);
+        found = prefix_probe(lpm, key,
+                prefixlen, prefix_hash(lpm, key, prefixlen));
+        if (found)
+            return found->data;
+    }
+
+    return NULL;
+}
+
+unsigned int ogs_lpm_count(ogs_lpm_t *lpm)
+{
+    ogs_assert(lpm);
+    return lpm->count;
+}
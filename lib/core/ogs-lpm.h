@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if !defined(OGS_CORE_INSIDE) && !defined(OGS_CORE_COMPILATION)
+#error "This header cannot be included directly."
+#endif
+
+#ifndef OGS_LPM_H
+#define OGS_LPM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Longest-prefix-match table for IPv4/IPv6 addresses.
+ *
+ * Prefixes are kept in one open-addressing hash keyed by
+ * (masked address, prefix length). A lookup probes only the prefix
+ * lengths that are currently in use, longest first, so the cost is
+ * bounded by the number of distinct prefix lengths, not by the number
+ * of entries.
+ *
+ * Addresses are given in network byte order
+ * (4 bytes for AF_INET, 16 bytes for AF_INET6).
+ */
+typedef struct ogs_lpm_s ogs_lpm_t;
+
+ogs_lpm_t *ogs_lpm_create(int family);
+void ogs_lpm_destroy(ogs_lpm_t *lpm);
+
+int ogs_lpm_add(ogs_lpm_t *lpm, const void *addr, int prefixlen, void *data);
+int ogs_lpm_delete(ogs_lpm_t *lpm, const void *addr, int prefixlen);
+
+void *ogs_lpm_find(ogs_lpm_t *lpm, const void *addr, int prefixlen);
+void *ogs_lpm_lookup(ogs_lpm_t *lpm, const void *addr);
+
+unsigned int ogs_lpm_count(ogs_lpm_t *lpm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_LPM_H */
@@ -42,6 +42,12 @@ extern "C" {
 #define ogs_inline __inline__
 #endif
 
+#if defined(_MSC_VER)
+#define ogs_thread_local __declspec(thread)
+#else
+#define ogs_thread_local __thread
+#endif
+
 #if defined(_WIN32)
 #define OGS_FUNC __FUNCTION__
 #elif defined(__STDC_VERSION__) && __STDC_VERSION__ < 199901L
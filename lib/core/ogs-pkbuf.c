@@ -62,6 +62,36 @@ OGS_STATIC_ASSERT(sizeof(ogs_cluster_8192_t) % sizeof(void *) == 0);
 OGS_STATIC_ASSERT(sizeof(ogs_cluster_32768_t) % sizeof(void *) == 0);
 OGS_STATIC_ASSERT(sizeof(ogs_cluster_big_t) % sizeof(void *) == 0);
 
+static const unsigned int cluster_size[OGS_PKBUF_NUM_OF_CLUSTER] = {
+    OGS_CLUSTER_128_SIZE, OGS_CLUSTER_256_SIZE, OGS_CLUSTER_512_SIZE,
+    OGS_CLUSTER_1024_SIZE, OGS_CLUSTER_2048_SIZE, OGS_CLUSTER_8192_SIZE,
+    OGS_CLUSTER_32768_SIZE, OGS_CLUSTER_BIG_SIZE,
+};
+
+/*
+ * Per-thread magazine cache
+ *
+ * Each thread keeps a small stack of pkbufs (header + cluster) for each
+ * cluster size in front of the shared pool. Alloc/free only take the pool
+ * mutex to refill or flush a whole batch. A cluster shared by
+ * ogs_pkbuf_copy() is always released through the mutex. The caches of
+ * a thread are given back to their pools when the thread exits.
+ */
+#define OGS_PKBUF_CACHE_SIZE 64
+#define OGS_PKBUF_MAX_THREAD_CACHE 8
+
+typedef struct ogs_pkbuf_cache_s {
+    ogs_lnode_t lnode;
+
+    struct {
+        int num;
+        ogs_pkbuf_t *pkbuf[OGS_PKBUF_CACHE_SIZE];
+
+        uint64_t hit;
+        uint64_t miss;
+    } magazine[OGS_PKBUF_NUM_OF_CLUSTER];
+} ogs_pkbuf_cache_t;
+
 typedef struct ogs_pkbuf_pool_s {
     OGS_POOL(pkbuf, ogs_pkbuf_t);
     OGS_POOL(cluster, ogs_cluster_t);
@@ -76,10 +106,43 @@ typedef struct ogs_pkbuf_pool_s {
     OGS_POOL(cluster_big, ogs_cluster_big_t);
 
     ogs_thread_mutex_t mutex;
+
+    unsigned int id;
+    int batch[OGS_PKBUF_NUM_OF_CLUSTER]; /* 0: cache disabled */
+    ogs_list_t cache_list;
+
+    /* Counters of the caches of exited threads */
+    struct {
+        uint64_t hit;
+        uint64_t miss;
+    } retired[OGS_PKBUF_NUM_OF_CLUSTER];
 } ogs_pkbuf_pool_t;
 
 static OGS_POOL(pkbuf_pool, ogs_pkbuf_pool_t);
 static ogs_pkbuf_pool_t *default_pool = NULL;
+static unsigned int pkbuf_pool_id = 0;
+
+/* Indexed by the slot of the pool in pkbuf_pool */
+static ogs_thread_local struct {
+    ogs_pkbuf_pool_t *pool;
+    unsigned int id;
+    ogs_pkbuf_cache_t *cache;
+} thread_cache[OGS_PKBUF_MAX_THREAD_CACHE];
+
+#if !defined(_WIN32)
+static pthread_key_t thread_cache_key;
+#endif
+
+static void cluster_usage(ogs_pkbuf_pool_t *pool,
+        int index, int *size, int *avail);
+static ogs_pkbuf_cache_t *cache_get(ogs_pkbuf_pool_t *pool);
+static void cache_refill(ogs_pkbuf_pool_t *pool,
+        ogs_pkbuf_cache_t *cache, int index);
+static void cache_flush(ogs_pkbuf_pool_t *pool,
+        ogs_pkbuf_cache_t *cache, int index, int num);
+#if !defined(_WIN32)
+static void cache_exit(void *data);
+#endif
 
 static ogs_cluster_t *cluster_alloc(
         ogs_pkbuf_pool_t *pool, unsigned int size);
@@ -99,13 +162,18 @@ void ogs_pkbuf_init(void)
 {
 #if OGS_USE_TALLOC == 0
     ogs_pool_init(&pkbuf_pool, ogs_core()->pkbuf.pool);
-
+#if !defined(_WIN32)
+    ogs_assert(pthread_key_create(&thread_cache_key, cache_exit) == 0);
+#endif
 #endif
 }
 
 void ogs_pkbuf_final(void)
 {
 #if OGS_USE_TALLOC == 0
+#if !defined(_WIN32)
+    pthread_key_delete(thread_cache_key);
+#endif
     ogs_pool_final(&pkbuf_pool);
 #endif
 }
@@ -145,7 +213,7 @@ ogs_pkbuf_pool_t *ogs_pkbuf_pool_create(ogs_pkbuf_config_t *config)
 {
     ogs_pkbuf_pool_t *pool = NULL;
 #if OGS_USE_TALLOC == 0
-    int tmp = 0;
+    int tmp = 0, i;
 
     ogs_assert(config);
 
@@ -171,6 +239,16 @@ ogs_pkbuf_pool_t *ogs_pkbuf_pool_create(ogs_pkbuf_config_t *config)
     ogs_pool_init(&pool->cluster_8192, config->cluster_8192_pool);
     ogs_pool_init(&pool->cluster_32768, config->cluster_32768_pool);
     ogs_pool_init(&pool->cluster_big, config->cluster_big_pool);
+
+    /* Keep at most 1/8 of each cluster pool in one thread cache */
+    for (i = 0; i < OGS_PKBUF_NUM_OF_CLUSTER; i++) {
+        int size, avail;
+
+        cluster_usage(pool, i, &size, &avail);
+        pool->batch[i] = ogs_min(OGS_PKBUF_CACHE_SIZE / 2, size / 16);
+    }
+
+    pool->id = ++pkbuf_pool_id;
 #endif
 
     return pool;
@@ -192,13 +270,25 @@ ogs_pkbuf_pool_t *ogs_pkbuf_pool_create(ogs_pkbuf_config_t *config)
     free((pool)->free); \
     free((pool)->array); \
     free((pool)->index); \
+    free((pool)->generation); \
 } while (0)
 
 void ogs_pkbuf_pool_destroy(ogs_pkbuf_pool_t *pool)
 {
 #if OGS_USE_TALLOC == 0
+    ogs_pkbuf_cache_t *cache = NULL;
+    int i;
+
     ogs_assert(pool);
 
+    /* Other threads must not use the pool any more */
+    while ((cache = ogs_list_first(&pool->cache_list))) {
+        for (i = 0; i < OGS_PKBUF_NUM_OF_CLUSTER; i++)
+            cache_flush(pool, cache, i, cache->magazine[i].num);
+        ogs_list_remove(&pool->cache_list, cache);
+        free(cache);
+    }
+
     ogs_pkbuf_pool_final(&pool->pkbuf);
     ogs_pool_final(&pool->cluster);
 
@@ -213,6 +303,8 @@ void ogs_pkbuf_pool_destroy(ogs_pkbuf_pool_t *pool)
 
     ogs_thread_mutex_destroy(&pool->mutex);
 
+    /* Exiting threads must not find their caches in this slot */
+    pool->id = 0;
     ogs_pool_free(&pkbuf_pool, pool);
 #endif
 }
@@ -243,11 +335,51 @@ ogs_pkbuf_t *ogs_pkbuf_alloc_debug(
 #else
     ogs_pkbuf_t *pkbuf = NULL;
     ogs_cluster_t *cluster = NULL;
+    ogs_pkbuf_cache_t *cache = NULL;
+    int i;
 
     if (pool == NULL)
         pool = default_pool;
     ogs_assert(pool);
 
+    for (i = 0; i < OGS_PKBUF_NUM_OF_CLUSTER; i++) {
+        if (size <= cluster_size[i])
+            break;
+    }
+
+    if (i < OGS_PKBUF_NUM_OF_CLUSTER && pool->batch[i] &&
+        (cache = cache_get(pool))) {
+        if (cache->magazine[i].num) {
+            cache->magazine[i].hit++;
+        } else {
+            cache->magazine[i].miss++;
+            cache_refill(pool, cache, i);
+            if (!cache->magazine[i].num) {
+                ogs_error("ogs_pkbuf_alloc() failed [size=%d]", size);
+                return NULL;
+            }
+        }
+
+        pkbuf = cache->magazine[i].pkbuf[--cache->magazine[i].num];
+        cluster = pkbuf->cluster;
+
+        memset(pkbuf, 0, sizeof(*pkbuf));
+        cluster->reference_count = 1;
+
+        pkbuf->cluster = cluster;
+
+        pkbuf->data = cluster->buffer;
+        pkbuf->head = cluster->buffer;
+        pkbuf->tail = cluster->buffer;
+        pkbuf->end = cluster->buffer + size;
+
+        pkbuf->file_line = file_line; /* For debug */
+
+        pkbuf->pool = pool;
+
+        return pkbuf;
+    }
+
     ogs_thread_mutex_lock(&pool->mutex);
 
     cluster = cluster_alloc(pool, size);
@@ -298,11 +430,34 @@ void ogs_pkbuf_free(ogs_pkbuf_t *pkbuf)
     pool = pkbuf->pool;
     ogs_assert(pool);
 
-    ogs_thread_mutex_lock(&pool->mutex);
-
     cluster = pkbuf->cluster;
     ogs_assert(cluster);
 
+    /*
+     * Only the owner of an unshared cluster can see a reference count of 1.
+     * A stale count from another thread only sends us to the locked path.
+     */
+    if (!OGS_OBJECT_IS_REF(cluster)) {
+        ogs_pkbuf_cache_t *cache = NULL;
+        int i;
+
+        for (i = 0; i < OGS_PKBUF_NUM_OF_CLUSTER; i++) {
+            if (cluster->size == cluster_size[i])
+                break;
+        }
+        ogs_assert(i < OGS_PKBUF_NUM_OF_CLUSTER);
+
+        if (pool->batch[i] && (cache = cache_get(pool))) {
+            if (cache->magazine[i].num >= pool->batch[i] * 2)
+                cache_flush(pool, cache, i, pool->batch[i]);
+
+            cache->magazine[i].pkbuf[cache->magazine[i].num++] = pkbuf;
+            return;
+        }
+    }
+
+    ogs_thread_mutex_lock(&pool->mutex);
+
     if (OGS_OBJECT_IS_REF(cluster))
         OGS_OBJECT_UNREF(cluster);
     else
@@ -372,6 +527,80 @@ ogs_pkbuf_t *ogs_pkbuf_copy_debug(ogs_pkbuf_t *pkbuf, const char *file_line)
     return newbuf;
 }
 
+ogs_pkbuf_t *ogs_pkbuf_right_size_debug(ogs_pkbuf_pool_t *pool,
+        ogs_pkbuf_t **scratch, const char *file_line)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+    unsigned int headroom;
+
+    ogs_assert(scratch);
+    pkbuf = *scratch;
+    ogs_assert(pkbuf);
+
+    headroom = ogs_pkbuf_headroom(pkbuf);
+
+#if OGS_USE_TALLOC == 0
+    ogs_assert(pkbuf->cluster);
+    if (headroom + pkbuf->len > pkbuf->cluster->size / 2) {
+        *scratch = NULL;
+        return pkbuf;
+    }
+#endif
+
+    pkbuf = ogs_pkbuf_alloc_debug(pool, headroom + (*scratch)->len, file_line);
+    if (!pkbuf) {
+        pkbuf = *scratch;
+        *scratch = NULL;
+        return pkbuf;
+    }
+
+    ogs_pkbuf_reserve(pkbuf, headroom);
+    ogs_pkbuf_put_data(pkbuf, (*scratch)->data, (*scratch)->len);
+
+    return pkbuf;
+}
+
+void ogs_pkbuf_pool_stat(
+        ogs_pkbuf_pool_t *pool, ogs_pkbuf_pool_stat_t *stat)
+{
+#if OGS_USE_TALLOC == 0
+    ogs_pkbuf_cache_t *cache = NULL;
+    int i;
+
+    if (pool == NULL)
+        pool = default_pool;
+    ogs_assert(pool);
+    ogs_assert(stat);
+
+    memset(stat, 0, sizeof(*stat) * OGS_PKBUF_NUM_OF_CLUSTER);
+
+    ogs_thread_mutex_lock(&pool->mutex);
+
+    for (i = 0; i < OGS_PKBUF_NUM_OF_CLUSTER; i++) {
+        stat[i].cluster_size = cluster_size[i];
+        cluster_usage(pool, i, &stat[i].size, &stat[i].avail);
+    }
+
+    /* Counters of other threads are read without their cooperation */
+    ogs_list_for_each(&pool->cache_list, cache) {
+        for (i = 0; i < OGS_PKBUF_NUM_OF_CLUSTER; i++) {
+            stat[i].cached += cache->magazine[i].num;
+            stat[i].hit += cache->magazine[i].hit;
+            stat[i].miss += cache->magazine[i].miss;
+        }
+    }
+    for (i = 0; i < OGS_PKBUF_NUM_OF_CLUSTER; i++) {
+        stat[i].hit += pool->retired[i].hit;
+        stat[i].miss += pool->retired[i].miss;
+    }
+
+    ogs_thread_mutex_unlock(&pool->mutex);
+#else
+    ogs_assert(stat);
+    memset(stat, 0, sizeof(*stat) * OGS_PKBUF_NUM_OF_CLUSTER);
+#endif
+}
+
 #if OGS_USE_TALLOC == 0
 static ogs_cluster_t *cluster_alloc(
         ogs_pkbuf_pool_t *pool, unsigned int size)
@@ -388,6 +617,7 @@ static ogs_cluster_t *cluster_alloc(
         ogs_pool_alloc(&pool->cluster_128, (ogs_cluster_128_t**)&buffer);
         if (!buffer) {
             ogs_error("ogs_pool_alloc() failed");
+            ogs_pool_free(&pool->cluster, cluster);
             return NULL;
         }
         cluster->size = OGS_CLUSTER_128_SIZE;
@@ -395,6 +625,7 @@ static ogs_cluster_t *cluster_alloc(
         ogs_pool_alloc(&pool->cluster_256, (ogs_cluster_256_t**)&buffer);
         if (!buffer) {
             ogs_error("ogs_pool_alloc() failed");
+            ogs_pool_free(&pool->cluster, cluster);
             return NULL;
         }
         cluster->size = OGS_CLUSTER_256_SIZE;
@@ -402,6 +633,7 @@ static ogs_cluster_t *cluster_alloc(
         ogs_pool_alloc(&pool->cluster_512, (ogs_cluster_512_t**)&buffer);
         if (!buffer) {
             ogs_error("ogs_pool_alloc() failed");
+            ogs_pool_free(&pool->cluster, cluster);
             return NULL;
         }
         cluster->size = OGS_CLUSTER_512_SIZE;
@@ -409,6 +641,7 @@ static ogs_cluster_t *cluster_alloc(
         ogs_pool_alloc(&pool->cluster_1024, (ogs_cluster_1024_t**)&buffer);
         if (!buffer) {
             ogs_error("ogs_pool_alloc() failed");
+            ogs_pool_free(&pool->cluster, cluster);
             return NULL;
         }
         cluster->size = OGS_CLUSTER_1024_SIZE;
@@ -416,6 +649,7 @@ static ogs_cluster_t *cluster_alloc(
         ogs_pool_alloc(&pool->cluster_2048, (ogs_cluster_2048_t**)&buffer);
         if (!buffer) {
             ogs_error("ogs_pool_alloc() failed");
+            ogs_pool_free(&pool->cluster, cluster);
             return NULL;
         }
         cluster->size = OGS_CLUSTER_2048_SIZE;
@@ -423,6 +657,7 @@ static ogs_cluster_t *cluster_alloc(
         ogs_pool_alloc(&pool->cluster_8192, (ogs_cluster_8192_t**)&buffer);
         if (!buffer) {
             ogs_error("ogs_pool_alloc() failed");
+            ogs_pool_free(&pool->cluster, cluster);
             return NULL;
         }
         cluster->size = OGS_CLUSTER_8192_SIZE;
@@ -430,6 +665,7 @@ static ogs_cluster_t *cluster_alloc(
         ogs_pool_alloc(&pool->cluster_32768, (ogs_cluster_32768_t**)&buffer);
         if (!buffer) {
             ogs_error("ogs_pool_alloc() failed");
+            ogs_pool_free(&pool->cluster, cluster);
             return NULL;
         }
         cluster->size = OGS_CLUSTER_32768_SIZE;
@@ -437,6 +673,7 @@ static ogs_cluster_t *cluster_alloc(
         ogs_pool_alloc(&pool->cluster_big, (ogs_cluster_big_t**)&buffer);
         if (!buffer) {
             ogs_error("ogs_pool_alloc() failed");
+            ogs_pool_free(&pool->cluster, cluster);
             return NULL;
         }
         cluster->size = OGS_CLUSTER_BIG_SIZE;
@@ -490,4 +727,169 @@ static void cluster_free(ogs_pkbuf_pool_t *pool, ogs_cluster_t *cluster)
 
     ogs_pool_free(&pool->cluster, cluster);
 }
+
+static void cluster_usage(ogs_pkbuf_pool_t *pool,
+        int index, int *size, int *avail)
+{
+    ogs_assert(pool);
+    ogs_assert(size);
+    ogs_assert(avail);
+
+    switch (cluster_size[index]) {
+    case OGS_CLUSTER_128_SIZE:
+        *size = ogs_pool_size(&pool->cluster_128);
+        *avail = ogs_pool_avail(&pool->cluster_128);
+        break;
+    case OGS_CLUSTER_256_SIZE:
+        *size = ogs_pool_size(&pool->cluster_256);
+        *avail = ogs_pool_avail(&pool->cluster_256);
+        break;
+    case OGS_CLUSTER_512_SIZE:
+        *size = ogs_pool_size(&pool->cluster_512);
+        *avail = ogs_pool_avail(&pool->cluster_512);
+        break;
+    case OGS_CLUSTER_1024_SIZE:
+        *size = ogs_pool_size(&pool->cluster_1024);
+        *avail = ogs_pool_avail(&pool->cluster_1024);
+        break;
+    case OGS_CLUSTER_2048_SIZE:
+        *size = ogs_pool_size(&pool->cluster_2048);
+        *avail = ogs_pool_avail(&pool->cluster_2048);
+        break;
+    case OGS_CLUSTER_8192_SIZE:
+        *size = ogs_pool_size(&pool->cluster_8192);
+        *avail = ogs_pool_avail(&pool->cluster_8192);
+        break;
+    case OGS_CLUSTER_32768_SIZE:
+        *size = ogs_pool_size(&pool->cluster_32768);
+        *avail = ogs_pool_avail(&pool->cluster_32768);
+        break;
+    case OGS_CLUSTER_BIG_SIZE:
+        *size = ogs_pool_size(&pool->cluster_big);
+        *avail = ogs_pool_avail(&pool->cluster_big);
+        break;
+    default:
+        ogs_assert_if_reached();
+    }
+}
+
+static ogs_pkbuf_cache_t *cache_get(ogs_pkbuf_pool_t *pool)
+{
+    ogs_pkbuf_cache_t *cache = NULL;
+    int i;
+
+    i = ogs_pool_index(&pkbuf_pool, pool) - 1;
+    if (i >= OGS_PKBUF_MAX_THREAD_CACHE)
+        return NULL;
+
+    /* The pool in this slot may have been destroyed and created again */
+    if (thread_cache[i].pool == pool && thread_cache[i].id == pool->id)
+        return thread_cache[i].cache;
+
+    /* ogs_calloc() cannot be used since it allocates from the pkbuf pool */
+    cache = calloc(1, sizeof(*cache));
+    if (!cache) {
+        ogs_error("calloc() failed");
+        return NULL;
+    }
+
+    ogs_thread_mutex_lock(&pool->mutex);
+    ogs_list_add(&pool->cache_list, cache);
+    ogs_thread_mutex_unlock(&pool->mutex);
+
+    thread_cache[i].pool = pool;
+    thread_cache[i].id = pool->id;
+    thread_cache[i].cache = cache;
+
+#if !defined(_WIN32)
+    /* Any non-NULL value makes cache_exit() run at thread exit */
+    pthread_setspecific(thread_cache_key, thread_cache);
+#endif
+
+    return cache;
+}
+
+static void cache_refill(ogs_pkbuf_pool_t *pool,
+        ogs_pkbuf_cache_t *cache, int index)
+{
+    int size, avail, num;
+
+    ogs_assert(pool);
+    ogs_assert(cache);
+
+    ogs_thread_mutex_lock(&pool->mutex);
+
+    cluster_usage(pool, index, &size, &avail);
+    num = ogs_min(pool->batch[index], avail);
+
+    while (cache->magazine[index].num < num) {
+        ogs_pkbuf_t *pkbuf = NULL;
+        ogs_cluster_t *cluster = NULL;
+
+        cluster = cluster_alloc(pool, cluster_size[index]);
+        if (!cluster)
+            break;
+
+        ogs_pool_alloc(&pool->pkbuf, &pkbuf);
+        if (!pkbuf) {
+            cluster_free(pool, cluster);
+            break;
+        }
+
+        pkbuf->cluster = cluster;
+        cache->magazine[index].pkbuf[cache->magazine[index].num++] = pkbuf;
+    }
+
+    ogs_thread_mutex_unlock(&pool->mutex);
+}
+
+static void cache_flush(ogs_pkbuf_pool_t *pool,
+        ogs_pkbuf_cache_t *cache, int index, int num)
+{
+    ogs_assert(pool);
+    ogs_assert(cache);
+    ogs_assert(num <= cache->magazine[index].num);
+
+    ogs_thread_mutex_lock(&pool->mutex);
+
+    while (num--) {
+        ogs_pkbuf_t *pkbuf =
+            cache->magazine[index].pkbuf[--cache->magazine[index].num];
+
+        cluster_free(pool, pkbuf->cluster);
+        ogs_pool_free(&pool->pkbuf, pkbuf);
+    }
+
+    ogs_thread_mutex_unlock(&pool->mutex);
+}
+
+#if !defined(_WIN32)
+static void cache_exit(void *data)
+{
+    int i, j;
+
+    for (i = 0; i < OGS_PKBUF_MAX_THREAD_CACHE; i++) {
+        ogs_pkbuf_pool_t *pool = thread_cache[i].pool;
+        ogs_pkbuf_cache_t *cache = thread_cache[i].cache;
+
+        /* The cache was freed along with its pool */
+        if (!pool || pool->id != thread_cache[i].id)
+            continue;
+
+        for (j = 0; j < OGS_PKBUF_NUM_OF_CLUSTER; j++)
+            cache_flush(pool, cache, j, cache->magazine[j].num);
+
+        ogs_thread_mutex_lock(&pool->mutex);
+        for (j = 0; j < OGS_PKBUF_NUM_OF_CLUSTER; j++) {
+            pool->retired[j].hit += cache->magazine[j].hit;
+            pool->retired[j].miss += cache->magazine[j].miss;
+        }
+        ogs_list_remove(&pool->cache_list, cache);
+        ogs_thread_mutex_unlock(&pool->mutex);
+
+        free(cache);
+        memset(&thread_cache[i], 0, sizeof(thread_cache[i]));
+    }
+}
+#endif
 #endif
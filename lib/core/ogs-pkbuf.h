@@ -73,6 +73,18 @@ typedef struct ogs_pkbuf_config_s {
     int cluster_big_pool;
 } ogs_pkbuf_config_t;
 
+#define OGS_PKBUF_NUM_OF_CLUSTER 8
+typedef struct ogs_pkbuf_pool_stat_s {
+    unsigned int cluster_size;
+
+    int size;           /* Clusters in the pool */
+    int avail;          /* Clusters not allocated and not cached */
+    int cached;         /* Clusters held by per-thread caches */
+
+    uint64_t hit;       /* Allocations served by a per-thread cache */
+    uint64_t miss;      /* Allocations that refilled a per-thread cache */
+} ogs_pkbuf_pool_stat_t;
+
 void ogs_pkbuf_init(void);
 void ogs_pkbuf_final(void);
 
@@ -82,6 +94,8 @@ void ogs_pkbuf_default_destroy(void);
 
 ogs_pkbuf_pool_t *ogs_pkbuf_pool_create(ogs_pkbuf_config_t *config);
 void ogs_pkbuf_pool_destroy(ogs_pkbuf_pool_t *pool);
+void ogs_pkbuf_pool_stat(
+        ogs_pkbuf_pool_t *pool, ogs_pkbuf_pool_stat_t *stat);
 
 #define ogs_pkbuf_alloc(pool, size) \
     ogs_pkbuf_alloc_debug(pool, size, OGS_FILE_LINE)
@@ -95,6 +109,17 @@ void *ogs_pkbuf_put_data(
     ogs_pkbuf_copy_debug(pkbuf, OGS_FILE_LINE)
 ogs_pkbuf_t *ogs_pkbuf_copy_debug(ogs_pkbuf_t *pkbuf, const char *file_line);
 
+/*
+ * For a receive buffer that is reused across reads. The packet is copied
+ * with the same headroom into the smallest cluster that fits, leaving
+ * *scratch for the next read. If that would not save a cluster size, or
+ * the allocation fails, *scratch itself is returned and set to NULL.
+ */
+#define ogs_pkbuf_right_size(pool, scratch) \
+    ogs_pkbuf_right_size_debug(pool, scratch, OGS_FILE_LINE)
+ogs_pkbuf_t *ogs_pkbuf_right_size_debug(ogs_pkbuf_pool_t *pool,
+        ogs_pkbuf_t **scratch, const char *file_line);
+
 static ogs_inline int ogs_pkbuf_tailroom(const ogs_pkbuf_t *pkbuf)
 {
     return pkbuf->end - pkbuf->tail;
@@ -41,8 +41,8 @@ typedef int32_t ogs_pool_id_t;
         int size, avail; \
         type **free, *array, **index; \
         \
-        ogs_hash_t *id_hash; \
-        ogs_pool_id_t id; \
+        ogs_pool_id_t *generation; \
+        int id_shift; \
     } pool
 
 /*
@@ -58,15 +58,20 @@ typedef int32_t ogs_pool_id_t;
     ogs_assert((pool)->array); \
     (pool)->index = malloc(sizeof(*(pool)->index) * _size); \
     ogs_assert((pool)->index); \
+    (pool)->generation = malloc(sizeof(*(pool)->generation) * _size); \
+    ogs_assert((pool)->generation); \
     (pool)->size = (pool)->avail = _size; \
     (pool)->head = (pool)->tail = 0; \
     for (i = 0; i < _size; i++) { \
         (pool)->free[i] = &((pool)->array[i]); \
         (pool)->index[i] = NULL; \
+        (pool)->generation[i] = 0; \
     } \
     \
-    (pool)->id_hash = ogs_hash_make(); \
-    ogs_assert((pool)->id_hash); \
+    (pool)->id_shift = 1; \
+    while ((1 << (pool)->id_shift) <= (_size)) \
+        (pool)->id_shift++; \
+    ogs_assert((pool)->id_shift < 31); \
 } while (0)
 
 /*
@@ -80,9 +85,7 @@ typedef int32_t ogs_pool_id_t;
     free((pool)->free); \
     free((pool)->array); \
     free((pool)->index); \
-    \
-    ogs_assert((pool)->id_hash); \
-    ogs_hash_destroy((pool)->id_hash); \
+    free((pool)->generation); \
 } while (0)
 
 /*
@@ -100,15 +103,20 @@ typedef int32_t ogs_pool_id_t;
     ogs_assert((pool)->array); \
     (pool)->index = ogs_malloc(sizeof(*(pool)->index) * _size); \
     ogs_assert((pool)->index); \
+    (pool)->generation = ogs_malloc(sizeof(*(pool)->generation) * _size); \
+    ogs_assert((pool)->generation); \
     (pool)->size = (pool)->avail = _size; \
     (pool)->head = (pool)->tail = 0; \
     for (i = 0; i < _size; i++) { \
         (pool)->free[i] = &((pool)->array[i]); \
         (pool)->index[i] = NULL; \
+        (pool)->generation[i] = 0; \
     } \
     \
-    (pool)->id_hash = ogs_hash_make(); \
-    ogs_assert((pool)->id_hash); \
+    (pool)->id_shift = 1; \
+    while ((1 << (pool)->id_shift) <= (_size)) \
+        (pool)->id_shift++; \
+    ogs_assert((pool)->id_shift < 31); \
 } while (0)
 
 /*
@@ -124,9 +132,7 @@ typedef int32_t ogs_pool_id_t;
     ogs_free((pool)->free); \
     ogs_free((pool)->array); \
     ogs_free((pool)->index); \
-    \
-    ogs_assert((pool)->id_hash); \
-    ogs_hash_destroy((pool)->id_hash); \
+    ogs_free((pool)->generation); \
 } while (0)
 
 #define ogs_pool_alloc(pool, node) do { \
@@ -153,26 +159,43 @@ typedef int32_t ogs_pool_id_t;
 #define ogs_pool_find(pool, _index) \
     (_index > 0 && _index <= (pool)->size) ? (pool)->index[_index-1] : NULL
 
+/*
+ * An ID is made of the 1-based slot index in the lower 'id_shift' bits
+ * and a per-slot generation in the upper bits. The generation is bumped
+ * on every ogs_pool_id_calloc(), so a stale ID is rejected by
+ * ogs_pool_find_by_id() once the slot has been reused.
+ */
+#define ogs_pool_id_index(pool, _id) \
+    ((int)((_id) & ((1 << (pool)->id_shift) - 1)))
+#define ogs_pool_id_generation_mask(pool) \
+    ((1 << (31 - (pool)->id_shift)) - 1)
+
 #define ogs_pool_id_calloc(pool, node) do { \
     ogs_pool_alloc(pool, node); \
     if (*node) { \
+        int __index = ogs_pool_index(pool, *(node)); \
         memset(*(node), 0, sizeof(**(node))); \
-        (*(node))->id = OGS_NEXT_ID((pool)->id, 1, OGS_MAX_POOL_ID); \
-        ogs_hash_set((pool)->id_hash, \
-                &((*(node))->id), sizeof(ogs_pool_id_t), *(node)); \
+        (pool)->generation[__index-1] = \
+            ((pool)->generation[__index-1] + 1) & \
+            ogs_pool_id_generation_mask(pool); \
+        (*(node))->id = \
+            ((pool)->generation[__index-1] << (pool)->id_shift) | __index; \
     } \
 } while (0)
 
 #define ogs_pool_id_free(pool, node) do { \
     ogs_assert(((node)->id) >= OGS_MIN_POOL_ID && \
             ((node)->id) <= OGS_MAX_POOL_ID); \
-    ogs_hash_set((pool)->id_hash, \
-            &((node)->id), sizeof(ogs_pool_id_t), NULL); \
     ogs_pool_free(pool, node); \
 } while (0)
 
-#define ogs_pool_find_by_id(pool, id) \
-    ogs_hash_get((pool)->id_hash, &id, sizeof(ogs_pool_id_t))
+#define ogs_pool_find_by_id(pool, _id) \
+    (((_id) >= OGS_MIN_POOL_ID && \
+      ogs_pool_id_index(pool, _id) > 0 && \
+      ogs_pool_id_index(pool, _id) <= (pool)->size && \
+      (pool)->index[ogs_pool_id_index(pool, _id)-1] && \
+      (pool)->index[ogs_pool_id_index(pool, _id)-1]->id == (_id)) ? \
+        (pool)->index[ogs_pool_id_index(pool, _id)-1] : NULL)
 
 #define ogs_pool_size(pool) ((pool)->size)
 #define ogs_pool_avail(pool) ((pool)->avail)
@@ -19,6 +19,11 @@
 
 #include "core-config-private.h"
 
+/* recvmmsg() and sendmmsg() are GNU extensions */
+#if (HAVE_RECVMMSG || HAVE_SENDMMSG) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #if HAVE_FCNTL_H
 #include <fcntl.h>
 #endif
@@ -245,6 +250,140 @@ ssize_t ogs_recvfrom(ogs_socket_t fd,
     return recvfrom(fd, buf, len, flags, &from->sa, &addrlen);
 }
 
+/*
+ * Receive up to 'num' datagrams in one call.
+ *
+ * Each pkbuf[i] must be prepared by the caller with pkbuf[i]->len set
+ * to the available room. On return, the first N buffers are trimmed
+ * to the received size and from[i] holds the peer address.
+ *
+ * Only the first datagram may block. Returns the number of datagrams
+ * received, or -1 with the socket errno set if nothing was received.
+ */
+int ogs_recvmmsg(ogs_socket_t fd,
+        ogs_pkbuf_t **pkbuf, ogs_sockaddr_t *from, int num, int flags)
+{
+#if HAVE_RECVMMSG
+    struct mmsghdr msgs[OGS_MAX_NUM_OF_MMSG];
+    struct iovec iovecs[OGS_MAX_NUM_OF_MMSG];
+#endif
+    int i, n;
+
+    ogs_assert(fd != INVALID_SOCKET);
+    ogs_assert(pkbuf);
+    ogs_assert(from);
+    ogs_assert(num > 0 && num <= OGS_MAX_NUM_OF_MMSG);
+
+#if HAVE_RECVMMSG
+    memset(msgs, 0, sizeof(struct mmsghdr) * num);
+    for (i = 0; i < num; i++) {
+        ogs_assert(pkbuf[i]);
+
+        iovecs[i].iov_base = pkbuf[i]->data;
+        iovecs[i].iov_len = pkbuf[i]->len;
+
+        memset(&from[i], 0, sizeof from[i]);
+        msgs[i].msg_hdr.msg_iov = &iovecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &from[i].sa;
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+    }
+
+    n = recvmmsg(fd, msgs, num, flags|MSG_WAITFORONE, NULL);
+    for (i = 0; i < n; i++)
+        ogs_pkbuf_trim(pkbuf[i], msgs[i].msg_len);
+
+    return n;
+#else
+    for (i = 0; i < num; i++) {
+        ssize_t size;
+
+        ogs_assert(pkbuf[i]);
+
+        if (i > 0) {
+#ifdef MSG_DONTWAIT
+            flags |= MSG_DONTWAIT;
+#else
+            /* Only the first read is known not to block */
+            break;
+#endif
+        }
+
+        size = ogs_recvfrom(fd,
+                pkbuf[i]->data, pkbuf[i]->len, flags, &from[i]);
+        if (size < 0)
+            break;
+
+        ogs_pkbuf_trim(pkbuf[i], size);
+    }
+
+    n = i;
+    return n ? n : -1;
+#endif
+}
+
+/*
+ * Send 'num' datagrams in as few calls as possible.
+ * pkbuf[i] is sent to to[i]; the buffers are not freed.
+ *
+ * Returns the number of datagrams sent, or -1 with the socket errno set
+ * if nothing was sent.
+ */
+int ogs_sendmmsg(ogs_socket_t fd,
+        ogs_pkbuf_t **pkbuf, ogs_sockaddr_t *to, int num, int flags)
+{
+#if HAVE_SENDMMSG
+    struct mmsghdr msgs[OGS_MAX_NUM_OF_MMSG];
+    struct iovec iovecs[OGS_MAX_NUM_OF_MMSG];
+    int sent = 0;
+#endif
+    int i, n;
+
+    ogs_assert(fd != INVALID_SOCKET);
+    ogs_assert(pkbuf);
+    ogs_assert(to);
+    ogs_assert(num > 0 && num <= OGS_MAX_NUM_OF_MMSG);
+
+#if HAVE_SENDMMSG
+    memset(msgs, 0, sizeof(struct mmsghdr) * num);
+    for (i = 0; i < num; i++) {
+        ogs_assert(pkbuf[i]);
+
+        iovecs[i].iov_base = pkbuf[i]->data;
+        iovecs[i].iov_len = pkbuf[i]->len;
+
+        msgs[i].msg_hdr.msg_iov = &iovecs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = (struct sockaddr *)&to[i].sa;
+        msgs[i].msg_hdr.msg_namelen = ogs_sockaddr_len(&to[i]);
+        ogs_assert(msgs[i].msg_hdr.msg_namelen);
+    }
+
+    /* sendmmsg() may stop early, so resume from the first unsent one */
+    while (sent < num) {
+        n = sendmmsg(fd, msgs + sent, num - sent, flags);
+        if (n <= 0)
+            break;
+        sent += n;
+    }
+
+    return sent ? sent : -1;
+#else
+    for (i = 0; i < num; i++) {
+        ssize_t size;
+
+        ogs_assert(pkbuf[i]);
+
+        size = ogs_sendto(fd, pkbuf[i]->data, pkbuf[i]->len, flags, &to[i]);
+        if (size < 0)
+            break;
+    }
+
+    n = i;
+    return n ? n : -1;
+#endif
+}
+
 int ogs_closesocket(ogs_socket_t fd)
 {
     int r;
@@ -69,6 +69,12 @@ ssize_t ogs_recv(ogs_socket_t fd, void *buf, size_t len, int flags);
 ssize_t ogs_recvfrom(ogs_socket_t fd,
         void *buf, size_t len, int flags, ogs_sockaddr_t *from);
 
+#define OGS_MAX_NUM_OF_MMSG 32
+int ogs_recvmmsg(ogs_socket_t fd,
+        ogs_pkbuf_t **pkbuf, ogs_sockaddr_t *from, int num, int flags);
+int ogs_sendmmsg(ogs_socket_t fd,
+        ogs_pkbuf_t **pkbuf, ogs_sockaddr_t *to, int num, int flags);
+
 int ogs_closesocket(ogs_socket_t fd);
 
 #ifdef __cplusplus
@@ -69,6 +69,28 @@ static ogs_inline int ogs_thread_cond_timedwait(
 #define ogs_thread_cond_destroy (void)pthread_cond_destroy
 #define ogs_thread_id_t pthread_t
 #define ogs_thread_join(_n) pthread_join((_n), NULL)
+#define ogs_thread_rwlock_t pthread_rwlock_t
+static ogs_inline void ogs_thread_rwlock_init(pthread_rwlock_t *rwlock)
+{
+    pthread_rwlockattr_t attr;
+
+    pthread_rwlockattr_init(&attr);
+#if defined(__GLIBC__)
+    /*
+     * glibc prefers readers by default, so a writer can starve
+     * while readers keep re-acquiring the lock.
+     */
+    pthread_rwlockattr_setkind_np(&attr,
+            PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    (void)pthread_rwlock_init(rwlock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+}
+#define ogs_thread_rwlock_rdlock (void)pthread_rwlock_rdlock
+#define ogs_thread_rwlock_wrlock (void)pthread_rwlock_wrlock
+#define ogs_thread_rwlock_rdunlock (void)pthread_rwlock_unlock
+#define ogs_thread_rwlock_wrunlock (void)pthread_rwlock_unlock
+#define ogs_thread_rwlock_destroy (void)pthread_rwlock_destroy
 #else
 #define ogs_thread_mutex_t CRITICAL_SECTION
 #define ogs_thread_mutex_init InitializeCriticalSection
@@ -103,6 +125,15 @@ static ogs_inline int ogs_thread_cond_destroy(ogs_thread_cond_t *_ignored)
 {
    return 0;
 }
+#define ogs_thread_rwlock_t SRWLOCK
+#define ogs_thread_rwlock_init InitializeSRWLock
+#define ogs_thread_rwlock_rdlock AcquireSRWLockShared
+#define ogs_thread_rwlock_wrlock AcquireSRWLockExclusive
+#define ogs_thread_rwlock_rdunlock ReleaseSRWLockShared
+#define ogs_thread_rwlock_wrunlock ReleaseSRWLockExclusive
+static ogs_inline void ogs_thread_rwlock_destroy(ogs_thread_rwlock_t *_ignored)
+{
+}
 #endif
 
 typedef struct ogs_thread_s ogs_thread_t;
@@ -22,9 +22,42 @@
 #undef OGS_LOG_DOMAIN
 #define OGS_LOG_DOMAIN __ogs_event_domain
 
+/*
+ * Hierarchical timing wheel
+ *
+ * Level 0 has one slot per tick; each upper level has slots that are
+ * OGS_TIMER_WHEEL_SIZE times wider. Timers in upper levels are cascaded
+ * down when the lower level wraps around. Start/stop are O(1).
+ */
+#define OGS_TIMER_WHEEL_BITS 6
+#define OGS_TIMER_WHEEL_SIZE (1 << OGS_TIMER_WHEEL_BITS)
+#define OGS_TIMER_WHEEL_MASK (OGS_TIMER_WHEEL_SIZE - 1)
+#define OGS_TIMER_WHEEL_LEVEL 6
+#define OGS_TIMER_WHEEL_TICK ogs_time_from_msec(1)
+#define OGS_TIMER_WHEEL_MAX_DELTA \
+    (((uint64_t)1 << (OGS_TIMER_WHEEL_BITS * OGS_TIMER_WHEEL_LEVEL)) - 1)
+
 typedef struct ogs_timer_mgr_s {
     OGS_POOL(pool, ogs_timer_t);
+    ogs_timer_backend_e backend;
+
     ogs_rbtree_t tree;
+
+    struct {
+        uint64_t tick;      /* Next tick to be processed */
+        /* Clock read by the last ogs_timer_mgr_expire(), which timers
+         * started while handling the events after it are based on.
+         * 0 once ogs_timer_mgr_next() is called, since the caller
+         * is then about to wait. */
+        ogs_time_t current;
+        unsigned int count; /* Number of timers in the wheel */
+        uint64_t bitmap[OGS_TIMER_WHEEL_LEVEL];
+        /* Earliest expiry tick in each slot. It may be stale (too early)
+         * after a stop, which only causes an early wakeup. */
+        uint64_t expires[OGS_TIMER_WHEEL_LEVEL][OGS_TIMER_WHEEL_SIZE];
+        ogs_list_t slot[OGS_TIMER_WHEEL_LEVEL][OGS_TIMER_WHEEL_SIZE];
+        ogs_list_t expired;
+    } wheel;
 } ogs_timer_mgr_t;
 
 static void add_timer_node(
@@ -52,7 +85,199 @@ static void add_timer_node(
     ogs_rbtree_insert_color(tree, timer);
 }
 
+static ogs_inline int wheel_ctz(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+
+    while (!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/* Distance from 'pos' to the next non-empty slot, wrapping around */
+static ogs_inline int wheel_next_slot(uint64_t bitmap, int pos)
+{
+    uint64_t rotated = bitmap >> pos;
+
+    if (pos)
+        rotated |= bitmap << (OGS_TIMER_WHEEL_SIZE - pos);
+
+    return wheel_ctz(rotated);
+}
+
+static void wheel_add(ogs_timer_mgr_t *manager, ogs_timer_t *timer)
+{
+    uint64_t expires, delta;
+    int level, index;
+
+    expires = (timer->timeout + OGS_TIMER_WHEEL_TICK - 1) /
+        OGS_TIMER_WHEEL_TICK;
+    if (expires < manager->wheel.tick)
+        expires = manager->wheel.tick;
+
+    delta = expires - manager->wheel.tick;
+    if (delta > OGS_TIMER_WHEEL_MAX_DELTA) {
+        delta = OGS_TIMER_WHEEL_MAX_DELTA;
+        expires = manager->wheel.tick + delta;
+    }
+
+    for (level = 0; level < OGS_TIMER_WHEEL_LEVEL - 1; level++) {
+        if (delta < ((uint64_t)1 << (OGS_TIMER_WHEEL_BITS * (level + 1))))
+            break;
+    }
+    index = (expires >> (OGS_TIMER_WHEEL_BITS * level)) &
+        OGS_TIMER_WHEEL_MASK;
+
+    if (!(manager->wheel.bitmap[level] & ((uint64_t)1 << index)) ||
+        expires < manager->wheel.expires[level][index])
+        manager->wheel.expires[level][index] = expires;
+
+    timer->slot = &manager->wheel.slot[level][index];
+    ogs_list_add(timer->slot, &timer->lnode);
+    manager->wheel.bitmap[level] |= (uint64_t)1 << index;
+    manager->wheel.count++;
+}
+
+static void wheel_del(ogs_timer_mgr_t *manager, ogs_timer_t *timer)
+{
+    ogs_list_t *slot = timer->slot;
+    int n;
+
+    ogs_assert(slot);
+    ogs_list_remove(slot, &timer->lnode);
+    timer->slot = NULL;
+
+    if (slot == &manager->wheel.expired)
+        return;
+
+    manager->wheel.count--;
+    if (ogs_list_empty(slot)) {
+        n = slot - &manager->wheel.slot[0][0];
+        manager->wheel.bitmap[n / OGS_TIMER_WHEEL_SIZE] &=
+            ~((uint64_t)1 << (n % OGS_TIMER_WHEEL_SIZE));
+    }
+}
+
+static void wheel_cascade(ogs_timer_mgr_t *manager, int level, int index)
+{
+    ogs_list_t list;
+    ogs_lnode_t *lnode, *next_lnode;
+
+    if (!(manager->wheel.bitmap[level] & ((uint64_t)1 << index)))
+        return;
+
+    ogs_list_copy(&list, &manager->wheel.slot[level][index]);
+    ogs_list_init(&manager->wheel.slot[level][index]);
+    manager->wheel.bitmap[level] &= ~((uint64_t)1 << index);
+
+    ogs_list_for_each_safe(&list, next_lnode, lnode) {
+        ogs_timer_t *this = ogs_rb_entry(lnode, ogs_timer_t, lnode);
+
+        manager->wheel.count--;
+        wheel_add(manager, this);
+    }
+}
+
+static void wheel_collect(ogs_timer_mgr_t *manager, int index)
+{
+    ogs_lnode_t *lnode, *next_lnode;
+    ogs_list_t *slot = &manager->wheel.slot[0][index];
+
+    if (!(manager->wheel.bitmap[0] & ((uint64_t)1 << index)))
+        return;
+
+    ogs_list_for_each_safe(slot, next_lnode, lnode) {
+        ogs_timer_t *this = ogs_rb_entry(lnode, ogs_timer_t, lnode);
+
+        this->slot = &manager->wheel.expired;
+        ogs_list_add(this->slot, &this->lnode);
+        manager->wheel.count--;
+    }
+    ogs_list_init(slot);
+    manager->wheel.bitmap[0] &= ~((uint64_t)1 << index);
+}
+
+static void wheel_advance(ogs_timer_mgr_t *manager, uint64_t target)
+{
+    while (manager->wheel.tick <= target) {
+        uint64_t tick = manager->wheel.tick;
+        int index = tick & OGS_TIMER_WHEEL_MASK;
+        uint64_t bitmap;
+
+        if (!manager->wheel.count) {
+            manager->wheel.tick = target + 1;
+            break;
+        }
+
+        if (index == 0) {
+            int level;
+
+            for (level = 1; level < OGS_TIMER_WHEEL_LEVEL; level++) {
+                int i = (tick >> (OGS_TIMER_WHEEL_BITS * level)) &
+                    OGS_TIMER_WHEEL_MASK;
+                wheel_cascade(manager, level, i);
+                if (i != 0)
+                    break;
+            }
+        }
+
+        wheel_collect(manager, index);
+
+        /* Skip empty slots up to the next cascade */
+        tick++;
+        index = tick & OGS_TIMER_WHEEL_MASK;
+        if (index) {
+            bitmap = manager->wheel.bitmap[0] >> index;
+            if (bitmap)
+                tick += wheel_ctz(bitmap);
+            else
+                tick = (tick | OGS_TIMER_WHEEL_MASK) + 1;
+        }
+
+        manager->wheel.tick = ogs_min(tick, target + 1);
+    }
+}
+
+static uint64_t wheel_next_tick(ogs_timer_mgr_t *manager)
+{
+    uint64_t next = UINT64_MAX;
+    int level;
+
+    for (level = 0; level < OGS_TIMER_WHEEL_LEVEL; level++) {
+        int shift = OGS_TIMER_WHEEL_BITS * level;
+        int start, index;
+
+        if (!manager->wheel.bitmap[level])
+            continue;
+
+        /* The current slot has already been cascaded
+         * unless the tick is on its boundary */
+        start = (manager->wheel.tick >> shift) & OGS_TIMER_WHEEL_MASK;
+        if (manager->wheel.tick & (((uint64_t)1 << shift) - 1))
+            start = (start + 1) & OGS_TIMER_WHEEL_MASK;
+
+        index = (start + wheel_next_slot(
+                    manager->wheel.bitmap[level], start)) &
+            OGS_TIMER_WHEEL_MASK;
+        next = ogs_min(next, manager->wheel.expires[level][index]);
+    }
+
+    return next;
+}
+
 ogs_timer_mgr_t *ogs_timer_mgr_create(unsigned int capacity)
+{
+    return ogs_timer_mgr_create_backend(capacity, OGS_TIMER_BACKEND_RBTREE);
+}
+
+ogs_timer_mgr_t *ogs_timer_mgr_create_backend(
+        unsigned int capacity, ogs_timer_backend_e backend)
 {
     ogs_timer_mgr_t *manager = ogs_calloc(1, sizeof *manager);
     if (!manager) {
@@ -62,6 +287,9 @@ ogs_timer_mgr_t *ogs_timer_mgr_create(unsigned int capacity)
 
     ogs_pool_init(&manager->pool, capacity);
 
+    manager->backend = backend;
+    manager->wheel.tick = ogs_get_monotonic_time() / OGS_TIMER_WHEEL_TICK;
+
     return manager;
 }
 
@@ -116,6 +344,19 @@ void ogs_timer_start_debug(
     manager = timer->manager;
     ogs_assert(manager);
 
+    if (manager->backend == OGS_TIMER_BACKEND_WHEEL) {
+        if (timer->running == true)
+            wheel_del(manager, timer);
+
+        if (!manager->wheel.current)
+            manager->wheel.current = ogs_get_monotonic_time();
+
+        timer->running = true;
+        timer->timeout = manager->wheel.current + duration;
+        wheel_add(manager, timer);
+        return;
+    }
+
     if (timer->running == true)
         ogs_rbtree_delete(&manager->tree, timer);
 
@@ -134,7 +375,10 @@ void ogs_timer_stop_debug(ogs_timer_t *timer, const char *file_line)
         return;
 
     timer->running = false;
-    ogs_rbtree_delete(&manager->tree, timer);
+    if (manager->backend == OGS_TIMER_BACKEND_WHEEL)
+        wheel_del(manager, timer);
+    else
+        ogs_rbtree_delete(&manager->tree, timer);
 }
 
 ogs_time_t ogs_timer_mgr_next(ogs_timer_mgr_t *manager)
@@ -144,6 +388,22 @@ ogs_time_t ogs_timer_mgr_next(ogs_timer_mgr_t *manager)
     ogs_assert(manager);
 
     current = ogs_get_monotonic_time();
+
+    if (manager->backend == OGS_TIMER_BACKEND_WHEEL) {
+        ogs_time_t timeout;
+
+        manager->wheel.current = 0;
+
+        if (!manager->wheel.count)
+            return OGS_INFINITE_TIME;
+
+        timeout = wheel_next_tick(manager) * OGS_TIMER_WHEEL_TICK;
+        if (timeout > current)
+            return (timeout - current);
+        else
+            return OGS_NO_WAIT_TIME;
+    }
+
     rbnode = ogs_rbtree_first(&manager->tree);
     if (rbnode) {
         ogs_timer_t *this = ogs_rb_entry(rbnode, ogs_timer_t, rbnode);
@@ -169,6 +429,21 @@ void ogs_timer_mgr_expire(ogs_timer_mgr_t *manager)
 
     current = ogs_get_monotonic_time();
 
+    if (manager->backend == OGS_TIMER_BACKEND_WHEEL) {
+        manager->wheel.current = current;
+        wheel_advance(manager, current / OGS_TIMER_WHEEL_TICK);
+
+        /* A timer stopped or deleted by an earlier callback
+         * is removed from the expired list and will not fire. */
+        while ((lnode = ogs_list_first(&manager->wheel.expired))) {
+            this = ogs_rb_entry(lnode, ogs_timer_t, lnode);
+            ogs_timer_stop(this);
+            if (this->cb)
+                this->cb(this->data);
+        }
+        return;
+    }
+
     ogs_rbtree_for_each(&manager->tree, rbnode) {
         this = ogs_rb_entry(rbnode, ogs_timer_t, rbnode);
 
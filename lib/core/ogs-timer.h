@@ -28,10 +28,16 @@
 extern "C" {
 #endif
 
+typedef enum {
+    OGS_TIMER_BACKEND_RBTREE = 0,
+    OGS_TIMER_BACKEND_WHEEL,
+} ogs_timer_backend_e;
+
 typedef struct ogs_timer_mgr_s ogs_timer_mgr_t;
 typedef struct ogs_timer_s {
     ogs_rbnode_t rbnode;
     ogs_lnode_t lnode;
+    ogs_list_t *slot;       /* timing wheel slot */
 
     void (*cb)(void*);
     void *data;
@@ -42,6 +48,8 @@ typedef struct ogs_timer_s {
 } ogs_timer_t;
 
 ogs_timer_mgr_t *ogs_timer_mgr_create(unsigned int capacity);
+ogs_timer_mgr_t *ogs_timer_mgr_create_backend(
+        unsigned int capacity, ogs_timer_backend_e backend);
 void ogs_timer_mgr_destroy(ogs_timer_mgr_t *manager);
 
 ogs_timer_t *ogs_timer_add(
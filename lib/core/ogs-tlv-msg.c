@@ -95,33 +95,106 @@ static uint8_t tlv_ctype2mode(ogs_tlv_type_e ctype, uint8_t msg_mode)
     }
 }
 
-static ogs_tlv_t *tlv_add_leaf(
-        ogs_tlv_t *parent_tlv, ogs_tlv_t *tlv, ogs_tlv_desc_t *desc, void *msg, uint8_t msg_mode)
+static uint8_t tlv_header_len(uint8_t mode)
 {
-    uint8_t tlv_mode = tlv_ctype2mode(desc->ctype, msg_mode);
+    switch(mode) {
+    case OGS_TLV_MODE_T1_L1:
+        return 2;
+    case OGS_TLV_MODE_T1_L2:
+        return 3;
+    case OGS_TLV_MODE_T1_L2_I1:
+    case OGS_TLV_MODE_T2_L2:
+        return 4;
+    case OGS_TLV_MODE_T1:
+        return 1;
+    default:
+        ogs_assert_if_reached();
+        break;
+    }
+
+    return 0;
+}
+
+static uint8_t *tlv_put_header(uint8_t *pos, uint8_t mode,
+        uint16_t type, uint32_t length, uint8_t instance)
+{
+    switch(mode) {
+    case OGS_TLV_MODE_T1_L1:
+        *(pos++) = type & 0xff;
+        *(pos++) = length & 0xff;
+        break;
+    case OGS_TLV_MODE_T1_L2:
+        *(pos++) = type & 0xff;
+        *(pos++) = (length >> 8) & 0xff;
+        *(pos++) = length & 0xff;
+        break;
+    case OGS_TLV_MODE_T1_L2_I1:
+        *(pos++) = type & 0xff;
+        *(pos++) = (length >> 8) & 0xff;
+        *(pos++) = length & 0xff;
+        *(pos++) = instance;
+        break;
+    case OGS_TLV_MODE_T2_L2:
+        *(pos++) = (type >> 8) & 0xff;
+        *(pos++) = type & 0xff;
+        *(pos++) = (length >> 8) & 0xff;
+        *(pos++) = length & 0xff;
+        break;
+    case OGS_TLV_MODE_T1:
+        *(pos++) = type & 0xff;
+        break;
+    default:
+        ogs_assert_if_reached();
+        break;
+    }
+
+    return pos;
+}
+
+#define TLV_BUILD_ERROR -1
+#define TLV_BUILD_NO_ROOM -2
+
+static int tlv_build_compound(ogs_tlv_desc_t *parent_desc, void *msg,
+        uint8_t *data, uint8_t *end, int depth, uint8_t mode);
+
+/*
+ * Encodes one IE in [data, end) and returns its size. If `data` is NULL,
+ * only the size is computed.
+ */
+static int tlv_build_element(ogs_tlv_desc_t *desc, void *msg,
+        uint8_t *data, uint8_t *end, int depth, uint8_t mode)
+{
+    uint8_t tlv_mode = tlv_ctype2mode(desc->ctype, mode);
+    uint8_t header_len = tlv_header_len(tlv_mode);
+    uint8_t buf[4];
+    void *value = NULL;
+    int length = 0;
 
     switch (desc->ctype) {
+    case OGS_TLV_COMPOUND:
+        if (data && end - data < header_len)
+            return TLV_BUILD_NO_ROOM;
+
+        length = tlv_build_compound(desc,
+                (uint8_t *)msg + sizeof(ogs_tlv_presence_t),
+                data ? data + header_len : NULL, end, depth + 1, mode);
+        if (length == TLV_BUILD_NO_ROOM)
+            return TLV_BUILD_NO_ROOM;
+        if (length <= 0) {
+            ogs_error("tlv_build_compound() failed");
+            return TLV_BUILD_ERROR;
+        }
+        break;
     case OGS_TLV_UINT8:
     case OGS_TLV_INT8:
     case OGS_TV_UINT8:
     case OGS_TV_INT8:
     {
         ogs_tlv_uint8_t *v = (ogs_tlv_uint8_t *)msg;
-        if (parent_tlv) {
-            tlv = ogs_tlv_embed(parent_tlv, tlv_mode,
-                    desc->type, 1, desc->instance, &v->u8);
-            if (!tlv) {
-                ogs_error("ogs_tlv_embed()");
-                return NULL;
-            }
-        } else {
-            tlv = ogs_tlv_add(tlv, tlv_mode,
-                    desc->type, 1, desc->instance, &v->u8);
-            if (!tlv) {
-                ogs_error("ogs_tlv_add()");
-                return NULL;
-            }
-        }
+
+        buf[0] = v->u8;
+        value = buf;
+        length = 1;
         break;
     }
     case OGS_TLV_UINT16:
@@ -131,23 +204,10 @@ static ogs_tlv_t *tlv_add_leaf(
     {
         ogs_tlv_uint16_t *v = (ogs_tlv_uint16_t *)msg;
 
-        v->u16 = htobe16(v->u16);
-
-        if (parent_tlv) {
-            tlv = ogs_tlv_embed(parent_tlv, tlv_mode,
-                    desc->type, 2, desc->instance, &v->u16);
-            if (!tlv) {
-                ogs_error("ogs_tlv_embed()");
-                return NULL;
-            }
-        } else {
-            tlv = ogs_tlv_add(tlv, tlv_mode,
-                    desc->type, 2, desc->instance, &v->u16);
-            if (!tlv) {
-                ogs_error("ogs_tlv_add()");
-                return NULL;
-            }
-        }
+        buf[0] = (v->u16 >> 8) & 0xff;
+        buf[1] = v->u16 & 0xff;
+        value = buf;
+        length = 2;
         break;
     }
     case OGS_TLV_UINT24:
@@ -157,24 +217,11 @@ static ogs_tlv_t *tlv_add_leaf(
     {
         ogs_tlv_uint24_t *v = (ogs_tlv_uint24_t *)msg;
 
-        v->u24 = v->u24 << 8;
-        v->u24 = htobe32(v->u24);
-
-        if (parent_tlv) {
-            tlv = ogs_tlv_embed(parent_tlv, tlv_mode,
-                    desc->type, 3, desc->instance, &v->u24);
-            if (!tlv) {
-                ogs_error("ogs_tlv_embed()");
-                return NULL;
-            }
-        } else {
-            tlv = ogs_tlv_add(tlv, tlv_mode,
-                    desc->type, 3, desc->instance, &v->u24);
-            if (!tlv) {
-                ogs_error("ogs_tlv_add()");
-                return NULL;
-            }
-        }
+        buf[0] = (v->u24 >> 16) & 0xff;
+        buf[1] = (v->u24 >> 8) & 0xff;
+        buf[2] = v->u24 & 0xff;
+        value = buf;
+        length = 3;
         break;
     }
     case OGS_TLV_UINT32:
@@ -184,23 +231,12 @@ static ogs_tlv_t *tlv_add_leaf(
     {
         ogs_tlv_uint32_t *v = (ogs_tlv_uint32_t *)msg;
 
-        v->u32 = htobe32(v->u32);
-
-        if (parent_tlv) {
-            tlv = ogs_tlv_embed(parent_tlv, tlv_mode,
-                    desc->type, 4, desc->instance, &v->u32);
-            if (!tlv) {
-                ogs_error("ogs_tlv_embed()");
-                return NULL;
-            }
-        } else {
-            tlv = ogs_tlv_add(tlv, tlv_mode,
-                    desc->type, 4, desc->instance, &v->u32);
-            if (!tlv) {
-                ogs_error("ogs_tlv_add()");
-                return NULL;
-            }
-        }
+        buf[0] = (v->u32 >> 24) & 0xff;
+        buf[1] = (v->u32 >> 16) & 0xff;
+        buf[2] = (v->u32 >> 8) & 0xff;
+        buf[3] = v->u32 & 0xff;
+        value = buf;
+        length = 4;
         break;
     }
     case OGS_TLV_FIXED_STR:
@@ -208,21 +244,8 @@ static ogs_tlv_t *tlv_add_leaf(
     {
         ogs_tlv_octet_t *v = (ogs_tlv_octet_t *)msg;
 
-        if (parent_tlv) {
-            tlv = ogs_tlv_embed(parent_tlv, tlv_mode,
-                    desc->type, desc->length, desc->instance, v->data);
-            if (!tlv) {
-                ogs_error("ogs_tlv_embed()");
-                return NULL;
-            }
-        } else {
-            tlv = ogs_tlv_add(tlv, tlv_mode,
-                    desc->type, desc->length, desc->instance, v->data);
-            if (!tlv) {
-                ogs_error("ogs_tlv_add()");
-                return NULL;
-            }
-        }
+        value = v->data;
+        length = desc->length;
         break;
     }
     case OGS_TLV_VAR_STR:
@@ -232,185 +255,113 @@ static ogs_tlv_t *tlv_add_leaf(
         if (v->len == 0) {
             ogs_error("No TLV length - [%s] T:%d I:%d (vsz=%d)",
                     desc->name, desc->type, desc->instance, desc->vsize);
-            return NULL;
+            return TLV_BUILD_ERROR;
         }
 
-        if (parent_tlv) {
-            tlv = ogs_tlv_embed(parent_tlv, tlv_mode,
-                    desc->type, v->len, desc->instance, v->data);
-            if (!tlv) {
-                ogs_error("ogs_tlv_embed()");
-                return NULL;
-            }
-        } else {
-            tlv = ogs_tlv_add(tlv, tlv_mode,
-                    desc->type, v->len, desc->instance, v->data);
-            if (!tlv) {
-                ogs_error("ogs_tlv_add()");
-                return NULL;
-            }
-        }
+        value = v->data;
+        length = v->len;
         break;
     }
     case OGS_TLV_NULL:
     case OGS_TV_NULL:
-    {
-        if (parent_tlv) {
-            tlv = ogs_tlv_embed(parent_tlv, tlv_mode,
-                    desc->type, 0, desc->instance, NULL);
-            if (!tlv) {
-                ogs_error("ogs_tlv_embed()");
-                return NULL;
-            }
-        } else {
-            tlv = ogs_tlv_add(tlv, tlv_mode,
-                    desc->type, 0, desc->instance, NULL);
-            if (!tlv) {
-                ogs_error("ogs_tlv_add()");
-                return NULL;
-            }
-        }
         break;
-    }
     default:
         ogs_error("Unknown type [%d]", desc->ctype);
-        return NULL;
+        return TLV_BUILD_ERROR;
+    }
+
+    if (length > (tlv_mode == OGS_TLV_MODE_T1_L1 ? 0xff : 0xffff)) {
+        ogs_error("TLV too long - [%s] T:%d I:%d L:%d",
+                desc->name, desc->type, desc->instance, length);
+        return TLV_BUILD_ERROR;
+    }
+
+    if (data) {
+        if (end - data < header_len + length)
+            return TLV_BUILD_NO_ROOM;
+
+        uint8_t *pos = tlv_put_header(
+                data, tlv_mode, desc->type, length, desc->instance);
+
+        /* A compound value has already been written in place */
+        if (desc->ctype != OGS_TLV_COMPOUND && length) {
+            ogs_assert(value);
+            memcpy(pos, value, length);
+        }
     }
 
-    return tlv;
+    return header_len + length;
 }
 
-static uint32_t tlv_add_compound(ogs_tlv_t **root, ogs_tlv_t *parent_tlv,
-        ogs_tlv_desc_t *parent_desc, void *msg, int depth, uint8_t mode)
+/*
+ * Walks the message struct in descriptor order and encodes every present
+ * IE. Returns the encoded size, 0 if nothing is present, or a negative
+ * TLV_BUILD_XXX code.
+ */
+static int tlv_build_compound(ogs_tlv_desc_t *parent_desc, void *msg,
+        uint8_t *data, uint8_t *end, int depth, uint8_t mode)
 {
     ogs_tlv_presence_t *presence_p;
     ogs_tlv_desc_t *desc = NULL, *next_desc = NULL;
-    ogs_tlv_t *tlv = NULL, *emb_tlv = NULL;
     uint8_t *p = msg;
-    uint32_t offset = 0, count = 0;
-    int i, j, r;
+    uint32_t offset = 0;
+    int length = 0;
+    int i, j, r, num;
     char indent[17] = "                "; /* 16 spaces */
 
-    ogs_assert(root);
     ogs_assert(parent_desc);
     ogs_assert(msg);
 
     ogs_assert(depth <= 8);
     indent[depth*2] = 0;
 
-    *root = NULL;
-
     for (i = 0, desc = parent_desc->child_descs[i]; desc != NULL;
             i++, desc = parent_desc->child_descs[i]) {
         next_desc = parent_desc->child_descs[i+1];
-        if (next_desc != NULL && next_desc->ctype == OGS_TLV_MORE) {
-            int offset2 = offset;
-            for (j = 0; j < next_desc->length; j++) {
-                presence_p = (ogs_tlv_presence_t *)(p + offset2);
+        if (next_desc != NULL && next_desc->ctype == OGS_TLV_MORE)
+            num = next_desc->length;
+        else
+            num = 1;
 
-                if (*presence_p == 0)
-                    break;
+        for (j = 0; j < num; j++) {
+            presence_p = (ogs_tlv_presence_t *)(p + offset + desc->vsize * j);
 
-                if (desc->ctype == OGS_TLV_COMPOUND) {
-                    ogs_trace("BUILD %sC#%d [%s] T:%d I:%d (vsz=%d) off:%p ",
-                            indent, i, desc->name, desc->type, desc->instance,
-                            desc->vsize, p + offset2);
-
-                    if (parent_tlv)
-                        tlv = ogs_tlv_embed(parent_tlv,
-                                tlv_ctype2mode(desc->ctype, mode),
-                                desc->type, 0, desc->instance, NULL);
-                    else
-                        tlv = ogs_tlv_add(tlv,
-                                tlv_ctype2mode(desc->ctype, mode),
-                                desc->type, 0, desc->instance, NULL);
-
-                    r = tlv_add_compound(&emb_tlv, tlv, desc,
-                            p + offset2 + sizeof(ogs_tlv_presence_t),
-                            depth + 1, mode);
-                    if (r <= 0 || !emb_tlv) {
-                        ogs_error("tlv_add_compound() failed");
-                        return 0;
-                    }
-                    count += 1 + r;
-                } else {
-                    ogs_trace("BUILD %sL#%d [%s] T:%d L:%d I:%d "
-                            "(cls:%d vsz:%d) off:%p ",
-                            indent, i, desc->name, desc->type, desc->length,
-                            desc->instance, desc->ctype, desc->vsize,
-                            p + offset2);
-
-                    tlv = tlv_add_leaf(parent_tlv, tlv, desc,
-                            p + offset2, mode);
-                    if (!tlv) {
-                        ogs_error("tlv_add_leaf() failed");
-                        return 0;
-                    }
-                    count++;
-                }
-
-                if (*root == NULL)
-                    *root = tlv;
-
-                offset2 += desc->vsize;
-            }
-            offset += desc->vsize * next_desc->length;
-            i++;
-        } else {
-            presence_p = (ogs_tlv_presence_t *)(p + offset);
-
-            if (*presence_p) {
-                if (desc->ctype == OGS_TLV_COMPOUND) {
-                    ogs_trace("BUILD %sC#%d [%s] T:%d I:%d (vsz=%d) off:%p ",
-                            indent, i, desc->name, desc->type, desc->instance,
-                            desc->vsize, p + offset);
-
-                    if (parent_tlv)
-                        tlv = ogs_tlv_embed(parent_tlv,
-                                tlv_ctype2mode(desc->ctype, mode),
-                                desc->type, 0, desc->instance, NULL);
-                    else
-                        tlv = ogs_tlv_add(tlv,
-                                tlv_ctype2mode(desc->ctype, mode),
-                                desc->type, 0, desc->instance, NULL);
-
-                    r = tlv_add_compound(&emb_tlv, tlv, desc,
-                            p + offset + sizeof(ogs_tlv_presence_t),
-                            depth + 1, mode);
-                    if (r <= 0 || !emb_tlv) {
-                        ogs_error("tlv_add_compound() failed");
-                        return 0;
-                    }
-                    count += 1 + r;
-                } else {
-                    ogs_trace("BUILD %sL#%d [%s] T:%d L:%d I:%d "
-                            "(cls:%d vsz:%d) off:%p ",
-                            indent, i, desc->name, desc->type, desc->length,
-                            desc->instance, desc->ctype, desc->vsize,
-                            p + offset);
-
-                    tlv = tlv_add_leaf(parent_tlv, tlv, desc, p + offset, mode);
-                    if (!tlv) {
-                        ogs_error("tlv_add_leaf() failed");
-                        return 0;
-                    }
-                    count++;
-                }
-
-                if (*root == NULL)
-                    *root = tlv;
-            }
-            offset += desc->vsize;
+            if (*presence_p == 0)
+                break;
+
+            if (data)
+                ogs_trace("BUILD %s%c#%d [%s] T:%d L:%d I:%d "
+                        "(cls:%d vsz:%d) off:%p ",
+                        indent, desc->ctype == OGS_TLV_COMPOUND ? 'C' : 'L',
+                        i, desc->name, desc->type, desc->length,
+                        desc->instance, desc->ctype, desc->vsize, presence_p);
+
+            r = tlv_build_element(desc, presence_p,
+                    data ? data + length : NULL, end, depth, mode);
+            if (r < 0)
+                return r;
+
+            length += r;
         }
+
+        offset += desc->vsize * num;
+        if (next_desc != NULL && next_desc->ctype == OGS_TLV_MORE)
+            i++;
     }
 
-    return count;
+    return length;
 }
 
+/*
+ * The encoder writes straight from the message struct into a flat buffer.
+ * Messages are encoded on the stack first, so that the struct is walked
+ * only once; if that is not enough room, a first walk sizes the pkbuf and
+ * a second one fills it.
+ */
 ogs_pkbuf_t *ogs_tlv_build_msg(ogs_tlv_desc_t *desc, void *msg, int mode)
 {
-    ogs_tlv_t *root = NULL;
-    uint32_t r, length, rendlen;
+    int length;
+    uint8_t buf[OGS_HUGE_LEN];
     ogs_pkbuf_t *pkbuf = NULL;
 
     ogs_assert(desc);
@@ -419,13 +370,14 @@ ogs_pkbuf_t *ogs_tlv_build_msg(ogs_tlv_desc_t *desc, void *msg, int mode)
     ogs_assert(desc->ctype == OGS_TLV_MESSAGE);
 
     if (desc->child_descs[0]) {
-        r = tlv_add_compound(&root, NULL, desc, msg, 0, mode);
-        if (r <= 0 || !root) {
-            ogs_error("tlv_add_compound() failed");
+        length = tlv_build_compound(
+                desc, msg, buf, buf + sizeof(buf), 0, mode);
+        if (length == TLV_BUILD_NO_ROOM)
+            length = tlv_build_compound(desc, msg, NULL, NULL, 0, mode);
+        if (length <= 0) {
+            ogs_error("tlv_build_compound() failed");
             return NULL;
         }
-
-        length = ogs_tlv_calc_length(root);
     } else {
         length = 0;
     }
@@ -437,53 +389,18 @@ ogs_pkbuf_t *ogs_tlv_build_msg(ogs_tlv_desc_t *desc, void *msg, int mode)
     ogs_pkbuf_reserve(pkbuf, OGS_TLV_MAX_HEADROOM);
     ogs_pkbuf_put(pkbuf, length);
 
-    if (desc->child_descs[0]) {
-        rendlen = ogs_tlv_render(root, pkbuf->data, length);
-        if (rendlen != length) {
-            ogs_error("ogs_tlv_render[rendlen:%d != length:%d] failed",
-                    rendlen, length);
-            return NULL;
-        }
-
-        ogs_tlv_free_all(root);
+    if (length <= sizeof(buf)) {
+        memcpy(pkbuf->data, buf, length);
+    } else if (tlv_build_compound(desc, msg,
+                pkbuf->data, pkbuf->data + length, 0, mode) != length) {
+        ogs_error("tlv_build_compound() failed [length:%d]", length);
+        ogs_pkbuf_free(pkbuf);
+        return NULL;
     }
 
     return pkbuf;
 }
 
-static ogs_tlv_desc_t* tlv_find_desc_by_type_inst(uint8_t *desc_index,
-        uint32_t *tlv_offset, ogs_tlv_desc_t *parent_desc, uint16_t match_type, uint8_t match_instance, uint8_t match_type_pos)
-{
-    ogs_tlv_desc_t *prev_desc = NULL, *desc = NULL;
-    int i, offset = 0;
-    unsigned match_i = 0;
-
-    ogs_assert(parent_desc);
-
-    for (i = 0, desc = parent_desc->child_descs[i]; desc != NULL;
-            i++, desc = parent_desc->child_descs[i]) {
-        if (desc->type == match_type && desc->instance == match_instance) {
-            if (match_i == match_type_pos) {
-                *desc_index = i;
-                *tlv_offset = offset;
-                break;
-            }
-            match_i++;
-        }
-
-        if (desc->ctype == OGS_TLV_MORE) {
-            ogs_assert(prev_desc && prev_desc->ctype != OGS_TLV_MORE);
-            offset += prev_desc->vsize * (desc->length - 1);
-        } else {
-            offset += desc->vsize;
-        }
-
-        prev_desc = desc;
-    }
-
-    return desc;
-}
-
 static int tlv_parse_leaf(void *msg, ogs_tlv_desc_t *desc, ogs_tlv_t *tlv)
 {
     ogs_assert(msg);
@@ -594,156 +511,189 @@ static int tlv_parse_leaf(void *msg, ogs_tlv_desc_t *desc, ogs_tlv_t *tlv)
     return OGS_OK;
 }
 
-/* rbtree structure used to keep track count of TLVs with given <type,instance>
- * while parsing. This is used to link it to the matching nth field in a
- * ogs_tlv_desc_t struct */
-typedef struct tlv_count_node_s {
-    ogs_rbnode_t node;
-    uint32_t key; /* type<<8 + instance */
-    unsigned count;
-} tlv_count_node_t;
-
-static tlv_count_node_t *tlv_count_node_find(ogs_rbtree_t *tree, tlv_count_node_t *count_node_arr, unsigned count_node_arr_len,
-        unsigned *count_alloc_next, uint16_t type, uint8_t instance)
+
+static uint16_t parse_get_element_type(uint8_t *pos, uint8_t mode)
 {
-    ogs_rbnode_t **new = NULL;
-    ogs_rbnode_t *parent = NULL;
-    tlv_count_node_t *this;
-
-    uint64_t key = (((uint32_t)type)<<8) | instance;
-
-    new = &tree->root;
-    while (*new) {
-        this = ogs_rb_entry(*new, tlv_count_node_t, node);
-        parent = *new;
-        if (key < this->key) {
-            new = &(*new)->left;
-        } else if (key > this->key) {
-            new = &(*new)->right;
-        } else { /* found entry: */
-            return this;
-        }
-    }
+    uint16_t type;
 
-    /* No entry, need to add one: */
-    if (*count_alloc_next == count_node_arr_len) {
-        ogs_error("This TLV has to many entries, can't parse");
-        return NULL;
+    switch(mode) {
+    case OGS_TLV_MODE_T1_L1:
+    case OGS_TLV_MODE_T1_L2:
+    case OGS_TLV_MODE_T1_L2_I1:
+    case OGS_TLV_MODE_T1:
+        type = *pos;
+        break;
+    case OGS_TLV_MODE_T2_L2:
+        type = *(pos++) << 8;
+        type += *(pos++);
+        break;
+    default:
+        ogs_assert_if_reached();
+        break;
     }
-    this = &count_node_arr[(*count_alloc_next)++];
-    this->key = key;
-    this->count = 0;
-    ogs_rbtree_link_node(&this->node, parent, new);
-    ogs_rbtree_insert_color(tree, &this->node);
-    return this;
+
+    return type;
 }
 
+/*
+ * Decodes a block of IEs straight from the wire into the message struct.
+ * The IE header is read into a ogs_tlv_t on the stack and octet values
+ * keep pointing into the pkbuf, so nothing is allocated.
+ *
+ * If `by_desc` is set, the TLV or TV format of each IE is taken from its
+ * descriptor (GTPv1-C); otherwise every IE uses `mode`.
+ */
 static int tlv_parse_compound(void *msg, ogs_tlv_desc_t *parent_desc,
-        ogs_tlv_t *parent_tlv, int depth, int mode)
+        uint8_t *data, uint32_t length, int depth, uint8_t mode, bool by_desc)
 {
     int rv;
-    ogs_tlv_presence_t *presence_p = (ogs_tlv_presence_t *)msg;
-    ogs_tlv_desc_t *desc = NULL, *next_desc = NULL;
-    ogs_tlv_t *tlv = NULL, *emb_tlv = NULL;
+    ogs_tlv_presence_t *presence_p;
+    ogs_tlv_desc_t *desc = NULL, *next_desc = NULL, *prev_desc = NULL;
+    ogs_tlv_t tlv;
     uint8_t *p = msg;
+    uint8_t *pos = data, *end = data + length, *next = NULL;
+    uint8_t tlv_mode;
     uint32_t offset = 0;
-    uint8_t index = 0;
-    int i = 0, j;
-    OGS_RBTREE(tree);
-    tlv_count_node_t count_node[OGS_TLV_MAX_CHILD_DESC];
-    unsigned count_node_alloc_next = 0;
+    uint32_t offsets[OGS_TLV_MAX_CHILD_DESC];
+    bool used[OGS_TLV_MAX_CHILD_DESC];
+    int i, j, num_desc;
     char indent[17] = "                "; /* 16 spaces */
 
     ogs_assert(msg);
     ogs_assert(parent_desc);
-    ogs_assert(parent_tlv);
 
     ogs_assert(depth <= 8);
     indent[depth*2] = 0;
 
-    tlv = parent_tlv;
-    while (tlv) {
-        tlv_count_node_t *curr_count = tlv_count_node_find(&tree, &count_node[0],
-                OGS_ARRAY_SIZE(count_node), &count_node_alloc_next, tlv->type, tlv->instance);
-        if (!curr_count)
-            return OGS_ERROR;
-        desc = tlv_find_desc_by_type_inst(&index, &offset, parent_desc, tlv->type, tlv->instance, curr_count->count);
-        if (desc == NULL) {
-            ogs_warn("Unknown TLV type [%d]", tlv->type);
-            tlv = tlv->next;
+    /* Offset of each descriptor in the struct. MORE extends the previous one */
+    for (i = 0, desc = parent_desc->child_descs[i]; desc != NULL;
+            i++, desc = parent_desc->child_descs[i]) {
+        offsets[i] = offset;
+        used[i] = false;
+
+        if (desc->ctype == OGS_TLV_MORE) {
+            ogs_assert(prev_desc && prev_desc->ctype != OGS_TLV_MORE);
+            offset += prev_desc->vsize * (desc->length - 1);
+        } else {
+            offset += desc->vsize;
+        }
+
+        prev_desc = desc;
+    }
+    num_desc = i;
+
+    while (pos < end) {
+        memset(&tlv, 0, sizeof(tlv));
+
+        tlv_mode = mode;
+        if (by_desc) {
+            if (end - pos < (mode == OGS_TLV_MODE_T2_L2 ? 2 : 1))
+                goto truncated;
+
+            tlv.type = parse_get_element_type(pos, mode);
+            for (i = 0; i < num_desc; i++) {
+                desc = parent_desc->child_descs[i];
+                if (desc->ctype != OGS_TLV_MORE &&
+                    desc->type == tlv.type && desc->instance == 0)
+                    break;
+            }
+            if (i == num_desc) {
+                ogs_error("Can't parse find TLV description for type %u",
+                        tlv.type);
+                return OGS_ERROR;
+            }
+            tlv_mode = tlv_ctype2mode(desc->ctype, mode);
+        }
+
+        if (end - pos < tlv_header_len(tlv_mode))
+            goto truncated;
+
+        if (by_desc && tlv_mode == OGS_TLV_MODE_T1)
+            next = tlv_get_element_fixed(&tlv, pos, tlv_mode, desc->length);
+        else
+            next = tlv_get_element(&tlv, pos, tlv_mode);
+        if (next > end)
+            goto truncated;
+
+        /* The n-th IE of a <type,instance> goes to the n-th descriptor */
+        for (i = 0; i < num_desc; i++) {
+            desc = parent_desc->child_descs[i];
+            if (desc->ctype != OGS_TLV_MORE && used[i] == false &&
+                desc->type == tlv.type && desc->instance == tlv.instance)
+                break;
+        }
+        if (i == num_desc) {
+            ogs_warn("Unknown TLV type [%d]", tlv.type);
+            pos = next;
             continue;
         }
 
-        presence_p = (ogs_tlv_presence_t *)(p + offset);
+        presence_p = (ogs_tlv_presence_t *)(p + offsets[i]);
 
         /* Multiple of the same type TLV may be included */
-        next_desc = parent_desc->child_descs[index+1];
+        next_desc = parent_desc->child_descs[i+1];
         if (next_desc != NULL && next_desc->ctype == OGS_TLV_MORE) {
             for (j = 0; j < next_desc->length; j++) {
-                presence_p =
-                    (ogs_tlv_presence_t *)(p + offset + desc->vsize * j);
-                if (*presence_p == 0) {
-                    offset += desc->vsize * j;
+                presence_p = (ogs_tlv_presence_t *)
+                    (p + offsets[i] + desc->vsize * j);
+                if (*presence_p == 0)
                     break;
-                }
             }
             if (j == next_desc->length) {
                 ogs_fatal("Multiple of the same type TLV need more room");
-                tlv = tlv->next;
+                pos = next;
                 continue;
             }
         } else {
-            curr_count->count++;
+            used[i] = true;
         }
 
         if (desc->ctype == OGS_TLV_COMPOUND) {
-            emb_tlv = ogs_tlv_parse_embedded_block(tlv, mode);
-            if (emb_tlv == NULL) {
-                ogs_error("Error while parse TLV");
-                return OGS_ERROR;
-            }
-
             ogs_trace("PARSE %sC#%d [%s] T:%d I:%d (vsz=%d) off:%p ",
-                    indent, i++, desc->name, desc->type, desc->instance,
-                    desc->vsize, p + offset);
+                    indent, i, desc->name, desc->type, desc->instance,
+                    desc->vsize, presence_p);
 
-            offset += sizeof(ogs_tlv_presence_t);
+            if (tlv.length == 0) {
+                ogs_error("Empty compound TLV [%s]", desc->name);
+                return OGS_ERROR;
+            }
 
             rv = tlv_parse_compound(
-                    p + offset, desc, emb_tlv, depth + 1, mode);
+                    (uint8_t *)presence_p + sizeof(ogs_tlv_presence_t),
+                    desc, tlv.value, tlv.length, depth + 1, mode, false);
             if (rv != OGS_OK) {
                 ogs_error("Can't parse compound TLV");
                 return OGS_ERROR;
             }
-
-            *presence_p = 1;
         } else {
             ogs_trace("PARSE %sL#%d [%s] T:%d L:%d I:%d "
                     "(cls:%d vsz:%d) off:%p ",
-                    indent, i++, desc->name, desc->type, desc->length,
-                    desc->instance, desc->ctype, desc->vsize, p + offset);
+                    indent, i, desc->name, desc->type, desc->length,
+                    desc->instance, desc->ctype, desc->vsize, presence_p);
 
-            rv = tlv_parse_leaf(p + offset, desc, tlv);
+            rv = tlv_parse_leaf(presence_p, desc, &tlv);
             if (rv != OGS_OK) {
                 ogs_error("Can't parse leaf TLV");
                 return OGS_ERROR;
             }
-
-            *presence_p = 1;
         }
 
-        tlv = tlv->next;
+        *presence_p = 1;
+        pos = next;
     }
 
     return OGS_OK;
+
+truncated:
+    ogs_error("Truncated TLV [LEN:%d,MODE:%d,POS:%d]",
+            length, mode, (int)(pos - data));
+    ogs_log_hexdump(OGS_LOG_ERROR, data, length);
+    return OGS_ERROR;
 }
 
 int ogs_tlv_parse_msg(void *msg, ogs_tlv_desc_t *desc, ogs_pkbuf_t *pkbuf,
         int mode)
 {
-    int rv;
-    ogs_tlv_t *root;
-
     ogs_assert(msg);
     ogs_assert(desc);
     ogs_assert(pkbuf);
@@ -754,110 +704,8 @@ int ogs_tlv_parse_msg(void *msg, ogs_tlv_desc_t *desc, ogs_pkbuf_t *pkbuf,
         ogs_assert_if_reached();
     }
 
-    root = ogs_tlv_parse_block(pkbuf->len, pkbuf->data, mode);
-    if (root == NULL) {
-        ogs_error("Can't parse TLV message");
-        return OGS_ERROR;
-    }
-
-    rv = tlv_parse_compound(msg, desc, root, 0, mode);
-
-    ogs_tlv_free_all(root);
-
-    return rv;
-}
-
-static uint16_t parse_get_element_type(uint8_t *pos, uint8_t mode)
-{
-    uint16_t type;
-
-    switch(mode) {
-    case OGS_TLV_MODE_T1_L1:
-    case OGS_TLV_MODE_T1_L2:
-    case OGS_TLV_MODE_T1_L2_I1:
-    case OGS_TLV_MODE_T1:
-        type = *pos;
-        break;
-    case OGS_TLV_MODE_T2_L2:
-        type = *(pos++) << 8;
-        type += *(pos++);
-        break;
-    default:
-        ogs_assert_if_reached();
-        break;
-    }
-
-    return type;
-}
-
-/* Get TLV element taking into account msg_mode (to know TLV tag length) +
- * specific TLV information from "desc" (to know whether the specific IE is TLV
- * or TV, and its expected length in the later case). */
-static uint8_t *tlv_get_element_desc(ogs_tlv_t *tlv, uint8_t *blk, uint8_t msg_mode, ogs_tlv_desc_t *desc)
-{
-    uint8_t instance;
-    unsigned tlv_tag_pos;
-    uint8_t desc_index = 0;
-    uint32_t tlv_offset = 0;
-    uint16_t tlv_tag;
-    uint8_t tlv_mode;
-    static ogs_tlv_desc_t* tlv_desc;
-
-    tlv_tag = parse_get_element_type(blk, msg_mode);
-    instance = 0;  /* TODO: support instance != 0 if ever really needed by looking it up in pos */
-    tlv_tag_pos = 0; /* All tags with same instance should use the same tlv_desc, so take the first one */
-    tlv_desc = tlv_find_desc_by_type_inst(&desc_index, &tlv_offset, desc, tlv_tag, instance, tlv_tag_pos);
-    if (!tlv_desc) {
-        ogs_error("Can't parse find TLV description for type %u", tlv_tag);
-        return NULL;
-    }
-    tlv_mode = tlv_ctype2mode(tlv_desc->ctype, msg_mode);
-
-    if (tlv_mode == OGS_TLV_MODE_T1)
-        return tlv_get_element_fixed(tlv, blk, tlv_mode, tlv_desc->length);
-    return tlv_get_element(tlv, blk, tlv_mode);
-}
-
-/* Similar to ogs_tlv_parse_block(), but taking into account each TLV format from "desc". */
-static ogs_tlv_t *ogs_tlv_parse_block_desc(uint32_t length, void *data, uint8_t msg_mode, ogs_tlv_desc_t *desc)
-{
-    uint8_t *pos = data;
-    uint8_t *blk = data;
-
-    ogs_tlv_t *root = NULL;
-    ogs_tlv_t *prev = NULL;
-    ogs_tlv_t *curr = NULL;
-
-    root = curr = ogs_tlv_get();
-
-    ogs_assert(curr);
-
-    pos = tlv_get_element_desc(curr, pos, msg_mode, desc);
-
-    ogs_assert(pos);
-
-    while(pos - blk < length) {
-        prev = curr;
-
-        curr = ogs_tlv_get();
-        ogs_assert(curr);
-        prev->next = curr;
-
-        pos = tlv_get_element_desc(curr, pos, msg_mode, desc);
-        ogs_assert(pos);
-    }
-
-    if (length != (pos - blk)) {
-        ogs_error("ogs_tlv_parse_block() failed[LEN:%d,MODE:%d]",
-                length, msg_mode);
-        ogs_error("POS[%p] BLK[%p] POS-BLK[%d]", pos, blk, (int)(pos - blk));
-        ogs_log_hexdump(OGS_LOG_FATAL, data, length);
-
-        ogs_tlv_free_all(root);
-        return NULL;
-    }
-
-    return root;
+    return tlv_parse_compound(
+            msg, desc, pkbuf->data, pkbuf->len, 0, mode, false);
 }
 
 /* Similar to ogs_tlv_parse_msg(), but takes each TLV type from the desc
@@ -866,9 +714,6 @@ static ogs_tlv_t *ogs_tlv_parse_block_desc(uint32_t length, void *data, uint8_t
 int ogs_tlv_parse_msg_desc(
         void *msg, ogs_tlv_desc_t *desc, ogs_pkbuf_t *pkbuf, int msg_mode)
 {
-    int rv;
-    ogs_tlv_t *root;
-
     ogs_assert(msg);
     ogs_assert(desc);
     ogs_assert(pkbuf);
@@ -876,15 +721,6 @@ int ogs_tlv_parse_msg_desc(
     ogs_assert(desc->ctype == OGS_TLV_MESSAGE);
     ogs_assert(desc->child_descs[0]);
 
-    root = ogs_tlv_parse_block_desc(pkbuf->len, pkbuf->data, msg_mode, desc);
-    if (root == NULL) {
-        ogs_error("Can't parse TLV message");
-        return OGS_ERROR;
-    }
-
-    rv = tlv_parse_compound(msg, desc, root, 0, msg_mode);
-
-    ogs_tlv_free_all(root);
-
-    return rv;
+    return tlv_parse_compound(
+            msg, desc, pkbuf->data, pkbuf->len, 0, msg_mode, true);
 }
@@ -44,6 +44,13 @@ ogs_sock_t *ogs_udp_server(
             addr = addr->next;
             continue;
         }
+        if (option.so_reuseport) {
+            if (ogs_listen_reuseport(new->fd, true) != OGS_OK) {
+                ogs_sock_destroy(new);
+                addr = addr->next;
+                continue;
+            }
+        }
         if (ogs_sock_bind(new, addr) != OGS_OK) {
             ogs_sock_destroy(new);
             addr = addr->next;
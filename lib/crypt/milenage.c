@@ -27,15 +27,10 @@ static void ShiftBits(uint8_t r, uint8_t rijndaelInput[16],
 static uint8_t *bits_shift(uint32_t bit_valid, uint8_t *dst,
                             uint8_t *src, uint32_t numBits);
 
-static int aes_128_encrypt_block(const uint8_t *key,
+static int aes_128_encrypt_block(ogs_aes_key_t *key,
     const uint8_t *in, uint8_t *out)
 {
-    const int key_bits = 128;
-    unsigned int rk[OGS_AES_RKLENGTH(128)];
-    int nrounds;
-
-    nrounds = ogs_aes_setup_enc(rk, key, key_bits);
-    ogs_aes_encrypt(rk, nrounds, in, out);
+    ogs_aes_key_encrypt(key, in, out, 1);
 
     return 0;
 }
@@ -57,14 +52,17 @@ int milenage_f1(const uint8_t *opc, const uint8_t *k,
 {
 	uint8_t tmp1[16], tmp2[16], tmp3[16];
 	int i;
+	ogs_aes_key_t key;
 #if 1 /* R1-R5 issues1153 */
     uint8_t r1 = 64;
 #endif
 
+	if (ogs_aes_key_setup(&key, k, 128) != OGS_OK)
+		return -1;
+
 	for (i = 0; i < 16; i++)
 		tmp1[i] = _rand[i] ^ opc[i];
-	if (aes_128_encrypt_block(k, tmp1, tmp1))
-		return -1;
+	aes_128_encrypt_block(&key, tmp1, tmp1);
 
 	/* tmp2 = IN1 = SQN || AMF || SQN || AMF */
 	os_memcpy(tmp2, sqn, 6);
@@ -86,8 +84,8 @@ int milenage_f1(const uint8_t *opc, const uint8_t *k,
 	/* XOR with c1 (= ..00, i.e., NOP) */
 
 	/* f1 || f1* = E_K(tmp3) XOR OP_c */
-	if (aes_128_encrypt_block(k, tmp3, tmp1))
-		return -1;
+	aes_128_encrypt_block(&key, tmp3, tmp1);
+	ogs_aes_key_clear(&key);
 	for (i = 0; i < 16; i++)
 		tmp1[i] ^= opc[i];
 	if (mac_a)
@@ -116,6 +114,7 @@ int milenage_f2345(const uint8_t *opc, const uint8_t *k,
 {
 	uint8_t tmp1[16], tmp2[16], tmp3[16];
 	int i;
+	ogs_aes_key_t key;
 
 #if 1 /* R1-R5 issues1153 */
     uint8_t r2 = 0;
@@ -124,11 +123,13 @@ int milenage_f2345(const uint8_t *opc, const uint8_t *k,
     uint8_t r5 = 96;
 #endif
 
+	if (ogs_aes_key_setup(&key, k, 128) != OGS_OK)
+		return -1;
+
 	/* tmp2 = TEMP = E_K(RAND XOR OP_C) */
 	for (i = 0; i < 16; i++)
 		tmp1[i] = _rand[i] ^ opc[i];
-	if (aes_128_encrypt_block(k, tmp1, tmp2))
-		return -1;
+	aes_128_encrypt_block(&key, tmp1, tmp2);
 
 	/* OUT2 = E_K(rot(TEMP XOR OP_C, r2) XOR c2) XOR OP_C */
 	/* OUT3 = E_K(rot(TEMP XOR OP_C, r3) XOR c3) XOR OP_C */
@@ -145,8 +146,7 @@ int milenage_f2345(const uint8_t *opc, const uint8_t *k,
 #endif
 	tmp1[15] ^= 1; /* XOR c2 (= ..01) */
 	/* f5 || f2 = E_K(tmp1) XOR OP_c */
-	if (aes_128_encrypt_block(k, tmp1, tmp3))
-		return -1;
+	aes_128_encrypt_block(&key, tmp1, tmp3);
 	for (i = 0; i < 16; i++)
 		tmp3[i] ^= opc[i];
 	if (res)
@@ -164,8 +164,7 @@ int milenage_f2345(const uint8_t *opc, const uint8_t *k,
         ShiftBits(r3, tmp1, tmp2, opc);
 #endif
 		tmp1[15] ^= 2; /* XOR c3 (= ..02) */
-		if (aes_128_encrypt_block(k, tmp1, ck))
-			return -1;
+		aes_128_encrypt_block(&key, tmp1, ck);
 		for (i = 0; i < 16; i++)
 			ck[i] ^= opc[i];
 	}
@@ -180,8 +179,7 @@ int milenage_f2345(const uint8_t *opc, const uint8_t *k,
         ShiftBits(r4, tmp1, tmp2, opc);
 #endif
 		tmp1[15] ^= 4; /* XOR c4 (= ..04) */
-		if (aes_128_encrypt_block(k, tmp1, ik))
-			return -1;
+		aes_128_encrypt_block(&key, tmp1, ik);
 		for (i = 0; i < 16; i++)
 			ik[i] ^= opc[i];
 	}
@@ -196,12 +194,13 @@ int milenage_f2345(const uint8_t *opc, const uint8_t *k,
         ShiftBits(r5, tmp1, tmp2, opc);
 #endif
 		tmp1[15] ^= 8; /* XOR c5 (= ..08) */
-		if (aes_128_encrypt_block(k, tmp1, tmp1))
-			return -1;
+		aes_128_encrypt_block(&key, tmp1, tmp1);
 		for (i = 0; i < 6; i++)
 			akstar[i] = tmp1[i] ^ opc[i];
 	}
 
+	ogs_aes_key_clear(&key);
+
 	return 0;
 }
 
@@ -224,25 +223,117 @@ void milenage_generate(const uint8_t *opc, const uint8_t *amf,
     uint8_t *autn, uint8_t *ik, uint8_t *ck, uint8_t *ak, 
     uint8_t *res, size_t *res_len)
 {
-	int i;
-	uint8_t mac_a[8];
+	milenage_vector_t vector;
 
 	if (*res_len < 8) {
 		*res_len = 0;
 		return;
 	}
-	if (milenage_f1(opc, k, _rand, sqn, amf, mac_a, NULL) ||
-	    milenage_f2345(opc, k, _rand, res, ck, ik, ak, NULL)) {
+
+	os_memcpy(vector.rand, _rand, 16);
+	os_memcpy(vector.sqn, sqn, 6);
+	if (milenage_generate_batch(opc, amf, k, &vector, 1)) {
 		*res_len = 0;
 		return;
 	}
 	*res_len = 8;
 
-	/* AUTN = (SQN ^ AK) || AMF || MAC */
-	for (i = 0; i < 6; i++)
-		autn[i] = sqn[i] ^ ak[i];
-	os_memcpy(autn + 6, amf, 2);
-	os_memcpy(autn + 8, mac_a, 8);
+	os_memcpy(autn, vector.autn, 16);
+	if (ik)
+		os_memcpy(ik, vector.ik, 16);
+	if (ck)
+		os_memcpy(ck, vector.ck, 16);
+	os_memcpy(ak, vector.ak, 6);
+	if (res)
+		os_memcpy(res, vector.res, 8);
+}
+
+/**
+ * milenage_generate_batch - Generate AKA vectors for one subscriber
+ * @opc: OPc = 128-bit operator variant algorithm configuration field (encr.)
+ * @amf: AMF = 16-bit authentication management field
+ * @k: K = 128-bit subscriber key
+ * @vector: RAND and SQN as input, AUTN, IK, CK, AK and RES as output
+ * @num_of_vector: Number of vectors
+ * Returns: 0 on success, -1 on failure
+ *
+ * K is expanded once, and the AES blocks of up to MILENAGE_BATCH_SIZE
+ * vectors are encrypted in two calls so that a pipelined AES backend
+ * can work on several blocks at a time.
+ */
+#define MILENAGE_BATCH_SIZE 16
+
+int milenage_generate_batch(const uint8_t *opc, const uint8_t *amf,
+    const uint8_t *k, milenage_vector_t *vector, int num_of_vector)
+{
+	ogs_aes_key_t key;
+	uint8_t temp[MILENAGE_BATCH_SIZE][16];
+	uint8_t in[MILENAGE_BATCH_SIZE * 4][16];
+	uint8_t out[MILENAGE_BATCH_SIZE * 4][16];
+	uint8_t in1[16];
+	milenage_vector_t *v = NULL;
+	int i, j, n, base;
+
+	if (ogs_aes_key_setup(&key, k, 128) != OGS_OK)
+		return -1;
+
+	for (base = 0; base < num_of_vector; base += n) {
+		n = ogs_min(num_of_vector - base, MILENAGE_BATCH_SIZE);
+
+		/* TEMP = E_K(RAND XOR OP_C) */
+		for (i = 0; i < n; i++)
+			for (j = 0; j < 16; j++)
+				in[i][j] = vector[base + i].rand[j] ^ opc[j];
+		ogs_aes_key_encrypt(&key, in[0], temp[0], n);
+
+		for (i = 0; i < n; i++) {
+			v = &vector[base + i];
+
+			/* f1 : E_K(TEMP XOR rot(IN1 XOR OP_C, r1) XOR c1) */
+			os_memcpy(in1, v->sqn, 6);
+			os_memcpy(in1 + 6, amf, 2);
+			os_memcpy(in1 + 8, in1, 8);
+			ShiftBits(64, in[4*i], in1, opc);
+			for (j = 0; j < 16; j++)
+				in[4*i][j] ^= temp[i][j];
+
+			/* f5 || f2 : E_K(rot(TEMP XOR OP_C, r2) XOR c2) */
+			ShiftBits(0, in[4*i+1], temp[i], opc);
+			in[4*i+1][15] ^= 1;
+
+			/* f3 : E_K(rot(TEMP XOR OP_C, r3) XOR c3) */
+			ShiftBits(32, in[4*i+2], temp[i], opc);
+			in[4*i+2][15] ^= 2;
+
+			/* f4 : E_K(rot(TEMP XOR OP_C, r4) XOR c4) */
+			ShiftBits(64, in[4*i+3], temp[i], opc);
+			in[4*i+3][15] ^= 4;
+		}
+		ogs_aes_key_encrypt(&key, in[0], out[0], 4 * n);
+
+		for (i = 0; i < n; i++) {
+			v = &vector[base + i];
+
+			for (j = 0; j < 16; j++) {
+				out[4*i][j] ^= opc[j];
+				out[4*i+1][j] ^= opc[j];
+				v->ck[j] = out[4*i+2][j] ^ opc[j];
+				v->ik[j] = out[4*i+3][j] ^ opc[j];
+			}
+			os_memcpy(v->res, out[4*i+1] + 8, 8);
+			os_memcpy(v->ak, out[4*i+1], 6);
+
+			/* AUTN = (SQN ^ AK) || AMF || MAC */
+			for (j = 0; j < 6; j++)
+				v->autn[j] = v->sqn[j] ^ v->ak[j];
+			os_memcpy(v->autn + 6, amf, 2);
+			os_memcpy(v->autn + 8, out[4*i], 8);
+		}
+	}
+
+	ogs_aes_key_clear(&key);
+
+	return 0;
 }
 
 /**
@@ -387,8 +478,11 @@ int milenage_check(const uint8_t *opc, const uint8_t *k,
 void milenage_opc(const uint8_t *k, const uint8_t *op,  uint8_t *opc)
 {
     int i;
+    ogs_aes_key_t key;
 
-    aes_128_encrypt_block(k,  op, opc);
+    ogs_assert(ogs_aes_key_setup(&key, k, 128) == OGS_OK);
+    aes_128_encrypt_block(&key, op, opc);
+    ogs_aes_key_clear(&key);
 
     for (i = 0; i < 16; i++)
     {
@@ -17,10 +17,23 @@
 extern "C" {
 #endif
 
+typedef struct milenage_vector_s {
+    uint8_t rand[16];           /* Input */
+    uint8_t sqn[6];             /* Input */
+
+    uint8_t autn[16];
+    uint8_t ik[16];
+    uint8_t ck[16];
+    uint8_t ak[6];
+    uint8_t res[8];
+} milenage_vector_t;
+
 void milenage_generate(const uint8_t *opc, const uint8_t *amf, 
     const uint8_t *k, const uint8_t *sqn, const uint8_t *_rand, 
     uint8_t *autn, uint8_t *ik, uint8_t *ck, uint8_t *ak,
     uint8_t *res, size_t *res_len);
+int milenage_generate_batch(const uint8_t *opc, const uint8_t *amf,
+    const uint8_t *k, milenage_vector_t *vector, int num_of_vector);
 int milenage_auts(const uint8_t *opc, const uint8_t *k, 
     const uint8_t *_rand, const uint8_t *auts, uint8_t *sqn);
 int gsm_milenage(const uint8_t *opc, const uint8_t *k, 
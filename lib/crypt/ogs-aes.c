@@ -27,6 +27,10 @@
 
 #include "ogs-crypt.h"
 
+#if HAVE_OPENSSL
+#include <openssl/evp.h>
+#endif
+
 #define FULL_UNROLL
 
 static const uint32_t Te0[256] =
@@ -1378,6 +1382,12 @@ int ogs_aes_cbc_decrypt(const uint8_t *key, const uint32_t keybits,
     return OGS_OK;
 }
 
+#if HAVE_OPENSSL
+static ogs_aes_backend_e default_backend = OGS_AES_BACKEND_OPENSSL;
+#else
+static ogs_aes_backend_e default_backend = OGS_AES_BACKEND_SOFTWARE;
+#endif
+
 static void ctr128_inc(uint8_t *counter)
 {
     uint32_t n = 16, c = 1;
@@ -1416,6 +1426,83 @@ static void ctr128_inc_aligned(uint8_t *counter)
     } while (n);
 }
 
+#if HAVE_OPENSSL
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+/*
+ * OpenSSL 3.0 looks up the implementation on every EVP_EncryptInit_ex()
+ * with the legacy EVP_aes_xxx() ciphers. Fetch them once instead.
+ */
+static EVP_CIPHER *fetched_cipher[4];
+
+static const EVP_CIPHER *openssl_cipher(int id, const char *name)
+{
+    EVP_CIPHER *cipher = __atomic_load_n(&fetched_cipher[id], __ATOMIC_ACQUIRE);
+    EVP_CIPHER *expected = NULL;
+
+    if (cipher)
+        return cipher;
+
+    cipher = EVP_CIPHER_fetch(NULL, name, NULL);
+    if (!cipher)
+        return NULL;
+
+    if (!__atomic_compare_exchange_n(&fetched_cipher[id], &expected, cipher,
+                false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        EVP_CIPHER_free(cipher);
+        cipher = expected;
+    }
+
+    return cipher;
+}
+
+#define OPENSSL_AES_128_ECB() openssl_cipher(0, "AES-128-ECB")
+#define OPENSSL_AES_192_ECB() openssl_cipher(1, "AES-192-ECB")
+#define OPENSSL_AES_256_ECB() openssl_cipher(2, "AES-256-ECB")
+#define OPENSSL_AES_128_CTR() openssl_cipher(3, "AES-128-CTR")
+#else
+#define OPENSSL_AES_128_ECB() EVP_aes_128_ecb()
+#define OPENSSL_AES_192_ECB() EVP_aes_192_ecb()
+#define OPENSSL_AES_256_ECB() EVP_aes_256_ecb()
+#define OPENSSL_AES_128_CTR() EVP_aes_128_ctr()
+#endif
+
+static int openssl_ctr128_encrypt(const uint8_t *key,
+        uint8_t *ivec, const uint8_t *in, const uint32_t inlen,
+        uint8_t *out)
+{
+    EVP_CIPHER_CTX *ctx = NULL;
+    const EVP_CIPHER *cipher = NULL;
+    uint32_t i;
+    int outlen = 0;
+
+    cipher = OPENSSL_AES_128_CTR();
+    if (!cipher) {
+        ogs_error("No AES-128-CTR in OpenSSL");
+        return OGS_ERROR;
+    }
+
+    ctx = EVP_CIPHER_CTX_new();
+    if (!ctx) {
+        ogs_error("EVP_CIPHER_CTX_new() failed");
+        return OGS_ERROR;
+    }
+
+    if (EVP_EncryptInit_ex(ctx, cipher, NULL, key, ivec) != 1 ||
+        EVP_EncryptUpdate(ctx, out, &outlen, in, inlen) != 1) {
+        ogs_error("EVP_Encrypt() failed");
+        EVP_CIPHER_CTX_free(ctx);
+        return OGS_ERROR;
+    }
+    EVP_CIPHER_CTX_free(ctx);
+
+    /* The counter is left at the next unused block as in the software path */
+    for (i = 0; i < (inlen + 15) / 16; i++)
+        ctr128_inc(ivec);
+
+    return OGS_OK;
+}
+#endif
+
 int ogs_aes_ctr128_encrypt(const uint8_t *key,
         uint8_t *ivec, const uint8_t *in, const uint32_t inlen,
         uint8_t *out)
@@ -1435,6 +1522,12 @@ int ogs_aes_ctr128_encrypt(const uint8_t *key,
     ogs_assert(len);
     ogs_assert(out);
 
+#if HAVE_OPENSSL
+    if (ogs_aes_get_backend() == OGS_AES_BACKEND_OPENSSL &&
+        openssl_ctr128_encrypt(key, ivec, in, inlen, out) == OGS_OK)
+        return OGS_OK;
+#endif
+
     memset(ecount_buf, 0, 16);
     nrounds = ogs_aes_setup_enc(rk, key, 128);
 
@@ -1485,3 +1578,119 @@ int ogs_aes_ctr128_encrypt(const uint8_t *key,
     return OGS_OK;
 }
 
+int ogs_aes_set_backend(ogs_aes_backend_e backend)
+{
+    switch (backend) {
+    case OGS_AES_BACKEND_SOFTWARE:
+        break;
+    case OGS_AES_BACKEND_OPENSSL:
+#if HAVE_OPENSSL
+        break;
+#else
+        ogs_warn("Not built with OpenSSL");
+        return OGS_ERROR;
+#endif
+    default:
+        ogs_error("Unknown AES backend [%d]", backend);
+        return OGS_ERROR;
+    }
+
+    __atomic_store_n(&default_backend, backend, __ATOMIC_RELEASE);
+
+    return OGS_OK;
+}
+
+ogs_aes_backend_e ogs_aes_get_backend(void)
+{
+    return __atomic_load_n(&default_backend, __ATOMIC_ACQUIRE);
+}
+
+int ogs_aes_key_setup(ogs_aes_key_t *key, const uint8_t *k, int keybits)
+{
+    ogs_assert(key);
+    ogs_assert(k);
+
+    memset(key, 0, sizeof(*key));
+
+#if HAVE_OPENSSL
+    if (ogs_aes_get_backend() == OGS_AES_BACKEND_OPENSSL) {
+        const EVP_CIPHER *cipher = NULL;
+        EVP_CIPHER_CTX *ctx = NULL;
+
+        switch (keybits) {
+        case 128:
+            cipher = OPENSSL_AES_128_ECB();
+            break;
+        case 192:
+            cipher = OPENSSL_AES_192_ECB();
+            break;
+        case 256:
+            cipher = OPENSSL_AES_256_ECB();
+            break;
+        default:
+            ogs_error("Invalid key bits [%d]", keybits);
+            return OGS_ERROR;
+        }
+
+        ctx = EVP_CIPHER_CTX_new();
+        if (ctx && cipher &&
+            EVP_EncryptInit_ex(ctx, cipher, NULL, k, NULL) == 1 &&
+            EVP_CIPHER_CTX_set_padding(ctx, 0) == 1) {
+            key->backend = OGS_AES_BACKEND_OPENSSL;
+            key->evp = ctx;
+            return OGS_OK;
+        }
+
+        ogs_error("EVP_EncryptInit_ex() failed");
+        if (ctx)
+            EVP_CIPHER_CTX_free(ctx);
+
+        /* Fall back to the software implementation */
+    }
+#endif
+
+    key->backend = OGS_AES_BACKEND_SOFTWARE;
+    key->nrounds = ogs_aes_setup_enc(key->rk, k, keybits);
+    if (!key->nrounds) {
+        ogs_error("Invalid key bits [%d]", keybits);
+        return OGS_ERROR;
+    }
+
+    return OGS_OK;
+}
+
+void ogs_aes_key_encrypt(ogs_aes_key_t *key,
+        const uint8_t *in, uint8_t *out, uint32_t num_of_block)
+{
+    uint32_t i;
+
+    ogs_assert(key);
+    ogs_assert(in);
+    ogs_assert(out);
+
+#if HAVE_OPENSSL
+    if (key->backend == OGS_AES_BACKEND_OPENSSL) {
+        int outlen = 0;
+
+        ogs_assert(EVP_EncryptUpdate(key->evp, out, &outlen,
+                    in, num_of_block * OGS_AES_BLOCK_SIZE) == 1);
+        return;
+    }
+#endif
+
+    for (i = 0; i < num_of_block; i++)
+        ogs_aes_encrypt(key->rk, key->nrounds,
+                in + i * OGS_AES_BLOCK_SIZE, out + i * OGS_AES_BLOCK_SIZE);
+}
+
+void ogs_aes_key_clear(ogs_aes_key_t *key)
+{
+    ogs_assert(key);
+
+#if HAVE_OPENSSL
+    if (key->evp)
+        EVP_CIPHER_CTX_free(key->evp);
+#endif
+
+    memset(key, 0, sizeof(*key));
+}
@@ -64,6 +64,34 @@ int ogs_aes_ctr128_encrypt(const uint8_t *key,
         uint8_t *ivec, const uint8_t *in, const uint32_t inlen,
         uint8_t *out);
 
+/*
+ * OGS_AES_BACKEND_OPENSSL goes through the OpenSSL EVP interface, which
+ * uses AES-NI or other hardware support when the CPU has it. It is the
+ * default when built with libcrypto. The backend applies to CTR, CMAC,
+ * Milenage and ogs_aes_key_t; it can be changed from any thread and an
+ * ogs_aes_key_t keeps the backend it was set up with.
+ */
+typedef enum {
+    OGS_AES_BACKEND_SOFTWARE = 0,
+    OGS_AES_BACKEND_OPENSSL,
+} ogs_aes_backend_e;
+
+int ogs_aes_set_backend(ogs_aes_backend_e backend);
+ogs_aes_backend_e ogs_aes_get_backend(void);
+
+/* Encryption key expanded once and used for many ECB blocks */
+typedef struct ogs_aes_key_s {
+    ogs_aes_backend_e backend;
+    int nrounds;
+    uint32_t rk[OGS_AES_RKLENGTH(OGS_AES_MAX_KEY_BITS)];
+    void *evp;
+} ogs_aes_key_t;
+
+int ogs_aes_key_setup(ogs_aes_key_t *key, const uint8_t *k, int keybits);
+void ogs_aes_key_encrypt(ogs_aes_key_t *key,
+        const uint8_t *in, uint8_t *out, uint32_t num_of_block);
+void ogs_aes_key_clear(ogs_aes_key_t *key);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2019-2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-crypt.h"
+
+#if HAVE_OPENSSL
+#include <openssl/opensslv.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#define OGS_ECIES_OPENSSL 1
+#include <openssl/evp.h>
+#include <openssl/bn.h>
+#include <openssl/core_names.h>
+#include <openssl/param_build.h>
+#endif
+#endif
+
+#if OGS_ECIES_OPENSSL
+static EVP_PKEY *openssl_p256_key(const uint8_t *data, size_t len, int priv)
+{
+    EVP_PKEY_CTX *ctx = NULL;
+    EVP_PKEY *pkey = NULL;
+    OSSL_PARAM_BLD *bld = NULL;
+    OSSL_PARAM *params = NULL;
+    BIGNUM *bn = NULL;
+
+    bld = OSSL_PARAM_BLD_new();
+    if (!bld)
+        goto cleanup;
+
+    if (!OSSL_PARAM_BLD_push_utf8_string(bld,
+                OSSL_PKEY_PARAM_GROUP_NAME, "prime256v1", 0))
+        goto cleanup;
+
+    if (priv) {
+        bn = BN_bin2bn(data, len, NULL);
+        if (!bn || !OSSL_PARAM_BLD_push_BN(bld,
+                    OSSL_PKEY_PARAM_PRIV_KEY, bn))
+            goto cleanup;
+    } else {
+        if (!OSSL_PARAM_BLD_push_octet_string(bld,
+                    OSSL_PKEY_PARAM_PUB_KEY, data, len))
+            goto cleanup;
+    }
+
+    params = OSSL_PARAM_BLD_to_param(bld);
+    if (!params)
+        goto cleanup;
+
+    ctx = EVP_PKEY_CTX_new_from_name(NULL, "EC", NULL);
+    if (!ctx || EVP_PKEY_fromdata_init(ctx) <= 0 ||
+        EVP_PKEY_fromdata(ctx, &pkey,
+            priv ? EVP_PKEY_KEYPAIR : EVP_PKEY_PUBLIC_KEY, params) <= 0)
+        pkey = NULL;
+
+cleanup:
+    EVP_PKEY_CTX_free(ctx);
+    OSSL_PARAM_free(params);
+    OSSL_PARAM_BLD_free(bld);
+    BN_clear_free(bn);
+
+    return pkey;
+}
+
+static int openssl_shared_secret(ogs_ecies_key_t *key,
+        const uint8_t *pubkey, uint8_t *z)
+{
+    EVP_PKEY_CTX *ctx = NULL;
+    EVP_PKEY *peer = NULL;
+    size_t len = ECC_BYTES;
+    int rv = OGS_ERROR;
+
+    if (key->scheme == OGS_PROTECTION_SCHEME_PROFILE_A)
+        peer = EVP_PKEY_new_raw_public_key(
+                EVP_PKEY_X25519, NULL, pubkey, ECC_BYTES);
+    else
+        peer = openssl_p256_key(pubkey, ECC_BYTES+1, 0);
+    if (!peer)
+        goto cleanup;
+
+    ctx = EVP_PKEY_CTX_new(key->pkey, NULL);
+    if (!ctx)
+        goto cleanup;
+
+    /*
+     * The point has already been decoded onto the curve. The extra public
+     * key check of EVP_PKEY_derive_set_peer() would cost another scalar
+     * multiplication per SUCI.
+     */
+    if (EVP_PKEY_derive_init(ctx) <= 0 ||
+        EVP_PKEY_derive_set_peer_ex(ctx, peer, 0) <= 0 ||
+        EVP_PKEY_derive(ctx, z, &len) <= 0 || len != ECC_BYTES)
+        goto cleanup;
+
+    rv = OGS_OK;
+
+cleanup:
+    EVP_PKEY_CTX_free(ctx);
+    EVP_PKEY_free(peer);
+
+    return rv;
+}
+#endif
+
+int ogs_ecies_key_setup(ogs_ecies_key_t *key, uint8_t scheme, const uint8_t *k)
+{
+    ogs_assert(key);
+    ogs_assert(k);
+
+    if (scheme != OGS_PROTECTION_SCHEME_PROFILE_A &&
+        scheme != OGS_PROTECTION_SCHEME_PROFILE_B) {
+        ogs_error("Invalid scheme [%d]", scheme);
+        return OGS_ERROR;
+    }
+
+    memset(key, 0, sizeof(*key));
+    key->backend = OGS_AES_BACKEND_SOFTWARE;
+    key->scheme = scheme;
+    memcpy(key->k, k, ECC_BYTES);
+
+#if OGS_ECIES_OPENSSL
+    if (ogs_aes_get_backend() == OGS_AES_BACKEND_OPENSSL) {
+        if (scheme == OGS_PROTECTION_SCHEME_PROFILE_A)
+            key->pkey = EVP_PKEY_new_raw_private_key(
+                    EVP_PKEY_X25519, NULL, k, ECC_BYTES);
+        else
+            key->pkey = openssl_p256_key(k, ECC_BYTES, 1);
+
+        if (key->pkey)
+            key->backend = OGS_AES_BACKEND_OPENSSL;
+        else
+            ogs_warn("Cannot load key into OpenSSL, use built-in curve");
+    }
+#endif
+
+    return OGS_OK;
+}
+
+void ogs_ecies_key_clear(ogs_ecies_key_t *key)
+{
+    ogs_assert(key);
+
+#if OGS_ECIES_OPENSSL
+    if (key->pkey)
+        EVP_PKEY_free(key->pkey);
+#endif
+
+    memset(key, 0, sizeof(*key));
+}
+
+int ogs_ecies_pubkey_len(uint8_t scheme)
+{
+    if (scheme == OGS_PROTECTION_SCHEME_PROFILE_A)
+        return ECC_BYTES;
+    else if (scheme == OGS_PROTECTION_SCHEME_PROFILE_B)
+        return ECC_BYTES+1;
+
+    return 0;
+}
+
+int ogs_ecies_shared_secret(ogs_ecies_key_t *key,
+        const uint8_t *pubkey, uint8_t *z)
+{
+    ogs_assert(key);
+    ogs_assert(key->scheme);
+    ogs_assert(pubkey);
+    ogs_assert(z);
+
+#if OGS_ECIES_OPENSSL
+    if (key->backend == OGS_AES_BACKEND_OPENSSL)
+        return openssl_shared_secret(key, pubkey, z);
+#endif
+
+    if (key->scheme == OGS_PROTECTION_SCHEME_PROFILE_A) {
+        curve25519_donna(z, key->k, pubkey);
+    } else {
+        if (ecdh_shared_secret(pubkey, key->k, z) != 1)
+            return OGS_ERROR;
+    }
+
+    return OGS_OK;
+}
+
+int ogs_ecies_decrypt(ogs_ecies_key_t *key, const uint8_t *pubkey,
+        const uint8_t *cipher_text, uint32_t len, const uint8_t *mactag,
+        uint8_t *plain_text)
+{
+    uint8_t z[ECC_BYTES];
+    uint8_t ek[OGS_KEY_LEN];
+    uint8_t icb[OGS_IVEC_LEN];
+    uint8_t mk[OGS_SHA256_DIGEST_SIZE];
+    uint8_t mactag2[OGS_MACTAG_LEN];
+
+    ogs_assert(key);
+    ogs_assert(pubkey);
+    ogs_assert(cipher_text);
+    ogs_assert(mactag);
+    ogs_assert(plain_text);
+
+    if (ogs_ecies_shared_secret(key, pubkey, z) != OGS_OK) {
+        ogs_error("ogs_ecies_shared_secret() failed");
+        ogs_log_hexdump(OGS_LOG_ERROR,
+                pubkey, ogs_ecies_pubkey_len(key->scheme));
+        return OGS_ERROR;
+    }
+
+    ogs_kdf_ansi_x963(z, ECC_BYTES,
+            pubkey, ogs_ecies_pubkey_len(key->scheme), ek, icb, mk);
+
+    ogs_hmac_sha256(mk, OGS_SHA256_DIGEST_SIZE,
+            cipher_text, len, mactag2, OGS_MACTAG_LEN);
+
+    if (memcmp(mactag, mactag2, OGS_MACTAG_LEN) != 0) {
+        ogs_error("MAC-tag not matched");
+        ogs_log_hexdump(OGS_LOG_ERROR, mactag, OGS_MACTAG_LEN);
+        ogs_log_hexdump(OGS_LOG_ERROR, mactag2, OGS_MACTAG_LEN);
+        return OGS_ERROR;
+    }
+
+    ogs_aes_ctr128_encrypt(ek, icb, cipher_text, len, plain_text);
+
+    return OGS_OK;
+}
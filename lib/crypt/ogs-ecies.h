@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2019-2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if !defined(OGS_CRYPT_INSIDE) && !defined(OGS_CRYPT_COMPILATION)
+#error "This header cannot be included directly."
+#endif
+
+#ifndef OGS_ECIES_H
+#define OGS_ECIES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * TS33.501 Annex C.3 : ECIES scheme on the home network side.
+ *
+ * The home network private key is loaded once into the backend
+ * (OpenSSL X25519/P-256 or the built-in curves, following
+ * ogs_aes_get_backend()) and can then be shared by several threads.
+ */
+typedef struct ogs_ecies_key_s {
+    ogs_aes_backend_e backend;
+    uint8_t scheme;
+    uint8_t k[ECC_BYTES];
+    void *pkey;
+} ogs_ecies_key_t;
+
+int ogs_ecies_key_setup(ogs_ecies_key_t *key, uint8_t scheme, const uint8_t *k);
+void ogs_ecies_key_clear(ogs_ecies_key_t *key);
+
+/* 32 bytes for Profile A, 33 bytes (compressed point) for Profile B */
+int ogs_ecies_pubkey_len(uint8_t scheme);
+
+int ogs_ecies_shared_secret(ogs_ecies_key_t *key,
+        const uint8_t *pubkey, uint8_t *z);
+
+/* Verifies the MAC tag and deciphers the scheme output */
+int ogs_ecies_decrypt(ogs_ecies_key_t *key, const uint8_t *pubkey,
+        const uint8_t *cipher_text, uint32_t len, const uint8_t *mactag,
+        uint8_t *plain_text);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_ECIES_H */
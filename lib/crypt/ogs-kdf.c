@@ -509,3 +509,11 @@ void ogs_auc_sqn(
         sqn_ms[i] = ak[i] ^ conc_sqn_ms[i];
     milenage_f1(opc, k, rand, sqn_ms, amf, NULL, mac_s);
 }
+
+uint64_t ogs_auc_sqn_next(uint64_t sqn, int n)
+{
+    ogs_assert(n >= 0);
+
+    /* SQN = SEQ || IND, with IND in the low 5 bits */
+    return (sqn + 32 * (uint64_t)n) & OGS_MAX_SQN;
+}
@@ -134,6 +134,12 @@ void ogs_auc_sqn(
     const uint8_t *rand, const uint8_t *conc_sqn_ms,
     uint8_t *sqn_ms, uint8_t *mac_s);
 
+/*
+ * TS33.102 C.3.2
+ * The n-th SQN after `sqn` when SEQ is stepped and IND is kept
+ */
+uint64_t ogs_auc_sqn_next(uint64_t sqn, int n);
+
 #ifdef __cplusplus
 }
 #endif
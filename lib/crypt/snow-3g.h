@@ -15,24 +15,36 @@ typedef uint8_t u8;
 typedef uint32_t u32;
 typedef uint64_t u64;
 
+/*
+ * SNOW 3G keystream generator state. The 16 LFSR words are a window
+ * at lfsr[base], see ClockLFSR() in snow-3g.c. A context is owned by
+ * its caller, so separate contexts can be used from different threads.
+ */
+typedef struct snow_3g_ctx_s {
+    u32 lfsr[32];
+    int base;
+    u32 R1, R2, R3;
+} snow_3g_ctx_t;
+
 /* Initialization.
 * Input k[4]: Four 32-bit words making up 128-bit key.
 * Input IV[4]: Four 32-bit words making 128-bit initialization variable.
-* Output: All the LFSRs and FSM are initialized for key generation.
+* Output: All the LFSRs and FSM are initialized for key generation,
+* and the first FSM output of section 4.2 is already discarded.
 * See Section 4.1.
 */
 
-void snow_3g_initialize(u32 k[4], u32 IV[4]);
+void snow_3g_initialize(snow_3g_ctx_t *ctx, u32 k[4], u32 IV[4]);
 
 /* Generation of Keystream.
-* input n: number of 32-bit words of keystream.
-* input z: space for the generated keystream, assumes
-* memory is allocated already.
-* output: generated keystream which is filled in z
+* The next 32 or 64 bits of keystream (z_t first in the MSB side),
+* or n 32-bit words into z. Successive calls continue the same keystream.
 * See section 4.2.
 */
 
-void snow_3g_generate_key_stream(u32 n, u32 *z);
+u32 snow_3g_generate_word32(snow_3g_ctx_t *ctx);
+u64 snow_3g_generate_word64(snow_3g_ctx_t *ctx);
+void snow_3g_generate_key_stream(snow_3g_ctx_t *ctx, u32 n, u32 *z);
 
 /* f8.
 * Input key: 128 bit Confidentiality Key.
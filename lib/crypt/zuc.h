@@ -21,15 +21,33 @@ extern "C" {
 typedef uint8_t u8;
 typedef uint32_t u32;
 
+typedef uint64_t u64;
+
+/*
+ * ZUC keystream generator state. The 16 LFSR words are a window at
+ * lfsr[base], see LFSR() in zuc.c. A context is owned by its caller,
+ * so separate contexts can be used from different threads.
+ */
+typedef struct zuc_ctx_s {
+    u32 lfsr[32];
+    int base;
+    u32 R1, R2;
+} zuc_ctx_t;
+
 /*
  * ZUC keystream generator
  * k: secret key (input, 16 bytes)
  * iv: initialization vector (input, 16 bytes)
- * Keystream: produced keystream (output, variable length)
- * KeystreamLen: length in bits requested for the keystream (input)
+ * Keystream: produced keystream (output, KeystreamLen 32-bit words)
+ *
+ * zuc_initialize() also discards the first output of F, so the next
+ * zuc_generate_word32() returns z1. Successive calls continue the
+ * same keystream.
 */
-void zuc_initialize(u8* k, u8* iv);
-void zuc_generate_key_stream(u32* pKeystream, u32 KeystreamLen);
+void zuc_initialize(zuc_ctx_t *ctx, u8* k, u8* iv);
+u32 zuc_generate_word32(zuc_ctx_t *ctx);
+void zuc_generate_key_stream(zuc_ctx_t *ctx,
+        u32* pKeystream, u32 KeystreamLen);
 
 /*
  * CK: ciphering key
@@ -0,0 +1,786 @@
+/*
+ * Copyright (C) 2019-2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-dbi.h"
+
+static int cache_initialized = 0;
+
+static OGS_POOL(cache_pool, ogs_dbi_cache_t);
+static ogs_hash_t *cache_hash;
+static ogs_list_t cache_list;     /* Most recently used first */
+static ogs_thread_mutex_t cache_mutex;
+
+static void cache_free(ogs_dbi_cache_t *cache);
+
+void ogs_dbi_cache_init(int size)
+{
+    ogs_assert(cache_initialized == 0);
+
+    if (size <= 0)
+        return;
+
+    ogs_list_init(&cache_list);
+    ogs_pool_init(&cache_pool, size);
+
+    cache_hash = ogs_hash_make();
+    ogs_assert(cache_hash);
+
+    ogs_thread_mutex_init(&cache_mutex);
+
+    cache_initialized = 1;
+
+    ogs_info("DBI cache enabled [size:%d]", size);
+}
+
+void ogs_dbi_cache_final(void)
+{
+    ogs_dbi_cache_t *cache = NULL, *next_cache = NULL;
+
+    if (!cache_initialized)
+        return;
+
+    if (ogs_dbi_cache_flush() != OGS_OK)
+        ogs_error("Cached SQN not written back");
+
+    ogs_list_for_each_safe(&cache_list, next_cache, cache)
+        cache_free(cache);
+
+    ogs_assert(cache_hash);
+    ogs_hash_destroy(cache_hash);
+
+    ogs_pool_final(&cache_pool);
+    ogs_thread_mutex_destroy(&cache_mutex);
+
+    cache_initialized = 0;
+}
+
+bool ogs_dbi_cache_enabled(void)
+{
+    return cache_initialized == 1;
+}
+
+static char **framed_routes_copy(char **src)
+{
+    char **dst = NULL;
+    int i;
+
+    if (!src)
+        return NULL;
+
+    dst = ogs_calloc(OGS_MAX_NUM_OF_FRAMED_ROUTES_IN_PDI, sizeof(dst[0]));
+    ogs_assert(dst);
+
+    for (i = 0; i < OGS_MAX_NUM_OF_FRAMED_ROUTES_IN_PDI && src[i]; i++) {
+        dst[i] = ogs_strdup(src[i]);
+        ogs_assert(dst[i]);
+    }
+
+    return dst;
+}
+
+static void framed_routes_free(char **routes)
+{
+    int i;
+
+    if (!routes)
+        return;
+
+    for (i = 0; i < OGS_MAX_NUM_OF_FRAMED_ROUTES_IN_PDI && routes[i]; i++)
+        ogs_free(routes[i]);
+    ogs_free(routes);
+}
+
+static void subscription_data_copy(
+        ogs_subscription_data_t *dst, ogs_subscription_data_t *src)
+{
+    int i, j;
+
+    memcpy(dst, src, sizeof(*dst));
+
+    if (src->imsi) {
+        dst->imsi = ogs_strdup(src->imsi);
+        ogs_assert(dst->imsi);
+    }
+    if (src->mme_host) {
+        dst->mme_host = ogs_strdup(src->mme_host);
+        ogs_assert(dst->mme_host);
+    }
+    if (src->mme_realm) {
+        dst->mme_realm = ogs_strdup(src->mme_realm);
+        ogs_assert(dst->mme_realm);
+    }
+
+    for (i = 0; i < src->num_of_slice; i++) {
+        for (j = 0; j < src->slice[i].num_of_session; j++) {
+            ogs_session_t *s = &src->slice[i].session[j];
+            ogs_session_t *d = &dst->slice[i].session[j];
+
+            if (s->name) {
+                d->name = ogs_strdup(s->name);
+                ogs_assert(d->name);
+            }
+            d->ipv4_framed_routes = framed_routes_copy(s->ipv4_framed_routes);
+            d->ipv6_framed_routes = framed_routes_copy(s->ipv6_framed_routes);
+        }
+    }
+}
+
+static void subscription_data_clear(ogs_subscription_data_t *data)
+{
+    int i, j;
+
+    for (i = 0; i < data->num_of_slice; i++) {
+        for (j = 0; j < data->slice[i].num_of_session; j++) {
+            framed_routes_free(data->slice[i].session[j].ipv4_framed_routes);
+            framed_routes_free(data->slice[i].session[j].ipv6_framed_routes);
+        }
+    }
+
+    ogs_subscription_data_free(data);
+    memset(data, 0, sizeof(*data));
+}
+
+static ogs_dbi_cache_t *cache_find(char *supi)
+{
+    ogs_dbi_cache_t *cache = NULL;
+
+    cache = ogs_hash_get(cache_hash, supi, OGS_HASH_KEY_STRING);
+    if (cache) {
+        ogs_list_remove(&cache_list, cache);
+        ogs_list_prepend(&cache_list, cache);
+    }
+
+    return cache;
+}
+
+static void cache_free(ogs_dbi_cache_t *cache)
+{
+    ogs_list_remove(&cache_list, cache);
+    ogs_hash_set(cache_hash, cache->supi, OGS_HASH_KEY_STRING, NULL);
+
+    if (cache->subscription_data_valid)
+        subscription_data_clear(&cache->subscription_data);
+
+    ogs_free(cache->supi);
+    ogs_pool_free(&cache_pool, cache);
+}
+
+/*
+ * An entry with an SQN not yet in the DB is kept for ogs_dbi_cache_flush(),
+ * but nothing else in it is used until it is loaded again.
+ */
+static void cache_invalidate(ogs_dbi_cache_t *cache)
+{
+    if (!cache->sqn_dirty) {
+        cache_free(cache);
+        return;
+    }
+
+    cache->auth_info_valid = false;
+
+    if (cache->subscription_data_valid)
+        subscription_data_clear(&cache->subscription_data);
+    cache->subscription_data_valid = false;
+}
+
+static ogs_dbi_cache_t *cache_add(char *supi)
+{
+    ogs_dbi_cache_t *cache = NULL;
+
+    ogs_pool_alloc(&cache_pool, &cache);
+    if (!cache) {
+        ogs_dbi_cache_t *lru = NULL;
+
+        /* Evict the least recently used entry with no SQN to write back */
+        for (lru = ogs_list_last(&cache_list); lru; lru = ogs_list_prev(lru))
+            if (!lru->sqn_dirty)
+                break;
+        if (!lru)
+            return NULL;
+
+        cache_free(lru);
+
+        ogs_pool_alloc(&cache_pool, &cache);
+        ogs_assert(cache);
+    }
+    memset(cache, 0, sizeof(*cache));
+
+    cache->supi = ogs_strdup(supi);
+    ogs_assert(cache->supi);
+
+    ogs_hash_set(cache_hash, cache->supi, OGS_HASH_KEY_STRING, cache);
+    ogs_list_prepend(&cache_list, cache);
+
+    return cache;
+}
+
+bool ogs_dbi_cache_get_auth_info(char *supi, ogs_dbi_auth_info_t *auth_info)
+{
+    ogs_dbi_cache_t *cache = NULL;
+    bool found = false;
+
+    ogs_assert(supi);
+    ogs_assert(auth_info);
+
+    if (!cache_initialized)
+        return false;
+
+    ogs_thread_mutex_lock(&cache_mutex);
+    cache = cache_find(supi);
+    if (cache && cache->auth_info_valid) {
+        memcpy(auth_info, &cache->auth_info, sizeof(*auth_info));
+        found = true;
+    }
+    ogs_thread_mutex_unlock(&cache_mutex);
+
+    return found;
+}
+
+void ogs_dbi_cache_set_auth_info(char *supi, ogs_dbi_auth_info_t *auth_info)
+{
+    ogs_dbi_cache_t *cache = NULL;
+
+    ogs_assert(supi);
+    ogs_assert(auth_info);
+
+    if (!cache_initialized)
+        return;
+
+    ogs_thread_mutex_lock(&cache_mutex);
+    cache = cache_find(supi);
+    if (!cache)
+        cache = cache_add(supi);
+    /* A valid entry is never older than what has just been read */
+    if (cache && !cache->auth_info_valid) {
+        uint64_t sqn = cache->auth_info.sqn;
+
+        memcpy(&cache->auth_info, auth_info, sizeof(*auth_info));
+        cache->auth_info_valid = true;
+
+        if (cache->sqn_dirty && auth_info->sqn == cache->sqn_base) {
+            /* The SQN not yet written back is still the newest */
+            cache->auth_info.sqn = sqn;
+        } else {
+            if (cache->sqn_dirty)
+                ogs_warn("[%s] SQN changed in DB, drop cached SQN", supi);
+            cache->sqn_dirty = false;
+            cache->sqn_base = auth_info->sqn;
+        }
+    }
+    ogs_thread_mutex_unlock(&cache_mutex);
+}
+
+bool ogs_dbi_cache_update_sqn(char *supi, uint64_t sqn)
+{
+    ogs_dbi_cache_t *cache = NULL;
+    bool found = false;
+
+    ogs_assert(supi);
+
+    if (!cache_initialized)
+        return false;
+
+    ogs_thread_mutex_lock(&cache_mutex);
+    cache = cache_find(supi);
+    if (cache && cache->auth_info_valid) {
+        cache->auth_info.sqn = sqn;
+        cache->sqn_dirty = true;
+        found = true;
+    }
+    ogs_thread_mutex_unlock(&cache_mutex);
+
+    return found;
+}
+
+bool ogs_dbi_cache_increment_sqn(char *supi)
+{
+    ogs_dbi_cache_t *cache = NULL;
+    bool found = false;
+
+    ogs_assert(supi);
+
+    if (!cache_initialized)
+        return false;
+
+    ogs_thread_mutex_lock(&cache_mutex);
+    cache = cache_find(supi);
+    if (cache && cache->auth_info_valid) {
+        /* Same as $inc 32 followed by $bit and OGS_MAX_SQN in the DB */
+        cache->auth_info.sqn = (cache->auth_info.sqn + 32) & OGS_MAX_SQN;
+        cache->sqn_dirty = true;
+        found = true;
+    }
+    ogs_thread_mutex_unlock(&cache_mutex);
+
+    return found;
+}
+
+bool ogs_dbi_cache_get_subscription_data(char *supi,
+        ogs_subscription_data_t *subscription_data)
+{
+    ogs_dbi_cache_t *cache = NULL;
+    bool found = false;
+
+    ogs_assert(supi);
+    ogs_assert(subscription_data);
+
+    if (!cache_initialized)
+        return false;
+
+    ogs_thread_mutex_lock(&cache_mutex);
+    cache = cache_find(supi);
+    if (cache && cache->subscription_data_valid) {
+        subscription_data_copy(subscription_data, &cache->subscription_data);
+        found = true;
+    }
+    ogs_thread_mutex_unlock(&cache_mutex);
+
+    return found;
+}
+
+void ogs_dbi_cache_set_subscription_data(char *supi,
+        ogs_subscription_data_t *subscription_data)
+{
+    ogs_dbi_cache_t *cache = NULL;
+
+    ogs_assert(supi);
+    ogs_assert(subscription_data);
+
+    if (!cache_initialized)
+        return;
+
+    ogs_thread_mutex_lock(&cache_mutex);
+    cache = cache_find(supi);
+    if (!cache)
+        cache = cache_add(supi);
+    if (cache) {
+        if (cache->subscription_data_valid)
+            subscription_data_clear(&cache->subscription_data);
+        subscription_data_copy(&cache->subscription_data, subscription_data);
+        cache->subscription_data_valid = true;
+    }
+    ogs_thread_mutex_unlock(&cache_mutex);
+}
+
+void ogs_dbi_cache_update_mme(char *supi,
+        char *mme_host, char *mme_realm, bool purge_flag)
+{
+    ogs_dbi_cache_t *cache = NULL;
+
+    ogs_assert(supi);
+
+    if (!cache_initialized)
+        return;
+
+    ogs_thread_mutex_lock(&cache_mutex);
+    cache = ogs_hash_get(cache_hash, supi, OGS_HASH_KEY_STRING);
+    if (cache && cache->subscription_data_valid) {
+        ogs_subscription_data_t *data = &cache->subscription_data;
+
+        if (data->mme_host)
+            ogs_free(data->mme_host);
+        data->mme_host = mme_host ? ogs_strdup(mme_host) : NULL;
+        if (data->mme_realm)
+            ogs_free(data->mme_realm);
+        data->mme_realm = mme_realm ? ogs_strdup(mme_realm) : NULL;
+        data->purge_flag = purge_flag;
+    }
+    ogs_thread_mutex_unlock(&cache_mutex);
+}
+
+typedef struct sqn_write_s {
+    char *supi;
+    uint64_t sqn;
+    uint64_t base;
+    int result;     /* OGS_OK, OGS_NOTFOUND if the DB SQN is not base */
+} sqn_write_t;
+
+static int sqn_read(char *supi, uint64_t *sqn)
+{
+    int rv = OGS_NOTFOUND;
+    bson_t *query = NULL;
+    bson_error_t error;
+    const bson_t *document;
+    bson_iter_t iter;
+    mongoc_cursor_t *cursor = NULL;
+    char *supi_type = NULL;
+    char *supi_id = NULL;
+
+    supi_type = ogs_id_get_type(supi);
+    ogs_assert(supi_type);
+    supi_id = ogs_id_get_value(supi);
+    ogs_assert(supi_id);
+
+    query = BCON_NEW(supi_type, BCON_UTF8(supi_id));
+#if MONGOC_CHECK_VERSION(1, 5, 0)
+    cursor = mongoc_collection_find_with_opts(
+            ogs_mongoc()->collection.subscriber, query, NULL, NULL);
+#else
+    cursor = mongoc_collection_find(ogs_mongoc()->collection.subscriber,
+            MONGOC_QUERY_NONE, 0, 0, 0, query, NULL, NULL);
+#endif
+
+    if (mongoc_cursor_next(cursor, &document)) {
+        if (bson_iter_init(&iter, document) &&
+            bson_iter_find_descendant(&iter,
+                OGS_SECURITY_STRING "." OGS_SQN_STRING, &iter) &&
+            BSON_ITER_HOLDS_NUMBER(&iter)) {
+            *sqn = bson_iter_as_int64(&iter);
+            rv = OGS_OK;
+        }
+    } else if (mongoc_cursor_error(cursor, &error)) {
+        ogs_error("Cursor Failure: %s", error.message);
+        rv = OGS_ERROR;
+    }
+
+    bson_destroy(query);
+    mongoc_cursor_destroy(cursor);
+    ogs_free(supi_type);
+    ogs_free(supi_id);
+
+    return rv;
+}
+
+/*
+ * Each SQN is only written if the DB still holds the SQN the entry was
+ * loaded with or last wrote, so a change made by the operator is kept.
+ */
+static void sqn_write(sqn_write_t *write, int num)
+{
+    int i;
+    int64_t matched = -1;
+    bson_error_t error;
+#if MONGOC_CHECK_VERSION(1, 9, 0)
+    mongoc_bulk_operation_t *bulk = NULL;
+    bson_t reply;
+    bson_iter_t iter;
+    bool failed = false;
+
+    bulk = mongoc_collection_create_bulk_operation_with_opts(
+            ogs_mongoc()->collection.subscriber, NULL);
+    ogs_assert(bulk);
+#endif
+
+    for (i = 0; i < num; i++) {
+        bson_t *query = NULL;
+        bson_t *update = NULL;
+        char *supi_type = NULL;
+        char *supi_id = NULL;
+
+        write[i].result = OGS_OK;
+
+        supi_type = ogs_id_get_type(write[i].supi);
+        ogs_assert(supi_type);
+        supi_id = ogs_id_get_value(write[i].supi);
+        ogs_assert(supi_id);
+
+        query = BCON_NEW(supi_type, BCON_UTF8(supi_id),
+                OGS_SECURITY_STRING "." OGS_SQN_STRING,
+                BCON_INT64(write[i].base));
+        update = BCON_NEW("$set",
+                "{",
+                    OGS_SECURITY_STRING "." OGS_SQN_STRING,
+                    BCON_INT64(write[i].sqn),
+                "}");
+
+#if MONGOC_CHECK_VERSION(1, 9, 0)
+        if (!mongoc_bulk_operation_update_one_with_opts(
+                    bulk, query, update, NULL, &error)) {
+            ogs_error("mongoc_bulk_operation_update_one_with_opts() "
+                    "failure: %s", error.message);
+            failed = true;
+        }
+#else
+        if (!mongoc_collection_update(ogs_mongoc()->collection.subscriber,
+                MONGOC_UPDATE_NONE, query, update, NULL, &error)) {
+            ogs_error("mongoc_collection_update() failure: %s",
+                    error.message);
+            write[i].result = OGS_ERROR;
+        }
+#endif
+
+        bson_destroy(query);
+        bson_destroy(update);
+        ogs_free(supi_type);
+        ogs_free(supi_id);
+    }
+
+#if MONGOC_CHECK_VERSION(1, 9, 0)
+    if (failed) {
+        for (i = 0; i < num; i++)
+            write[i].result = OGS_ERROR;
+    } else if (!mongoc_bulk_operation_execute(bulk, &reply, &error)) {
+        ogs_error("mongoc_bulk_operation_execute() failure: %s",
+                error.message);
+        for (i = 0; i < num; i++)
+            write[i].result = OGS_ERROR;
+    } else if (bson_iter_init_find(&iter, &reply, "nMatched") &&
+            BSON_ITER_HOLDS_NUMBER(&iter)) {
+        matched = bson_iter_as_int64(&iter);
+    }
+    bson_destroy(&reply);
+    mongoc_bulk_operation_destroy(bulk);
+#endif
+
+    if (matched == num)
+        return;
+
+    /* Find out which SQNs were not written because the DB SQN changed */
+    for (i = 0; i < num; i++) {
+        uint64_t sqn = 0;
+        int rv;
+
+        if (write[i].result != OGS_OK)
+            continue;
+
+        rv = sqn_read(write[i].supi, &sqn);
+        if (rv == OGS_ERROR)
+            write[i].result = OGS_ERROR;
+        else if (rv == OGS_NOTFOUND || sqn != write[i].sqn)
+            write[i].result = OGS_NOTFOUND;
+    }
+}
+
+int ogs_dbi_cache_flush(void)
+{
+    ogs_dbi_cache_t *cache = NULL;
+    sqn_write_t *write = NULL;
+    int i, num = 0, rv = OGS_OK;
+
+    if (!cache_initialized)
+        return OGS_OK;
+
+    ogs_thread_mutex_lock(&cache_mutex);
+    ogs_list_for_each(&cache_list, cache)
+        if (cache->sqn_dirty)
+            num++;
+
+    if (num) {
+        write = ogs_calloc(num, sizeof(*write));
+        ogs_assert(write);
+
+        i = 0;
+        ogs_list_for_each(&cache_list, cache) {
+            if (!cache->sqn_dirty)
+                continue;
+
+            write[i].supi = ogs_strdup(cache->supi);
+            ogs_assert(write[i].supi);
+            write[i].sqn = cache->auth_info.sqn;
+            write[i].base = cache->sqn_base;
+            i++;
+        }
+    }
+    ogs_thread_mutex_unlock(&cache_mutex);
+
+    if (!num)
+        return OGS_OK;
+
+    sqn_write(write, num);
+
+    /*
+     * Dirty entries are never evicted or removed, so each one is found.
+     * The SQN may have been advanced again while it was being written.
+     */
+    ogs_thread_mutex_lock(&cache_mutex);
+    for (i = 0; i < num; i++) {
+        cache = ogs_hash_get(cache_hash, write[i].supi, OGS_HASH_KEY_STRING);
+        if (!cache || !cache->sqn_dirty)
+            continue;
+
+        switch (write[i].result) {
+        case OGS_OK:
+            cache->sqn_base = write[i].sqn;
+            if (cache->auth_info.sqn == write[i].sqn)
+                cache->sqn_dirty = false;
+            break;
+        case OGS_NOTFOUND:
+            ogs_warn("[%s] SQN changed in DB, drop cached SQN",
+                    write[i].supi);
+            cache->sqn_dirty = false;
+            cache_free(cache);
+            break;
+        default:
+            /* Retry on the next flush */
+            rv = OGS_ERROR;
+            break;
+        }
+    }
+    ogs_thread_mutex_unlock(&cache_mutex);
+
+    for (i = 0; i < num; i++)
+        ogs_free(write[i].supi);
+    ogs_free(write);
+
+    return rv;
+}
+
+void ogs_dbi_cache_remove(char *supi)
+{
+    ogs_dbi_cache_t *cache = NULL;
+
+    ogs_assert(supi);
+
+    if (!cache_initialized)
+        return;
+
+    ogs_thread_mutex_lock(&cache_mutex);
+    cache = ogs_hash_get(cache_hash, supi, OGS_HASH_KEY_STRING);
+    if (cache)
+        cache_invalidate(cache);
+    ogs_thread_mutex_unlock(&cache_mutex);
+}
+
+void ogs_dbi_cache_remove_all(void)
+{
+    ogs_dbi_cache_t *cache = NULL, *next_cache = NULL;
+
+    if (!cache_initialized)
+        return;
+
+    ogs_thread_mutex_lock(&cache_mutex);
+    ogs_list_for_each_safe(&cache_list, next_cache, cache)
+        cache_invalidate(cache);
+    ogs_thread_mutex_unlock(&cache_mutex);
+}
+
+static bool field_is_synced(const char *key)
+{
+    static const char *synced[] = {
+        OGS_SECURITY_STRING "." OGS_SQN_STRING,
+        OGS_IMEISV_STRING,
+        OGS_MME_HOST_STRING,
+        OGS_MME_REALM_STRING,
+        OGS_MME_TIMESTAMP_STRING,
+        OGS_PURGE_FLAG_STRING,
+    };
+    int i;
+
+    for (i = 0; i < OGS_ARRAY_SIZE(synced); i++)
+        if (!strcmp(key, synced[i]))
+            return true;
+
+    return false;
+}
+
+void ogs_dbi_cache_handle_change(const bson_t *document)
+{
+    bson_iter_t iter, child_iter;
+    const char *utf8 = NULL;
+    uint32_t length = 0;
+
+    ogs_dbi_cache_t *cache = NULL;
+    char *supi = NULL;
+    bool cached_field_changed = true;
+    bool sqn_changed = true;
+    bool sqn_presence = false;
+    uint64_t sqn = 0;
+
+    ogs_assert(document);
+
+    if (!cache_initialized)
+        return;
+
+    if (bson_iter_init_find(&iter, document, "fullDocument") &&
+            BSON_ITER_HOLDS_DOCUMENT(&iter) &&
+            bson_iter_recurse(&iter, &child_iter) &&
+            bson_iter_find(&child_iter, OGS_ID_SUPI_TYPE_IMSI) &&
+            BSON_ITER_HOLDS_UTF8(&child_iter)) {
+        utf8 = bson_iter_utf8(&child_iter, &length);
+        supi = ogs_msprintf("%s-%.*s", OGS_ID_SUPI_TYPE_IMSI,
+                (int)ogs_min(length, OGS_MAX_IMSI_BCD_LEN), utf8);
+        ogs_assert(supi);
+    }
+
+    /* With updateLookup, this is the SQN currently in the DB */
+    if (bson_iter_init_find(&iter, document, "fullDocument") &&
+            BSON_ITER_HOLDS_DOCUMENT(&iter) &&
+            bson_iter_recurse(&iter, &child_iter) &&
+            bson_iter_find_descendant(&child_iter,
+                OGS_SECURITY_STRING "." OGS_SQN_STRING, &child_iter) &&
+            BSON_ITER_HOLDS_NUMBER(&child_iter)) {
+        sqn = bson_iter_as_int64(&child_iter);
+        sqn_presence = true;
+    }
+
+    if (!supi) {
+        /* e.g. a deleted document only carries its _id */
+        ogs_dbi_cache_flush();
+        ogs_dbi_cache_remove_all();
+        return;
+    }
+
+    /*
+     * Updates written by this NF, e.g. the SQN from ogs_dbi_cache_flush(),
+     * only touch fields that are either kept in sync or not cached at all.
+     */
+    if (bson_iter_init_find(&iter, document, "updateDescription") &&
+            BSON_ITER_HOLDS_DOCUMENT(&iter)) {
+        bson_iter_t desc_iter;
+
+        cached_field_changed = false;
+        sqn_changed = false;
+
+        bson_iter_recurse(&iter, &desc_iter);
+        while (bson_iter_next(&desc_iter)) {
+            const char *key = bson_iter_key(&desc_iter);
+
+            if (!strcmp(key, "updatedFields") &&
+                    BSON_ITER_HOLDS_DOCUMENT(&desc_iter)) {
+                bson_iter_recurse(&desc_iter, &child_iter);
+                while (bson_iter_next(&child_iter)) {
+                    const char *field = bson_iter_key(&child_iter);
+
+                    if (!field_is_synced(field))
+                        cached_field_changed = true;
+                    if (!strncmp(field, OGS_SECURITY_STRING,
+                                strlen(OGS_SECURITY_STRING)))
+                        sqn_changed = true;
+                }
+            } else if (!strcmp(key, "removedFields") &&
+                    BSON_ITER_HOLDS_ARRAY(&desc_iter)) {
+                bson_iter_recurse(&desc_iter, &child_iter);
+                if (bson_iter_next(&child_iter))
+                    cached_field_changed = true;
+            }
+        }
+    }
+
+    ogs_thread_mutex_lock(&cache_mutex);
+    cache = ogs_hash_get(cache_hash, supi, OGS_HASH_KEY_STRING);
+    if (cache) {
+        /*
+         * The SQN written by ogs_dbi_cache_flush() comes back as the base.
+         * Any other SQN was set from outside, e.g. by the WebUI or dbctl,
+         * and overrides the one not yet written back.
+         */
+        if (sqn_changed && sqn_presence && sqn != cache->sqn_base) {
+            if (cache->sqn_dirty)
+                ogs_warn("[%s] SQN changed in DB, drop cached SQN", supi);
+            cache->sqn_dirty = false;
+            cached_field_changed = true;
+        }
+
+        if (cached_field_changed)
+            cache_invalidate(cache);
+    }
+    ogs_thread_mutex_unlock(&cache_mutex);
+
+    ogs_free(supi);
+}
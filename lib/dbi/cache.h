@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2019-2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if !defined(OGS_DBI_INSIDE) && !defined(OGS_DBI_COMPILATION)
+#error "This header cannot be included directly."
+#endif
+
+#ifndef OGS_DBI_CACHE_H
+#define OGS_DBI_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * LRU cache of decoded subscriber documents keyed by SUPI.
+ *
+ * Entries are invalidated from the MongoDB change stream, so the cache
+ * must only be enabled together with ogs_dbi_collection_watch_init().
+ * SQN updates are applied to the cached entry and written back to the DB
+ * in one bulk operation by ogs_dbi_cache_flush(), unless the SQN in the DB
+ * has been changed from outside in the meantime.
+ */
+typedef struct ogs_dbi_cache_s {
+    ogs_lnode_t lnode;
+
+    char *supi;
+
+    bool auth_info_valid;
+    ogs_dbi_auth_info_t auth_info;
+    bool sqn_dirty;
+    uint64_t sqn_base;      /* SQN last read from or written to the DB */
+
+    bool subscription_data_valid;
+    ogs_subscription_data_t subscription_data;
+} ogs_dbi_cache_t;
+
+void ogs_dbi_cache_init(int size);
+void ogs_dbi_cache_final(void);
+bool ogs_dbi_cache_enabled(void);
+
+bool ogs_dbi_cache_get_auth_info(char *supi, ogs_dbi_auth_info_t *auth_info);
+void ogs_dbi_cache_set_auth_info(char *supi, ogs_dbi_auth_info_t *auth_info);
+bool ogs_dbi_cache_update_sqn(char *supi, uint64_t sqn);
+bool ogs_dbi_cache_increment_sqn(char *supi);
+void ogs_dbi_cache_update_mme(char *supi,
+        char *mme_host, char *mme_realm, bool purge_flag);
+
+bool ogs_dbi_cache_get_subscription_data(char *supi,
+        ogs_subscription_data_t *subscription_data);
+void ogs_dbi_cache_set_subscription_data(char *supi,
+        ogs_subscription_data_t *subscription_data);
+
+void ogs_dbi_cache_remove(char *supi);
+void ogs_dbi_cache_remove_all(void);
+
+int ogs_dbi_cache_flush(void);
+void ogs_dbi_cache_handle_change(const bson_t *document);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_DBI_CACHE_H */
@@ -25,6 +25,13 @@ int __ogs_dbi_domain;
 
 static ogs_mongoc_t self;
 
+/*
+ * A mongoc_client_t must not be shared between threads. A DBI worker
+ * takes its own client from self.pool, and ogs_mongoc() returns the
+ * context of that client on the worker thread.
+ */
+static ogs_thread_local ogs_mongoc_t *thread_self;
+
 /*
  * We've added it 
  * Because the following function is deprecated in the mongo-c-driver
@@ -155,9 +162,93 @@ void ogs_mongoc_final(void)
 
 ogs_mongoc_t *ogs_mongoc(void)
 {
+    if (thread_self)
+        return thread_self;
+
     return &self;
 }
 
+int ogs_mongoc_pool_init(void)
+{
+    const mongoc_uri_t *uri;
+
+    ogs_assert(self.pool == NULL);
+
+    if (!self.client) {
+        ogs_error("No MongoDB client");
+        return OGS_ERROR;
+    }
+
+    uri = mongoc_client_get_uri(self.client);
+    ogs_assert(uri);
+
+    self.pool = mongoc_client_pool_new(uri);
+    if (!self.pool) {
+        ogs_error("mongoc_client_pool_new() failed [%s]", self.masked_db_uri);
+        return OGS_ERROR;
+    }
+
+#if MONGOC_CHECK_VERSION(1, 4, 0)
+    mongoc_client_pool_set_error_api(self.pool, 2);
+#endif
+
+    return OGS_OK;
+}
+
+void ogs_mongoc_pool_final(void)
+{
+    if (self.pool) {
+        mongoc_client_pool_destroy(self.pool);
+        self.pool = NULL;
+    }
+}
+
+int ogs_mongoc_thread_init(void)
+{
+    ogs_mongoc_t *worker = NULL;
+
+    ogs_assert(thread_self == NULL);
+    ogs_assert(self.pool);
+    ogs_assert(self.name);
+
+    worker = ogs_calloc(1, sizeof(*worker));
+    ogs_assert(worker);
+
+    worker->initialized = true;
+    worker->name = self.name;
+    worker->masked_db_uri = self.masked_db_uri;
+
+    worker->client = mongoc_client_pool_pop(self.pool);
+    ogs_assert(worker->client);
+
+    worker->database = mongoc_client_get_database(worker->client, self.name);
+    ogs_assert(worker->database);
+
+    worker->collection.subscriber = mongoc_client_get_collection(
+            worker->client, self.name, "subscribers");
+    ogs_assert(worker->collection.subscriber);
+
+    thread_self = worker;
+
+    return OGS_OK;
+}
+
+void ogs_mongoc_thread_final(void)
+{
+    ogs_mongoc_t *worker = thread_self;
+
+    if (!worker)
+        return;
+
+    thread_self = NULL;
+
+    mongoc_collection_destroy(worker->collection.subscriber);
+    mongoc_database_destroy(worker->database);
+    mongoc_client_pool_push(self.pool, worker->client);
+
+    ogs_free(worker);
+}
+
 int ogs_dbi_init(const char *db_uri)
 {
     int rv;
@@ -178,6 +269,9 @@ int ogs_dbi_init(const char *db_uri)
 
 void ogs_dbi_final(void)
 {
+    ogs_dbi_worker_final();
+    ogs_dbi_cache_final();
+
     if (self.collection.subscriber) {
         mongoc_collection_destroy(self.collection.subscriber);
     }
@@ -220,3 +314,32 @@ int ogs_dbi_collection_watch_init(void)
     return OGS_ERROR;
 #endif
 }
+
+int ogs_dbi_poll_change_stream(void)
+{
+#if MONGOC_CHECK_VERSION(1, 9, 0)
+    const bson_t *document;
+    const bson_t *err_document;
+    bson_error_t error;
+
+    ogs_assert(self.stream);
+
+    while (mongoc_change_stream_next(self.stream, &document))
+        ogs_dbi_cache_handle_change(document);
+
+    if (mongoc_change_stream_error_document(self.stream, &error,
+            &err_document)) {
+        if (!bson_empty(err_document)) {
+            ogs_debug("Server Error: %s\n",
+            bson_as_relaxed_extended_json(err_document, NULL));
+        } else {
+            ogs_debug("Client Error: %s\n", error.message);
+        }
+        return OGS_ERROR;
+    }
+
+    return OGS_OK;
+#else
+    return OGS_ERROR;
+#endif
+}
@@ -46,12 +46,19 @@ typedef struct ogs_mongoc_s {
     struct {
         void *subscriber;
     } collection;
+
+    void *pool; /* mongoc_client_pool_t for DBI workers */
 } ogs_mongoc_t;
 
 int ogs_mongoc_init(const char *db_uri);
 void ogs_mongoc_final(void);
 ogs_mongoc_t *ogs_mongoc(void);
 
+int ogs_mongoc_pool_init(void);
+void ogs_mongoc_pool_final(void);
+int ogs_mongoc_thread_init(void);
+void ogs_mongoc_thread_final(void);
+
 int ogs_dbi_init(const char *db_uri);
 void ogs_dbi_final(void);
 
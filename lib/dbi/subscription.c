@@ -38,6 +38,9 @@ int ogs_dbi_auth_info(char *supi, ogs_dbi_auth_info_t *auth_info)
     ogs_assert(supi);
     ogs_assert(auth_info);
 
+    if (ogs_dbi_cache_get_auth_info(supi, auth_info))
+        return OGS_OK;
+
     supi_type = ogs_id_get_type(supi);
     if (!supi_type) {
         ogs_error("Invalid supi=%s", supi);
@@ -123,9 +126,26 @@ out:
     ogs_free(supi_type);
     ogs_free(supi_id);
 
+    if (rv == OGS_OK)
+        ogs_dbi_cache_set_auth_info(supi, auth_info);
+
     return rv;
 }
 
+/*
+ * With the cache enabled, the SQN is always updated in the cached entry,
+ * which is loaded first if needed, and written back by ogs_dbi_cache_flush().
+ */
+static bool cache_sqn(char *supi)
+{
+    ogs_dbi_auth_info_t auth_info;
+
+    if (!ogs_dbi_cache_enabled())
+        return false;
+
+    return ogs_dbi_auth_info(supi, &auth_info) == OGS_OK;
+}
+
 int ogs_dbi_update_sqn(char *supi, uint64_t sqn)
 {
     int rv = OGS_OK;
@@ -138,6 +158,9 @@ int ogs_dbi_update_sqn(char *supi, uint64_t sqn)
 
     ogs_assert(supi);
 
+    if (cache_sqn(supi) && ogs_dbi_cache_update_sqn(supi, sqn))
+        return OGS_OK;
+
     supi_type = ogs_id_get_type(supi);
     ogs_assert(supi_type);
     supi_id = ogs_id_get_value(supi);
@@ -248,6 +271,9 @@ int ogs_dbi_update_mme(char *supi, char *mme_host, char *mme_realm,
     ogs_free(supi_type);
     ogs_free(supi_id);
 
+    if (rv == OGS_OK)
+        ogs_dbi_cache_update_mme(supi, mme_host, mme_realm, purge_flag);
+
     return rv;
 }
 
@@ -264,6 +290,9 @@ int ogs_dbi_increment_sqn(char *supi)
 
     ogs_assert(supi);
 
+    if (cache_sqn(supi) && ogs_dbi_cache_increment_sqn(supi))
+        return OGS_OK;
+
     supi_type = ogs_id_get_type(supi);
     ogs_assert(supi_type);
     supi_id = ogs_id_get_value(supi);
@@ -327,6 +356,9 @@ int ogs_dbi_subscription_data(char *supi,
 
     memset(subscription_data, 0, sizeof(*subscription_data));
 
+    if (ogs_dbi_cache_get_subscription_data(supi, subscription_data))
+        return OGS_OK;
+
     supi_type = ogs_id_get_type(supi);
     ogs_assert(supi_type);
     supi_id = ogs_id_get_value(supi);
@@ -834,5 +866,8 @@ out:
     ogs_free(supi_type);
     ogs_free(supi_id);
 
+    if (rv == OGS_OK)
+        ogs_dbi_cache_set_subscription_data(supi, subscription_data);
+
     return rv;
 }
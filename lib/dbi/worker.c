@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2019-2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-dbi.h"
+
+static int num_of_worker = 0;
+static ogs_thread_t **workers = NULL;
+static ogs_queue_t *request_queue = NULL;
+static ogs_dbi_backend_t backend;
+
+/* Default backend : MongoDB with one pooled client per worker */
+static const ogs_dbi_backend_t mongoc_backend = {
+    .thread_init = ogs_mongoc_thread_init,
+    .thread_final = ogs_mongoc_thread_final,
+
+    .auth_info = ogs_dbi_auth_info,
+    .update_sqn = ogs_dbi_update_sqn,
+    .increment_sqn = ogs_dbi_increment_sqn,
+    .subscription_data = ogs_dbi_subscription_data,
+};
+
+static void request_execute(ogs_dbi_request_t *request)
+{
+    int rv = OGS_OK;
+
+    ogs_assert(request);
+    ogs_assert(request->supi);
+
+    if (request->ops & OGS_DBI_REQUEST_AUTH_INFO) {
+        rv = backend.auth_info(request->supi, &request->auth_info);
+        if (rv != OGS_OK) {
+            request->failed = OGS_DBI_REQUEST_AUTH_INFO;
+            return;
+        }
+        request->done |= OGS_DBI_REQUEST_AUTH_INFO;
+    }
+    if (request->ops & OGS_DBI_REQUEST_UPDATE_SQN) {
+        rv = backend.update_sqn(request->supi, request->sqn);
+        if (rv != OGS_OK) {
+            request->failed = OGS_DBI_REQUEST_UPDATE_SQN;
+            return;
+        }
+        request->done |= OGS_DBI_REQUEST_UPDATE_SQN;
+    }
+    if (request->ops & OGS_DBI_REQUEST_INCREMENT_SQN) {
+        rv = backend.increment_sqn(request->supi);
+        if (rv != OGS_OK) {
+            request->failed = OGS_DBI_REQUEST_INCREMENT_SQN;
+            return;
+        }
+        request->done |= OGS_DBI_REQUEST_INCREMENT_SQN;
+    }
+    if (request->ops & OGS_DBI_REQUEST_SUBSCRIPTION_DATA) {
+        rv = backend.subscription_data(
+                request->supi, &request->subscription_data);
+        if (rv != OGS_OK) {
+            request->failed = OGS_DBI_REQUEST_SUBSCRIPTION_DATA;
+            return;
+        }
+        request->done |= OGS_DBI_REQUEST_SUBSCRIPTION_DATA;
+    }
+}
+
+static void worker_main(void *data)
+{
+    ogs_dbi_request_t *request = NULL;
+    int rv;
+
+    if (backend.thread_init) {
+        rv = backend.thread_init();
+        if (rv != OGS_OK)
+            ogs_error("thread_init() failed");
+    }
+
+    for ( ;; ) {
+        rv = ogs_queue_pop(request_queue, (void **)&request);
+        if (rv == OGS_DONE)
+            break;
+        if (rv != OGS_OK)
+            continue;
+
+        /* NULL is pushed once per worker by ogs_dbi_worker_final() */
+        if (!request)
+            break;
+
+        request_execute(request);
+
+        ogs_assert(request->complete);
+        request->complete(request);
+    }
+
+    if (backend.thread_final)
+        backend.thread_final();
+}
+
+int ogs_dbi_worker_init(int num, const ogs_dbi_backend_t *be)
+{
+    int i;
+
+    ogs_assert(num_of_worker == 0);
+
+    if (num <= 0)
+        return OGS_OK;
+
+    if (!be) {
+        if (ogs_mongoc_pool_init() != OGS_OK) {
+            ogs_error("ogs_mongoc_pool_init() failed");
+            return OGS_ERROR;
+        }
+        be = &mongoc_backend;
+    }
+    memcpy(&backend, be, sizeof(backend));
+    ogs_assert(backend.auth_info);
+    ogs_assert(backend.update_sqn);
+    ogs_assert(backend.increment_sqn);
+    ogs_assert(backend.subscription_data);
+
+    request_queue = ogs_queue_create(OGS_DBI_MAX_NUM_OF_REQUEST);
+    ogs_assert(request_queue);
+
+    workers = ogs_calloc(num, sizeof(ogs_thread_t *));
+    ogs_assert(workers);
+
+    for (i = 0; i < num; i++) {
+        workers[i] = ogs_thread_create(worker_main, NULL);
+        ogs_assert(workers[i]);
+    }
+    num_of_worker = num;
+
+    ogs_info("DBI worker started [num:%d]", num_of_worker);
+
+    return OGS_OK;
+}
+
+void ogs_dbi_worker_final(void)
+{
+    int i;
+
+    if (!num_of_worker)
+        return;
+
+    /* Requests already queued are executed before the workers exit */
+    for (i = 0; i < num_of_worker; i++)
+        ogs_assert(OGS_OK == ogs_queue_push(request_queue, NULL));
+
+    for (i = 0; i < num_of_worker; i++)
+        ogs_thread_destroy(workers[i]);
+
+    ogs_free(workers);
+    workers = NULL;
+
+    ogs_queue_destroy(request_queue);
+    request_queue = NULL;
+
+    if (backend.thread_init == ogs_mongoc_thread_init)
+        ogs_mongoc_pool_final();
+
+    memset(&backend, 0, sizeof(backend));
+    num_of_worker = 0;
+}
+
+bool ogs_dbi_worker_enabled(void)
+{
+    return num_of_worker > 0;
+}
+
+ogs_dbi_request_t *ogs_dbi_request_new(int ops, char *supi,
+        ogs_dbi_request_cb complete, void *data)
+{
+    ogs_dbi_request_t *request = NULL;
+
+    ogs_assert(ops);
+    ogs_assert(supi);
+    ogs_assert(complete);
+
+    request = ogs_calloc(1, sizeof(*request));
+    if (!request) {
+        ogs_error("ogs_calloc() failed");
+        return NULL;
+    }
+
+    request->ops = ops;
+    request->supi = ogs_strdup(supi);
+    ogs_assert(request->supi);
+
+    request->complete = complete;
+    request->data = data;
+
+    return request;
+}
+
+void ogs_dbi_request_free(ogs_dbi_request_t *request)
+{
+    ogs_assert(request);
+
+    ogs_subscription_data_free(&request->subscription_data);
+
+    ogs_free(request->supi);
+    ogs_free(request);
+}
+
+int ogs_dbi_request_submit(ogs_dbi_request_t *request)
+{
+    int rv;
+
+    ogs_assert(request);
+
+    if (!num_of_worker) {
+        ogs_error("No DBI worker");
+        return OGS_ERROR;
+    }
+
+    rv = ogs_queue_trypush(request_queue, request);
+    if (rv != OGS_OK) {
+        ogs_error("ogs_queue_trypush() failed [%d]", rv);
+        return rv;
+    }
+
+    return OGS_OK;
+}
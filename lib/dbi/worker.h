@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2019-2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if !defined(OGS_DBI_INSIDE) && !defined(OGS_DBI_COMPILATION)
+#error "This header cannot be included directly."
+#endif
+
+#ifndef OGS_DBI_WORKER_H
+#define OGS_DBI_WORKER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Subscriber DB access from a pool of worker threads.
+ *
+ * A request carries one or more operations, executed on a worker in
+ * the order of the OGS_DBI_REQUEST_XXX bits below. Execution stops at
+ * the first operation that fails. The complete() callback is then called
+ * on the worker thread. It is expected to post an event to the NF queue
+ * so that the result is consumed by the main loop, which frees the request.
+ */
+#define OGS_DBI_REQUEST_AUTH_INFO           0x01
+#define OGS_DBI_REQUEST_UPDATE_SQN          0x02
+#define OGS_DBI_REQUEST_INCREMENT_SQN       0x04
+#define OGS_DBI_REQUEST_SUBSCRIPTION_DATA   0x08
+
+#define OGS_DBI_MAX_NUM_OF_REQUEST 1024
+
+typedef struct ogs_dbi_request_s ogs_dbi_request_t;
+typedef void (*ogs_dbi_request_cb)(ogs_dbi_request_t *request);
+
+typedef struct ogs_dbi_request_s {
+    int ops;                /* OGS_DBI_REQUEST_XXX */
+    char *supi;
+    uint64_t sqn;           /* Input of OGS_DBI_REQUEST_UPDATE_SQN */
+
+    int done;               /* Operations completed successfully */
+    int failed;             /* Operation that failed, 0 if none */
+
+    ogs_dbi_auth_info_t auth_info;
+    ogs_subscription_data_t subscription_data;
+
+    ogs_dbi_request_cb complete;
+    void *data;
+} ogs_dbi_request_t;
+
+/*
+ * Backend used by the workers. thread_init/thread_final are called on
+ * each worker thread, e.g. to take a connection from a pool.
+ */
+typedef struct ogs_dbi_backend_s {
+    int (*thread_init)(void);
+    void (*thread_final)(void);
+
+    int (*auth_info)(char *supi, ogs_dbi_auth_info_t *auth_info);
+    int (*update_sqn)(char *supi, uint64_t sqn);
+    int (*increment_sqn)(char *supi);
+    int (*subscription_data)(char *supi,
+            ogs_subscription_data_t *subscription_data);
+} ogs_dbi_backend_t;
+
+int ogs_dbi_worker_init(int num_of_worker, const ogs_dbi_backend_t *backend);
+void ogs_dbi_worker_final(void);
+bool ogs_dbi_worker_enabled(void);
+
+ogs_dbi_request_t *ogs_dbi_request_new(int ops, char *supi,
+        ogs_dbi_request_cb complete, void *data);
+void ogs_dbi_request_free(ogs_dbi_request_t *request);
+int ogs_dbi_request_submit(ogs_dbi_request_t *request);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_DBI_WORKER_H */
@@ -158,6 +158,90 @@ int ogs_gtp_send_with_teid(
     return OGS_OK;
 }
 
+static ogs_thread_local ogs_gtp_sendbatch_t *current_sendbatch = NULL;
+
+static void sendbatch_flush(ogs_gtp_sendbatch_t *batch)
+{
+    int i, n, sent;
+
+    ogs_assert(batch);
+
+    for (i = 0; i < batch->num; i += n) {
+        /* Consecutive packets on the same socket go in one call */
+        for (n = 1; i + n < batch->num &&
+                batch->fd[i + n] == batch->fd[i]; n++);
+
+        sent = ogs_sendmmsg(batch->fd[i],
+                &batch->pkbuf[i], &batch->to[i], n, 0);
+        if (sent != n)
+            ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                    "ogs_sendmmsg() failed [%d/%d]", sent, n);
+    }
+
+    for (i = 0; i < batch->num; i++)
+        ogs_pkbuf_free(batch->pkbuf[i]);
+
+    batch->num = 0;
+}
+
+void ogs_gtp_sendbatch_begin(ogs_gtp_sendbatch_t *batch)
+{
+    ogs_assert(batch);
+    ogs_assert(current_sendbatch == NULL);
+
+    batch->num = 0;
+    current_sendbatch = batch;
+}
+
+void ogs_gtp_sendbatch_end(void)
+{
+    ogs_assert(current_sendbatch);
+
+    sendbatch_flush(current_sendbatch);
+    current_sendbatch = NULL;
+}
+
+/*
+ * Unlike ogs_gtp_send_with_teid(), the Packet Buffer(pkbuf) is
+ * always consumed.
+ */
+int ogs_gtp_sendbatch_add(
+        ogs_sock_t *sock,
+        ogs_pkbuf_t *pkbuf, uint32_t teid,
+        ogs_sockaddr_t *to)
+{
+    char buf[OGS_ADDRSTRLEN];
+    ogs_gtp_sendbatch_t *batch = current_sendbatch;
+    ogs_gtp2_header_t *gtp_h = NULL;
+    int rv;
+
+    ogs_assert(sock);
+    ogs_assert(pkbuf);
+    ogs_assert(to);
+
+    if (!batch) {
+        rv = ogs_gtp_send_with_teid(sock, pkbuf, teid, to);
+        ogs_pkbuf_free(pkbuf);
+        return rv;
+    }
+
+    gtp_h = (ogs_gtp2_header_t *)pkbuf->data;
+    ogs_assert(gtp_h);
+    gtp_h->teid = htobe32(teid);
+
+    ogs_trace("SEND GTP-U to Peer[%s] : TEID[0x%x]", OGS_ADDR(to, buf), teid);
+
+    batch->fd[batch->num] = sock->fd;
+    batch->pkbuf[batch->num] = pkbuf;
+    memcpy(&batch->to[batch->num], to, sizeof *to);
+    batch->num++;
+
+    if (batch->num == OGS_MAX_NUM_OF_MMSG)
+        sendbatch_flush(batch);
+
+    return OGS_OK;
+}
+
 void ogs_gtp_send_error_message(
         ogs_gtp_xact_t *xact, uint32_t teid, uint8_t type, uint8_t cause_value)
 {
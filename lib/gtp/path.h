@@ -74,6 +74,28 @@ int ogs_gtp_send_with_teid(
         ogs_pkbuf_t *pkbuf, uint32_t teid,
         ogs_sockaddr_t *to);
 
+/*
+ * G-PDU transmit batching
+ *
+ * Between ogs_gtp_sendbatch_begin() and ogs_gtp_sendbatch_end(),
+ * packets passed to ogs_gtp_sendbatch_add() on the calling thread are
+ * queued and sent with ogs_sendmmsg(). Outside a batch, they are sent
+ * immediately.
+ */
+typedef struct ogs_gtp_sendbatch_s {
+    int num;
+    ogs_socket_t fd[OGS_MAX_NUM_OF_MMSG];
+    ogs_pkbuf_t *pkbuf[OGS_MAX_NUM_OF_MMSG];
+    ogs_sockaddr_t to[OGS_MAX_NUM_OF_MMSG];
+} ogs_gtp_sendbatch_t;
+
+void ogs_gtp_sendbatch_begin(ogs_gtp_sendbatch_t *batch);
+void ogs_gtp_sendbatch_end(void);
+int ogs_gtp_sendbatch_add(
+        ogs_sock_t *sock,
+        ogs_pkbuf_t *pkbuf, uint32_t teid,
+        ogs_sockaddr_t *to);
+
 void ogs_gtp_send_error_message(
         ogs_gtp_xact_t *xact, uint32_t teid, uint8_t type, uint8_t cause_value);
 
@@ -26,6 +26,30 @@
 
 #define MAX_LABELS 8
 
+/*
+ * Counter and gauge updates do not go through prom_counter_add() and
+ * prom_gauge_add(), which look up the label set and take a mutex on
+ * every call. Each instance instead owns one slot per thread, padded to
+ * a cache line, that is updated with a relaxed atomic add. The slots are
+ * folded into the Prometheus registry when /metrics is scraped.
+ *
+ * Threads are assigned a slot in order of their first update. If there
+ * are more threads than slots, the slots are shared, which is still
+ * correct but no longer free of contention.
+ */
+#define MAX_SHARDS 16
+#define CACHE_LINE_SIZE 64
+
+typedef union ogs_metrics_shard_s {
+    int64_t value;
+    uint8_t pad[CACHE_LINE_SIZE];
+} ogs_metrics_shard_t;
+
+static ogs_thread_local int shard_index = -1;
+static int num_of_shard_index = 0;
+
+static ogs_thread_mutex_t inst_mutex;
+
 typedef struct ogs_metrics_server_s {
     ogs_socknode_t node;
     struct MHD_Daemon *mhd;
@@ -49,6 +73,9 @@ typedef struct ogs_metrics_inst_s {
     ogs_list_t              entry; /* included in ogs_metrics_spec_t spec */
     unsigned int            num_labels;
     char                    *label_values[MAX_LABELS];
+
+    ogs_metrics_shard_t     *shard; /* MAX_SHARDS, counter and gauge only */
+    int64_t                 folded; /* Sum of shards already in registry */
 } ogs_metrics_inst_t;
 
 static OGS_POOL(metrics_spec_pool, ogs_metrics_spec_t);
@@ -57,6 +84,9 @@ static OGS_POOL(metrics_server_pool, ogs_metrics_server_t);
 static int ogs_metrics_context_server_start(ogs_metrics_server_t *server);
 static int ogs_metrics_context_server_stop(ogs_metrics_server_t *server);
 
+static void ogs_metrics_inst_fold(ogs_metrics_inst_t *inst);
+static void ogs_metrics_spec_fold_all(ogs_metrics_context_t *ctx);
+
 void ogs_metrics_server_init(ogs_metrics_context_t *ctx)
 {
     ogs_list_init(&ctx->server_list);
@@ -207,6 +237,7 @@ static _MHD_Result mhd_server_access_handler(void *cls, struct MHD_Connection *c
         return ret;
     }
     if (strcmp(url, "/metrics") == 0) {
+        ogs_metrics_spec_fold_all(ogs_metrics_self());
         buf = prom_collector_registry_bridge(PROM_COLLECTOR_REGISTRY_DEFAULT);
         rsp = MHD_create_response_from_buffer(strlen(buf), (void *)buf, MHD_RESPMEM_MUST_FREE);
         MHD_add_response_header(rsp, "Content-Type", "text/plain; version=0.0.4; charset=utf-8");
@@ -321,6 +352,7 @@ void ogs_metrics_spec_init(ogs_metrics_context_t *ctx)
 {
     ogs_list_init(&ctx->spec_list);
     ogs_pool_init(&metrics_spec_pool, ogs_app()->metrics.max_specs);
+    ogs_thread_mutex_init(&inst_mutex);
 
     prom_collector_registry_default_init();
 }
@@ -334,9 +366,25 @@ void ogs_metrics_spec_final(ogs_metrics_context_t *ctx)
     }
     prom_collector_registry_destroy(PROM_COLLECTOR_REGISTRY_DEFAULT);
 
+    ogs_thread_mutex_destroy(&inst_mutex);
     ogs_pool_final(&metrics_spec_pool);
 }
 
+static void ogs_metrics_spec_fold_all(ogs_metrics_context_t *ctx)
+{
+    ogs_metrics_spec_t *spec = NULL;
+    ogs_metrics_inst_t *inst = NULL;
+
+    ogs_assert(ctx);
+
+    ogs_thread_mutex_lock(&inst_mutex);
+    ogs_list_for_each_entry(&ctx->spec_list, spec, entry) {
+        ogs_list_for_each_entry(&spec->inst_list, inst, entry)
+            ogs_metrics_inst_fold(inst);
+    }
+    ogs_thread_mutex_unlock(&inst_mutex);
+}
+
 ogs_metrics_spec_t *ogs_metrics_spec_new(
         ogs_metrics_context_t *ctx, ogs_metrics_metric_type_t type,
         const char *name, const char *description,
@@ -463,8 +511,17 @@ ogs_metrics_inst_t *ogs_metrics_inst_new(
         ogs_assert(label_values[i]);
         inst->label_values[i] = ogs_strdup(label_values[i]);
     }
-    ogs_list_add(&spec->inst_list, &inst->entry);
+    if (spec->type == OGS_METRICS_METRIC_TYPE_COUNTER ||
+        spec->type == OGS_METRICS_METRIC_TYPE_GAUGE) {
+        inst->shard = ogs_calloc(MAX_SHARDS, sizeof(ogs_metrics_shard_t));
+        ogs_assert(inst->shard);
+    }
     ogs_metrics_inst_reset(inst);
+
+    ogs_thread_mutex_lock(&inst_mutex);
+    ogs_list_add(&spec->inst_list, &inst->entry);
+    ogs_thread_mutex_unlock(&inst_mutex);
+
     return inst;
 }
 
@@ -472,7 +529,14 @@ void ogs_metrics_inst_free(ogs_metrics_inst_t *inst)
 {
     unsigned int i;
 
+    ogs_thread_mutex_lock(&inst_mutex);
     ogs_list_remove(&inst->spec->inst_list, &inst->entry);
+    if (inst->shard)
+        ogs_metrics_inst_fold(inst);
+    ogs_thread_mutex_unlock(&inst_mutex);
+
+    if (inst->shard)
+        ogs_free(inst->shard);
 
     for (i = 0; i < inst->num_labels; i++)
         ogs_free(inst->label_values[i]);
@@ -480,11 +544,67 @@ void ogs_metrics_inst_free(ogs_metrics_inst_t *inst)
     ogs_free(inst);
 }
 
+static int64_t ogs_metrics_inst_sum(ogs_metrics_inst_t *inst)
+{
+    int64_t sum = 0;
+    int i;
+
+    for (i = 0; i < MAX_SHARDS; i++)
+        sum += __atomic_load_n(&inst->shard[i].value, __ATOMIC_RELAXED);
+
+    return sum;
+}
+
+/* Move updates made since the last fold into the Prometheus registry */
+static void ogs_metrics_inst_fold(ogs_metrics_inst_t *inst)
+{
+    int64_t sum, delta;
+
+    ogs_assert(inst);
+    if (!inst->shard)
+        return;
+
+    sum = ogs_metrics_inst_sum(inst);
+    delta = sum - inst->folded;
+    inst->folded = sum;
+
+    if (delta == 0)
+        return;
+
+    switch (inst->spec->type) {
+    case OGS_METRICS_METRIC_TYPE_COUNTER:
+        prom_counter_add(inst->spec->prom, (double)delta, (const char **)inst->label_values);
+        break;
+    case OGS_METRICS_METRIC_TYPE_GAUGE:
+        if (delta >= 0)
+            prom_gauge_add(inst->spec->prom, (double)delta, (const char **)inst->label_values);
+        else
+            prom_gauge_sub(inst->spec->prom, (double)-1.0*(double)delta, (const char **)inst->label_values);
+        break;
+    default:
+        ogs_assert_if_reached();
+        break;
+    }
+}
+
+static ogs_metrics_shard_t *ogs_metrics_inst_shard(ogs_metrics_inst_t *inst)
+{
+    if (ogs_unlikely(shard_index < 0))
+        shard_index = __atomic_fetch_add(
+                &num_of_shard_index, 1, __ATOMIC_RELAXED) % MAX_SHARDS;
+
+    return &inst->shard[shard_index];
+}
+
 void ogs_metrics_inst_set(ogs_metrics_inst_t *inst, int val)
 {
     switch (inst->spec->type) {
     case OGS_METRICS_METRIC_TYPE_GAUGE:
+        /* Updates not yet folded are overridden by the new value */
+        ogs_thread_mutex_lock(&inst_mutex);
+        inst->folded = ogs_metrics_inst_sum(inst);
         prom_gauge_set(inst->spec->prom, (double)val, (const char **)inst->label_values);
+        ogs_thread_mutex_unlock(&inst_mutex);
         break;
     default:
         ogs_assert_if_reached();
@@ -499,7 +619,10 @@ void ogs_metrics_inst_reset(ogs_metrics_inst_t *inst)
         prom_counter_add(inst->spec->prom, 0.0, (const char **)inst->label_values);
         break;
     case OGS_METRICS_METRIC_TYPE_GAUGE:
+        ogs_thread_mutex_lock(&inst_mutex);
+        inst->folded = ogs_metrics_inst_sum(inst);
         prom_gauge_set(inst->spec->prom, (double)inst->spec->initial_val, (const char **)inst->label_values);
+        ogs_thread_mutex_unlock(&inst_mutex);
         break;
     default:
         /* Other types have no way to reset */
@@ -512,13 +635,12 @@ void ogs_metrics_inst_add(ogs_metrics_inst_t *inst, int val)
     switch (inst->spec->type) {
     case OGS_METRICS_METRIC_TYPE_COUNTER:
         ogs_assert(val >= 0);
-        prom_counter_add(inst->spec->prom, (double)val, (const char **)inst->label_values);
+        __atomic_fetch_add(&ogs_metrics_inst_shard(inst)->value,
+                val, __ATOMIC_RELAXED);
         break;
     case OGS_METRICS_METRIC_TYPE_GAUGE:
-        if (val >= 0)
-            prom_gauge_add(inst->spec->prom, (double)val, (const char **)inst->label_values);
-        else
-            prom_gauge_sub(inst->spec->prom, (double)-1.0*(double)val, (const char **)inst->label_values);
+        __atomic_fetch_add(&ogs_metrics_inst_shard(inst)->value,
+                val, __ATOMIC_RELAXED);
         break;
     case OGS_METRICS_METRIC_TYPE_HISTOGRAM:
         ogs_assert(val >= 0);
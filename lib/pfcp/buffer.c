@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "app/ogs-app.h"
+#include "ogs-pfcp.h"
+
+static OGS_POOL(ogs_pfcp_buffered_gtpu_pool, ogs_pfcp_buffered_gtpu_t);
+static OGS_POOL(ogs_pfcp_buffer_cluster_pool, ogs_pfcp_buffer_cluster_t);
+
+static ogs_pfcp_buffer_stat_t buffer_stat;
+static int buffer_initialized = 0;
+
+void ogs_pfcp_buffer_init(void)
+{
+    ogs_assert(buffer_initialized == 0);
+
+    ogs_pool_init(&ogs_pfcp_buffered_gtpu_pool, ogs_app()->pool.gtpu);
+    ogs_pool_init(&ogs_pfcp_buffer_cluster_pool,
+            ogs_app()->pool.gtpu * OGS_PFCP_BUFFER_CLUSTER_PER_PACKET);
+
+    memset(&buffer_stat, 0, sizeof(buffer_stat));
+
+    buffer_initialized = 1;
+}
+
+void ogs_pfcp_buffer_final(void)
+{
+    ogs_assert(buffer_initialized == 1);
+
+    ogs_info("GTP-U buffering: buffered[%llu] flushed[%llu] discarded[%llu] "
+            "dropped by quota[%llu] dropped by memory[%llu]",
+            (unsigned long long)buffer_stat.buffered,
+            (unsigned long long)buffer_stat.flushed,
+            (unsigned long long)buffer_stat.discarded,
+            (unsigned long long)buffer_stat.dropped_by_quota,
+            (unsigned long long)buffer_stat.dropped_by_memory);
+
+    ogs_pool_final(&ogs_pfcp_buffered_gtpu_pool);
+    ogs_pool_final(&ogs_pfcp_buffer_cluster_pool);
+
+    buffer_initialized = 0;
+}
+
+static uint32_t session_quota(ogs_pfcp_sess_t *sess)
+{
+    ogs_assert(sess);
+
+    if (sess->bar && sess->bar->suggested_buffering_packets_count)
+        return sess->bar->suggested_buffering_packets_count;
+
+    return OGS_MAX_NUM_OF_GTPU_BUFFER;
+}
+
+static void buffered_gtpu_free(ogs_pfcp_far_t *far,
+        ogs_pfcp_buffered_gtpu_t *packet)
+{
+    ogs_pfcp_buffer_cluster_t *cluster = NULL, *next = NULL;
+
+    ogs_assert(far);
+    ogs_assert(far->sess);
+    ogs_assert(packet);
+
+    ogs_list_remove(&far->buffered_list, packet);
+    far->num_of_buffered_gtpu--;
+    far->sess->num_of_buffered_gtpu--;
+
+    for (cluster = packet->cluster; cluster; cluster = next) {
+        next = cluster->next;
+        ogs_pool_free(&ogs_pfcp_buffer_cluster_pool, cluster);
+    }
+
+    ogs_pool_free(&ogs_pfcp_buffered_gtpu_pool, packet);
+}
+
+bool ogs_pfcp_buffer_push(ogs_pfcp_far_t *far, ogs_pkbuf_t *pkbuf)
+{
+    ogs_pfcp_sess_t *sess = NULL;
+    ogs_pfcp_buffered_gtpu_t *packet = NULL;
+    ogs_pfcp_buffer_cluster_t **last = NULL;
+    int num_of_cluster, i;
+    uint8_t *data = NULL;
+    uint16_t len;
+
+    ogs_assert(buffer_initialized == 1);
+    ogs_assert(far);
+    sess = far->sess;
+    ogs_assert(sess);
+    ogs_assert(pkbuf);
+
+    if (sess->num_of_buffered_gtpu >= session_quota(sess)) {
+        buffer_stat.dropped_by_quota++;
+        ogs_pkbuf_free(pkbuf);
+        return false;
+    }
+
+    num_of_cluster = (pkbuf->len + OGS_PFCP_BUFFER_CLUSTER_SIZE - 1) /
+                        OGS_PFCP_BUFFER_CLUSTER_SIZE;
+    if (!num_of_cluster ||
+        ogs_pool_avail(&ogs_pfcp_buffered_gtpu_pool) == 0 ||
+        ogs_pool_avail(&ogs_pfcp_buffer_cluster_pool) < num_of_cluster) {
+        buffer_stat.dropped_by_memory++;
+        ogs_pkbuf_free(pkbuf);
+        return false;
+    }
+
+    ogs_pool_alloc(&ogs_pfcp_buffered_gtpu_pool, &packet);
+    ogs_assert(packet);
+    memset(packet, 0, sizeof(*packet));
+
+    packet->len = pkbuf->len;
+
+    data = pkbuf->data;
+    len = pkbuf->len;
+    last = &packet->cluster;
+    for (i = 0; i < num_of_cluster; i++) {
+        ogs_pfcp_buffer_cluster_t *cluster = NULL;
+        uint16_t size = ogs_min(len, OGS_PFCP_BUFFER_CLUSTER_SIZE);
+
+        ogs_pool_alloc(&ogs_pfcp_buffer_cluster_pool, &cluster);
+        ogs_assert(cluster);
+
+        memcpy(cluster->data, data, size);
+        cluster->next = NULL;
+        data += size;
+        len -= size;
+
+        *last = cluster;
+        last = &cluster->next;
+    }
+
+    ogs_pkbuf_free(pkbuf);
+
+    ogs_list_add(&far->buffered_list, packet);
+    far->num_of_buffered_gtpu++;
+    sess->num_of_buffered_gtpu++;
+
+    buffer_stat.buffered++;
+
+    return true;
+}
+
+ogs_pkbuf_t *ogs_pfcp_buffer_pop(ogs_pfcp_far_t *far)
+{
+    ogs_pfcp_buffered_gtpu_t *packet = NULL;
+    ogs_pfcp_buffer_cluster_t *cluster = NULL;
+    ogs_pkbuf_t *pkbuf = NULL;
+    uint16_t len;
+
+    ogs_assert(far);
+
+    packet = ogs_list_first(&far->buffered_list);
+    if (!packet)
+        return NULL;
+
+    pkbuf = ogs_pkbuf_alloc(NULL, packet->len);
+    if (!pkbuf) {
+        ogs_error("ogs_pkbuf_alloc() failed [len:%d]", packet->len);
+        buffer_stat.discarded++;
+        buffered_gtpu_free(far, packet);
+        return NULL;
+    }
+
+    len = packet->len;
+    for (cluster = packet->cluster; cluster; cluster = cluster->next) {
+        uint16_t size = ogs_min(len, OGS_PFCP_BUFFER_CLUSTER_SIZE);
+
+        ogs_pkbuf_put_data(pkbuf, cluster->data, size);
+        len -= size;
+    }
+    ogs_assert(len == 0);
+
+    buffer_stat.flushed++;
+    buffered_gtpu_free(far, packet);
+
+    return pkbuf;
+}
+
+void ogs_pfcp_buffer_discard(ogs_pfcp_far_t *far)
+{
+    ogs_pfcp_buffered_gtpu_t *packet = NULL, *next_packet = NULL;
+
+    ogs_assert(far);
+
+    ogs_list_for_each_safe(&far->buffered_list, next_packet, packet) {
+        buffer_stat.discarded++;
+        buffered_gtpu_free(far, packet);
+    }
+}
+
+const ogs_pfcp_buffer_stat_t *ogs_pfcp_buffer_stat(void)
+{
+    return &buffer_stat;
+}
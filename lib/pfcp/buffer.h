@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if !defined(OGS_PFCP_INSIDE) && !defined(OGS_PFCP_COMPILATION)
+#error "This header cannot be included directly."
+#endif
+
+#ifndef OGS_PFCP_BUFFER_H
+#define OGS_PFCP_BUFFER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Downlink packets held while the UE is idle are copied out of their
+ * pkbuf into fixed-size clusters taken from one pool shared by every
+ * session. The pool bounds the memory used for buffering, and each
+ * session is limited to the Suggested Buffering Packets Count of its BAR.
+ */
+#define OGS_PFCP_BUFFER_CLUSTER_SIZE    256
+/* Budget of clusters per packet: 512 bytes on average */
+#define OGS_PFCP_BUFFER_CLUSTER_PER_PACKET 2
+
+typedef struct ogs_pfcp_buffer_cluster_s {
+    struct ogs_pfcp_buffer_cluster_s *next;
+    uint8_t data[OGS_PFCP_BUFFER_CLUSTER_SIZE];
+} ogs_pfcp_buffer_cluster_t;
+
+typedef struct ogs_pfcp_buffered_gtpu_s {
+    ogs_lnode_t lnode;
+
+    uint16_t len;
+    ogs_pfcp_buffer_cluster_t *cluster;
+} ogs_pfcp_buffered_gtpu_t;
+
+typedef struct ogs_pfcp_buffer_stat_s {
+    uint64_t buffered;
+    uint64_t flushed;
+    uint64_t discarded;         /* Freed with the FAR, never sent */
+    uint64_t dropped_by_quota;  /* Session reached its packet count */
+    uint64_t dropped_by_memory; /* No packet or cluster left in the pool */
+} ogs_pfcp_buffer_stat_t;
+
+void ogs_pfcp_buffer_init(void);
+void ogs_pfcp_buffer_final(void);
+
+/* Always consumes pkbuf. Returns false if the packet was dropped */
+bool ogs_pfcp_buffer_push(ogs_pfcp_far_t *far, ogs_pkbuf_t *pkbuf);
+/* Returns the oldest packet in a right-sized pkbuf, NULL if none */
+ogs_pkbuf_t *ogs_pfcp_buffer_pop(ogs_pfcp_far_t *far);
+void ogs_pfcp_buffer_discard(ogs_pfcp_far_t *far);
+
+const ogs_pfcp_buffer_stat_t *ogs_pfcp_buffer_stat(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_PFCP_BUFFER_H */
@@ -1133,6 +1133,28 @@ void ogs_pfcp_node_remove_all(ogs_list_t *list)
         ogs_pfcp_node_remove(list, node);
 }
 
+/*
+ * Share of new sessions for an associated UPF: the capacity left by
+ * its reported load, cut further while an overload reduction is valid.
+ * A saturated UPF keeps a minimal weight so that sessions are still
+ * placed when every candidate is saturated.
+ */
+int ogs_pfcp_node_weight(ogs_pfcp_node_t *node)
+{
+    int weight;
+
+    ogs_assert(node);
+
+    weight = 100 - node->load.metric;
+
+    if (node->overload.reduction_metric &&
+        (node->overload.expires == 0 ||
+         ogs_get_monotonic_time() < node->overload.expires))
+        weight = weight * (100 - node->overload.reduction_metric) / 100;
+
+    return ogs_max(weight, 1);
+}
+
 /******************************************************************************
  * Compare two node IDs for equality. Returns true if they match, else false.
  ******************************************************************************/
@@ -1322,6 +1344,7 @@ ogs_pfcp_pdr_t *ogs_pfcp_pdr_add(ogs_pfcp_sess_t *sess)
 
     pdr->sess = sess;
     ogs_list_add(&sess->pdr_list, pdr);
+    ogs_pfcp_classifier_clear(sess);
 
     return pdr;
 }
@@ -1527,6 +1550,7 @@ void ogs_pfcp_pdr_reorder_by_precedence(
 
     pdr->precedence = precedence;
     ogs_list_insert_sorted(&sess->pdr_list, pdr, precedence_compare);
+    ogs_pfcp_classifier_clear(sess);
 }
 
 void ogs_pfcp_pdr_associate_far(ogs_pfcp_pdr_t *pdr, ogs_pfcp_far_t *far)
@@ -1567,6 +1591,7 @@ void ogs_pfcp_pdr_remove(ogs_pfcp_pdr_t *pdr)
     ogs_assert(pdr->sess);
 
     ogs_list_remove(&pdr->sess->pdr_list, pdr);
+    ogs_pfcp_classifier_clear(pdr->sess);
 
     ogs_pfcp_rule_remove_all(pdr);
 
@@ -1864,7 +1889,6 @@ ogs_pfcp_far_t *ogs_pfcp_far_find_by_teid(uint32_t teid)
 
 void ogs_pfcp_far_remove(ogs_pfcp_far_t *far)
 {
-    int i;
     ogs_pfcp_sess_t *sess = NULL;
 
     ogs_assert(far);
@@ -1884,8 +1908,7 @@ void ogs_pfcp_far_remove(ogs_pfcp_far_t *far)
     if (far->dnn)
         ogs_free(far->dnn);
 
-    for (i = 0; i < far->num_of_buffered_gtpu; i++)
-        ogs_pkbuf_free(far->buffered_gtpu[i]);
+    ogs_pfcp_buffer_discard(far);
 
     if (far->id_node)
         ogs_pool_free(&far->sess->far_id_pool, far->id_node);
@@ -2125,6 +2148,7 @@ ogs_pfcp_rule_t *ogs_pfcp_rule_add(ogs_pfcp_pdr_t *pdr)
 
     rule->pdr = pdr;
     ogs_list_add(&pdr->rule_list, rule);
+    ogs_pfcp_classifier_clear(pdr->sess);
 
     return rule;
 }
@@ -2156,6 +2180,7 @@ void ogs_pfcp_rule_remove(ogs_pfcp_rule_t *rule)
     ogs_assert(pdr);
 
     ogs_list_remove(&pdr->rule_list, rule);
+    ogs_pfcp_classifier_clear(pdr->sess);
     ogs_pool_free(&ogs_pfcp_rule_pool, rule);
 }
 
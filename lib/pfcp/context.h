@@ -122,6 +122,18 @@ typedef struct ogs_pfcp_node_s {
 
     ogs_pfcp_up_function_features_t up_function_features;
     int up_function_features_len;
+
+    /* Load/Overload Control Information reported by the UP function */
+    struct {
+        uint32_t    sequence_number;
+        uint8_t     metric;             /* 0 ~ 100 */
+    } load;
+    struct {
+        uint32_t    sequence_number;
+        uint8_t     reduction_metric;   /* 0 ~ 100 */
+        ogs_time_t  expires;            /* 0 : Until superseded */
+    } overload;
+    int             current_weight;     /* Weighted round-robin */
 } ogs_pfcp_node_t;
 
 typedef enum {
@@ -260,8 +272,9 @@ typedef struct ogs_pfcp_far_s {
 
     ogs_pfcp_smreq_flags_t  smreq_flags;
 
+    ogs_list_t              buffered_list;  /* ogs_pfcp_buffered_gtpu_t */
     uint32_t                num_of_buffered_gtpu;
-    ogs_pkbuf_t             *buffered_gtpu[OGS_MAX_NUM_OF_GTPU_BUFFER];
+    bool                    downlink_data_reported; /* Until FAR updated */
 
     struct {
         bool prepared;
@@ -322,9 +335,12 @@ typedef struct ogs_pfcp_bar_s {
     uint8_t                 *id_node;      /* Pool-Node for ID */
     ogs_pfcp_bar_id_t       id;
 
+    uint8_t                 suggested_buffering_packets_count;
+
     ogs_pfcp_sess_t         *sess;
 } ogs_pfcp_bar_t;
 
+typedef struct ogs_pfcp_classifier_s ogs_pfcp_classifier_t;
 typedef struct ogs_pfcp_sess_s {
     ogs_pfcp_object_t   obj;
 
@@ -334,11 +350,15 @@ typedef struct ogs_pfcp_sess_s {
     ogs_list_t          qer_list;       /* QER List */
     ogs_pfcp_bar_t      *bar;           /* BAR Item */
 
+    uint32_t            num_of_buffered_gtpu; /* Sum over all FARs */
+
     OGS_POOL(pdr_id_pool, uint8_t);
     OGS_POOL(far_id_pool, uint8_t);
     OGS_POOL(urr_id_pool, uint8_t);
     OGS_POOL(qer_id_pool, uint8_t);
     OGS_POOL(bar_id_pool, uint8_t);
+
+    ogs_pfcp_classifier_t *classifier; /* Compiled SDF Filters */
 } ogs_pfcp_sess_t;
 
 typedef struct ogs_pfcp_subnet_s ogs_pfcp_subnet_t;
@@ -420,6 +440,7 @@ int ogs_pfcp_node_merge(ogs_pfcp_node_t *node,
     ogs_pfcp_node_id_t *node_id, ogs_sockaddr_t *from);
 void ogs_pfcp_node_remove(ogs_list_t *list, ogs_pfcp_node_t *node);
 void ogs_pfcp_node_remove_all(ogs_list_t *list);
+int ogs_pfcp_node_weight(ogs_pfcp_node_t *node);
 bool ogs_pfcp_node_id_compare(
         const ogs_pfcp_node_id_t *id1, const ogs_pfcp_node_id_t *id2);
 
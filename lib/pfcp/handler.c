@@ -105,6 +105,10 @@ bool ogs_pfcp_cp_handle_association_setup_request(
 
     ogs_gtpu_resource_remove_all(&node->gtpu_resource_list);
 
+    /* Sequence numbers start over with a new association */
+    memset(&node->load, 0, sizeof(node->load));
+    memset(&node->overload, 0, sizeof(node->overload));
+
     for (i = 0; i < OGS_MAX_NUM_OF_GTPU_RESOURCE; i++) {
         ogs_pfcp_tlv_user_plane_ip_resource_information_t *message =
             &req->user_plane_ip_resource_information[i];
@@ -152,6 +156,10 @@ bool ogs_pfcp_cp_handle_association_setup_response(
 
     ogs_gtpu_resource_remove_all(&node->gtpu_resource_list);
 
+    /* Sequence numbers start over with a new association */
+    memset(&node->load, 0, sizeof(node->load));
+    memset(&node->overload, 0, sizeof(node->overload));
+
     for (i = 0; i < OGS_MAX_NUM_OF_GTPU_RESOURCE; i++) {
         ogs_pfcp_tlv_user_plane_ip_resource_information_t *message =
             &rsp->user_plane_ip_resource_information[i];
@@ -184,6 +192,103 @@ bool ogs_pfcp_cp_handle_association_setup_response(
     return true;
 }
 
+static bool sequence_number_is_newer(
+        ogs_tlv_octet_t *octet, uint32_t current, uint32_t *sequence_number)
+{
+    ogs_assert(octet);
+    ogs_assert(sequence_number);
+
+    if (!octet->presence || octet->len != sizeof(*sequence_number)) {
+        ogs_error("Invalid Sequence Number");
+        return false;
+    }
+
+    memcpy(sequence_number, octet->data, sizeof(*sequence_number));
+    *sequence_number = be32toh(*sequence_number);
+
+    /*
+     * TS29.244 Ch 6.2.3.3.2 and 6.2.4.3.2
+     *
+     * The CP function shall only consider the information
+     * whose sequence number is higher than the one already received.
+     */
+    if (current && (int32_t)(*sequence_number - current) <= 0)
+        return false;
+
+    return true;
+}
+
+void ogs_pfcp_cp_handle_load_control_information(ogs_pfcp_node_t *node,
+        ogs_pfcp_tlv_load_control_information_t *message)
+{
+    uint32_t sequence_number;
+
+    ogs_assert(node);
+    ogs_assert(message);
+
+    if (message->presence == 0)
+        return;
+
+    if (!message->load_metric.presence || message->load_metric.len != 1) {
+        ogs_error("Invalid Load Metric");
+        return;
+    }
+
+    if (sequence_number_is_newer(&message->load_control_sequence_number,
+                node->load.sequence_number, &sequence_number) == false)
+        return;
+
+    node->load.sequence_number = sequence_number;
+    node->load.metric = ogs_min(*(uint8_t *)message->load_metric.data, 100);
+
+    ogs_debug("[%s] Load Metric [%d] Sequence Number [%u]",
+            ogs_sockaddr_to_string_static(node->addr_list),
+            node->load.metric, node->load.sequence_number);
+}
+
+void ogs_pfcp_cp_handle_overload_control_information(ogs_pfcp_node_t *node,
+        ogs_pfcp_tlv_overload_control_information_t *message)
+{
+    uint32_t sequence_number;
+    ogs_time_t validity;
+
+    ogs_assert(node);
+    ogs_assert(message);
+
+    if (message->presence == 0)
+        return;
+
+    if (!message->overload_reduction_metric.presence ||
+        message->overload_reduction_metric.len != 1) {
+        ogs_error("Invalid Overload Reduction Metric");
+        return;
+    }
+    if (!message->period_of_validity.presence ||
+        message->period_of_validity.len != 1) {
+        ogs_error("Invalid Period of Validity");
+        return;
+    }
+
+    if (sequence_number_is_newer(&message->overload_control_sequence_number,
+                node->overload.sequence_number, &sequence_number) == false)
+        return;
+
+    node->overload.sequence_number = sequence_number;
+    node->overload.reduction_metric = ogs_min(
+            *(uint8_t *)message->overload_reduction_metric.data, 100);
+
+    validity = ogs_pfcp_decode_timer(
+            *(uint8_t *)message->period_of_validity.data);
+    if (validity == OGS_INFINITE_TIME)
+        node->overload.expires = 0;
+    else
+        node->overload.expires = ogs_get_monotonic_time() + validity;
+
+    ogs_debug("[%s] Overload Reduction Metric [%d] Sequence Number [%u]",
+            ogs_sockaddr_to_string_static(node->addr_list),
+            node->overload.reduction_metric, node->overload.sequence_number);
+}
+
 bool ogs_pfcp_up_handle_association_setup_request(
         ogs_pfcp_node_t *node, ogs_pfcp_xact_t *xact,
         ogs_pfcp_association_setup_request_t *req)
@@ -349,17 +454,14 @@ bool ogs_pfcp_up_handle_pdr(
 
     if (buffering == true) {
 
-        if (far->num_of_buffered_gtpu == 0) {
+        if (far->downlink_data_reported == false) {
             /* Only the first time a packet is buffered,
              * it reports downlink notifications. */
             report->type.downlink_data_report = 1;
+            far->downlink_data_reported = true;
         }
 
-        if (far->num_of_buffered_gtpu < OGS_MAX_NUM_OF_GTPU_BUFFER) {
-            far->buffered_gtpu[far->num_of_buffered_gtpu++] = sendbuf;
-        } else {
-            ogs_pkbuf_free(sendbuf);
-        }
+        ogs_pfcp_buffer_push(far, sendbuf);
     }
 
     return true;
@@ -1150,8 +1252,11 @@ ogs_pfcp_far_t *ogs_pfcp_handle_update_far(ogs_pfcp_sess_t *sess,
         return NULL;
     }
 
-    if (message->apply_action.presence)
+    if (message->apply_action.presence) {
         far->apply_action = message->apply_action.u16;
+        /* The next buffered packet is reported again */
+        far->downlink_data_reported = false;
+    }
 
     if (message->update_forwarding_parameters.presence) {
         if (message->update_forwarding_parameters.
@@ -1377,6 +1482,11 @@ ogs_pfcp_bar_t *ogs_pfcp_handle_create_bar(ogs_pfcp_sess_t *sess,
 
     sess->bar->id = message->bar_id.u8;
 
+    if (message->suggested_buffering_packets_count.presence &&
+        message->suggested_buffering_packets_count.len == 1)
+        sess->bar->suggested_buffering_packets_count =
+            *(uint8_t *)message->suggested_buffering_packets_count.data;
+
     return sess->bar;
 }
 
@@ -428,28 +428,24 @@ void ogs_pfcp_send_gtpu(ogs_pfcp_pdr_t *pdr, ogs_pkbuf_t *sendbuf)
         return;
     }
 
-    ogs_gtp_send_with_teid(
+    ogs_gtp_sendbatch_add(
             gnode->sock,
             sendbuf, far->outer_header_creation.teid,
             &gnode->addr);
-
-    ogs_pkbuf_free(sendbuf);
 }
 
 void ogs_pfcp_send_buffered_gtpu(ogs_pfcp_pdr_t *pdr)
 {
     ogs_pfcp_far_t *far = NULL;
-    int i;
+    ogs_pkbuf_t *sendbuf = NULL;
 
     ogs_assert(pdr);
     far = pdr->far;
 
     if (far && far->gnode) {
         if (far->apply_action & OGS_PFCP_APPLY_ACTION_FORW) {
-            for (i = 0; i < far->num_of_buffered_gtpu; i++) {
-                ogs_pfcp_send_gtpu(pdr, far->buffered_gtpu[i]);
-            }
-            far->num_of_buffered_gtpu = 0;
+            while ((sendbuf = ogs_pfcp_buffer_pop(far)))
+                ogs_pfcp_send_gtpu(pdr, sendbuf);
         }
     }
 }
@@ -109,65 +109,110 @@ static int decode_ipv6_header(
     return OGS_OK;
 }
 
-ogs_pfcp_rule_t *ogs_pfcp_pdr_rule_find_by_packet(
-                    ogs_pfcp_pdr_t *pdr, ogs_pkbuf_t *pkbuf)
+int ogs_pfcp_packet_key_parse(ogs_pfcp_packet_key_t *key, ogs_pkbuf_t *pkbuf)
 {
     struct ip *ip_h =  NULL;
     struct ip6_hdr *ip6_h = NULL;
-    uint32_t *src_addr = NULL;
-    uint32_t *dst_addr = NULL;
-    int addr_len = 0;
-    uint8_t proto = 0;
     uint16_t ip_hlen = 0;
 
-    ogs_pfcp_rule_t *rule = NULL;
-
+    ogs_assert(key);
     ogs_assert(pkbuf);
     ogs_assert(pkbuf->len);
     ogs_assert(pkbuf->data);
 
-    ogs_list_for_each(&pdr->rule_list, rule) {
-        int k;
-        uint32_t src_mask[4];
-        uint32_t dst_mask[4];
-        ogs_ipfw_rule_t *ipfw = NULL;
-
-        ipfw = &rule->ipfw;
-        ogs_assert(ipfw);
-
-        ip_h = (struct ip *)pkbuf->data;
-        if (ip_h->ip_v == 4) {
-            ip_h = (struct ip *)pkbuf->data;
-            ip6_h = NULL;
-
-            proto = ip_h->ip_p;
-            ip_hlen = (ip_h->ip_hl)*4;
-
-            src_addr = (void *)&ip_h->ip_src.s_addr;
-            dst_addr = (void *)&ip_h->ip_dst.s_addr;
-            addr_len = OGS_IPV4_LEN;
-        } else if (ip_h->ip_v == 6) {
-            ip_h = NULL;
-            ip6_h = (struct ip6_hdr *)pkbuf->data;
-
-            decode_ipv6_header(ip6_h, &proto, &ip_hlen);
-
-            src_addr = (void *)ip6_h->ip6_src.s6_addr;
-            dst_addr = (void *)ip6_h->ip6_dst.s6_addr;
-            addr_len = OGS_IPV6_LEN;
-        } else {
-            ogs_error("Invalid packet [IP version:%d, Packet Length:%d]",
-                    ip_h->ip_v, pkbuf->len);
-            ogs_log_hexdump(OGS_LOG_ERROR, pkbuf->data, pkbuf->len);
-            continue;
-        }
+    memset(key, 0, sizeof *key);
+
+    ip_h = (struct ip *)pkbuf->data;
+    if (ip_h->ip_v == 4) {
+        key->proto = ip_h->ip_p;
+        ip_hlen = (ip_h->ip_hl)*4;
+
+        memcpy(key->src, &ip_h->ip_src.s_addr, OGS_IPV4_LEN);
+        memcpy(key->dst, &ip_h->ip_dst.s_addr, OGS_IPV4_LEN);
+    } else if (ip_h->ip_v == 6) {
+        ip6_h = (struct ip6_hdr *)pkbuf->data;
+
+        decode_ipv6_header(ip6_h, &key->proto, &ip_hlen);
+
+        memcpy(key->src, ip6_h->ip6_src.s6_addr, OGS_IPV6_LEN);
+        memcpy(key->dst, ip6_h->ip6_dst.s6_addr, OGS_IPV6_LEN);
+    } else {
+        ogs_error("Invalid packet [IP version:%d, Packet Length:%d]",
+                ip_h->ip_v, pkbuf->len);
+        ogs_log_hexdump(OGS_LOG_ERROR, pkbuf->data, pkbuf->len);
+        return OGS_ERROR;
+    }
+
+    /* The TCP and UDP headers both start with the source/destination port */
+    if ((key->proto == IPPROTO_TCP || key->proto == IPPROTO_UDP) &&
+        pkbuf->len >= ip_hlen + 2 * sizeof(uint16_t)) {
+        uint16_t *port = (uint16_t *)((char *)pkbuf->data + ip_hlen);
+
+        key->src_port = be16toh(port[0]);
+        key->dst_port = be16toh(port[1]);
+    }
+
+    ogs_trace("PROTO:%d SRC:%08x %08x %08x %08x",
+            key->proto, be32toh(key->src[0]), be32toh(key->src[1]),
+            be32toh(key->src[2]), be32toh(key->src[3]));
+    ogs_trace("HLEN:%d  DST:%08x %08x %08x %08x",
+            ip_hlen, be32toh(key->dst[0]), be32toh(key->dst[1]),
+            be32toh(key->dst[2]), be32toh(key->dst[3]));
+    ogs_trace("SPORT:%d DPORT:%d", key->src_port, key->dst_port);
+
+    return OGS_OK;
+}
+
+static bool port_match(ogs_ipfw_rule_t *ipfw, ogs_pfcp_packet_key_t *key)
+{
+    if (ipfw->proto != IPPROTO_TCP && ipfw->proto != IPPROTO_UDP)
+        return true;
+
+    /* Source port */
+    if (ipfw->port.src.low && key->src_port < ipfw->port.src.low)
+        return false;
+    if (ipfw->port.src.high && key->src_port > ipfw->port.src.high)
+        return false;
+
+    /* Dst Port*/
+    if (ipfw->port.dst.low && key->dst_port < ipfw->port.dst.low)
+        return false;
+    if (ipfw->port.dst.high && key->dst_port > ipfw->port.dst.high)
+        return false;
+
+    return true;
+}
+
+static bool rule_match(ogs_ipfw_rule_t *ipfw, ogs_pfcp_packet_key_t *key)
+{
+    int k;
+
+    for (k = 0; k < 4; k++) {
+        if ((key->src[k] & ipfw->ip.src.mask[k]) != ipfw->ip.src.addr[k] ||
+            (key->dst[k] & ipfw->ip.dst.mask[k]) != ipfw->ip.dst.addr[k])
+            return false;
+    }
+
+    /* Protocol match */
+    if (ipfw->proto == 0) /* IP */
+        return true; /* No need to match port */
 
-        ogs_trace("PROTO:%d SRC:%08x %08x %08x %08x",
-                proto, be32toh(src_addr[0]), be32toh(src_addr[1]),
-                be32toh(src_addr[2]), be32toh(src_addr[3]));
-        ogs_trace("HLEN:%d  DST:%08x %08x %08x %08x",
-                ip_hlen, be32toh(dst_addr[0]), be32toh(dst_addr[1]),
-                be32toh(dst_addr[2]), be32toh(dst_addr[3]));
+    if (ipfw->proto != key->proto)
+        return false;
+
+    return port_match(ipfw, key);
+}
+
+ogs_pfcp_rule_t *ogs_pfcp_pdr_rule_find_by_key(
+                    ogs_pfcp_pdr_t *pdr, ogs_pfcp_packet_key_t *key)
+{
+    ogs_pfcp_rule_t *rule = NULL;
+
+    ogs_assert(pdr);
+    ogs_assert(key);
+
+    ogs_list_for_each(&pdr->rule_list, rule) {
+        ogs_ipfw_rule_t *ipfw = &rule->ipfw;
 
         ogs_trace("PROTO:%d SRC:%d-%d DST:%d-%d",
                 ipfw->proto,
@@ -175,105 +220,264 @@ ogs_pfcp_rule_t *ogs_pfcp_pdr_rule_find_by_packet(
                 ipfw->port.src.high,
                 ipfw->port.dst.low,
                 ipfw->port.dst.high);
-        ogs_trace("SRC:%08x %08x %08x %08x/%08x %08x %08x %08x",
-                be32toh(ipfw->ip.src.addr[0]),
-                be32toh(ipfw->ip.src.addr[1]),
-                be32toh(ipfw->ip.src.addr[2]),
-                be32toh(ipfw->ip.src.addr[3]),
-                be32toh(ipfw->ip.src.mask[0]),
-                be32toh(ipfw->ip.src.mask[1]),
-                be32toh(ipfw->ip.src.mask[2]),
-                be32toh(ipfw->ip.src.mask[3]));
-        ogs_trace("DST:%08x %08x %08x %08x/%08x %08x %08x %08x",
-                be32toh(ipfw->ip.dst.addr[0]),
-                be32toh(ipfw->ip.dst.addr[1]),
-                be32toh(ipfw->ip.dst.addr[2]),
-                be32toh(ipfw->ip.dst.addr[3]),
-                be32toh(ipfw->ip.dst.mask[0]),
-                be32toh(ipfw->ip.dst.mask[1]),
-                be32toh(ipfw->ip.dst.mask[2]),
-                be32toh(ipfw->ip.dst.mask[3]));
 
+        if (rule_match(ipfw, key) == true)
+            return rule;
+    }
+
+    return NULL;
+}
+
+ogs_pfcp_rule_t *ogs_pfcp_pdr_rule_find_by_packet(
+                    ogs_pfcp_pdr_t *pdr, ogs_pkbuf_t *pkbuf)
+{
+    ogs_pfcp_packet_key_t key;
+
+    ogs_assert(pdr);
+    ogs_assert(pkbuf);
+
+    if (ogs_pfcp_packet_key_parse(&key, pkbuf) != OGS_OK)
+        return NULL;
+
+    return ogs_pfcp_pdr_rule_find_by_key(pdr, &key);
+}
+
+/*
+ * SDF Classifier
+ *
+ * A tuple-space classifier compiled from the PDRs of a session.
+ *
+ * Every SDF filter (or a PDR without any filter) becomes an entry.
+ * Entries with the same source/destination mask, and the same use of
+ * the protocol field, share a tuple. Each tuple is a hash table
+ * keyed by the masked addresses and the protocol. So a lookup costs
+ * one hash probe per tuple, not one comparison per rule. Port ranges
+ * are checked on the entries found.
+ *
+ * An entry's order is the position of its PDR in sess->pdr_list,
+ * which is sorted by precedence. Lookup returns the matching PDR with
+ * the lowest order, which is the PDR that a linear walk would find.
+ *
+ * Any change to the PDRs or their rules clears the classifier, and
+ * lookups walk the PDR list until the UP function compiles it again
+ * once the whole PFCP request has been applied.
+ */
+typedef struct classifier_key_s {
+    uint32_t src[4];
+    uint32_t dst[4];
+    uint32_t proto;
+} classifier_key_t;
+
+typedef struct classifier_entry_s classifier_entry_t;
+typedef struct classifier_entry_s {
+    classifier_key_t key;
+    int order;
+
+    ogs_pfcp_pdr_t *pdr;
+    ogs_pfcp_rule_t *rule;      /* NULL if PDR has no SDF filter */
+
+    classifier_entry_t *next;   /* Same key, higher order */
+} classifier_entry_t;
+
+typedef struct classifier_tuple_s {
+    uint32_t src_mask[4];
+    uint32_t dst_mask[4];
+    bool proto;
+    int order;                  /* Lowest order in this tuple */
+
+    ogs_hash_t *hash;
+} classifier_tuple_t;
+
+struct ogs_pfcp_classifier_s {
+    int num_of_tuple;
+    classifier_tuple_t *tuple;
+
+    int num_of_entry;
+    classifier_entry_t *entry;
+};
+
+static void classifier_add(ogs_pfcp_classifier_t *classifier,
+        ogs_pfcp_pdr_t *pdr, ogs_pfcp_rule_t *rule, int order)
+{
+    static const uint32_t zero[4] = { 0, 0, 0, 0 };
+    const uint32_t *src_mask = zero, *dst_mask = zero;
+    bool proto = false;
+    classifier_tuple_t *tuple = NULL;
+    classifier_entry_t *entry = NULL, *last = NULL;
+    int i, k;
+
+    if (rule) {
+        src_mask = rule->ipfw.ip.src.mask;
+        dst_mask = rule->ipfw.ip.dst.mask;
+        proto = rule->ipfw.proto != 0;
+    }
+
+    for (i = 0; i < classifier->num_of_tuple; i++) {
+        tuple = &classifier->tuple[i];
+        if (tuple->proto == proto &&
+            memcmp(tuple->src_mask, src_mask, sizeof(tuple->src_mask)) == 0 &&
+            memcmp(tuple->dst_mask, dst_mask, sizeof(tuple->dst_mask)) == 0)
+            break;
+    }
+    if (i == classifier->num_of_tuple) {
+        tuple = &classifier->tuple[classifier->num_of_tuple++];
+        memcpy(tuple->src_mask, src_mask, sizeof(tuple->src_mask));
+        memcpy(tuple->dst_mask, dst_mask, sizeof(tuple->dst_mask));
+        tuple->proto = proto;
+        tuple->order = order;
+        tuple->hash = ogs_hash_make();
+        ogs_assert(tuple->hash);
+    }
+
+    entry = &classifier->entry[classifier->num_of_entry++];
+    entry->order = order;
+    entry->pdr = pdr;
+    entry->rule = rule;
+    if (rule) {
         for (k = 0; k < 4; k++) {
-            src_mask[k] = src_addr[k] & ipfw->ip.src.mask[k];
-            dst_mask[k] = dst_addr[k] & ipfw->ip.dst.mask[k];
+            entry->key.src[k] = rule->ipfw.ip.src.addr[k] & src_mask[k];
+            entry->key.dst[k] = rule->ipfw.ip.dst.addr[k] & dst_mask[k];
         }
+        entry->key.proto = rule->ipfw.proto;
+    }
+
+    last = ogs_hash_get(tuple->hash, &entry->key, sizeof(entry->key));
+    if (!last) {
+        ogs_hash_set(tuple->hash, &entry->key, sizeof(entry->key), entry);
+        return;
+    }
+
+    while (last->next)
+        last = last->next;
+    last->next = entry;
+}
+
+void ogs_pfcp_classifier_compile(ogs_pfcp_sess_t *sess)
+{
+    ogs_pfcp_classifier_t *classifier = NULL;
+    ogs_pfcp_pdr_t *pdr = NULL;
+    ogs_pfcp_rule_t *rule = NULL;
+    int count = 0, order = 0;
+
+    ogs_assert(sess);
+
+    ogs_pfcp_classifier_clear(sess);
+
+    ogs_list_for_each(&sess->pdr_list, pdr) {
+        int num_of_rule = ogs_list_count(&pdr->rule_list);
+        count += num_of_rule ? num_of_rule : 1;
+    }
+    if (!count)
+        return;
+
+    classifier = ogs_calloc(1, sizeof(*classifier));
+    ogs_assert(classifier);
+    classifier->tuple = ogs_calloc(count, sizeof(classifier_tuple_t));
+    ogs_assert(classifier->tuple);
+    classifier->entry = ogs_calloc(count, sizeof(classifier_entry_t));
+    ogs_assert(classifier->entry);
+
+    ogs_list_for_each(&sess->pdr_list, pdr) {
+        if (ogs_list_first(&pdr->rule_list) == NULL)
+            classifier_add(classifier, pdr, NULL, order);
+        else
+            ogs_list_for_each(&pdr->rule_list, rule)
+                classifier_add(classifier, pdr, rule, order);
+        order++;
+    }
+
+    ogs_debug("SDF classifier compiled [PDR:%d, Entry:%d, Tuple:%d]",
+            order, classifier->num_of_entry, classifier->num_of_tuple);
+
+    sess->classifier = classifier;
+}
+
+void ogs_pfcp_classifier_clear(ogs_pfcp_sess_t *sess)
+{
+    ogs_pfcp_classifier_t *classifier = NULL;
+    int i;
+
+    ogs_assert(sess);
 
-        if (memcmp(src_mask, ipfw->ip.src.addr, addr_len) == 0 &&
-            memcmp(dst_mask, ipfw->ip.dst.addr, addr_len) == 0) {
-            /* Protocol match */
-            if (ipfw->proto == 0) { /* IP */
-                /* No need to match port */
-                return rule;
-            }
-
-            if (ipfw->proto == proto) {
-                if (ipfw->proto == IPPROTO_TCP) {
-                    struct tcphdr *tcph =
-                        (struct tcphdr *)((char *)pkbuf->data + ip_hlen);
-
-                    /* Source port */
-                    if (ipfw->port.src.low &&
-                          be16toh(tcph->th_sport) < ipfw->port.src.low) {
-                        continue;
-                    }
-
-                    if (ipfw->port.src.high &&
-                          be16toh(tcph->th_sport) > ipfw->port.src.high) {
-                        continue;
-                    }
-
-                    /* Dst Port*/
-                    if (ipfw->port.dst.low &&
-                          be16toh(tcph->th_dport) < ipfw->port.dst.low) {
-                        continue;
-                    }
-
-                    if (ipfw->port.dst.high &&
-                          be16toh(tcph->th_dport) > ipfw->port.dst.high) {
-                        continue;
-                    }
-
-                    /* Matched */
-                    return rule;
-
-                } else if (ipfw->proto == IPPROTO_UDP) {
-                    struct udphdr *udph =
-                        (struct udphdr *)((char *)pkbuf->data + ip_hlen);
-
-                    /* Source port */
-                    if (ipfw->port.src.low &&
-                          be16toh(udph->uh_sport) < ipfw->port.src.low) {
-                        continue;
-                    }
-
-                    if (ipfw->port.src.high &&
-                          be16toh(udph->uh_sport) > ipfw->port.src.high) {
-                        continue;
-                    }
-
-                    /* Dst Port*/
-                    if (ipfw->port.dst.low &&
-                          be16toh(udph->uh_dport) < ipfw->port.dst.low) {
-                        continue;
-                    }
-
-                    if (ipfw->port.dst.high &&
-                          be16toh(udph->uh_dport) > ipfw->port.dst.high) {
-                        continue;
-                    }
-
-                    /* Matched */
-                    return rule;
-
-                } else {
-
-                    /* No need to match port */
-                    return rule;
-
-                }
-            }
+    classifier = sess->classifier;
+    if (!classifier)
+        return;
+
+    for (i = 0; i < classifier->num_of_tuple; i++)
+        ogs_hash_destroy(classifier->tuple[i].hash);
+
+    ogs_free(classifier->tuple);
+    ogs_free(classifier->entry);
+    ogs_free(classifier);
+
+    sess->classifier = NULL;
+}
+
+static ogs_pfcp_pdr_t *classifier_find(ogs_pfcp_classifier_t *classifier,
+        ogs_pfcp_packet_key_t *key,
+        ogs_pfcp_classifier_filter_f filter, void *data)
+{
+    classifier_entry_t *best = NULL;
+    int i, k;
+
+    for (i = 0; i < classifier->num_of_tuple; i++) {
+        classifier_tuple_t *tuple = &classifier->tuple[i];
+        classifier_entry_t *entry = NULL;
+        classifier_key_t masked;
+
+        /* Tuples are in order of their first entry */
+        if (best && tuple->order >= best->order)
+            break;
+
+        for (k = 0; k < 4; k++) {
+            masked.src[k] = key->src[k] & tuple->src_mask[k];
+            masked.dst[k] = key->dst[k] & tuple->dst_mask[k];
         }
+        masked.proto = tuple->proto ? key->proto : 0;
+
+        for (entry = ogs_hash_get(tuple->hash, &masked, sizeof(masked));
+                entry; entry = entry->next) {
+            if (best && entry->order >= best->order)
+                break;
+            if (entry->rule && port_match(&entry->rule->ipfw, key) == false)
+                continue;
+            if (filter && filter(entry->pdr, data) == false)
+                continue;
+
+            best = entry;
+            break;
+        }
+    }
+
+    return best ? best->pdr : NULL;
+}
+
+ogs_pfcp_pdr_t *ogs_pfcp_classifier_find(ogs_pfcp_sess_t *sess,
+        ogs_pkbuf_t *pkbuf, ogs_pfcp_classifier_filter_f filter, void *data)
+{
+    ogs_pfcp_pdr_t *pdr = NULL;
+    ogs_pfcp_packet_key_t key;
+    bool parsed;
+
+    ogs_assert(sess);
+    ogs_assert(pkbuf);
+
+    parsed = ogs_pfcp_packet_key_parse(&key, pkbuf) == OGS_OK;
+
+    if (sess->classifier && parsed)
+        return classifier_find(sess->classifier, &key, filter, data);
+
+    /* Not compiled yet, or not an IP packet : walk the PDR list */
+    ogs_list_for_each(&sess->pdr_list, pdr) {
+        if (filter && filter(pdr, data) == false)
+            continue;
+
+        /* Check if Rule List in PDR */
+        if (ogs_list_first(&pdr->rule_list) &&
+            (!parsed || ogs_pfcp_pdr_rule_find_by_key(pdr, &key) == NULL))
+            continue;
+
+        return pdr;
     }
 
     return NULL;
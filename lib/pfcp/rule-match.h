@@ -28,9 +28,28 @@
 extern "C" {
 #endif
 
+typedef struct ogs_pfcp_packet_key_s {
+    uint32_t src[4];
+    uint32_t dst[4];
+    uint8_t proto;
+    uint16_t src_port;
+    uint16_t dst_port;
+} ogs_pfcp_packet_key_t;
+
+int ogs_pfcp_packet_key_parse(ogs_pfcp_packet_key_t *key, ogs_pkbuf_t *pkbuf);
+
+ogs_pfcp_rule_t *ogs_pfcp_pdr_rule_find_by_key(
+                    ogs_pfcp_pdr_t *pdr, ogs_pfcp_packet_key_t *key);
 ogs_pfcp_rule_t *ogs_pfcp_pdr_rule_find_by_packet(
                     ogs_pfcp_pdr_t *pdr, ogs_pkbuf_t *pkbuf);
 
+typedef bool (*ogs_pfcp_classifier_filter_f)(ogs_pfcp_pdr_t *pdr, void *data);
+
+void ogs_pfcp_classifier_compile(ogs_pfcp_sess_t *sess);
+void ogs_pfcp_classifier_clear(ogs_pfcp_sess_t *sess);
+ogs_pfcp_pdr_t *ogs_pfcp_classifier_find(ogs_pfcp_sess_t *sess,
+        ogs_pkbuf_t *pkbuf, ogs_pfcp_classifier_filter_f filter, void *data);
+
 #ifdef __cplusplus
 }
 #endif
@@ -833,3 +833,53 @@ int16_t ogs_pfcp_build_user_id(
 
     return octet->len;
 }
+
+uint8_t ogs_pfcp_encode_timer(uint32_t sec)
+{
+    ogs_pfcp_timer_t timer;
+
+    memset(&timer, 0, sizeof(timer));
+
+    if (sec <= 2 * 31) {
+        timer.unit = OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_2_SS;
+        timer.value = (sec + 1) / 2;
+    } else if (sec <= 60 * 31) {
+        timer.unit = OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_1_MM;
+        timer.value = (sec + 59) / 60;
+    } else if (sec <= 10 * 60 * 31) {
+        timer.unit = OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_10_MM;
+        timer.value = (sec + 599) / 600;
+    } else if (sec <= 60 * 60 * 31) {
+        timer.unit = OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_1_HH;
+        timer.value = (sec + 3599) / 3600;
+    } else if (sec <= 10 * 60 * 60 * 31) {
+        timer.unit = OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_10_HH;
+        timer.value = (sec + 35999) / 36000;
+    } else {
+        timer.unit = OGS_PFCP_TIMER_UNIT_INFINITE;
+    }
+
+    return timer.octet;
+}
+
+ogs_time_t ogs_pfcp_decode_timer(uint8_t octet)
+{
+    ogs_pfcp_timer_t timer;
+
+    timer.octet = octet;
+
+    switch (timer.unit) {
+    case OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_2_SS:
+        return ogs_time_from_sec(timer.value * 2);
+    case OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_10_MM:
+        return ogs_time_from_sec(timer.value * 10 * 60);
+    case OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_1_HH:
+        return ogs_time_from_sec(timer.value * 60 * 60);
+    case OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_10_HH:
+        return ogs_time_from_sec(timer.value * 10 * 60 * 60);
+    case OGS_PFCP_TIMER_UNIT_INFINITE:
+        return OGS_INFINITE_TIME;
+    default:
+        return ogs_time_from_sec(timer.value * 60);
+    }
+}
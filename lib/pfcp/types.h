@@ -1727,6 +1727,54 @@ ED3(uint8_t     spare:6;,
     };
 } __attribute__ ((packed)) ogs_pfcp_sereq_flags_t;
 
+/*
+ * 8.2.41 Timer
+ *
+ * Octet 5 : Timer unit (Bits 8 to 6) and Timer value (Bits 5 to 1)
+ * - 000 : value is incremented in multiples of 2 seconds
+ * - 001 : value is incremented in multiples of 1 minute
+ * - 010 : value is incremented in multiples of 10 minutes
+ * - 011 : value is incremented in multiples of 1 hour
+ * - 100 : value is incremented in multiples of 10 hours
+ * - 111 : value indicates that the timer is infinite
+ * Other values shall be interpreted as multiples of 1 minute.
+ */
+#define OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_2_SS       0
+#define OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_1_MM       1
+#define OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_10_MM      2
+#define OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_1_HH       3
+#define OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_10_HH      4
+#define OGS_PFCP_TIMER_UNIT_INFINITE                7
+typedef struct ogs_pfcp_timer_s {
+    union {
+        struct {
+ED2(uint8_t     unit:3;,
+    uint8_t     value:5;)
+        };
+        uint8_t octet;
+    };
+} __attribute__ ((packed)) ogs_pfcp_timer_t;
+
+/* Rounded up to the next representable value */
+uint8_t ogs_pfcp_encode_timer(uint32_t sec);
+/* OGS_INFINITE_TIME for an infinite timer */
+ogs_time_t ogs_pfcp_decode_timer(uint8_t octet);
+
+/*
+ * 8.2.76 OCI Flags
+ *
+ * - Bit 1 – AOCI: Associate OCI with Node ID
+ */
+typedef struct ogs_pfcp_oci_flags_s {
+    union {
+        struct {
+ED2(uint8_t     spare:7;,
+    uint8_t     aoci:1;)
+        };
+        uint8_t value;
+    };
+} __attribute__ ((packed)) ogs_pfcp_oci_flags_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -23,12 +23,259 @@ const char *OGS_EVENT_NAME_SBI_SERVER = "OGS_EVENT_NAME_SBI_SERVER";
 const char *OGS_EVENT_NAME_SBI_CLIENT = "OGS_EVENT_NAME_SBI_CLIENT";
 const char *OGS_EVENT_NAME_SBI_TIMER = "OGS_EVENT_NAME_SBI_TIMER";
 
+/*
+ * Events are served from fixed-size blocks kept on per-thread free lists.
+ *
+ * An event is usually allocated and freed on the NF main thread. Blocks
+ * freed on another thread stay in that thread's list, and any excess is
+ * moved to a shared depot so that producer threads can take them back.
+ * A thread's list is also given back to the depot when the thread exits.
+ * New blocks are only allocated from the heap when all lists are empty.
+ */
+#define EVENT_LOCAL_MAX     256     /* Blocks kept per thread and class */
+#define EVENT_LOCAL_REFILL  32      /* Blocks taken from the depot at once */
+
+#define EVENT_UNPOOLED      0xff
+
+typedef struct event_block_s {
+    struct event_block_s *next;     /* Free list */
+    struct event_block_s *link;     /* All blocks, released at final */
+    uint64_t size_class;
+} event_block_t;
+
+/* Keeps the event itself 16-byte aligned */
+#define EVENT_BLOCK_HEADER_SIZE 32
+OGS_STATIC_ASSERT(EVENT_BLOCK_HEADER_SIZE >= sizeof(event_block_t));
+
+static const size_t size_class_size[OGS_EVENT_NUM_OF_SIZE_CLASS] = {
+    64, 128, OGS_EVENT_SIZE
+};
+
+static struct {
+    bool initialized;
+    uint32_t epoch;
+
+    ogs_thread_mutex_t mutex;
+    event_block_t *head[OGS_EVENT_NUM_OF_SIZE_CLASS];
+    event_block_t *link;
+#if !defined(_WIN32)
+    pthread_key_t key;              /* Flushes the list of an exiting thread */
+#endif
+
+    uint64_t num_of_block[OGS_EVENT_NUM_OF_SIZE_CLASS];
+    uint64_t num_of_used[OGS_EVENT_NUM_OF_SIZE_CLASS];
+    uint64_t num_of_alloc[OGS_EVENT_NUM_OF_SIZE_CLASS];
+} depot;
+
+static ogs_thread_local struct {
+    uint32_t epoch;
+    event_block_t *head[OGS_EVENT_NUM_OF_SIZE_CLASS];
+    int count[OGS_EVENT_NUM_OF_SIZE_CLASS];
+} local;
+
+static void local_flush(void *data)
+{
+    int i;
+
+    if (depot.initialized == false || local.epoch != depot.epoch)
+        return;
+
+    ogs_thread_mutex_lock(&depot.mutex);
+    for (i = 0; i < OGS_EVENT_NUM_OF_SIZE_CLASS; i++) {
+        while (local.head[i]) {
+            event_block_t *block = local.head[i];
+            local.head[i] = block->next;
+
+            block->next = depot.head[i];
+            depot.head[i] = block;
+        }
+        local.count[i] = 0;
+    }
+    ogs_thread_mutex_unlock(&depot.mutex);
+}
+
+void ogs_event_init(void)
+{
+    ogs_assert(depot.initialized == false);
+
+    ogs_thread_mutex_init(&depot.mutex);
+#if !defined(_WIN32)
+    ogs_assert(pthread_key_create(&depot.key, local_flush) == 0);
+#endif
+    memset(depot.head, 0, sizeof(depot.head));
+    depot.link = NULL;
+
+    memset(depot.num_of_block, 0, sizeof(depot.num_of_block));
+    memset(depot.num_of_used, 0, sizeof(depot.num_of_used));
+    memset(depot.num_of_alloc, 0, sizeof(depot.num_of_alloc));
+
+    /* Per-thread lists of a previous init are no longer valid */
+    depot.epoch++;
+    depot.initialized = true;
+}
+
+void ogs_event_final(void)
+{
+    event_block_t *block = NULL;
+    int i;
+
+    if (depot.initialized == false)
+        return;
+
+    for (i = 0; i < OGS_EVENT_NUM_OF_SIZE_CLASS; i++) {
+        if (depot.num_of_used[i])
+            ogs_warn("%d event(s) of %d bytes still in use",
+                    (int)depot.num_of_used[i], (int)size_class_size[i]);
+        ogs_debug("Event blocks of %d bytes [block:%d, alloc:%lld]",
+                (int)size_class_size[i], (int)depot.num_of_block[i],
+                (long long)depot.num_of_alloc[i]);
+    }
+
+    while (depot.link) {
+        block = depot.link;
+        depot.link = block->link;
+        ogs_free(block);
+    }
+
+    memset(local.head, 0, sizeof(local.head));
+    memset(local.count, 0, sizeof(local.count));
+
+#if !defined(_WIN32)
+    pthread_key_delete(depot.key);
+#endif
+    ogs_thread_mutex_destroy(&depot.mutex);
+    depot.initialized = false;
+}
+
+void ogs_event_stat(ogs_event_stat_t stat[OGS_EVENT_NUM_OF_SIZE_CLASS])
+{
+    int i;
+
+    ogs_assert(stat);
+
+    for (i = 0; i < OGS_EVENT_NUM_OF_SIZE_CLASS; i++) {
+        stat[i].size = size_class_size[i];
+        stat[i].num_of_block = __atomic_load_n(
+                &depot.num_of_block[i], __ATOMIC_RELAXED);
+        stat[i].num_of_used = __atomic_load_n(
+                &depot.num_of_used[i], __ATOMIC_RELAXED);
+        stat[i].num_of_alloc = __atomic_load_n(
+                &depot.num_of_alloc[i], __ATOMIC_RELAXED);
+    }
+}
+
+static void local_check_epoch(void)
+{
+    if (ogs_unlikely(local.epoch != depot.epoch)) {
+        memset(local.head, 0, sizeof(local.head));
+        memset(local.count, 0, sizeof(local.count));
+        local.epoch = depot.epoch;
+#if !defined(_WIN32)
+        /* Any non-NULL value makes local_flush() run at thread exit */
+        pthread_setspecific(depot.key, &local);
+#endif
+    }
+}
+
+static event_block_t *block_alloc(int size_class)
+{
+    event_block_t *block = NULL;
+
+    local_check_epoch();
+
+    if (!local.head[size_class]) {
+        int i;
+
+        ogs_thread_mutex_lock(&depot.mutex);
+        for (i = 0; i < EVENT_LOCAL_REFILL && depot.head[size_class]; i++) {
+            block = depot.head[size_class];
+            depot.head[size_class] = block->next;
+
+            block->next = local.head[size_class];
+            local.head[size_class] = block;
+            local.count[size_class]++;
+        }
+
+        if (!local.head[size_class]) {
+            block = ogs_malloc(EVENT_BLOCK_HEADER_SIZE +
+                    size_class_size[size_class]);
+            if (!block) {
+                ogs_thread_mutex_unlock(&depot.mutex);
+                ogs_error("ogs_malloc() failed");
+                return NULL;
+            }
+            block->size_class = size_class;
+            block->link = depot.link;
+            depot.link = block;
+            depot.num_of_block[size_class]++;
+
+            block->next = NULL;
+            local.head[size_class] = block;
+            local.count[size_class]++;
+        }
+        ogs_thread_mutex_unlock(&depot.mutex);
+    }
+
+    block = local.head[size_class];
+    local.head[size_class] = block->next;
+    local.count[size_class]--;
+
+    __atomic_add_fetch(&depot.num_of_used[size_class], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&depot.num_of_alloc[size_class], 1, __ATOMIC_RELAXED);
+
+    return block;
+}
+
+static void block_free(event_block_t *block)
+{
+    int size_class = block->size_class;
+
+    local_check_epoch();
+
+    __atomic_sub_fetch(&depot.num_of_used[size_class], 1, __ATOMIC_RELAXED);
+
+    block->next = local.head[size_class];
+    local.head[size_class] = block;
+    local.count[size_class]++;
+
+    if (local.count[size_class] > EVENT_LOCAL_MAX) {
+        /* Give half of the list back to the depot */
+        ogs_thread_mutex_lock(&depot.mutex);
+        while (local.count[size_class] > EVENT_LOCAL_MAX / 2) {
+            block = local.head[size_class];
+            local.head[size_class] = block->next;
+            local.count[size_class]--;
+
+            block->next = depot.head[size_class];
+            depot.head[size_class] = block;
+        }
+        ogs_thread_mutex_unlock(&depot.mutex);
+    }
+}
+
 void *ogs_event_size(int id, size_t size)
 {
+    event_block_t *block = NULL;
     ogs_event_t *e = NULL;
+    int size_class;
 
-    e = ogs_calloc(1, size);
-    ogs_assert(e);
+    ogs_assert(size <= OGS_EVENT_SIZE);
+
+    if (ogs_unlikely(depot.initialized == false)) {
+        /* e.g. unit tests running without ogs_app_initialize() */
+        block = ogs_malloc(EVENT_BLOCK_HEADER_SIZE + size);
+        ogs_assert(block);
+        block->size_class = EVENT_UNPOOLED;
+    } else {
+        for (size_class = 0; size_class_size[size_class] < size; size_class++)
+            /* nothing */;
+
+        block = block_alloc(size_class);
+        ogs_assert(block);
+    }
+
+    e = (ogs_event_t *)((uint8_t *)block + EVENT_BLOCK_HEADER_SIZE);
+    memset(e, 0, size);
 
     e->id = id;
 
@@ -42,8 +289,18 @@ ogs_event_t *ogs_event_new(int id)
 
 void ogs_event_free(void *e)
 {
+    event_block_t *block = NULL;
+
     ogs_assert(e);
-    ogs_free(e);
+
+    block = (event_block_t *)((uint8_t *)e - EVENT_BLOCK_HEADER_SIZE);
+    if (block->size_class == EVENT_UNPOOLED) {
+        ogs_free(block);
+        return;
+    }
+
+    ogs_assert(block->size_class < OGS_EVENT_NUM_OF_SIZE_CLASS);
+    block_free(block);
 }
 
 const char *ogs_event_get_name(ogs_event_t *e)
@@ -64,6 +64,20 @@ typedef struct ogs_event_s {
 
 #define OGS_EVENT_SIZE 256
 
+/* Block sizes of the event allocator : 64, 128 and OGS_EVENT_SIZE */
+#define OGS_EVENT_NUM_OF_SIZE_CLASS 3
+
+typedef struct ogs_event_stat_s {
+    size_t size;                /* Block size of this class */
+    uint64_t num_of_block;      /* Blocks allocated from the heap */
+    uint64_t num_of_used;       /* Blocks currently in use */
+    uint64_t num_of_alloc;      /* Events allocated so far */
+} ogs_event_stat_t;
+
+void ogs_event_init(void);
+void ogs_event_final(void);
+void ogs_event_stat(ogs_event_stat_t stat[OGS_EVENT_NUM_OF_SIZE_CLASS]);
+
 void *ogs_event_size(int id, size_t size);
 ogs_event_t *ogs_event_new(int id);
 void ogs_event_free(void *e);
@@ -17,6 +17,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "metrics/ogs-metrics.h"
 #include "ogs-sbi.h"
 
 #include "curl/curl.h"
@@ -39,7 +40,6 @@ typedef struct connection_s {
     int num_of_header;
     char **headers;
     struct curl_slist *header_list;
-    struct curl_slist *resolve_list;
 
     char *content;
 
@@ -63,6 +63,58 @@ static OGS_POOL(client_pool, ogs_sbi_client_t);
 static OGS_POOL(sockinfo_pool, sockinfo_t);
 static OGS_POOL(connection_pool, connection_t);
 
+static ogs_sbi_client_stat_t client_stat;
+
+typedef enum {
+    CLIENT_METR_CTR_REQ,
+    CLIENT_METR_CTR_HANDLE_REUSE,
+    CLIENT_METR_CTR_CONN_NEW,
+    CLIENT_METR_CTR_CONN_REUSE,
+    CLIENT_METR_GAUGE_STREAM,
+    _CLIENT_METR_MAX,
+} client_metric_type_t;
+
+static const struct {
+    ogs_metrics_metric_type_t type;
+    const char *name;
+    const char *description;
+} client_metrics_spec_def[_CLIENT_METR_MAX] = {
+[CLIENT_METR_CTR_REQ] = {
+    .type = OGS_METRICS_METRIC_TYPE_COUNTER,
+    .name = "sbi_client_request",
+    .description = "SBI client requests sent",
+},
+[CLIENT_METR_CTR_HANDLE_REUSE] = {
+    .type = OGS_METRICS_METRIC_TYPE_COUNTER,
+    .name = "sbi_client_handle_reuse",
+    .description = "SBI client requests served by a cached CURL handle",
+},
+[CLIENT_METR_CTR_CONN_NEW] = {
+    .type = OGS_METRICS_METRIC_TYPE_COUNTER,
+    .name = "sbi_client_connection_new",
+    .description = "SBI client requests that opened a new connection",
+},
+[CLIENT_METR_CTR_CONN_REUSE] = {
+    .type = OGS_METRICS_METRIC_TYPE_COUNTER,
+    .name = "sbi_client_connection_reuse",
+    .description = "SBI client requests sent on an existing connection",
+},
+[CLIENT_METR_GAUGE_STREAM] = {
+    .type = OGS_METRICS_METRIC_TYPE_GAUGE,
+    .name = "sbi_client_stream",
+    .description = "SBI client requests in flight",
+},
+};
+
+/* NULL unless the NF exports metrics */
+static ogs_metrics_inst_t *client_metrics[_CLIENT_METR_MAX];
+
+static void client_metrics_add(client_metric_type_t t, int val)
+{
+    if (client_metrics[t])
+        ogs_metrics_inst_add(client_metrics[t], val);
+}
+
 static size_t write_cb(void *contents, size_t size, size_t nmemb, void *data);
 static size_t header_cb(void *ptr, size_t size, size_t nmemb, void *data);
 static int sock_cb(CURL *e, curl_socket_t s, int what, void *cbp, void *sockp);
@@ -77,6 +129,9 @@ static void connection_free(connection_t *conn);
 static void connection_remove_all(ogs_sbi_client_t *client);
 static void connection_timer_expired(void *data);
 
+static CURL *easy_handle_get(ogs_sbi_client_t *client);
+static void easy_handle_put(ogs_sbi_client_t *client, CURL *easy);
+
 void ogs_sbi_client_init(int num_of_sockinfo_pool, int num_of_connection_pool)
 {
     curl_global_init(CURL_GLOBAL_DEFAULT);
@@ -87,6 +142,7 @@ void ogs_sbi_client_init(int num_of_sockinfo_pool, int num_of_connection_pool)
     ogs_pool_init(&sockinfo_pool, num_of_sockinfo_pool);
     ogs_pool_init(&connection_pool, num_of_connection_pool);
 
+    memset(&client_stat, 0, sizeof(client_stat));
 }
 void ogs_sbi_client_final(void)
 {
@@ -161,11 +217,24 @@ ogs_sbi_client_t *ogs_sbi_client_add(
     curl_multi_setopt(multi, CURLMOPT_SOCKETDATA, client);
     curl_multi_setopt(multi, CURLMOPT_TIMERFUNCTION, multi_timer_cb);
     curl_multi_setopt(multi, CURLMOPT_TIMERDATA, client);
+    /* Keep one warm HTTP/2 connection per peer and multiplex on it */
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    if (ogs_global_conf()->sbi.client.max_host_connections)
+        curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+                (long)ogs_global_conf()->sbi.client.max_host_connections);
 #if CURL_AT_LEAST_VERSION(7,67,0)
     curl_multi_setopt(multi, CURLMOPT_MAX_CONCURRENT_STREAMS,
-                        ogs_app()->pool.stream);
+            ogs_global_conf()->sbi.client.max_concurrent_streams ?
+            (long)ogs_global_conf()->sbi.client.max_concurrent_streams :
+            (long)ogs_app()->pool.stream);
 #endif
 
+    client->max_idle_easy = ogs_global_conf()->sbi.client.idle_handle;
+    if (client->max_idle_easy > 0) {
+        client->idle_easy = ogs_calloc(client->max_idle_easy, sizeof(CURL *));
+        ogs_assert(client->idle_easy);
+    }
+
     ogs_list_init(&client->connection_list);
 
     ogs_list_add(&ogs_sbi_self()->client_list, client);
@@ -205,6 +274,11 @@ void ogs_sbi_client_remove(ogs_sbi_client_t *client)
 
     connection_remove_all(client);
 
+    while (client->num_of_idle_easy)
+        curl_easy_cleanup(client->idle_easy[--client->num_of_idle_easy]);
+    if (client->idle_easy)
+        ogs_free(client->idle_easy);
+
     ogs_assert(client->t_curl);
     ogs_timer_delete(client->t_curl);
     client->t_curl = NULL;
@@ -227,6 +301,7 @@ void ogs_sbi_client_remove(ogs_sbi_client_t *client)
         ogs_free(client->fqdn);
     if (client->resolve)
         ogs_free(client->resolve);
+    curl_slist_free_all(client->resolve_list);
 
     if (client->addr)
         ogs_freeaddrinfo(client->addr);
@@ -309,6 +384,40 @@ void ogs_sbi_client_stop_all(void)
         ogs_sbi_client_stop(client);
 }
 
+void ogs_sbi_client_stat(ogs_sbi_client_stat_t *stat)
+{
+    ogs_assert(stat);
+    memcpy(stat, &client_stat, sizeof(*stat));
+}
+
+void ogs_sbi_client_metrics_init(void)
+{
+    ogs_metrics_spec_t *spec = NULL;
+    int i;
+
+    for (i = 0; i < _CLIENT_METR_MAX; i++) {
+        spec = ogs_metrics_spec_new(ogs_metrics_self(),
+                client_metrics_spec_def[i].type,
+                client_metrics_spec_def[i].name,
+                client_metrics_spec_def[i].description,
+                0, 0, NULL, NULL);
+        client_metrics[i] = ogs_metrics_inst_new(spec, 0, NULL);
+    }
+
+    /* Requests may already be in flight */
+    client_metrics_add(CLIENT_METR_GAUGE_STREAM, client_stat.stream);
+}
+
+void ogs_sbi_client_metrics_final(void)
+{
+    int i;
+
+    for (i = 0; i < _CLIENT_METR_MAX; i++)
+        if (client_metrics[i])
+            ogs_metrics_inst_free(client_metrics[i]);
+    memset(client_metrics, 0, sizeof(client_metrics));
+}
+
 #define mycase(code) \
   case code: s = OGS_STRINGIFY(code)
 
@@ -468,9 +577,9 @@ static connection_t *connection_add(
     ogs_timer_start(conn->timer,
             ogs_local_conf()->time.message.sbi.connection_deadline);
 
-    conn->easy = curl_easy_init();
+    conn->easy = easy_handle_get(client);
     if (!conn->easy) {
-        ogs_error("conn->easy is NULL");
+        ogs_error("easy_handle_get() failed");
         connection_free(conn);
         return NULL;
     }
@@ -487,35 +596,13 @@ static connection_t *connection_add(
         request->h.uri = uri;
     }
 
-    curl_easy_setopt(conn->easy, CURLOPT_BUFFERSIZE, OGS_MAX_SDU_LEN);
+    /* Configure HTTP Method
+     *
+     * The handle may come back from the idle list, so the method and
+     * body of the previous request are reset first. */
+    curl_easy_setopt(conn->easy, CURLOPT_HTTPGET, 1L);
+    curl_easy_setopt(conn->easy, CURLOPT_CUSTOMREQUEST, NULL);
 
-    /* HTTPS certificate-related settings */
-    if (client->scheme == OpenAPI_uri_scheme_https) {
-        if (client->insecure_skip_verify) {
-            curl_easy_setopt(conn->easy, CURLOPT_SSL_VERIFYPEER, 0);
-            curl_easy_setopt(conn->easy, CURLOPT_SSL_VERIFYHOST, 0);
-        } else {
-            if (client->cacert)
-                curl_easy_setopt(conn->easy, CURLOPT_CAINFO, client->cacert);
-        }
-
-        /* Set private key & certificate */
-        if (client->private_key && client->cert) {
-            curl_easy_setopt(conn->easy, CURLOPT_SSLKEY, client->private_key);
-            curl_easy_setopt(conn->easy, CURLOPT_SSLCERT, client->cert);
-        }
-
-        if (client->sslkeylog) {
-            /* Set SSL_CTX callback */
-            curl_easy_setopt(conn->easy, CURLOPT_SSL_CTX_FUNCTION,
-                    sslctx_callback);
-
-            /* Optionally set additional user data */
-            curl_easy_setopt(conn->easy, CURLOPT_SSL_CTX_DATA, client);
-        }
-    }
-
-    /* Configure HTTP Method */
     if (strcmp(request->h.method, OGS_SBI_HTTP_METHOD_PUT) == 0 ||
         strcmp(request->h.method, OGS_SBI_HTTP_METHOD_PATCH) == 0 ||
         strcmp(request->h.method, OGS_SBI_HTTP_METHOD_DELETE) == 0 ||
@@ -549,28 +636,12 @@ static connection_t *connection_add(
 
     curl_easy_setopt(conn->easy, CURLOPT_HTTPHEADER, conn->header_list);
 
-#if 1 /* Use HTTP2 */
-    curl_easy_setopt(conn->easy,
-            CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE);
-#endif
-
     ogs_list_add(&client->connection_list, conn);
 
     curl_easy_setopt(conn->easy, CURLOPT_URL, request->h.uri);
 
-    if (client->resolve) {
-        conn->resolve_list = curl_slist_append(NULL, client->resolve);
-        curl_easy_setopt(conn->easy, CURLOPT_RESOLVE, conn->resolve_list);
-    }
-
-    if (client->local_if) {
-        curl_easy_setopt(conn->easy, CURLOPT_INTERFACE, client->local_if);
-    }
-
     curl_easy_setopt(conn->easy, CURLOPT_PRIVATE, conn);
-    curl_easy_setopt(conn->easy, CURLOPT_WRITEFUNCTION, write_cb);
     curl_easy_setopt(conn->easy, CURLOPT_WRITEDATA, conn);
-    curl_easy_setopt(conn->easy, CURLOPT_HEADERFUNCTION, header_cb);
     curl_easy_setopt(conn->easy, CURLOPT_HEADERDATA, conn);
     curl_easy_setopt(conn->easy, CURLOPT_ERRORBUFFER, conn->error);
 
@@ -578,6 +649,11 @@ static connection_t *connection_add(
     rc = curl_multi_add_handle(client->multi, conn->easy);
     mcode_or_die("connection_add: curl_multi_add_handle", rc);
 
+    client_stat.request++;
+    client_stat.stream++;
+    client_metrics_add(CLIENT_METR_CTR_REQ, 1);
+    client_metrics_add(CLIENT_METR_GAUGE_STREAM, 1);
+
     return conn;
 }
 
@@ -594,6 +670,12 @@ static void connection_remove(connection_t *conn)
     ogs_assert(client->multi);
     curl_multi_remove_handle(client->multi, conn->easy);
 
+    client_stat.stream--;
+    client_metrics_add(CLIENT_METR_GAUGE_STREAM, -1);
+
+    easy_handle_put(client, conn->easy);
+    conn->easy = NULL;
+
     connection_free(conn);
 }
 
@@ -628,8 +710,6 @@ static void connection_free(connection_t *conn)
     }
     curl_slist_free_all(conn->header_list);
 
-    curl_slist_free_all(conn->resolve_list);
-
     if (conn->method)
         ogs_free(conn->method);
 
@@ -646,6 +726,95 @@ static void connection_remove_all(ogs_sbi_client_t *client)
         connection_remove(conn);
 }
 
+static CURL *easy_handle_get(ogs_sbi_client_t *client)
+{
+    CURL *easy = NULL;
+
+    ogs_assert(client);
+
+    if (client->num_of_idle_easy) {
+        client_stat.handle_reuse++;
+        client_metrics_add(CLIENT_METR_CTR_HANDLE_REUSE, 1);
+        return client->idle_easy[--client->num_of_idle_easy];
+    }
+
+    easy = curl_easy_init();
+    if (!easy) {
+        ogs_error("curl_easy_init() failed");
+        return NULL;
+    }
+    client_stat.handle_new++;
+
+    /*
+     * Options below only depend on the client,
+     * so they are kept while the handle sits in the idle list.
+     */
+    curl_easy_setopt(easy, CURLOPT_BUFFERSIZE, OGS_MAX_SDU_LEN);
+
+    /* HTTPS certificate-related settings */
+    if (client->scheme == OpenAPI_uri_scheme_https) {
+        if (client->insecure_skip_verify) {
+            curl_easy_setopt(easy, CURLOPT_SSL_VERIFYPEER, 0);
+            curl_easy_setopt(easy, CURLOPT_SSL_VERIFYHOST, 0);
+        } else {
+            if (client->cacert)
+                curl_easy_setopt(easy, CURLOPT_CAINFO, client->cacert);
+        }
+
+        /* Set private key & certificate */
+        if (client->private_key && client->cert) {
+            curl_easy_setopt(easy, CURLOPT_SSLKEY, client->private_key);
+            curl_easy_setopt(easy, CURLOPT_SSLCERT, client->cert);
+        }
+
+        if (client->sslkeylog) {
+            /* Set SSL_CTX callback */
+            curl_easy_setopt(easy, CURLOPT_SSL_CTX_FUNCTION,
+                    sslctx_callback);
+
+            /* Optionally set additional user data */
+            curl_easy_setopt(easy, CURLOPT_SSL_CTX_DATA, client);
+        }
+    }
+
+#if 1 /* Use HTTP2 */
+    curl_easy_setopt(easy,
+            CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE);
+#endif
+
+    /* Wait for a multiplexed stream instead of opening a new connection */
+    curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+    curl_easy_setopt(easy, CURLOPT_TCP_KEEPALIVE, 1L);
+
+    if (client->resolve) {
+        if (!client->resolve_list)
+            client->resolve_list = curl_slist_append(NULL, client->resolve);
+        curl_easy_setopt(easy, CURLOPT_RESOLVE, client->resolve_list);
+    }
+
+    if (client->local_if) {
+        curl_easy_setopt(easy, CURLOPT_INTERFACE, client->local_if);
+    }
+
+    curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, write_cb);
+    curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, header_cb);
+
+    return easy;
+}
+
+static void easy_handle_put(ogs_sbi_client_t *client, CURL *easy)
+{
+    ogs_assert(client);
+    ogs_assert(easy);
+
+    if (client->num_of_idle_easy < client->max_idle_easy) {
+        client->idle_easy[client->num_of_idle_easy++] = easy;
+        return;
+    }
+
+    curl_easy_cleanup(easy);
+}
+
 static void connection_timer_expired(void *data)
 {
     connection_t *conn = NULL;
@@ -687,6 +856,7 @@ static void check_multi_info(ogs_sbi_client_t *client)
         char *url;
         char *content_type = NULL;
         long res_status;
+        long num_connects = 0;
         ogs_assert(resource);
 
         switch (resource->msg) {
@@ -700,6 +870,14 @@ static void check_multi_info(ogs_sbi_client_t *client)
             curl_easy_getinfo(easy, CURLINFO_EFFECTIVE_URL, &url);
             curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &res_status);
             curl_easy_getinfo(easy, CURLINFO_CONTENT_TYPE, &content_type);
+            curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &num_connects);
+            if (num_connects) {
+                client_stat.connection_new++;
+                client_metrics_add(CLIENT_METR_CTR_CONN_NEW, 1);
+            } else {
+                client_stat.connection_reuse++;
+                client_metrics_add(CLIENT_METR_CTR_CONN_REUSE, 1);
+            }
 
             res = resource->data.result;
             if (res == CURLE_OK) {
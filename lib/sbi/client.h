@@ -89,6 +89,7 @@ typedef struct ogs_sbi_client_s {
     ogs_sockaddr_t  *addr6;
 
     char *resolve;
+    void *resolve_list;                 /* CURLOPT_RESOLVE for all handles */
 
     ogs_timer_t     *t_curl;            /* timer for CURL */
     ogs_list_t      connection_list;    /* CURL connection list */
@@ -96,9 +97,22 @@ typedef struct ogs_sbi_client_s {
     void            *multi;             /* CURL multi handle */
     int             still_running;      /* number of running CURL handle */
 
+    void            **idle_easy;        /* pre-configured CURL easy handles */
+    int             num_of_idle_easy;
+    int             max_idle_easy;
+
     unsigned int    reference_count;    /* reference count for memory free */
 } ogs_sbi_client_t;
 
+typedef struct ogs_sbi_client_stat_s {
+    uint64_t request;           /* requests handed to CURL */
+    uint64_t handle_new;        /* CURL easy handles created */
+    uint64_t handle_reuse;      /* requests served by an idle easy handle */
+    uint64_t connection_new;    /* transfers that had to open a connection */
+    uint64_t connection_reuse;  /* transfers multiplexed on a warm connection */
+    int stream;                 /* requests in flight */
+} ogs_sbi_client_stat_t;
+
 typedef struct ogs_sbi_nf_instance_s ogs_sbi_nf_instance_t;
 
 void ogs_sbi_client_init(int num_of_sockinfo_pool, int num_of_connection_pool);
@@ -118,6 +132,12 @@ ogs_sbi_client_t *ogs_sbi_client_find(
 void ogs_sbi_client_stop(ogs_sbi_client_t *client);
 void ogs_sbi_client_stop_all(void);
 
+void ogs_sbi_client_stat(ogs_sbi_client_stat_t *stat);
+
+/* Exports the statistics above in the metrics context of the NF */
+void ogs_sbi_client_metrics_init(void);
+void ogs_sbi_client_metrics_final(void);
+
 bool ogs_sbi_client_send_request(
         ogs_sbi_client_t *client, ogs_sbi_client_cb_f client_cb,
         ogs_sbi_request_t *request, void *data);
@@ -17,6 +17,8 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <ctype.h>
+
 #include "ogs-sbi.h"
 
 int __ogs_sbi_domain;
@@ -32,6 +34,38 @@ static OGS_POOL(smf_info_pool, ogs_sbi_smf_info_t);
 static OGS_POOL(amf_info_pool, ogs_sbi_amf_info_t);
 static OGS_POOL(nf_info_pool, ogs_sbi_nf_info_t);
 
+/* NF-Instance indexes by NF-Instance-ID and by NF-Type */
+static ogs_hash_t *nf_instance_id_hash;
+static ogs_list_t nf_instance_type_list[OGS_SBI_MAX_NUM_OF_NF_TYPE];
+static int nf_instance_type_count[OGS_SBI_MAX_NUM_OF_NF_TYPE];
+
+/*
+ * Discovery indexes by PLMN, S-NSSAI, DNN and TAI within an NF-Type.
+ *
+ * An NF instance that cannot be placed in an index on some dimension
+ * (e.g. an SMF without smfInfo matches any S-NSSAI) is counted as
+ * uncovered. The dimension is not used for that NF-Type while any remain.
+ */
+typedef enum {
+    NF_INDEX_PLMN = 0,
+    NF_INDEX_S_NSSAI,
+    NF_INDEX_DNN,
+    NF_INDEX_TAI,
+    MAX_NUM_OF_NF_INDEX,
+} nf_index_e;
+#define NF_INDEX_ALL ((1 << MAX_NUM_OF_NF_INDEX) - 1)
+#define NF_INDEX_KEY_LEN (OGS_MAX_DNN_LEN + 32)
+
+typedef struct nf_index_s {
+    char *key;
+    ogs_list_t list;                    /* ogs_sbi_nf_index_node_t */
+    int count;
+} nf_index_t;
+
+static ogs_hash_t *nf_index_hash;
+static int nf_index_uncovered[OGS_SBI_MAX_NUM_OF_NF_TYPE][MAX_NUM_OF_NF_INDEX];
+static ogs_list_t nf_index_empty_list;
+
 void ogs_sbi_context_init(OpenAPI_nf_type_e nf_type)
 {
     char nf_instance_id[OGS_UUID_FORMATTED_LENGTH + 1];
@@ -51,6 +85,19 @@ void ogs_sbi_context_init(OpenAPI_nf_type_e nf_type)
 
     ogs_list_init(&self.nf_instance_list);
     ogs_pool_init(&nf_instance_pool, ogs_app()->pool.nf);
+
+    nf_instance_id_hash = ogs_hash_make();
+    ogs_assert(nf_instance_id_hash);
+    memset(nf_instance_type_list, 0, sizeof(nf_instance_type_list));
+    memset(nf_instance_type_count, 0, sizeof(nf_instance_type_count));
+
+    nf_index_hash = ogs_hash_make();
+    ogs_assert(nf_index_hash);
+    memset(nf_index_uncovered, 0, sizeof(nf_index_uncovered));
+    ogs_list_init(&nf_index_empty_list);
+
+    ogs_sbi_discovery_cache_init(ogs_app()->pool.discovery_cache);
+
     ogs_pool_init(&nf_service_pool, ogs_app()->pool.nf_service);
 
     ogs_pool_init(&xact_pool, ogs_app()->pool.xact);
@@ -94,8 +141,16 @@ void ogs_sbi_context_init(OpenAPI_nf_type_e nf_type)
 
 void ogs_sbi_context_final(void)
 {
+    int i;
+
     ogs_assert(context_initialized == 1);
 
+    for (i = OGS_HOME_NETWORK_PKI_VALUE_MIN;
+            i <= OGS_HOME_NETWORK_PKI_VALUE_MAX; i++) {
+        if (self.hnet[i].avail)
+            ogs_ecies_key_clear(&self.hnet[i].key);
+    }
+
     ogs_sbi_subscription_data_remove_all();
     ogs_pool_final(&subscription_data_pool);
 
@@ -106,6 +161,13 @@ void ogs_sbi_context_final(void)
 
     ogs_sbi_nf_instance_remove_all();
 
+    ogs_sbi_discovery_cache_final();
+
+    ogs_assert(nf_instance_id_hash);
+    ogs_hash_destroy(nf_instance_id_hash);
+    ogs_assert(nf_index_hash);
+    ogs_hash_destroy(nf_index_hash);
+
     ogs_pool_final(&nf_instance_pool);
     ogs_pool_final(&nf_service_pool);
     ogs_pool_final(&smf_info_pool);
@@ -702,28 +764,34 @@ int ogs_sbi_context_parse_hnet_config(ogs_yaml_iter_t *root_iter)
         if (id >= OGS_HOME_NETWORK_PKI_VALUE_MIN &&
             id <= OGS_HOME_NETWORK_PKI_VALUE_MAX &&
             filename) {
+            uint8_t key[OGS_ECCKEY_LEN];
+
+            rv = OGS_ERROR;
             if (scheme == OGS_PROTECTION_SCHEME_PROFILE_A) {
-                rv = ogs_pem_decode_curve25519_key(
-                        filename, self.hnet[id].key);
-                if (rv == OGS_OK) {
-                    self.hnet[id].avail = true;
-                    self.hnet[id].scheme = scheme;
-                } else {
+                rv = ogs_pem_decode_curve25519_key(filename, key);
+                if (rv != OGS_OK)
                     ogs_error("ogs_pem_decode_curve25519_key"
                             "[%s] failed", filename);
-                }
             } else if (scheme == OGS_PROTECTION_SCHEME_PROFILE_B) {
-                rv = ogs_pem_decode_secp256r1_key(
-                        filename, self.hnet[id].key);
+                rv = ogs_pem_decode_secp256r1_key(filename, key);
+                if (rv != OGS_OK)
+                    ogs_error("ogs_pem_decode_secp256r1_key[%s]"
+                            " failed", filename);
+            } else
+                ogs_error("Invalid scheme [%d]", scheme);
+
+            if (rv == OGS_OK) {
+                if (self.hnet[id].avail)
+                    ogs_ecies_key_clear(&self.hnet[id].key);
+                rv = ogs_ecies_key_setup(&self.hnet[id].key, scheme, key);
                 if (rv == OGS_OK) {
                     self.hnet[id].avail = true;
                     self.hnet[id].scheme = scheme;
                 } else {
-                    ogs_error("ogs_pem_decode_secp256r1_key[%s]"
-                            " failed", filename);
+                    ogs_error("ogs_ecies_key_setup[%s] failed", filename);
                 }
-            } else
-                ogs_error("Invalid scheme [%d]", scheme);
+            }
+            memset(key, 0, sizeof(key));
         } else
             ogs_error("Invalid home network configuration "
                     "[id:%d, filename:%s]", id, filename);
@@ -1266,8 +1334,128 @@ void ogs_sbi_nf_instance_set_id(ogs_sbi_nf_instance_t *nf_instance, char *id)
     ogs_assert(nf_instance);
     ogs_assert(id);
 
+    if (nf_instance->id) {
+        if (ogs_hash_get(nf_instance_id_hash,
+                    nf_instance->id, OGS_HASH_KEY_STRING) == nf_instance)
+            ogs_hash_set(nf_instance_id_hash,
+                    nf_instance->id, OGS_HASH_KEY_STRING, NULL);
+        ogs_free(nf_instance->id);
+    }
+
     nf_instance->id = ogs_strdup(id);
     ogs_assert(nf_instance->id);
+
+    ogs_hash_set(nf_instance_id_hash,
+            nf_instance->id, OGS_HASH_KEY_STRING, nf_instance);
+}
+
+static void nf_index_set_uncovered(
+        ogs_sbi_nf_instance_t *nf_instance, uint8_t uncovered)
+{
+    int i;
+
+    ogs_assert(nf_instance);
+    ogs_assert(nf_instance->nf_type);
+
+    for (i = 0; i < MAX_NUM_OF_NF_INDEX; i++) {
+        if (nf_instance->index_uncovered & (1 << i))
+            nf_index_uncovered[nf_instance->nf_type][i]--;
+        if (uncovered & (1 << i))
+            nf_index_uncovered[nf_instance->nf_type][i]++;
+    }
+
+    nf_instance->index_uncovered = uncovered;
+}
+
+static void nf_index_add(ogs_sbi_nf_instance_t *nf_instance, char *key)
+{
+    nf_index_t *index = NULL;
+    ogs_sbi_nf_index_node_t *node = NULL;
+
+    ogs_assert(nf_instance);
+    ogs_assert(key);
+
+    index = ogs_hash_get(nf_index_hash, key, OGS_HASH_KEY_STRING);
+    if (index) {
+        ogs_list_for_each_entry(
+                &nf_instance->index_list, node, instance_lnode) {
+            if (node->index == index)
+                return;
+        }
+    } else {
+        index = ogs_calloc(1, sizeof(*index));
+        ogs_assert(index);
+        index->key = ogs_strdup(key);
+        ogs_assert(index->key);
+        ogs_hash_set(nf_index_hash, index->key, OGS_HASH_KEY_STRING, index);
+    }
+
+    node = ogs_calloc(1, sizeof(*node));
+    ogs_assert(node);
+    node->index = index;
+    node->nf_instance = nf_instance;
+
+    ogs_list_add(&index->list, node);
+    index->count++;
+    ogs_list_add(&nf_instance->index_list, &node->instance_lnode);
+}
+
+static void nf_index_remove_all(ogs_sbi_nf_instance_t *nf_instance)
+{
+    ogs_sbi_nf_index_node_t *node = NULL, *next_node = NULL;
+
+    ogs_assert(nf_instance);
+
+    ogs_list_for_each_entry_safe(
+            &nf_instance->index_list, next_node, node, instance_lnode) {
+        nf_index_t *index = node->index;
+
+        ogs_assert(index);
+        ogs_list_remove(&index->list, node);
+        if (--index->count == 0) {
+            ogs_hash_set(nf_index_hash, index->key, OGS_HASH_KEY_STRING, NULL);
+            ogs_free(index->key);
+            ogs_free(index);
+        }
+
+        ogs_list_remove(&nf_instance->index_list, &node->instance_lnode);
+        ogs_free(node);
+    }
+}
+
+static char *nf_index_plmn_key(char *key,
+        OpenAPI_nf_type_e nf_type, ogs_plmn_id_t *plmn_id)
+{
+    ogs_snprintf(key, NF_INDEX_KEY_LEN, "%d:plmn:%06x",
+            nf_type, ogs_plmn_id_hexdump(plmn_id));
+    return key;
+}
+
+static char *nf_index_s_nssai_key(char *key,
+        OpenAPI_nf_type_e nf_type, ogs_s_nssai_t *s_nssai)
+{
+    ogs_snprintf(key, NF_INDEX_KEY_LEN, "%d:s-nssai:%d:%06x",
+            nf_type, s_nssai->sst, s_nssai->sd.v);
+    return key;
+}
+
+/* DNNs are compared case-insensitively */
+static char *nf_index_dnn_key(char *key, OpenAPI_nf_type_e nf_type, char *dnn)
+{
+    char *p;
+
+    ogs_snprintf(key, NF_INDEX_KEY_LEN, "%d:dnn:%s", nf_type, dnn);
+    for (p = key; *p; p++)
+        *p = tolower((unsigned char)*p);
+    return key;
+}
+
+static char *nf_index_tai_key(char *key,
+        OpenAPI_nf_type_e nf_type, ogs_5gs_tai_t *tai)
+{
+    ogs_snprintf(key, NF_INDEX_KEY_LEN, "%d:tai:%06x:%d",
+            nf_type, ogs_plmn_id_hexdump(&tai->plmn_id), tai->tac.v);
+    return key;
 }
 
 void ogs_sbi_nf_instance_set_type(
@@ -1275,8 +1463,27 @@ void ogs_sbi_nf_instance_set_type(
 {
     ogs_assert(nf_instance);
     ogs_assert(nf_type);
+    ogs_assert(nf_type < OGS_SBI_MAX_NUM_OF_NF_TYPE);
+
+    if (nf_instance->nf_type == nf_type)
+        return;
+
+    if (nf_instance->nf_type) {
+        ogs_list_remove(&nf_instance_type_list[nf_instance->nf_type],
+                &nf_instance->type_node);
+        nf_instance_type_count[nf_instance->nf_type]--;
+
+        nf_index_remove_all(nf_instance);
+        nf_index_set_uncovered(nf_instance, 0);
+    }
 
     nf_instance->nf_type = nf_type;
+    nf_instance->type_node.nf_instance = nf_instance;
+    ogs_list_add(&nf_instance_type_list[nf_type], &nf_instance->type_node);
+    nf_instance_type_count[nf_type]++;
+
+    /* Left out of the discovery indexes until they are updated */
+    nf_index_set_uncovered(nf_instance, NF_INDEX_ALL);
 }
 
 void ogs_sbi_nf_instance_set_status(
@@ -1359,6 +1566,14 @@ void ogs_sbi_nf_instance_remove(ogs_sbi_nf_instance_t *nf_instance)
             nf_instance->id);
 
     ogs_list_remove(&ogs_sbi_self()->nf_instance_list, nf_instance);
+    if (nf_instance->nf_type) {
+        ogs_list_remove(&nf_instance_type_list[nf_instance->nf_type],
+                &nf_instance->type_node);
+        nf_instance_type_count[nf_instance->nf_type]--;
+
+        nf_index_remove_all(nf_instance);
+        nf_index_set_uncovered(nf_instance, 0);
+    }
 
     ogs_sbi_nf_info_remove_all(&nf_instance->nf_info_list);
 
@@ -1367,7 +1582,12 @@ void ogs_sbi_nf_instance_remove(ogs_sbi_nf_instance_t *nf_instance)
     ogs_sbi_nf_instance_clear(nf_instance);
 
     if (nf_instance->id) {
+        if (ogs_hash_get(nf_instance_id_hash,
+                    nf_instance->id, OGS_HASH_KEY_STRING) == nf_instance)
+            ogs_hash_set(nf_instance_id_hash,
+                    nf_instance->id, OGS_HASH_KEY_STRING, NULL);
         ogs_sbi_subscription_data_remove_all_by_nf_instance_id(nf_instance->id);
+        ogs_sbi_discovery_cache_remove_by_nf_instance_id(nf_instance->id);
         ogs_free(nf_instance->id);
     }
 
@@ -1407,25 +1627,146 @@ ogs_sbi_nf_instance_t *ogs_sbi_nf_instance_find(char *id)
      */
     if (!id) return NULL;
 
-    ogs_list_for_each(&ogs_sbi_self()->nf_instance_list, nf_instance) {
-        if (nf_instance->id && strcmp(nf_instance->id, id) == 0)
-            break;
-    }
+    nf_instance = ogs_hash_get(nf_instance_id_hash, id, OGS_HASH_KEY_STRING);
 
     return nf_instance;
 }
 
+/*
+ * Rebuild the discovery indexes of an NF instance from its PLMN list
+ * and smfInfo. To be called whenever either of them is changed.
+ */
+void ogs_sbi_nf_instance_update_index(ogs_sbi_nf_instance_t *nf_instance)
+{
+    char key[NF_INDEX_KEY_LEN];
+    ogs_sbi_nf_info_t *nf_info = NULL;
+    uint8_t uncovered = 0;
+    bool smf_info_presence = false;
+    int i, j;
+
+    ogs_assert(nf_instance);
+
+    if (!nf_instance->nf_type)
+        return;
+
+    nf_index_remove_all(nf_instance);
+
+    for (i = 0; i < nf_instance->num_of_plmn_id; i++)
+        nf_index_add(nf_instance, nf_index_plmn_key(
+                    key, nf_instance->nf_type, &nf_instance->plmn_id[i]));
+
+    if (nf_instance->nf_type == OpenAPI_nf_type_SMF) {
+        ogs_list_for_each(&nf_instance->nf_info_list, nf_info) {
+            ogs_sbi_smf_info_t *smf_info = &nf_info->smf;
+
+            if (nf_info->nf_type != OpenAPI_nf_type_SMF)
+                continue;
+
+            smf_info_presence = true;
+
+            for (i = 0; i < smf_info->num_of_slice; i++) {
+                nf_index_add(nf_instance, nf_index_s_nssai_key(
+                            key, nf_instance->nf_type,
+                            &smf_info->slice[i].s_nssai));
+                for (j = 0; j < smf_info->slice[i].num_of_dnn; j++)
+                    nf_index_add(nf_instance, nf_index_dnn_key(
+                                key, nf_instance->nf_type,
+                                smf_info->slice[i].dnn[j]));
+            }
+
+            /* Any TAI, or TAC ranges */
+            if (smf_info->num_of_nr_tai == 0 ||
+                smf_info->num_of_nr_tai_range)
+                uncovered |= 1 << NF_INDEX_TAI;
+
+            for (i = 0; i < smf_info->num_of_nr_tai; i++)
+                nf_index_add(nf_instance, nf_index_tai_key(
+                            key, nf_instance->nf_type, &smf_info->nr_tai[i]));
+        }
+
+        if (smf_info_presence == false)
+            uncovered |= (1 << NF_INDEX_S_NSSAI) |
+                (1 << NF_INDEX_DNN) | (1 << NF_INDEX_TAI);
+    }
+
+    nf_index_set_uncovered(nf_instance, uncovered);
+}
+
+static void nf_index_select(ogs_list_t **list, int *count,
+        OpenAPI_nf_type_e nf_type, nf_index_e dimension, char *key)
+{
+    nf_index_t *index = NULL;
+
+    if (nf_index_uncovered[nf_type][dimension])
+        return;
+
+    index = ogs_hash_get(nf_index_hash, key, OGS_HASH_KEY_STRING);
+    if (!index) {
+        *list = &nf_index_empty_list;
+        *count = 0;
+    } else if (index->count < *count) {
+        *list = &index->list;
+        *count = index->count;
+    }
+}
+
+/*
+ * The smallest list of ogs_sbi_nf_index_node_t that holds every NF
+ * instance of the NF-Type that may match the discovery option.
+ * The candidates still have to be matched against the option.
+ */
+ogs_list_t *ogs_sbi_nf_instance_index_list(
+        OpenAPI_nf_type_e nf_type,
+        ogs_sbi_discovery_option_t *discovery_option)
+{
+    char key[NF_INDEX_KEY_LEN];
+    ogs_list_t *list = NULL;
+    int count;
+
+    ogs_assert(nf_type < OGS_SBI_MAX_NUM_OF_NF_TYPE);
+
+    list = &nf_instance_type_list[nf_type];
+    count = nf_instance_type_count[nf_type];
+
+    if (!discovery_option)
+        return list;
+
+    /* With several target PLMNs, any of them matches */
+    if (discovery_option->num_of_target_plmn_list == 1)
+        nf_index_select(&list, &count, nf_type, NF_INDEX_PLMN,
+                nf_index_plmn_key(key, nf_type,
+                    &discovery_option->target_plmn_list[0]));
+
+    if (nf_type == OpenAPI_nf_type_SMF) {
+        if (discovery_option->num_of_snssais && discovery_option->dnn) {
+            nf_index_select(&list, &count, nf_type, NF_INDEX_S_NSSAI,
+                    nf_index_s_nssai_key(key, nf_type,
+                        &discovery_option->snssais[0]));
+            nf_index_select(&list, &count, nf_type, NF_INDEX_DNN,
+                    nf_index_dnn_key(key, nf_type, discovery_option->dnn));
+        }
+        if (discovery_option->tai_presence)
+            nf_index_select(&list, &count, nf_type, NF_INDEX_TAI,
+                    nf_index_tai_key(key, nf_type, &discovery_option->tai));
+    }
+
+    return list;
+}
+
 ogs_sbi_nf_instance_t *ogs_sbi_nf_instance_find_by_discovery_param(
         OpenAPI_nf_type_e target_nf_type,
         OpenAPI_nf_type_e requester_nf_type,
         ogs_sbi_discovery_option_t *discovery_option)
 {
-    ogs_sbi_nf_instance_t *nf_instance = NULL;
+    ogs_sbi_nf_index_node_t *node = NULL;
 
     ogs_assert(target_nf_type);
     ogs_assert(requester_nf_type);
 
-    ogs_list_for_each(&ogs_sbi_self()->nf_instance_list, nf_instance) {
+    ogs_list_for_each(ogs_sbi_nf_instance_index_list(
+                target_nf_type, discovery_option), node) {
+        ogs_sbi_nf_instance_t *nf_instance = node->nf_instance;
+
         if (ogs_sbi_discovery_param_is_matched(
                     nf_instance, target_nf_type, requester_nf_type,
                     discovery_option) == false)
@@ -1920,6 +2261,8 @@ void ogs_sbi_nf_instance_build_default(ogs_sbi_nf_instance_t *nf_instance)
                 sizeof(nf_instance->plmn_id));
         nf_instance->num_of_plmn_id = ogs_local_conf()->num_of_serving_plmn_id;
     }
+
+    ogs_sbi_nf_instance_update_index(nf_instance);
 }
 
 ogs_sbi_nf_service_t *ogs_sbi_nf_service_build_default(
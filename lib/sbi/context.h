@@ -62,7 +62,7 @@ typedef struct ogs_sbi_context_s {
     struct {
         uint8_t avail;
         uint8_t scheme;
-        uint8_t key[OGS_ECCKEY_LEN]; /* 32 bytes Private Key */
+        ogs_ecies_key_t key; /* Private Key loaded once at start-up */
     } hnet[OGS_HOME_NETWORK_PKI_VALUE_MAX+1]; /* PKI Value : 1 ~ 254 */
 
     struct {
@@ -110,8 +110,19 @@ typedef struct ogs_sbi_context_s {
     const char *service_name[OGS_SBI_MAX_NUM_OF_SERVICE_TYPE];
 } ogs_sbi_context_t;
 
+/* Entry of an NF instance in one of the NF-Type or discovery indexes */
+typedef struct ogs_sbi_nf_index_node_s {
+    ogs_lnode_t lnode;                      /* Index list */
+    ogs_lnode_t instance_lnode;             /* nf_instance->index_list */
+    void *index;
+    ogs_sbi_nf_instance_t *nf_instance;
+} ogs_sbi_nf_index_node_t;
+
 typedef struct ogs_sbi_nf_instance_s {
     ogs_lnode_t lnode;
+    ogs_sbi_nf_index_node_t type_node;      /* NF-Type index */
+    ogs_list_t index_list;                  /* PLMN/S-NSSAI/DNN/TAI index */
+    uint8_t index_uncovered;                /* Dimensions left out of it */
 
     ogs_fsm_t sm;                           /* A state machine */
     ogs_timer_t *t_registration_interval;   /* timer to retry
@@ -456,6 +467,10 @@ void ogs_sbi_nf_instance_clear(ogs_sbi_nf_instance_t *nf_instance);
 void ogs_sbi_nf_instance_remove(ogs_sbi_nf_instance_t *nf_instance);
 void ogs_sbi_nf_instance_remove_all(void);
 ogs_sbi_nf_instance_t *ogs_sbi_nf_instance_find(char *id);
+void ogs_sbi_nf_instance_update_index(ogs_sbi_nf_instance_t *nf_instance);
+ogs_list_t *ogs_sbi_nf_instance_index_list(
+        OpenAPI_nf_type_e nf_type,
+        ogs_sbi_discovery_option_t *discovery_option);
 ogs_sbi_nf_instance_t *ogs_sbi_nf_instance_find_by_discovery_param(
         OpenAPI_nf_type_e nf_type,
         OpenAPI_nf_type_e requester_nf_type,
@@ -0,0 +1,396 @@
+/*
+ * Copyright (C) 2019-2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-sbi.h"
+
+static int cache_initialized = 0;
+
+static OGS_POOL(cache_pool, ogs_sbi_discovery_cache_t);
+static ogs_hash_t *cache_hash;
+static ogs_list_t cache_list;
+
+void ogs_sbi_discovery_cache_init(int size)
+{
+    ogs_assert(cache_initialized == 0);
+
+    ogs_list_init(&cache_list);
+    ogs_pool_init(&cache_pool, size);
+
+    cache_hash = ogs_hash_make();
+    ogs_assert(cache_hash);
+
+    cache_initialized = 1;
+}
+
+void ogs_sbi_discovery_cache_final(void)
+{
+    ogs_assert(cache_initialized == 1);
+
+    ogs_sbi_discovery_cache_remove_all();
+
+    ogs_assert(cache_hash);
+    ogs_hash_destroy(cache_hash);
+
+    ogs_pool_final(&cache_pool);
+
+    cache_initialized = 0;
+}
+
+static int compare_string(const void *a, const void *b)
+{
+    return strcmp(*(const char **)a, *(const char **)b);
+}
+
+static int compare_uint32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static char *key_add_plmn_list(
+        char *key, const char *name, ogs_plmn_id_t *plmn_list, int num)
+{
+    uint32_t value[OGS_MAX_NUM_OF_PLMN];
+    int i;
+
+    ogs_assert(num <= OGS_MAX_NUM_OF_PLMN);
+
+    if (!num)
+        return key;
+
+    for (i = 0; i < num; i++)
+        value[i] = ogs_plmn_id_hexdump(&plmn_list[i]);
+    qsort(value, num, sizeof(value[0]), compare_uint32);
+
+    key = ogs_mstrcatf(key, "|%s=", name);
+    for (i = 0; i < num; i++)
+        key = ogs_mstrcatf(key, "%s%06x", i ? "," : "", value[i]);
+
+    return key;
+}
+
+/*
+ * Build a key that is independent of the order in which service names,
+ * S-NSSAIs and PLMNs were added to the discovery option.
+ */
+char *ogs_sbi_discovery_cache_key(
+        OpenAPI_nf_type_e target_nf_type,
+        OpenAPI_nf_type_e requester_nf_type,
+        ogs_sbi_discovery_option_t *discovery_option)
+{
+    char *key = NULL;
+    int i;
+
+    ogs_assert(target_nf_type);
+    ogs_assert(requester_nf_type);
+
+    key = ogs_msprintf("%d:%d", target_nf_type, requester_nf_type);
+    ogs_assert(key);
+
+    if (!discovery_option)
+        return key;
+
+    if (discovery_option->target_nf_instance_id)
+        key = ogs_mstrcatf(key, "|tid=%s",
+                discovery_option->target_nf_instance_id);
+    if (discovery_option->requester_nf_instance_id)
+        key = ogs_mstrcatf(key, "|rid=%s",
+                discovery_option->requester_nf_instance_id);
+
+    if (discovery_option->num_of_service_names) {
+        char *service_names[OGS_SBI_MAX_NUM_OF_SERVICE_TYPE];
+        int num = discovery_option->num_of_service_names;
+
+        memcpy(service_names, discovery_option->service_names,
+                sizeof(service_names[0]) * num);
+        qsort(service_names, num, sizeof(service_names[0]), compare_string);
+
+        key = ogs_mstrcatf(key, "|svc=");
+        for (i = 0; i < num; i++)
+            key = ogs_mstrcatf(key, "%s%s", i ? "," : "", service_names[i]);
+    }
+
+    if (discovery_option->num_of_snssais) {
+        uint32_t snssais[OGS_MAX_NUM_OF_SLICE];
+        int num = discovery_option->num_of_snssais;
+
+        for (i = 0; i < num; i++)
+            snssais[i] = (discovery_option->snssais[i].sst << 24) |
+                (discovery_option->snssais[i].sd.v & 0xffffff);
+        qsort(snssais, num, sizeof(snssais[0]), compare_uint32);
+
+        key = ogs_mstrcatf(key, "|nssai=");
+        for (i = 0; i < num; i++)
+            key = ogs_mstrcatf(key, "%s%08x", i ? "," : "", snssais[i]);
+    }
+
+    if (discovery_option->dnn)
+        key = ogs_mstrcatf(key, "|dnn=%s", discovery_option->dnn);
+
+    if (discovery_option->tai_presence)
+        key = ogs_mstrcatf(key, "|tai=%06x:%06x",
+                ogs_plmn_id_hexdump(&discovery_option->tai.plmn_id),
+                discovery_option->tai.tac.v);
+
+    if (discovery_option->guami_presence)
+        key = ogs_mstrcatf(key, "|guami=%06x:%06x",
+                ogs_plmn_id_hexdump(&discovery_option->guami.plmn_id),
+                ogs_amf_id_hexdump(&discovery_option->guami.amf_id));
+
+    key = key_add_plmn_list(key, "tplmn",
+            discovery_option->target_plmn_list,
+            discovery_option->num_of_target_plmn_list);
+    key = key_add_plmn_list(key, "rplmn",
+            discovery_option->requester_plmn_list,
+            discovery_option->num_of_requester_plmn_list);
+
+    if (discovery_option->hnrf_uri)
+        key = ogs_mstrcatf(key, "|hnrf=%s", discovery_option->hnrf_uri);
+
+    if (discovery_option->requester_features)
+        key = ogs_mstrcatf(key, "|feat=%llx",
+                (unsigned long long)discovery_option->requester_features);
+
+    ogs_assert(key);
+    return key;
+}
+
+static void cache_clear(ogs_sbi_discovery_cache_t *cache)
+{
+    int i;
+
+    ogs_assert(cache);
+
+    for (i = 0; i < cache->num_of_nf_instance_id; i++) {
+        ogs_assert(cache->nf_instance_id[i]);
+        ogs_free(cache->nf_instance_id[i]);
+        cache->nf_instance_id[i] = NULL;
+    }
+    cache->num_of_nf_instance_id = 0;
+}
+
+ogs_sbi_discovery_cache_t *ogs_sbi_discovery_cache_update(
+        OpenAPI_nf_type_e target_nf_type,
+        OpenAPI_nf_type_e requester_nf_type,
+        ogs_sbi_discovery_option_t *discovery_option,
+        OpenAPI_search_result_t *SearchResult)
+{
+    ogs_sbi_discovery_cache_t *cache = NULL;
+    OpenAPI_lnode_t *node = NULL;
+    char *key = NULL;
+    int validity;
+
+    ogs_assert(target_nf_type);
+    ogs_assert(requester_nf_type);
+    ogs_assert(SearchResult);
+
+    if (!cache_initialized)
+        return NULL;
+
+    key = ogs_sbi_discovery_cache_key(
+            target_nf_type, requester_nf_type, discovery_option);
+    ogs_assert(key);
+
+    cache = ogs_hash_get(cache_hash, key, OGS_HASH_KEY_STRING);
+    if (cache) {
+        ogs_free(key);
+        cache_clear(cache);
+    } else {
+        ogs_pool_alloc(&cache_pool, &cache);
+        if (!cache && ogs_list_first(&cache_list)) {
+            /* Evict the oldest entry */
+            ogs_sbi_discovery_cache_remove(ogs_list_first(&cache_list));
+            ogs_pool_alloc(&cache_pool, &cache);
+        }
+        if (!cache) {
+            ogs_error("ogs_pool_alloc() failed");
+            ogs_free(key);
+            return NULL;
+        }
+        memset(cache, 0, sizeof *cache);
+
+        cache->key = key;
+        cache->target_nf_type = target_nf_type;
+
+        ogs_hash_set(cache_hash, cache->key, OGS_HASH_KEY_STRING, cache);
+        ogs_list_add(&cache_list, cache);
+    }
+
+    OpenAPI_list_for_each(SearchResult->nf_instances, node) {
+        OpenAPI_nf_profile_t *NFProfile = node->data;
+
+        if (!NFProfile || !NFProfile->nf_instance_id)
+            continue;
+        if (NFProfile->nf_type != target_nf_type)
+            continue;
+        if (NF_INSTANCE_ID_IS_SELF(NFProfile->nf_instance_id))
+            continue;
+        if (cache->num_of_nf_instance_id >=
+                OGS_SBI_DISCOVERY_CACHE_MAX_NF_INSTANCE)
+            break;
+
+        cache->nf_instance_id[cache->num_of_nf_instance_id] =
+            ogs_strdup(NFProfile->nf_instance_id);
+        ogs_assert(cache->nf_instance_id[cache->num_of_nf_instance_id]);
+        cache->num_of_nf_instance_id++;
+    }
+
+    if (cache->num_of_nf_instance_id) {
+        if (SearchResult->is_validity_period && SearchResult->validity_period)
+            validity = SearchResult->validity_period;
+        else
+            validity = ogs_local_conf()->time.discovery.validity_duration;
+    } else {
+        validity = ogs_local_conf()->time.discovery.negative_duration;
+    }
+
+    if (validity <= 0) {
+        ogs_sbi_discovery_cache_remove(cache);
+        return NULL;
+    }
+
+    cache->expires = ogs_get_monotonic_time() + ogs_time_from_sec(validity);
+
+    /* Keep the list ordered by insertion time for eviction */
+    ogs_list_remove(&cache_list, cache);
+    ogs_list_add(&cache_list, cache);
+
+    ogs_debug("[%s] Discovery cached [num:%d validity:%ds]",
+            cache->key, cache->num_of_nf_instance_id, validity);
+
+    return cache;
+}
+
+ogs_sbi_discovery_cache_t *ogs_sbi_discovery_cache_find(
+        OpenAPI_nf_type_e target_nf_type,
+        OpenAPI_nf_type_e requester_nf_type,
+        ogs_sbi_discovery_option_t *discovery_option)
+{
+    ogs_sbi_discovery_cache_t *cache = NULL;
+    char *key = NULL;
+
+    ogs_assert(target_nf_type);
+    ogs_assert(requester_nf_type);
+
+    if (!cache_initialized)
+        return NULL;
+
+    key = ogs_sbi_discovery_cache_key(
+            target_nf_type, requester_nf_type, discovery_option);
+    ogs_assert(key);
+
+    cache = ogs_hash_get(cache_hash, key, OGS_HASH_KEY_STRING);
+    ogs_free(key);
+
+    if (cache && cache->expires <= ogs_get_monotonic_time()) {
+        ogs_sbi_discovery_cache_remove(cache);
+        cache = NULL;
+    }
+
+    return cache;
+}
+
+/*
+ * The profile of a cached NF instance may have been updated since
+ * the discovery, so it is matched again as a fresh lookup would.
+ */
+ogs_sbi_nf_instance_t *ogs_sbi_discovery_cache_find_nf_instance(
+        ogs_sbi_discovery_cache_t *cache,
+        OpenAPI_nf_type_e requester_nf_type,
+        ogs_sbi_discovery_option_t *discovery_option)
+{
+    ogs_sbi_nf_instance_t *nf_instance = NULL;
+    int i;
+
+    ogs_assert(cache);
+
+    for (i = 0; i < cache->num_of_nf_instance_id; i++) {
+        nf_instance = ogs_sbi_nf_instance_find(cache->nf_instance_id[i]);
+        if (!nf_instance)
+            continue;
+        if (ogs_sbi_discovery_param_is_matched(
+                    nf_instance, cache->target_nf_type, requester_nf_type,
+                    discovery_option) == false)
+            continue;
+
+        return nf_instance;
+    }
+
+    return NULL;
+}
+
+void ogs_sbi_discovery_cache_remove(ogs_sbi_discovery_cache_t *cache)
+{
+    ogs_assert(cache);
+
+    ogs_list_remove(&cache_list, cache);
+    ogs_hash_set(cache_hash, cache->key, OGS_HASH_KEY_STRING, NULL);
+
+    cache_clear(cache);
+    ogs_free(cache->key);
+
+    ogs_pool_free(&cache_pool, cache);
+}
+
+void ogs_sbi_discovery_cache_remove_all(void)
+{
+    ogs_sbi_discovery_cache_t *cache = NULL, *next_cache = NULL;
+
+    ogs_list_for_each_safe(&cache_list, next_cache, cache)
+        ogs_sbi_discovery_cache_remove(cache);
+}
+
+void ogs_sbi_discovery_cache_remove_by_nf_instance_id(char *nf_instance_id)
+{
+    ogs_sbi_discovery_cache_t *cache = NULL, *next_cache = NULL;
+    int i;
+
+    ogs_assert(nf_instance_id);
+
+    if (!cache_initialized)
+        return;
+
+    ogs_list_for_each_safe(&cache_list, next_cache, cache) {
+        for (i = 0; i < cache->num_of_nf_instance_id; i++) {
+            if (strcmp(cache->nf_instance_id[i], nf_instance_id) == 0) {
+                ogs_sbi_discovery_cache_remove(cache);
+                break;
+            }
+        }
+    }
+}
+
+void ogs_sbi_discovery_cache_remove_negative(OpenAPI_nf_type_e nf_type)
+{
+    ogs_sbi_discovery_cache_t *cache = NULL, *next_cache = NULL;
+
+    if (!cache_initialized)
+        return;
+
+    ogs_list_for_each_safe(&cache_list, next_cache, cache) {
+        if (cache->num_of_nf_instance_id)
+            continue;
+        if (nf_type && cache->target_nf_type != nf_type)
+            continue;
+
+        ogs_sbi_discovery_cache_remove(cache);
+    }
+}
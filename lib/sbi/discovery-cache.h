@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2019-2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if !defined(OGS_SBI_INSIDE) && !defined(OGS_SBI_COMPILATION)
+#error "This header cannot be included directly."
+#endif
+
+#ifndef OGS_SBI_DISCOVERY_CACHE_H
+#define OGS_SBI_DISCOVERY_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Consumer-side cache of NFDiscover results.
+ *
+ * Entries are keyed by target/requester NF type and the normalized
+ * discovery option, and live for the SearchResult validityPeriod.
+ * An empty SearchResult is cached as a negative entry so that repeated
+ * lookups for a missing NF do not hit the NRF on every request.
+ */
+
+#define OGS_SBI_DISCOVERY_CACHE_MAX_NF_INSTANCE 8
+
+typedef struct ogs_sbi_discovery_cache_s {
+    ogs_lnode_t lnode;
+
+    char *key;
+    OpenAPI_nf_type_e target_nf_type;
+    ogs_time_t expires;
+
+    int num_of_nf_instance_id;
+    char *nf_instance_id[OGS_SBI_DISCOVERY_CACHE_MAX_NF_INSTANCE];
+} ogs_sbi_discovery_cache_t;
+
+void ogs_sbi_discovery_cache_init(int size);
+void ogs_sbi_discovery_cache_final(void);
+
+char *ogs_sbi_discovery_cache_key(
+        OpenAPI_nf_type_e target_nf_type,
+        OpenAPI_nf_type_e requester_nf_type,
+        ogs_sbi_discovery_option_t *discovery_option);
+
+ogs_sbi_discovery_cache_t *ogs_sbi_discovery_cache_update(
+        OpenAPI_nf_type_e target_nf_type,
+        OpenAPI_nf_type_e requester_nf_type,
+        ogs_sbi_discovery_option_t *discovery_option,
+        OpenAPI_search_result_t *SearchResult);
+ogs_sbi_discovery_cache_t *ogs_sbi_discovery_cache_find(
+        OpenAPI_nf_type_e target_nf_type,
+        OpenAPI_nf_type_e requester_nf_type,
+        ogs_sbi_discovery_option_t *discovery_option);
+ogs_sbi_nf_instance_t *ogs_sbi_discovery_cache_find_nf_instance(
+        ogs_sbi_discovery_cache_t *cache,
+        OpenAPI_nf_type_e requester_nf_type,
+        ogs_sbi_discovery_option_t *discovery_option);
+
+void ogs_sbi_discovery_cache_remove(ogs_sbi_discovery_cache_t *cache);
+void ogs_sbi_discovery_cache_remove_all(void);
+void ogs_sbi_discovery_cache_remove_by_nf_instance_id(char *nf_instance_id);
+void ogs_sbi_discovery_cache_remove_negative(OpenAPI_nf_type_e nf_type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OGS_SBI_DISCOVERY_CACHE_H */
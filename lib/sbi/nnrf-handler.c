@@ -86,7 +86,7 @@ void ogs_nnrf_nfm_handle_nf_profile(
 
     ogs_sbi_nf_instance_clear(nf_instance);
 
-    nf_instance->nf_type = NFProfile->nf_type;
+    ogs_sbi_nf_instance_set_type(nf_instance, NFProfile->nf_type);
     nf_instance->nf_status = NFProfile->nf_status;
     if (NFProfile->is_heart_beat_timer == true)
         nf_instance->time.heartbeat_interval = NFProfile->heart_beat_timer;
@@ -286,6 +286,8 @@ void ogs_nnrf_nfm_handle_nf_profile(
         handle_scp_info(nf_instance, NFProfile->scp_info);
     if (NFProfile->sepp_info)
         handle_sepp_info(nf_instance, NFProfile->sepp_info);
+
+    ogs_sbi_nf_instance_update_index(nf_instance);
 }
 
 static void handle_nf_service(
@@ -1155,6 +1157,10 @@ bool ogs_nnrf_nfm_handle_nf_status_notify(
                     nf_instance->id,
                     OpenAPI_nf_type_ToString(nf_instance->nf_type));
 
+        /* Cached discovery results may no longer reflect this profile */
+        ogs_sbi_discovery_cache_remove_by_nf_instance_id(nf_instance->id);
+        ogs_sbi_discovery_cache_remove_negative(nf_instance->nf_type);
+
         ogs_sbi_client_associate(nf_instance);
 
         switch (nf_instance->nf_type) {
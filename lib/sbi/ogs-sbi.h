@@ -117,6 +117,7 @@
 #include "sbi/server.h"
 #include "sbi/client.h"
 #include "sbi/context.h"
+#include "sbi/discovery-cache.h"
 
 #include "sbi/nf-sm.h"
 
@@ -207,6 +207,8 @@ static int client_discover_cb(
                 break;
             }
 
+            ogs_sbi_nf_instance_update_index(nf_instance);
+
             ogs_sbi_nf_fsm_init(nf_instance);
 
             ogs_info("[%s] (SCP-discover) NF registered [%s]",
@@ -303,6 +305,17 @@ int ogs_sbi_discover_and_send(ogs_sbi_xact_t *xact)
         ogs_debug("ogs_sbi_nf_instance_find_by_discovery_param() "
                 "[nf_instance:%p,service_name:%s]",
                 nf_instance, ogs_sbi_service_type_to_name(service_type));
+        if (!nf_instance) {
+            ogs_sbi_discovery_cache_t *cache =
+                ogs_sbi_discovery_cache_find(
+                        target_nf_type, requester_nf_type, discovery_option);
+            if (cache)
+                nf_instance = ogs_sbi_discovery_cache_find_nf_instance(
+                        cache, requester_nf_type, discovery_option);
+            ogs_debug("ogs_sbi_discovery_cache_find() "
+                    "[nf_instance:%p,service_name:%s]",
+                    nf_instance, ogs_sbi_service_type_to_name(service_type));
+        }
         if (nf_instance)
             OGS_SBI_SETUP_NF_INSTANCE(
                     sbi_object->service_type_array[service_type], nf_instance);
@@ -534,6 +547,7 @@ int ogs_sbi_discover_and_send(ogs_sbi_xact_t *xact)
 int ogs_sbi_discover_only(ogs_sbi_xact_t *xact)
 {
     ogs_sbi_nf_instance_t *nf_instance = NULL;
+    ogs_sbi_discovery_cache_t *cache = NULL;
 
     ogs_sbi_object_t *sbi_object = NULL;
     ogs_sbi_service_type_e service_type = OGS_SBI_SERVICE_TYPE_NULL;
@@ -553,6 +567,15 @@ int ogs_sbi_discover_only(ogs_sbi_xact_t *xact)
 
     discovery_option = xact->discovery_option;
 
+    /* Negative cache : the NRF has recently returned an empty SearchResult */
+    cache = ogs_sbi_discovery_cache_find(
+            target_nf_type, requester_nf_type, discovery_option);
+    if (cache && cache->num_of_nf_instance_id == 0) {
+        ogs_error("Cannot discover [%s] (negative cache)",
+                    ogs_sbi_service_type_to_name(service_type));
+        return OGS_NOTFOUND;
+    }
+
     /* NRF NF-Instance */
     nf_instance = ogs_sbi_self()->nrf_instance;
     if (nf_instance) {
@@ -965,6 +988,8 @@ static int sepp_discover_handler(
     }
 
     ogs_nnrf_disc_handle_nf_discover_search_result(message.SearchResult);
+    ogs_sbi_discovery_cache_update(OpenAPI_nf_type_SEPP,
+            xact->requester_nf_type, NULL, message.SearchResult);
 
     /*****************************
      * Check if SEPP is discovered
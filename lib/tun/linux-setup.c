@@ -34,7 +34,7 @@
 #define IFNAMSIZ 32
 #endif
 
-ogs_socket_t ogs_tun_open(char *ifname, int len, int is_tap)
+static ogs_socket_t tun_open(char *ifname, int is_tap, bool multi_queue)
 {
     ogs_socket_t fd = INVALID_SOCKET;
 
@@ -45,6 +45,15 @@ ogs_socket_t ogs_tun_open(char *ifname, int len, int is_tap)
 
     ogs_assert(ifname);
 
+    if (multi_queue) {
+#if defined(IFF_MULTI_QUEUE)
+        flags |= IFF_MULTI_QUEUE;
+#else
+        ogs_error("IFF_MULTI_QUEUE is not supported");
+        return INVALID_SOCKET;
+#endif
+    }
+
     fd = open(dev, O_RDWR);
     if (fd < 0) {
         ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
@@ -71,6 +80,23 @@ cleanup:
     return INVALID_SOCKET;
 }
 
+ogs_socket_t ogs_tun_open(char *ifname, int len, int is_tap)
+{
+    return tun_open(ifname, is_tap, false);
+}
+
+/*
+ * Every queue of a multi-queue TUN/TAP device must be opened
+ * with IFF_MULTI_QUEUE, including the first one. The device is created
+ * as follows when it is persistent.
+ *
+ * $ sudo ip tuntap add name ogstun mode tun multi_queue
+ */
+ogs_socket_t ogs_tun_open_queue(char *ifname, int len, int is_tap)
+{
+    return tun_open(ifname, is_tap, true);
+}
+
 int ogs_tun_set_ip(char *ifname, ogs_ipsubnet_t *gw, ogs_ipsubnet_t *sub)
 {
     return OGS_OK;
@@ -24,30 +24,41 @@
 
 ogs_pkbuf_t *ogs_tun_read(ogs_socket_t fd, ogs_pkbuf_pool_t *packet_pool)
 {
+    /*
+     * Read into the stack of the calling thread first, so that the packet
+     * only takes a cluster of its own size from packet_pool.
+     */
+    uint8_t scratch[OGS_MAX_PKT_LEN-OGS_TUN_MAX_HEADROOM];
+    uint8_t *data = scratch;
     ogs_pkbuf_t *recvbuf = NULL;
     int n;
 
     ogs_assert(fd != INVALID_SOCKET);
 
-    recvbuf = ogs_pkbuf_alloc(packet_pool, OGS_MAX_PKT_LEN);
-    ogs_assert(recvbuf);
-    ogs_pkbuf_reserve(recvbuf, OGS_TUN_MAX_HEADROOM);
-    ogs_pkbuf_put(recvbuf, OGS_MAX_PKT_LEN-OGS_TUN_MAX_HEADROOM);
-
-    n = ogs_read(fd, recvbuf->data, recvbuf->len);
+    n = ogs_read(fd, scratch, sizeof(scratch));
     if (n <= 0) {
         ogs_log_message(OGS_LOG_WARN, ogs_socket_errno, "ogs_read() failed");
-        ogs_pkbuf_free(recvbuf);
         return NULL;
     }
 
-    ogs_pkbuf_trim(recvbuf, n);
-
 #if defined(__APPLE__)
     /* Remove Null/Loopback Header (4bytes) */
-    ogs_pkbuf_pull(recvbuf, 4);
+    if (n <= 4) {
+        ogs_error("Invalid packet [len:%d]", n);
+        return NULL;
+    }
+    data += 4;
+    n -= 4;
 #endif
 
+    recvbuf = ogs_pkbuf_alloc(packet_pool, OGS_TUN_MAX_HEADROOM + n);
+    if (!recvbuf) {
+        ogs_error("ogs_pkbuf_alloc() failed [len:%d]", n);
+        return NULL;
+    }
+    ogs_pkbuf_reserve(recvbuf, OGS_TUN_MAX_HEADROOM);
+    ogs_pkbuf_put_data(recvbuf, data, n);
+
     return recvbuf;
 }
 
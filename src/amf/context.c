@@ -41,6 +41,9 @@ static void stats_remove_ran_ue(void);
 static void stats_add_amf_session(void);
 static void stats_remove_amf_session(void);
 static bool amf_namf_comm_parse_guti(ogs_nas_5gs_guti_t *guti, char *ue_context_id);
+static void gnb_paging_area_clear(amf_gnb_t *gnb);
+static void ran_ue_hash_add(amf_gnb_t *gnb, ran_ue_t *ran_ue);
+static void ran_ue_hash_remove(amf_gnb_t *gnb, ran_ue_t *ran_ue);
 
 void amf_context_init(void)
 {
@@ -77,11 +80,13 @@ void amf_context_init(void)
     ogs_assert(self.gnb_addr_hash);
     self.gnb_id_hash = ogs_hash_make();
     ogs_assert(self.gnb_id_hash);
-    self.guti_ue_hash = ogs_hash_make();
+    self.paging_area_hash = ogs_hash_make();
+    ogs_assert(self.paging_area_hash);
+    self.guti_ue_hash = ogs_hash_make_size(ogs_global_conf()->max.ue);
     ogs_assert(self.guti_ue_hash);
-    self.suci_hash = ogs_hash_make();
+    self.suci_hash = ogs_hash_make_size(ogs_global_conf()->max.ue);
     ogs_assert(self.suci_hash);
-    self.supi_hash = ogs_hash_make();
+    self.supi_hash = ogs_hash_make_size(ogs_global_conf()->max.ue);
     ogs_assert(self.supi_hash);
 
     context_initialized = 1;
@@ -98,6 +103,8 @@ void amf_context_final(void)
     ogs_hash_destroy(self.gnb_addr_hash);
     ogs_assert(self.gnb_id_hash);
     ogs_hash_destroy(self.gnb_id_hash);
+    ogs_assert(self.paging_area_hash);
+    ogs_hash_destroy(self.paging_area_hash);
 
     ogs_assert(self.guti_ue_hash);
     ogs_hash_destroy(self.guti_ue_hash);
@@ -1263,6 +1270,8 @@ amf_gnb_t *amf_gnb_add(ogs_sock_t *sock, ogs_sockaddr_t *addr)
     gnb->ostream_id = 0;
 
     ogs_list_init(&gnb->ran_ue_list);
+    gnb->ran_ue_hash = ogs_hash_make();
+    ogs_assert(gnb->ran_ue_hash);
 
     ogs_hash_set(self.gnb_addr_hash,
             gnb->sctp.addr, sizeof(ogs_sockaddr_t), gnb);
@@ -1298,6 +1307,11 @@ void amf_gnb_remove(amf_gnb_t *gnb)
     if (gnb->gnb_id_presence == true)
         ogs_hash_set(self.gnb_id_hash, &gnb->gnb_id, sizeof(gnb->gnb_id), NULL);
 
+    gnb_paging_area_clear(gnb);
+
+    ogs_assert(gnb->ran_ue_hash);
+    ogs_hash_destroy(gnb->ran_ue_hash);
+
     ogs_sctp_flush_and_destroy(&gnb->sctp);
 
     ogs_pool_id_free(&amf_gnb_pool, gnb);
@@ -1363,6 +1377,100 @@ amf_gnb_t *amf_gnb_find_by_id(ogs_pool_id_t id)
     return ogs_pool_find_by_id(&amf_gnb_pool, id);
 }
 
+static void gnb_paging_area_clear(amf_gnb_t *gnb)
+{
+    int i;
+
+    ogs_assert(gnb);
+
+    for (i = 0; i < gnb->num_of_paging_area; i++) {
+        amf_paging_area_t *area = gnb->paging_area[i];
+        amf_paging_gnb_t *node = NULL, *next_node = NULL;
+
+        ogs_assert(area);
+        ogs_list_for_each_safe(&area->gnb_list, next_node, node) {
+            if (node->gnb == gnb) {
+                ogs_list_remove(&area->gnb_list, node);
+                ogs_free(node);
+                break;
+            }
+        }
+
+        if (ogs_list_empty(&area->gnb_list) == true) {
+            ogs_hash_set(self.paging_area_hash,
+                    &area->tai, sizeof(area->tai), NULL);
+            ogs_free(area);
+        }
+    }
+
+    if (gnb->paging_area)
+        ogs_free(gnb->paging_area);
+    gnb->paging_area = NULL;
+    gnb->num_of_paging_area = 0;
+}
+
+void amf_gnb_update_paging_area(amf_gnb_t *gnb)
+{
+    int i, j, max = 0;
+
+    ogs_assert(gnb);
+
+    gnb_paging_area_clear(gnb);
+
+    for (i = 0; i < gnb->num_of_supported_ta_list; i++)
+        max += gnb->supported_ta_list[i].num_of_bplmn_list;
+    if (!max)
+        return;
+
+    gnb->paging_area = ogs_calloc(max, sizeof(amf_paging_area_t *));
+    ogs_assert(gnb->paging_area);
+
+    for (i = 0; i < gnb->num_of_supported_ta_list; i++) {
+        for (j = 0; j < gnb->supported_ta_list[i].num_of_bplmn_list; j++) {
+            ogs_5gs_tai_t tai;
+            amf_paging_area_t *area = NULL;
+            amf_paging_gnb_t *node = NULL;
+
+            memset(&tai, 0, sizeof(tai));
+            memcpy(&tai.plmn_id,
+                    &gnb->supported_ta_list[i].bplmn_list[j].plmn_id,
+                    OGS_PLMN_ID_LEN);
+            tai.tac.v = gnb->supported_ta_list[i].tac.v;
+
+            area = amf_paging_area_find(&tai);
+            if (!area) {
+                area = ogs_calloc(1, sizeof(*area));
+                ogs_assert(area);
+                memcpy(&area->tai, &tai, sizeof(tai));
+                ogs_list_init(&area->gnb_list);
+                ogs_hash_set(self.paging_area_hash,
+                        &area->tai, sizeof(area->tai), area);
+            } else {
+                /* Same TAI listed twice by this gNB */
+                ogs_list_for_each(&area->gnb_list, node)
+                    if (node->gnb == gnb)
+                        break;
+                if (node)
+                    continue;
+            }
+
+            node = ogs_calloc(1, sizeof(*node));
+            ogs_assert(node);
+            node->gnb = gnb;
+            ogs_list_add(&area->gnb_list, node);
+
+            gnb->paging_area[gnb->num_of_paging_area++] = area;
+        }
+    }
+}
+
+amf_paging_area_t *amf_paging_area_find(ogs_5gs_tai_t *tai)
+{
+    ogs_assert(tai);
+    return (amf_paging_area_t *)ogs_hash_get(
+            self.paging_area_hash, tai, sizeof(*tai));
+}
+
 /** ran_ue_context handling function */
 ran_ue_t *ran_ue_add(amf_gnb_t *gnb, uint64_t ran_ue_ngap_id)
 {
@@ -1404,6 +1512,7 @@ ran_ue_t *ran_ue_add(amf_gnb_t *gnb, uint64_t ran_ue_ngap_id)
     ran_ue->gnb_id = gnb->id;
 
     ogs_list_add(&gnb->ran_ue_list, ran_ue);
+    ran_ue_hash_add(gnb, ran_ue);
 
     stats_add_ran_ue();
 
@@ -1418,7 +1527,10 @@ void ran_ue_remove(ran_ue_t *ran_ue)
 
     gnb = amf_gnb_find_by_id(ran_ue->gnb_id);
 
-    if (gnb) ogs_list_remove(&gnb->ran_ue_list, ran_ue);
+    if (gnb) {
+        ran_ue_hash_remove(gnb, ran_ue);
+        ogs_list_remove(&gnb->ran_ue_list, ran_ue);
+    }
 
     ogs_assert(ran_ue->t_ng_holding);
     ogs_timer_delete(ran_ue->t_ng_holding);
@@ -1439,26 +1551,68 @@ void ran_ue_switch_to_gnb(ran_ue_t *ran_ue, amf_gnb_t *new_gnb)
     ogs_assert(gnb);
 
     /* Remove from the old gnb */
+    ran_ue_hash_remove(gnb, ran_ue);
     ogs_list_remove(&gnb->ran_ue_list, ran_ue);
 
     /* Add to the new gnb */
     ogs_list_add(&new_gnb->ran_ue_list, ran_ue);
+    ran_ue_hash_add(new_gnb, ran_ue);
 
     /* Switch to gnb */
     ran_ue->gnb_id = new_gnb->id;
 }
 
+void ran_ue_set_ran_ue_ngap_id(ran_ue_t *ran_ue, uint64_t ran_ue_ngap_id)
+{
+    amf_gnb_t *gnb = NULL;
+
+    ogs_assert(ran_ue);
+
+    gnb = amf_gnb_find_by_id(ran_ue->gnb_id);
+    if (gnb) ran_ue_hash_remove(gnb, ran_ue);
+
+    ran_ue->ran_ue_ngap_id = ran_ue_ngap_id;
+
+    if (gnb) ran_ue_hash_add(gnb, ran_ue);
+}
+
 ran_ue_t *ran_ue_find_by_ran_ue_ngap_id(
         amf_gnb_t *gnb, uint64_t ran_ue_ngap_id)
 {
-    ran_ue_t *ran_ue = NULL;
+    ogs_hash_chain_t *node = NULL;
 
-    ogs_list_for_each(&gnb->ran_ue_list, ran_ue) {
-        if (ran_ue_ngap_id == ran_ue->ran_ue_ngap_id)
-            break;
-    }
+    ogs_assert(gnb);
+    ogs_assert(gnb->ran_ue_hash);
 
-    return ran_ue;
+    node = ogs_hash_get(gnb->ran_ue_hash,
+            &ran_ue_ngap_id, sizeof(ran_ue_ngap_id));
+
+    return node ? ogs_container_of(node, ran_ue_t, hash_chain) : NULL;
+}
+
+/*
+ * A gNB may reuse a RAN-UE-NGAP-ID that an older context still holds.
+ * The hash keeps the oldest one, the rest are chained behind it.
+ */
+static void ran_ue_hash_add(amf_gnb_t *gnb, ran_ue_t *ran_ue)
+{
+    ogs_assert(gnb);
+    ogs_assert(ran_ue);
+
+    /* Handover target not yet acknowledged by the gNB */
+    if (ran_ue->ran_ue_ngap_id == INVALID_UE_NGAP_ID)
+        return;
+
+    ogs_hash_chain_add(gnb->ran_ue_hash, &ran_ue->hash_chain,
+            &ran_ue->ran_ue_ngap_id, sizeof(ran_ue->ran_ue_ngap_id));
+}
+
+static void ran_ue_hash_remove(amf_gnb_t *gnb, ran_ue_t *ran_ue)
+{
+    ogs_assert(gnb);
+    ogs_assert(ran_ue);
+
+    ogs_hash_chain_remove(gnb->ran_ue_hash, &ran_ue->hash_chain);
 }
 
 ran_ue_t *ran_ue_find(uint32_t index)
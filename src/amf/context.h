@@ -115,6 +115,7 @@ typedef struct amf_context_s {
 
     ogs_hash_t      *gnb_addr_hash; /* hash table for GNB Address */
     ogs_hash_t      *gnb_id_hash;   /* hash table for GNB-ID */
+    ogs_hash_t      *paging_area_hash; /* hash table (TAI : Paging Area) */
     ogs_hash_t      *guti_ue_hash;  /* hash table (GUTI : AMF_UE) */
     ogs_hash_t      *suci_hash;     /* hash table (SUCI) */
     ogs_hash_t      *supi_hash;     /* hash table (SUPI) */
@@ -162,14 +163,34 @@ typedef struct amf_gnb_s {
         } bplmn_list[OGS_MAX_NUM_OF_BPLMN];
     } supported_ta_list[OGS_MAX_NUM_OF_SUPPORTED_TA];
 
+    /* Paging areas this gNB is registered in (see paging_area_hash) */
+    int             num_of_paging_area;
+    struct amf_paging_area_s **paging_area;
+
     OpenAPI_rat_type_e rat_type;
 
     ogs_pkbuf_t     *ng_reset_ack; /* Reset message */
 
     ogs_list_t      ran_ue_list;
+    ogs_hash_t      *ran_ue_hash;   /* hash table (RAN_UE_NGAP_ID : RAN_UE) */
 
 } amf_gnb_t;
 
+/*
+ * Every gNB broadcasting a TAI, built from the Supported TA List
+ * on NG Setup and RAN Configuration Update. NG-Paging walks this list
+ * instead of matching the TAI against every gNB.
+ */
+typedef struct amf_paging_area_s {
+    ogs_5gs_tai_t   tai;        /* Hash Key */
+    ogs_list_t      gnb_list;   /* amf_paging_gnb_t */
+} amf_paging_area_t;
+
+typedef struct amf_paging_gnb_s {
+    ogs_lnode_t     lnode;
+    amf_gnb_t       *gnb;
+} amf_paging_gnb_t;
+
 struct ran_ue_s {
     ogs_lnode_t     lnode;
     uint32_t        index;
@@ -180,6 +201,9 @@ struct ran_ue_s {
     uint64_t        ran_ue_ngap_id; /* RAN-UE-NGAP-ID received from RAN */
     uint64_t        amf_ue_ngap_id; /* AMF-UE-NGAP-ID received from AMF */
 
+    /* Entry in gnb->ran_ue_hash, a reused RAN-UE-NGAP-ID is chained */
+    ogs_hash_chain_t hash_chain;
+
     uint16_t        gnb_ostream_id; /* SCTP output stream id for eNB */
 
     /* UE context */
@@ -936,10 +960,13 @@ amf_gnb_t *amf_gnb_find_by_gnb_id(uint32_t gnb_id);
 int amf_gnb_set_gnb_id(amf_gnb_t *gnb, uint32_t gnb_id);
 int amf_gnb_sock_type(ogs_sock_t *sock);
 amf_gnb_t *amf_gnb_find_by_id(ogs_pool_id_t id);
+void amf_gnb_update_paging_area(amf_gnb_t *gnb);
+amf_paging_area_t *amf_paging_area_find(ogs_5gs_tai_t *tai);
 
 ran_ue_t *ran_ue_add(amf_gnb_t *gnb, uint64_t ran_ue_ngap_id);
 void ran_ue_remove(ran_ue_t *ran_ue);
 void ran_ue_switch_to_gnb(ran_ue_t *ran_ue, amf_gnb_t *new_gnb);
+void ran_ue_set_ran_ue_ngap_id(ran_ue_t *ran_ue, uint64_t ran_ue_ngap_id);
 ran_ue_t *ran_ue_find_by_ran_ue_ngap_id(
         amf_gnb_t *gnb, uint64_t ran_ue_ngap_id);
 ran_ue_t *ran_ue_find(uint32_t index);
@@ -365,6 +365,8 @@ void amf_metrics_init(void)
 
     amf_metrics_init_by_slice();
     amf_metrics_init_by_cause();
+
+    ogs_sbi_client_metrics_init();
 }
 
 void amf_metrics_final(void)
@@ -402,5 +404,6 @@ void amf_metrics_final(void)
         ogs_hash_destroy(metrics_hash_by_cause);
     }
 
+    ogs_sbi_client_metrics_final();
     ogs_metrics_context_final();
 }
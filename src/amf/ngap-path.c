@@ -75,6 +75,47 @@ int ngap_send_to_gnb(amf_gnb_t *gnb, ogs_pkbuf_t *pkbuf, uint16_t stream_no)
     }
 }
 
+/* The caller keeps pkbuf so that one PDU can be sent to several gNBs */
+int ngap_send_to_gnb_without_free(
+        amf_gnb_t *gnb, ogs_pkbuf_t *pkbuf, uint16_t stream_no)
+{
+    char buf[OGS_ADDRSTRLEN];
+    int sent;
+
+    ogs_assert(pkbuf);
+    ogs_assert(gnb);
+
+    ogs_assert(gnb->sctp.sock);
+    if (gnb->sctp.sock->fd == INVALID_SOCKET) {
+        ogs_error("gNB SCTP socket has already been destroyed");
+        ogs_log_hexdump(OGS_LOG_FATAL, pkbuf->data, pkbuf->len);
+        return OGS_ERROR;
+    }
+
+    if (gnb->sctp.type == SOCK_STREAM) {
+        ogs_pkbuf_t *sendbuf = ogs_pkbuf_copy(pkbuf);
+        if (!sendbuf) {
+            ogs_error("ogs_pkbuf_copy() failed");
+            return OGS_ERROR;
+        }
+        return ngap_send_to_gnb(gnb, sendbuf, stream_no);
+    }
+
+    ogs_debug("    IP[%s] RAN_ID[%d]",
+            OGS_ADDR(gnb->sctp.addr, buf), gnb->gnb_id);
+
+    sent = ogs_sctp_sendmsg(gnb->sctp.sock, pkbuf->data, pkbuf->len,
+            gnb->sctp.addr, OGS_SCTP_NGAP_PPID, stream_no);
+    if (sent < 0 || sent != pkbuf->len) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                "ogs_sctp_sendmsg(len:%d,ssn:%d)",
+                pkbuf->len, (int)stream_no);
+        return OGS_ERROR;
+    }
+
+    return OGS_OK;
+}
+
 int ngap_send_to_ran_ue(ran_ue_t *ran_ue, ogs_pkbuf_t *pkbuf)
 {
     int rv;
@@ -423,9 +464,8 @@ int ngap_send_ran_ue_context_release_command(
 
 int ngap_send_paging(amf_ue_t *amf_ue)
 {
-    ogs_pkbuf_t *ngapbuf = NULL;
-    amf_gnb_t *gnb = NULL;
-    int i, j;
+    amf_paging_area_t *area = NULL;
+    amf_paging_gnb_t *node = NULL;
     int rv;
 
     ogs_debug("NG-Paging");
@@ -435,38 +475,25 @@ int ngap_send_paging(amf_ue_t *amf_ue)
         return OGS_NOTFOUND;
     }
 
-    ogs_list_for_each(&amf_self()->gnb_list, gnb) {
-        for (i = 0; i < gnb->num_of_supported_ta_list; i++) {
-            for (j = 0; j < gnb->supported_ta_list[i].num_of_bplmn_list; j++) {
-                if (memcmp(&gnb->supported_ta_list[i].bplmn_list[j].plmn_id,
-                            &amf_ue->nr_tai.plmn_id, OGS_PLMN_ID_LEN) == 0 &&
-                    gnb->supported_ta_list[i].tac.v == amf_ue->nr_tai.tac.v) {
-
-                    if (amf_ue->t3513.pkbuf) {
-                        ngapbuf = amf_ue->t3513.pkbuf;
-                    } else {
-                        ngapbuf = ngap_build_paging(amf_ue);
-                        if (!ngapbuf) {
-                            ogs_error("ngap_build_paging() failed");
-                            return OGS_ERROR;
-                        }
-                    }
-
-                    amf_ue->t3513.pkbuf = ogs_pkbuf_copy(ngapbuf);
-                    if (!amf_ue->t3513.pkbuf) {
-                        ogs_error("ogs_pkbuf_copy() failed");
-                        ogs_pkbuf_free(ngapbuf);
-                        return OGS_ERROR;
-                    }
-
-                    amf_metrics_inst_global_inc(AMF_METR_GLOB_CTR_MM_PAGING_5G_REQ);
-
-                    rv = ngap_send_to_gnb(gnb, ngapbuf, NGAP_NON_UE_SIGNALLING);
-                    if (rv != OGS_OK) {
-                        ogs_error("ngap_send_to_gnb() failed");
-                        return rv;
-                    }
-                }
+    area = amf_paging_area_find(&amf_ue->nr_tai);
+    if (area && ogs_list_first(&area->gnb_list)) {
+        /* Encoded once and kept for retransmission on T3513 expiry */
+        if (!amf_ue->t3513.pkbuf) {
+            amf_ue->t3513.pkbuf = ngap_build_paging(amf_ue);
+            if (!amf_ue->t3513.pkbuf) {
+                ogs_error("ngap_build_paging() failed");
+                return OGS_ERROR;
+            }
+        }
+
+        ogs_list_for_each(&area->gnb_list, node) {
+            amf_metrics_inst_global_inc(AMF_METR_GLOB_CTR_MM_PAGING_5G_REQ);
+
+            rv = ngap_send_to_gnb_without_free(
+                    node->gnb, amf_ue->t3513.pkbuf, NGAP_NON_UE_SIGNALLING);
+            if (rv != OGS_OK) {
+                ogs_error("ngap_send_to_gnb_without_free() failed");
+                return rv;
             }
         }
     }
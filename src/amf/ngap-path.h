@@ -38,6 +38,8 @@ void ngap_recv_upcall(short when, ogs_socket_t fd, void *data);
 
 int ngap_send_to_gnb(
         amf_gnb_t *gnb, ogs_pkbuf_t *pkb, uint16_t stream_no);
+int ngap_send_to_gnb_without_free(
+        amf_gnb_t *gnb, ogs_pkbuf_t *pkbuf, uint16_t stream_no);
 int ngap_send_to_ran_ue(ran_ue_t *ran_ue, ogs_pkbuf_t *pkbuf);
 int ngap_delayed_send_to_ran_ue(ran_ue_t *ran_ue,
         ogs_pkbuf_t *pkbuf, ogs_time_t duration);
@@ -317,6 +317,8 @@ static int client_discover_cb(
     }
 
     ogs_nnrf_disc_handle_nf_discover_search_result(message.SearchResult);
+    ogs_sbi_discovery_cache_update(target_nf_type, requester_nf_type,
+            discovery_option, message.SearchResult);
 
     nf_instance = ogs_sbi_nf_instance_find_by_discovery_param(
                     target_nf_type, requester_nf_type, discovery_option);
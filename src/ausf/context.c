@@ -114,6 +114,8 @@ int ausf_context_parse_config(void)
                     /* handle config in sbi library */
                 } else if (!strcmp(ausf_key, "discovery")) {
                     /* handle config in sbi library */
+                } else if (!strcmp(ausf_key, "metrics")) {
+                    /* handle config in metrics library */
                 } else
                     ogs_warn("unknown key `%s`", ausf_key);
             }
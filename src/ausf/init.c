@@ -17,6 +17,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "ogs-metrics.h"
 #include "sbi-path.h"
 
 static ogs_thread_t *thread;
@@ -31,6 +32,9 @@ int ausf_initialize(void)
     rv = ogs_app_parse_local_conf(APP_NAME);
     if (rv != OGS_OK) return rv;
 
+    ogs_metrics_context_init();
+    ogs_sbi_client_metrics_init();
+
     ogs_sbi_context_init(OpenAPI_nf_type_AUSF);
     ausf_context_init();
 
@@ -41,9 +45,14 @@ int ausf_initialize(void)
     rv = ogs_sbi_context_parse_config(APP_NAME, "nrf", "scp");
     if (rv != OGS_OK) return rv;
 
+    rv = ogs_metrics_context_parse_config(APP_NAME);
+    if (rv != OGS_OK) return rv;
+
     rv = ausf_context_parse_config();
     if (rv != OGS_OK) return rv;
 
+    ogs_metrics_context_open(ogs_metrics_self());
+
     rv = ausf_sbi_open();
     if (rv != OGS_OK) return rv;
 
@@ -90,8 +99,13 @@ void ausf_terminate(void)
 
     ausf_sbi_close();
 
+    ogs_metrics_context_close(ogs_metrics_self());
+
     ausf_context_final();
     ogs_sbi_context_final();
+
+    ogs_sbi_client_metrics_final();
+    ogs_metrics_context_final();
 }
 
 static void ausf_main(void *data)
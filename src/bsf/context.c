@@ -113,6 +113,8 @@ int bsf_context_parse_config(void)
                     /* handle config in sbi library */
                 } else if (!strcmp(bsf_key, "discovery")) {
                     /* handle config in sbi library */
+                } else if (!strcmp(bsf_key, "metrics")) {
+                    /* handle config in metrics library */
                 } else
                     ogs_warn("unknown key `%s`", bsf_key);
             }
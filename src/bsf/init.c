@@ -17,6 +17,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "ogs-metrics.h"
 #include "context.h"
 #include "sbi-path.h"
 
@@ -33,6 +34,9 @@ int bsf_initialize(void)
     rv = ogs_app_parse_local_conf(APP_NAME);
     if (rv != OGS_OK) return rv;
 
+    ogs_metrics_context_init();
+    ogs_sbi_client_metrics_init();
+
     ogs_sbi_context_init(OpenAPI_nf_type_BSF);
     bsf_context_init();
 
@@ -43,9 +47,14 @@ int bsf_initialize(void)
     rv = ogs_sbi_context_parse_config(APP_NAME, "nrf", "scp");
     if (rv != OGS_OK) return rv;
 
+    rv = ogs_metrics_context_parse_config(APP_NAME);
+    if (rv != OGS_OK) return rv;
+
     rv = bsf_context_parse_config();
     if (rv != OGS_OK) return rv;
 
+    ogs_metrics_context_open(ogs_metrics_self());
+
     rv = bsf_sbi_open();
     if (rv != 0) return OGS_ERROR;
 
@@ -92,9 +101,14 @@ void bsf_terminate(void)
 
     bsf_sbi_close();
 
+    ogs_metrics_context_close(ogs_metrics_self());
+
     bsf_context_final();
 
     ogs_sbi_context_final();
+
+    ogs_sbi_client_metrics_final();
+    ogs_metrics_context_final();
 }
 
 static void bsf_main(void *data)
@@ -0,0 +1,432 @@
+/*
+ * Copyright (C) 2019-2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hss-av.h"
+
+typedef struct hss_av_s {
+    char *imsi_bcd;
+
+    /* Changed by hss_av_remove(), refills from before are discarded */
+    uint64_t generation;
+    bool refill_queued;
+
+    /* Ring of 2 x num_of_reserve vectors in SQN order */
+    int head;
+    int num;
+    milenage_vector_t *vector;
+} hss_av_t;
+
+typedef struct hss_av_refill_s {
+    char *imsi_bcd;
+    uint64_t generation;
+} hss_av_refill_t;
+
+static int num_of_reserve = 0;
+static uint64_t av_generation = 0;
+
+static ogs_hash_t *av_hash = NULL;
+static ogs_thread_mutex_t av_lock;
+
+/* A single thread refills so that vectors are appended in SQN order */
+static ogs_queue_t *refill_queue = NULL;
+static ogs_thread_t *refill_thread = NULL;
+
+static void av_free(hss_av_t *av)
+{
+    ogs_assert(av);
+
+    ogs_free(av->imsi_bcd);
+    ogs_free(av->vector);
+    ogs_free(av);
+}
+
+static void refill_free(hss_av_refill_t *req)
+{
+    ogs_assert(req);
+
+    ogs_free(req->imsi_bcd);
+    ogs_free(req);
+}
+
+static int generate(char *imsi_bcd, milenage_vector_t *vector, int num)
+{
+    ogs_dbi_auth_info_t auth_info;
+    uint8_t opc[OGS_KEY_LEN];
+    int i, rv;
+
+    ogs_assert(imsi_bcd);
+    ogs_assert(vector);
+
+    rv = hss_db_reserve_sqn(imsi_bcd, num, &auth_info);
+    if (rv != OGS_OK)
+        return rv;
+
+    if (auth_info.use_opc)
+        memcpy(opc, auth_info.opc, sizeof(opc));
+    else
+        milenage_opc(auth_info.k, auth_info.op, opc);
+
+    for (i = 0; i < num; i++) {
+        ogs_random(vector[i].rand, OGS_RAND_LEN);
+        ogs_uint64_to_buffer(ogs_auc_sqn_next(auth_info.sqn, i),
+                OGS_SQN_LEN, vector[i].sqn);
+    }
+
+    rv = milenage_generate_batch(opc, auth_info.amf, auth_info.k, vector, num);
+    if (rv != 0) {
+        ogs_error("[%s] milenage_generate_batch() failed", imsi_bcd);
+        return OGS_ERROR;
+    }
+
+    return OGS_OK;
+}
+
+/* `generation` is that of the entry when the refill was requested */
+static int refill(char *imsi_bcd, uint64_t generation)
+{
+    milenage_vector_t *vector = NULL;
+    hss_av_t *av = NULL;
+    int i, rv;
+
+    ogs_assert(imsi_bcd);
+
+    vector = ogs_calloc(num_of_reserve, sizeof(*vector));
+    ogs_assert(vector);
+
+    rv = generate(imsi_bcd, vector, num_of_reserve);
+    if (rv != OGS_OK) {
+        ogs_free(vector);
+        return rv;
+    }
+
+    ogs_thread_mutex_lock(&av_lock);
+
+    av = ogs_hash_get(av_hash, imsi_bcd, OGS_HASH_KEY_STRING);
+    if (!av || av->generation != generation) {
+        /* e.g. reserved from the SQN before a re-synchronisation */
+        ogs_debug("[%s] Discard stale authentication vectors", imsi_bcd);
+        ogs_thread_mutex_unlock(&av_lock);
+        ogs_free(vector);
+        return OGS_OK;
+    }
+
+    /* The reserved range is skipped if there is no room, which is
+     * allowed since the UE only checks that SQN increases */
+    if (av->num + num_of_reserve <= 2 * num_of_reserve) {
+        for (i = 0; i < num_of_reserve; i++) {
+            memcpy(&av->vector[
+                    (av->head + av->num) % (2 * num_of_reserve)],
+                    &vector[i], sizeof(*vector));
+            av->num++;
+        }
+    }
+
+    ogs_thread_mutex_unlock(&av_lock);
+
+    ogs_free(vector);
+
+    return OGS_OK;
+}
+
+/* Called with av_lock held */
+static void refill_push(hss_av_t *av)
+{
+    hss_av_refill_t *req = NULL;
+
+    ogs_assert(av);
+
+    req = ogs_calloc(1, sizeof(*req));
+    ogs_assert(req);
+    req->imsi_bcd = ogs_strdup(av->imsi_bcd);
+    ogs_assert(req->imsi_bcd);
+    req->generation = av->generation;
+
+    if (ogs_queue_trypush(refill_queue, req) == OGS_OK)
+        av->refill_queued = true;
+    else
+        refill_free(req);
+}
+
+static void refill_main(void *data)
+{
+    hss_av_refill_t *req = NULL;
+    hss_av_t *av = NULL;
+    int rv;
+
+    for ( ;; ) {
+        rv = ogs_queue_pop(refill_queue, (void **)&req);
+        if (rv == OGS_DONE)
+            break;
+        if (rv != OGS_OK)
+            continue;
+
+        /* NULL is pushed by hss_av_final() */
+        if (!req)
+            break;
+
+        rv = refill(req->imsi_bcd, req->generation);
+        if (rv != OGS_OK)
+            ogs_warn("[%s] Cannot refill authentication vectors",
+                    req->imsi_bcd);
+
+        ogs_thread_mutex_lock(&av_lock);
+        av = ogs_hash_get(av_hash, req->imsi_bcd, OGS_HASH_KEY_STRING);
+        if (av && av->generation == req->generation)
+            av->refill_queued = false;
+        ogs_thread_mutex_unlock(&av_lock);
+
+        refill_free(req);
+    }
+}
+
+int hss_av_init(int num)
+{
+    ogs_assert(num_of_reserve == 0);
+
+    if (num <= 0)
+        return OGS_OK;
+
+    av_hash = ogs_hash_make();
+    ogs_assert(av_hash);
+
+    ogs_thread_mutex_init(&av_lock);
+
+    refill_queue = ogs_queue_create(ogs_global_conf()->max.ue);
+    ogs_assert(refill_queue);
+
+    num_of_reserve = num;
+
+    refill_thread = ogs_thread_create(refill_main, NULL);
+    ogs_assert(refill_thread);
+
+    ogs_info("Authentication vector reserve [num:%d]", num_of_reserve);
+
+    return OGS_OK;
+}
+
+void hss_av_final(void)
+{
+    hss_av_refill_t *req = NULL;
+
+    if (!num_of_reserve)
+        return;
+
+    ogs_assert(OGS_OK == ogs_queue_push(refill_queue, NULL));
+    ogs_thread_destroy(refill_thread);
+    refill_thread = NULL;
+
+    while (ogs_queue_trypop(refill_queue, (void **)&req) == OGS_OK) {
+        if (req)
+            refill_free(req);
+    }
+    ogs_queue_destroy(refill_queue);
+    refill_queue = NULL;
+
+    hss_av_remove_all();
+    ogs_hash_destroy(av_hash);
+    av_hash = NULL;
+
+    ogs_thread_mutex_destroy(&av_lock);
+
+    num_of_reserve = 0;
+}
+
+bool hss_av_enabled(void)
+{
+    return num_of_reserve > 0;
+}
+
+/*
+ * Returns OGS_NOTFOUND if no vector could be reserved, in which case
+ * the caller generates one on its own.
+ */
+int hss_av_get(char *imsi_bcd, milenage_vector_t *vector)
+{
+    hss_av_t *av = NULL;
+    int rv;
+
+    ogs_assert(imsi_bcd);
+    ogs_assert(vector);
+
+    if (!num_of_reserve)
+        return OGS_NOTFOUND;
+
+    ogs_thread_mutex_lock(&av_lock);
+    av = ogs_hash_get(av_hash, imsi_bcd, OGS_HASH_KEY_STRING);
+    if (av && av->num) {
+        memcpy(vector, &av->vector[av->head], sizeof(*vector));
+        av->head = (av->head + 1) % (2 * num_of_reserve);
+        av->num--;
+
+        if (av->num <= num_of_reserve / 2 && !av->refill_queued)
+            refill_push(av);
+
+        ogs_thread_mutex_unlock(&av_lock);
+        return OGS_OK;
+    }
+
+    ogs_thread_mutex_unlock(&av_lock);
+
+    /* Out of vectors: one is generated here, the rest in the background */
+    rv = generate(imsi_bcd, vector, 1);
+    if (rv != OGS_OK)
+        return OGS_NOTFOUND;
+
+    ogs_thread_mutex_lock(&av_lock);
+    av = ogs_hash_get(av_hash, imsi_bcd, OGS_HASH_KEY_STRING);
+    if (!av && ogs_hash_count(av_hash) < ogs_global_conf()->max.ue) {
+        av = ogs_calloc(1, sizeof(*av));
+        ogs_assert(av);
+        av->imsi_bcd = ogs_strdup(imsi_bcd);
+        ogs_assert(av->imsi_bcd);
+        av->vector = ogs_calloc(2 * num_of_reserve, sizeof(*av->vector));
+        ogs_assert(av->vector);
+
+        ogs_hash_set(av_hash, av->imsi_bcd, OGS_HASH_KEY_STRING, av);
+    }
+    if (av) {
+        /* A refill in progress may have reserved SQNs below this one */
+        av->head = 0;
+        av->num = 0;
+        av->generation = ++av_generation;
+        refill_push(av);
+    }
+    ogs_thread_mutex_unlock(&av_lock);
+
+    return OGS_OK;
+}
+
+void hss_av_remove(char *imsi_bcd)
+{
+    hss_av_t *av = NULL;
+
+    ogs_assert(imsi_bcd);
+
+    if (!num_of_reserve)
+        return;
+
+    ogs_thread_mutex_lock(&av_lock);
+
+    /* Refills requested before are discarded by the new generation */
+    av = ogs_hash_get(av_hash, imsi_bcd, OGS_HASH_KEY_STRING);
+    if (av) {
+        av->head = 0;
+        av->num = 0;
+        av->generation = ++av_generation;
+        av->refill_queued = false;
+    }
+
+    ogs_thread_mutex_unlock(&av_lock);
+}
+
+void hss_av_remove_all(void)
+{
+    ogs_hash_index_t *hi = NULL;
+    hss_av_t *av = NULL;
+
+    if (!num_of_reserve)
+        return;
+
+    ogs_thread_mutex_lock(&av_lock);
+
+    for (hi = ogs_hash_first(av_hash); hi; hi = ogs_hash_next(hi)) {
+        av = ogs_hash_this_val(hi);
+        ogs_assert(av);
+        ogs_hash_set(av_hash, av->imsi_bcd, OGS_HASH_KEY_STRING, NULL);
+        av_free(av);
+    }
+
+    ogs_thread_mutex_unlock(&av_lock);
+}
+
+/*
+ * Vectors are dropped when the keys of the subscriber may have changed.
+ * The SQN written by a refill comes back as an update of security.sqn,
+ * which is ignored.
+ */
+void hss_av_handle_change(const bson_t *document)
+{
+    bson_iter_t iter, child_iter;
+    const char *utf8 = NULL;
+    uint32_t length = 0;
+
+    char *imsi_bcd = NULL;
+    bool security_changed = true;
+
+    ogs_assert(document);
+
+    if (!num_of_reserve)
+        return;
+
+    if (bson_iter_init_find(&iter, document, "fullDocument") &&
+            BSON_ITER_HOLDS_DOCUMENT(&iter) &&
+            bson_iter_recurse(&iter, &child_iter) &&
+            bson_iter_find(&child_iter, OGS_ID_SUPI_TYPE_IMSI) &&
+            BSON_ITER_HOLDS_UTF8(&child_iter)) {
+        utf8 = bson_iter_utf8(&child_iter, &length);
+        imsi_bcd = ogs_strndup(utf8, ogs_min(length, OGS_MAX_IMSI_BCD_LEN));
+        ogs_assert(imsi_bcd);
+    }
+
+    if (!imsi_bcd) {
+        /* e.g. a deleted document only carries its _id */
+        hss_av_remove_all();
+        return;
+    }
+
+    if (bson_iter_init_find(&iter, document, "updateDescription") &&
+            BSON_ITER_HOLDS_DOCUMENT(&iter)) {
+        bson_iter_t desc_iter;
+
+        security_changed = false;
+
+        bson_iter_recurse(&iter, &desc_iter);
+        while (bson_iter_next(&desc_iter)) {
+            const char *key = bson_iter_key(&desc_iter);
+
+            if (!strcmp(key, "updatedFields") &&
+                    BSON_ITER_HOLDS_DOCUMENT(&desc_iter)) {
+                bson_iter_recurse(&desc_iter, &child_iter);
+                while (bson_iter_next(&child_iter)) {
+                    const char *field = bson_iter_key(&child_iter);
+                    if (!strncmp(field, OGS_SECURITY_STRING,
+                                strlen(OGS_SECURITY_STRING)) &&
+                        strcmp(field,
+                            OGS_SECURITY_STRING "." OGS_SQN_STRING) != 0)
+                        security_changed = true;
+                }
+            } else if (!strcmp(key, "removedFields") &&
+                    BSON_ITER_HOLDS_ARRAY(&desc_iter)) {
+                bson_iter_recurse(&desc_iter, &child_iter);
+                while (bson_iter_next(&child_iter)) {
+                    if (BSON_ITER_HOLDS_UTF8(&child_iter) &&
+                        !strncmp(bson_iter_utf8(&child_iter, NULL),
+                            OGS_SECURITY_STRING,
+                            strlen(OGS_SECURITY_STRING)))
+                        security_changed = true;
+                }
+            }
+        }
+    }
+
+    if (security_changed)
+        hss_av_remove(imsi_bcd);
+
+    ogs_free(imsi_bcd);
+}
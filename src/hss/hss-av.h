@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2019-2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HSS_AV_H
+#define HSS_AV_H
+
+#include "ogs-crypt.h"
+
+#include "hss-context.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Pre-generated authentication vectors.
+ *
+ * A refill reserves the SQN range of `num` vectors with a single DB update
+ * and runs Milenage for all of them at once. Refills are done by a
+ * background thread once half of the reserve has been used. A request
+ * that finds no vector left generates one on its own and queues a refill.
+ *
+ * Only the Milenage output is kept. Keys bound to the serving network,
+ * such as KASME, are derived when the vector is handed out.
+ */
+int hss_av_init(int num);
+void hss_av_final(void);
+bool hss_av_enabled(void);
+
+int hss_av_get(char *imsi_bcd, milenage_vector_t *vector);
+
+void hss_av_remove(char *imsi_bcd);
+void hss_av_remove_all(void);
+void hss_av_handle_change(const bson_t *document);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HSS_AV_H */
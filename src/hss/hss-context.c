@@ -22,6 +22,7 @@
 #include "hss-event.h"
 #include "hss-fd-path.h"
 #include "hss-s6a-path.h"
+#include "hss-av.h"
 
 
 typedef struct hss_impi_s hss_impi_t;
@@ -353,6 +354,9 @@ int hss_context_parse_config(void)
 #else
                     self.use_mongodb_change_stream = false;
 #endif
+                } else if (!strcmp(hss_key, "av_reserve")) {
+                    const char *v = ogs_yaml_iter_value(&hss_iter);
+                    if (v) self.av_reserve = atoi(v);
                 } else if (!strcmp(hss_key, "metrics")) {
                     /* handle config in metrics library */
                 } else
@@ -464,6 +468,35 @@ int hss_db_increment_sqn(char *imsi_bcd)
     return rv;
 }
 
+/*
+ * Reads the authentication info and moves the SQN past the vectors
+ * that will be generated from auth_info->sqn, with one DB update.
+ */
+int hss_db_reserve_sqn(char *imsi_bcd, int num_of_sqn,
+        ogs_dbi_auth_info_t *auth_info)
+{
+    int rv;
+    char *supi = NULL;
+
+    ogs_assert(imsi_bcd);
+    ogs_assert(num_of_sqn > 0);
+    ogs_assert(auth_info);
+
+    ogs_thread_mutex_lock(&self.db_lock);
+    supi = ogs_msprintf("%s-%s", OGS_ID_SUPI_TYPE_IMSI, imsi_bcd);
+    ogs_assert(supi);
+
+    rv = ogs_dbi_auth_info(supi, auth_info);
+    if (rv == OGS_OK)
+        rv = ogs_dbi_update_sqn(supi,
+                ogs_auc_sqn_next(auth_info->sqn, num_of_sqn));
+
+    ogs_free(supi);
+    ogs_thread_mutex_unlock(&self.db_lock);
+
+    return rv;
+}
+
 int hss_db_subscription_data(
     char *imsi_bcd, ogs_subscription_data_t *subscription_data)
 {
@@ -1371,6 +1404,7 @@ int hss_db_poll_change_stream(void)
     ogs_thread_mutex_lock(&self.db_lock);
 
     rv = poll_change_stream();
+    ogs_dbi_cache_flush();
 
     ogs_thread_mutex_unlock(&self.db_lock);
 
@@ -1449,6 +1483,13 @@ int hss_handle_change_event(const bson_t *document)
 # else
     ogs_debug("Received change stream document.");
 #endif
+
+    /* Drop the stale entry before building IDR/CLR from the DB */
+    ogs_thread_mutex_lock(&self.db_lock);
+    ogs_dbi_cache_handle_change(document);
+    ogs_thread_mutex_unlock(&self.db_lock);
+    hss_av_handle_change(document);
+
     if (!bson_iter_init_find(&iter, document, "fullDocument")) {
         ogs_error("No 'imsi' field in this document.");
         return OGS_ERROR;
@@ -41,6 +41,7 @@ typedef struct _hss_context_t {
     ogs_diam_config_t   *diam_config;   /* HSS Diameter config */
     const char          *sms_over_ims;  /* SMS over IMS */
     int                 use_mongodb_change_stream;
+    int                 av_reserve;     /* Pre-generated vectors per IMSI */
 
     ogs_thread_mutex_t  db_lock;
     ogs_thread_mutex_t  cx_lock;
@@ -64,6 +65,8 @@ int hss_context_parse_config(void);
 int hss_db_auth_info(char *imsi_bcd, ogs_dbi_auth_info_t *auth_info);
 int hss_db_update_sqn(char *imsi_bcd, uint8_t *rand, uint64_t sqn);
 int hss_db_increment_sqn(char *imsi_bcd);
+int hss_db_reserve_sqn(char *imsi_bcd, int num_of_sqn,
+        ogs_dbi_auth_info_t *auth_info);
 int hss_db_update_imeisv(char *imsi_bcd, char *imeisv);
 int hss_db_update_mme(char *imsi_bcd, char *mme_host, char *mme_realm,
     bool purge_flag);
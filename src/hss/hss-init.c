@@ -19,6 +19,7 @@
 
 #include "hss-context.h"
 #include "hss-fd-path.h"
+#include "hss-av.h"
 #include "hss-sm.h"
 #include "metrics.h"
 
@@ -56,6 +57,16 @@ int hss_initialize(void)
     rv = ogs_dbi_init(ogs_app()->db_uri);
     if (rv != OGS_OK) return rv;
 
+    if (hss_self()->use_mongodb_change_stream) {
+        /* The cache relies on the change stream for invalidation */
+        rv = ogs_dbi_collection_watch_init();
+        if (rv == OGS_OK)
+            ogs_dbi_cache_init(ogs_global_conf()->dbi.cache);
+    }
+
+    rv = hss_av_init(hss_self()->av_reserve);
+    if (rv != OGS_OK) return rv;
+
     rv = hss_fd_init();
     if (rv != OGS_OK) return OGS_ERROR;
 
@@ -77,6 +88,7 @@ void hss_terminate(void)
 
     hss_fd_final();
 
+    hss_av_final();
     ogs_dbi_final();
     hss_context_final();
     hss_event_final();
@@ -22,6 +22,7 @@
 #include "hss-context.h"
 #include "hss-fd-path.h"
 #include "hss-s6a-path.h"
+#include "hss-av.h"
 
 /* handler for fallback cb */
 static struct disp_hdl *hdl_s6a_fb = NULL;
@@ -96,6 +97,7 @@ static int hss_ogs_diam_s6a_air_cb( struct msg **msg, struct avp *avp,
     uint8_t mac_s[OGS_MAC_S_LEN];
 
     ogs_dbi_auth_info_t auth_info;
+    milenage_vector_t vector;
     uint8_t zero[OGS_RAND_LEN];
     int rv;
     uint32_t result_code = 0;
@@ -119,6 +121,28 @@ static int hss_ogs_diam_s6a_air_cb( struct msg **msg, struct avp *avp,
     ogs_cpystrn(imsi_bcd, (char*)hdr->avp_value->os.data,
         ogs_min(hdr->avp_value->os.len, OGS_MAX_IMSI_BCD_LEN)+1);
 
+    avpch = NULL;
+    ret = fd_msg_search_avp(qry, ogs_diam_s6a_req_eutran_auth_info, &avp);
+    ogs_assert(ret == 0);
+    if (avp) {
+        ret = fd_avp_search_avp(
+                avp, ogs_diam_s6a_re_synchronization_info, &avpch);
+        ogs_assert(ret == 0);
+    }
+
+    if (!avpch && hss_av_get(imsi_bcd, &vector) == OGS_OK) {
+        memcpy(auth_info.rand, vector.rand, OGS_RAND_LEN);
+        memcpy(sqn, vector.sqn, OGS_SQN_LEN);
+        memcpy(autn, vector.autn, OGS_AUTN_LEN);
+        memcpy(ik, vector.ik, OGS_KEY_LEN);
+        memcpy(ck, vector.ck, OGS_KEY_LEN);
+        memcpy(ak, vector.ak, OGS_AK_LEN);
+        memcpy(xres, vector.res, sizeof(vector.res));
+        xres_len = sizeof(vector.res);
+
+        goto vector_ready;
+    }
+
     rv = hss_db_auth_info(imsi_bcd, &auth_info);
     if (rv != OGS_OK) {
         result_code = OGS_DIAM_S6A_ERROR_USER_UNKNOWN;
@@ -135,38 +159,34 @@ static int hss_ogs_diam_s6a_air_cb( struct msg **msg, struct avp *avp,
     else
         milenage_opc(auth_info.k, auth_info.op, opc);
 
-    ret = fd_msg_search_avp(qry, ogs_diam_s6a_req_eutran_auth_info, &avp);
-    ogs_assert(ret == 0);
-    if (avp) {
-        ret = fd_avp_search_avp(
-                avp, ogs_diam_s6a_re_synchronization_info, &avpch);
+    if (avpch) {
+        /* Vectors reserved from the old SQN are no longer usable */
+        hss_av_remove(imsi_bcd);
+
+        ret = fd_msg_avp_hdr(avpch, &hdr);
         ogs_assert(ret == 0);
-        if (avpch) {
-            ret = fd_msg_avp_hdr(avpch, &hdr);
-            ogs_assert(ret == 0);
-            ogs_auc_sqn(opc, auth_info.k,
-                    hdr->avp_value->os.data,
-                    hdr->avp_value->os.data + OGS_RAND_LEN,
-                    sqn, mac_s);
-            if (memcmp(mac_s, hdr->avp_value->os.data +
-                        OGS_RAND_LEN + OGS_SQN_LEN, OGS_MAC_S_LEN) == 0) {
-                ogs_random(auth_info.rand, OGS_RAND_LEN);
-                auth_info.sqn = ogs_buffer_to_uint64(sqn, OGS_SQN_LEN);
-                /* 33.102 C.3.4 Guide : IND + 1 */
-                auth_info.sqn = (auth_info.sqn + 32 + 1) & OGS_MAX_SQN;
-            } else {
-                ogs_error("Re-synch MAC failed for IMSI:`%s`", imsi_bcd);
-                ogs_log_print(OGS_LOG_ERROR, "MAC_S: ");
-                ogs_log_hexdump(OGS_LOG_ERROR, mac_s, OGS_MAC_S_LEN);
-                ogs_log_hexdump(OGS_LOG_ERROR,
-                    (void*)(hdr->avp_value->os.data +
-                        OGS_RAND_LEN + OGS_SQN_LEN),
-                    OGS_MAC_S_LEN);
-                ogs_log_print(OGS_LOG_ERROR, "SQN: ");
-                ogs_log_hexdump(OGS_LOG_ERROR, sqn, OGS_SQN_LEN);
-                result_code = OGS_DIAM_S6A_AUTHENTICATION_DATA_UNAVAILABLE;
-                goto out;
-            }
+        ogs_auc_sqn(opc, auth_info.k,
+                hdr->avp_value->os.data,
+                hdr->avp_value->os.data + OGS_RAND_LEN,
+                sqn, mac_s);
+        if (memcmp(mac_s, hdr->avp_value->os.data +
+                    OGS_RAND_LEN + OGS_SQN_LEN, OGS_MAC_S_LEN) == 0) {
+            ogs_random(auth_info.rand, OGS_RAND_LEN);
+            auth_info.sqn = ogs_buffer_to_uint64(sqn, OGS_SQN_LEN);
+            /* 33.102 C.3.4 Guide : IND + 1 */
+            auth_info.sqn = (auth_info.sqn + 32 + 1) & OGS_MAX_SQN;
+        } else {
+            ogs_error("Re-synch MAC failed for IMSI:`%s`", imsi_bcd);
+            ogs_log_print(OGS_LOG_ERROR, "MAC_S: ");
+            ogs_log_hexdump(OGS_LOG_ERROR, mac_s, OGS_MAC_S_LEN);
+            ogs_log_hexdump(OGS_LOG_ERROR,
+                (void*)(hdr->avp_value->os.data +
+                    OGS_RAND_LEN + OGS_SQN_LEN),
+                OGS_MAC_S_LEN);
+            ogs_log_print(OGS_LOG_ERROR, "SQN: ");
+            ogs_log_hexdump(OGS_LOG_ERROR, sqn, OGS_SQN_LEN);
+            result_code = OGS_DIAM_S6A_AUTHENTICATION_DATA_UNAVAILABLE;
+            goto out;
         }
     }
 
@@ -184,6 +204,15 @@ static int hss_ogs_diam_s6a_air_cb( struct msg **msg, struct avp *avp,
         goto out;
     }
 
+    /* Drop vectors a refill has reserved before the new SQN was written */
+    if (avpch)
+        hss_av_remove(imsi_bcd);
+
+    milenage_generate(opc, auth_info.amf, auth_info.k,
+        ogs_uint64_to_buffer(auth_info.sqn, OGS_SQN_LEN, sqn), auth_info.rand,
+        autn, ik, ck, ak, xres, &xres_len);
+
+vector_ready:
     ret = fd_msg_search_avp(qry, ogs_diam_visited_plmn_id, &avp);
     ogs_assert(ret == 0);
     ret = fd_msg_avp_hdr(avp, &hdr);
@@ -191,9 +220,6 @@ static int hss_ogs_diam_s6a_air_cb( struct msg **msg, struct avp *avp,
     memcpy(&visited_plmn_id, hdr->avp_value->os.data,
             ogs_min(hdr->avp_value->os.len, sizeof(visited_plmn_id)));
 
-    milenage_generate(opc, auth_info.amf, auth_info.k,
-        ogs_uint64_to_buffer(auth_info.sqn, OGS_SQN_LEN, sqn), auth_info.rand,
-        autn, ik, ck, ak, xres, &xres_len);
     ogs_auc_kasme(ck, ik, hdr->avp_value->os.data, sqn, ak, kasme);
 
     /* Set the Authentication-Info */
@@ -34,8 +34,6 @@ void hss_state_initial(ogs_fsm_t *s, hss_event_t *e)
 
 #if MONGOC_CHECK_VERSION(1, 9, 0)
     if (hss_self()->use_mongodb_change_stream) {
-        ogs_dbi_collection_watch_init();
-
         t_db_polling = ogs_timer_add(ogs_app()->timer_mgr,
                 hss_timer_dbi_poll_change_stream, 0);
         ogs_assert(t_db_polling);
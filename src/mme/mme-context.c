@@ -65,6 +65,9 @@ static void stats_add_enb_ue(void);
 static void stats_remove_enb_ue(void);
 static void stats_add_mme_session(void);
 static void stats_remove_mme_session(void);
+static void enb_paging_area_clear(mme_enb_t *enb);
+static void enb_ue_hash_add(mme_enb_t *enb, enb_ue_t *enb_ue);
+static void enb_ue_hash_remove(mme_enb_t *enb, enb_ue_t *enb_ue);
 
 static bool compare_ue_info(mme_sgw_t *node, enb_ue_t *enb_ue);
 static mme_sgw_t *selected_sgw_node(mme_sgw_t *current, enb_ue_t *enb_ue);
@@ -132,13 +135,15 @@ void mme_context_init(void)
     ogs_assert(self.enb_addr_hash);
     self.enb_id_hash = ogs_hash_make();
     ogs_assert(self.enb_id_hash);
-    self.imsi_ue_hash = ogs_hash_make();
+    self.paging_area_hash = ogs_hash_make();
+    ogs_assert(self.paging_area_hash);
+    self.imsi_ue_hash = ogs_hash_make_size(ogs_global_conf()->max.ue);
     ogs_assert(self.imsi_ue_hash);
-    self.guti_ue_hash = ogs_hash_make();
+    self.guti_ue_hash = ogs_hash_make_size(ogs_global_conf()->max.ue);
     ogs_assert(self.guti_ue_hash);
-    self.mme_s11_teid_hash = ogs_hash_make();
+    self.mme_s11_teid_hash = ogs_hash_make_size(ogs_global_conf()->max.ue);
     ogs_assert(self.mme_s11_teid_hash);
-    self.mme_gn_teid_hash = ogs_hash_make();
+    self.mme_gn_teid_hash = ogs_hash_make_size(ogs_global_conf()->max.ue);
     ogs_assert(self.mme_gn_teid_hash);
 
     ogs_list_init(&self.mme_ue_list);
@@ -164,6 +169,8 @@ void mme_context_final(void)
     ogs_hash_destroy(self.enb_addr_hash);
     ogs_assert(self.enb_id_hash);
     ogs_hash_destroy(self.enb_id_hash);
+    ogs_assert(self.paging_area_hash);
+    ogs_hash_destroy(self.paging_area_hash);
 
     ogs_assert(self.imsi_ue_hash);
     ogs_hash_destroy(self.imsi_ue_hash);
@@ -3021,6 +3028,8 @@ mme_enb_t *mme_enb_add(ogs_sock_t *sock, ogs_sockaddr_t *addr)
     enb->ostream_id = 0;
 
     ogs_list_init(&enb->enb_ue_list);
+    enb->enb_ue_hash = ogs_hash_make();
+    ogs_assert(enb->enb_ue_hash);
 
     ogs_hash_set(self.enb_addr_hash,
             enb->sctp.addr, sizeof(ogs_sockaddr_t), enb);
@@ -3056,6 +3065,11 @@ int mme_enb_remove(mme_enb_t *enb)
     if (enb->enb_id_presence == true)
         ogs_hash_set(self.enb_id_hash, &enb->enb_id, sizeof(enb->enb_id), NULL);
 
+    enb_paging_area_clear(enb);
+
+    ogs_assert(enb->enb_ue_hash);
+    ogs_hash_destroy(enb->enb_ue_hash);
+
     /*
      * CHECK:
      *
@@ -3132,6 +3146,90 @@ mme_enb_t *mme_enb_find_by_id(ogs_pool_id_t id)
     return ogs_pool_find_by_id(&mme_enb_pool, id);
 }
 
+static void enb_paging_area_clear(mme_enb_t *enb)
+{
+    int i;
+
+    ogs_assert(enb);
+
+    for (i = 0; i < enb->num_of_paging_area; i++) {
+        mme_paging_area_t *area = enb->paging_area[i];
+        mme_paging_enb_t *node = NULL, *next_node = NULL;
+
+        ogs_assert(area);
+        ogs_list_for_each_safe(&area->enb_list, next_node, node) {
+            if (node->enb == enb) {
+                ogs_list_remove(&area->enb_list, node);
+                ogs_free(node);
+                break;
+            }
+        }
+
+        if (ogs_list_empty(&area->enb_list) == true) {
+            ogs_hash_set(self.paging_area_hash,
+                    &area->tai, sizeof(area->tai), NULL);
+            ogs_free(area);
+        }
+    }
+
+    if (enb->paging_area)
+        ogs_free(enb->paging_area);
+    enb->paging_area = NULL;
+    enb->num_of_paging_area = 0;
+}
+
+void mme_enb_update_paging_area(mme_enb_t *enb)
+{
+    int i;
+
+    ogs_assert(enb);
+
+    enb_paging_area_clear(enb);
+
+    if (!enb->num_of_supported_ta_list)
+        return;
+
+    enb->paging_area = ogs_calloc(
+            enb->num_of_supported_ta_list, sizeof(mme_paging_area_t *));
+    ogs_assert(enb->paging_area);
+
+    for (i = 0; i < enb->num_of_supported_ta_list; i++) {
+        mme_paging_area_t *area = NULL;
+        mme_paging_enb_t *node = NULL;
+
+        area = mme_paging_area_find(&enb->supported_ta_list[i]);
+        if (!area) {
+            area = ogs_calloc(1, sizeof(*area));
+            ogs_assert(area);
+            memcpy(&area->tai, &enb->supported_ta_list[i], sizeof(area->tai));
+            ogs_list_init(&area->enb_list);
+            ogs_hash_set(self.paging_area_hash,
+                    &area->tai, sizeof(area->tai), area);
+        } else {
+            /* Same TAI listed twice by this eNB */
+            ogs_list_for_each(&area->enb_list, node)
+                if (node->enb == enb)
+                    break;
+            if (node)
+                continue;
+        }
+
+        node = ogs_calloc(1, sizeof(*node));
+        ogs_assert(node);
+        node->enb = enb;
+        ogs_list_add(&area->enb_list, node);
+
+        enb->paging_area[enb->num_of_paging_area++] = area;
+    }
+}
+
+mme_paging_area_t *mme_paging_area_find(ogs_eps_tai_t *tai)
+{
+    ogs_assert(tai);
+    return (mme_paging_area_t *)ogs_hash_get(
+            self.paging_area_hash, tai, sizeof(*tai));
+}
+
 /** enb_ue_context handling function */
 enb_ue_t *enb_ue_add(mme_enb_t *enb, uint32_t enb_ue_s1ap_id)
 {
@@ -3173,6 +3271,7 @@ enb_ue_t *enb_ue_add(mme_enb_t *enb, uint32_t enb_ue_s1ap_id)
     enb_ue->enb_id = enb->id;
 
     ogs_list_add(&enb->enb_ue_list, enb_ue);
+    enb_ue_hash_add(enb, enb_ue);
 
     stats_add_enb_ue();
 
@@ -3187,7 +3286,10 @@ void enb_ue_remove(enb_ue_t *enb_ue)
 
     enb = mme_enb_find_by_id(enb_ue->enb_id);
 
-    if (enb) ogs_list_remove(&enb->enb_ue_list, enb_ue);
+    if (enb) {
+        enb_ue_hash_remove(enb, enb_ue);
+        ogs_list_remove(&enb->enb_ue_list, enb_ue);
+    }
 
     ogs_assert(enb_ue->t_s1_holding);
     ogs_timer_delete(enb_ue->t_s1_holding);
@@ -3206,26 +3308,68 @@ void enb_ue_switch_to_enb(enb_ue_t *enb_ue, mme_enb_t *new_enb)
     enb = mme_enb_find_by_id(enb_ue->enb_id);
 
     /* Remove from the old enb */
+    enb_ue_hash_remove(enb, enb_ue);
     ogs_list_remove(&enb->enb_ue_list, enb_ue);
 
     /* Add to the new enb */
     ogs_list_add(&new_enb->enb_ue_list, enb_ue);
+    enb_ue_hash_add(new_enb, enb_ue);
 
     /* Switch to enb */
     enb_ue->enb_id = new_enb->id;
 }
 
+void enb_ue_set_enb_ue_s1ap_id(enb_ue_t *enb_ue, uint32_t enb_ue_s1ap_id)
+{
+    mme_enb_t *enb = NULL;
+
+    ogs_assert(enb_ue);
+
+    enb = mme_enb_find_by_id(enb_ue->enb_id);
+    if (enb) enb_ue_hash_remove(enb, enb_ue);
+
+    enb_ue->enb_ue_s1ap_id = enb_ue_s1ap_id;
+
+    if (enb) enb_ue_hash_add(enb, enb_ue);
+}
+
 enb_ue_t *enb_ue_find_by_enb_ue_s1ap_id(
         const mme_enb_t *enb, uint32_t enb_ue_s1ap_id)
 {
-    enb_ue_t *enb_ue = NULL;
+    ogs_hash_chain_t *node = NULL;
 
-    ogs_list_for_each(&enb->enb_ue_list, enb_ue) {
-        if (enb_ue_s1ap_id == enb_ue->enb_ue_s1ap_id)
-            break;
-    }
+    ogs_assert(enb);
+    ogs_assert(enb->enb_ue_hash);
 
-    return enb_ue;
+    node = ogs_hash_get(enb->enb_ue_hash,
+            &enb_ue_s1ap_id, sizeof(enb_ue_s1ap_id));
+
+    return node ? ogs_container_of(node, enb_ue_t, hash_chain) : NULL;
+}
+
+/*
+ * An eNB may reuse an ENB-UE-S1AP-ID that an older context still holds.
+ * The hash keeps the oldest one, the rest are chained behind it.
+ */
+static void enb_ue_hash_add(mme_enb_t *enb, enb_ue_t *enb_ue)
+{
+    ogs_assert(enb);
+    ogs_assert(enb_ue);
+
+    /* Handover target not yet acknowledged by the eNB */
+    if (enb_ue->enb_ue_s1ap_id == INVALID_UE_S1AP_ID)
+        return;
+
+    ogs_hash_chain_add(enb->enb_ue_hash, &enb_ue->hash_chain,
+            &enb_ue->enb_ue_s1ap_id, sizeof(enb_ue->enb_ue_s1ap_id));
+}
+
+static void enb_ue_hash_remove(mme_enb_t *enb, enb_ue_t *enb_ue)
+{
+    ogs_assert(enb);
+    ogs_assert(enb_ue);
+
+    ogs_hash_chain_remove(enb->enb_ue_hash, &enb_ue->hash_chain);
 }
 
 enb_ue_t *enb_ue_find(uint32_t index)
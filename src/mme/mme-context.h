@@ -152,6 +152,7 @@ typedef struct mme_context_s {
 
     ogs_hash_t *enb_addr_hash;  /* hash table for ENB Address */
     ogs_hash_t *enb_id_hash;    /* hash table for ENB-ID */
+    ogs_hash_t *paging_area_hash; /* hash table (TAI : Paging Area) */
     ogs_hash_t *imsi_ue_hash;   /* hash table (IMSI : MME_UE) */
     ogs_hash_t *guti_ue_hash;   /* hash table (GUTI : MME_UE) */
 
@@ -261,12 +262,32 @@ typedef struct mme_enb_s {
     int             num_of_supported_ta_list;
     ogs_eps_tai_t   supported_ta_list[OGS_MAX_NUM_OF_SUPPORTED_TA];
 
+    /* Paging areas this eNB is registered in (see paging_area_hash) */
+    int             num_of_paging_area;
+    struct mme_paging_area_s **paging_area;
+
     ogs_pkbuf_t     *s1_reset_ack; /* Reset message */
 
     ogs_list_t      enb_ue_list;
+    ogs_hash_t      *enb_ue_hash;   /* hash table (ENB_UE_S1AP_ID : ENB_UE) */
 
 } mme_enb_t;
 
+/*
+ * Every eNB broadcasting a TAI, built from the Supported TAs
+ * on S1 Setup and eNB Configuration Update. S1-Paging walks this list
+ * instead of matching the TAI against every eNB.
+ */
+typedef struct mme_paging_area_s {
+    ogs_eps_tai_t   tai;        /* Hash Key */
+    ogs_list_t      enb_list;   /* mme_paging_enb_t */
+} mme_paging_area_t;
+
+typedef struct mme_paging_enb_s {
+    ogs_lnode_t     lnode;
+    mme_enb_t       *enb;
+} mme_paging_enb_t;
+
 struct enb_ue_s {
     ogs_lnode_t     lnode;
     ogs_pool_id_t   id;
@@ -277,6 +298,9 @@ struct enb_ue_s {
     uint32_t        enb_ue_s1ap_id; /* eNB-UE-S1AP-ID received from eNB */
     uint32_t        mme_ue_s1ap_id; /* MME-UE-S1AP-ID received from MME */
 
+    /* Entry in enb->enb_ue_hash, a reused ENB-UE-S1AP-ID is chained */
+    ogs_hash_chain_t hash_chain;
+
     uint16_t        enb_ostream_id; /* SCTP output stream id for eNB */
 
     /* Handover Info */
@@ -1056,10 +1080,13 @@ mme_enb_t *mme_enb_find_by_enb_id(uint32_t enb_id);
 int mme_enb_set_enb_id(mme_enb_t *enb, uint32_t enb_id);
 int mme_enb_sock_type(ogs_sock_t *sock);
 mme_enb_t *mme_enb_find_by_id(ogs_pool_id_t id);
+void mme_enb_update_paging_area(mme_enb_t *enb);
+mme_paging_area_t *mme_paging_area_find(ogs_eps_tai_t *tai);
 
 enb_ue_t *enb_ue_add(mme_enb_t *enb, uint32_t enb_ue_s1ap_id);
 void enb_ue_remove(enb_ue_t *enb_ue);
 void enb_ue_switch_to_enb(enb_ue_t *enb_ue, mme_enb_t *new_enb);
+void enb_ue_set_enb_ue_s1ap_id(enb_ue_t *enb_ue, uint32_t enb_ue_s1ap_id);
 enb_ue_t *enb_ue_find_by_enb_ue_s1ap_id(
         const mme_enb_t *enb, uint32_t enb_ue_s1ap_id);
 enb_ue_t *enb_ue_find(uint32_t index);
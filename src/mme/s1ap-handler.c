@@ -257,6 +257,8 @@ void s1ap_handle_s1_setup_request(mme_enb_t *enb, ogs_s1ap_message_t *message)
         return;
     }
 
+    mme_enb_update_paging_area(enb);
+
     enb->state.s1_setup_success = true;
     r = s1ap_send_s1_setup_response(enb);
     ogs_expect(r == OGS_OK);
@@ -388,6 +390,8 @@ void s1ap_handle_enb_configuration_update(
             ogs_assert(r != OGS_ERROR);
             return;
         }
+
+        mme_enb_update_paging_area(enb);
     }
 
     if (PagingDRX)
@@ -2568,7 +2572,7 @@ void s1ap_handle_path_switch_request(
             mme_ue->e_cgi.cell_id);
 
     /* Update ENB-UE-S1AP-ID */
-    enb_ue->enb_ue_s1ap_id = *ENB_UE_S1AP_ID;
+    enb_ue_set_enb_ue_s1ap_id(enb_ue, *ENB_UE_S1AP_ID);
 
     /* Change enb_ue to the NEW eNB */
     enb_ue_switch_to_enb(enb_ue, enb);
@@ -3169,7 +3173,7 @@ void s1ap_handle_handover_request_ack(
     ogs_debug("    Target : ENB_UE_S1AP_ID[%d] MME_UE_S1AP_ID[%d]",
             target_ue->enb_ue_s1ap_id, target_ue->mme_ue_s1ap_id);
 
-    target_ue->enb_ue_s1ap_id = *ENB_UE_S1AP_ID;
+    enb_ue_set_enb_ue_s1ap_id(target_ue, *ENB_UE_S1AP_ID);
 
     for (i = 0; i < E_RABAdmittedList->list.count; i++) {
         S1AP_E_RABAdmittedItemIEs_t *item = NULL;
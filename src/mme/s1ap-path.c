@@ -76,6 +76,47 @@ int s1ap_send_to_enb(mme_enb_t *enb, ogs_pkbuf_t *pkbuf, uint16_t stream_no)
     }
 }
 
+/* The caller keeps pkbuf so that one PDU can be sent to several eNBs */
+int s1ap_send_to_enb_without_free(
+        mme_enb_t *enb, ogs_pkbuf_t *pkbuf, uint16_t stream_no)
+{
+    char buf[OGS_ADDRSTRLEN];
+    int sent;
+
+    ogs_assert(pkbuf);
+    ogs_assert(enb);
+
+    ogs_assert(enb->sctp.sock);
+    if (enb->sctp.sock->fd == INVALID_SOCKET) {
+        ogs_error("eNB SCTP socket has already been destroyed");
+        ogs_log_hexdump(OGS_LOG_FATAL, pkbuf->data, pkbuf->len);
+        return OGS_ERROR;
+    }
+
+    if (enb->sctp.type == SOCK_STREAM) {
+        ogs_pkbuf_t *sendbuf = ogs_pkbuf_copy(pkbuf);
+        if (!sendbuf) {
+            ogs_error("ogs_pkbuf_copy() failed");
+            return OGS_ERROR;
+        }
+        return s1ap_send_to_enb(enb, sendbuf, stream_no);
+    }
+
+    ogs_debug("    IP[%s] ENB_ID[%d]",
+            OGS_ADDR(enb->sctp.addr, buf), enb->enb_id);
+
+    sent = ogs_sctp_sendmsg(enb->sctp.sock, pkbuf->data, pkbuf->len,
+            enb->sctp.addr, OGS_SCTP_S1AP_PPID, stream_no);
+    if (sent < 0 || sent != pkbuf->len) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                "ogs_sctp_sendmsg(len:%d,ssn:%d)",
+                pkbuf->len, (int)stream_no);
+        return OGS_ERROR;
+    }
+
+    return OGS_OK;
+}
+
 int s1ap_send_to_enb_ue(enb_ue_t *enb_ue, ogs_pkbuf_t *pkbuf)
 {
     int rv;
@@ -492,9 +533,8 @@ int s1ap_send_ue_context_release_command(
 
 int s1ap_send_paging(mme_ue_t *mme_ue, S1AP_CNDomain_t cn_domain)
 {
-    ogs_pkbuf_t *s1apbuf = NULL;
-    mme_enb_t *enb = NULL;
-    int i;
+    mme_paging_area_t *area = NULL;
+    mme_paging_enb_t *node = NULL;
     int rv;
 
     ogs_debug("S1-Paging");
@@ -505,34 +545,23 @@ int s1ap_send_paging(mme_ue_t *mme_ue, S1AP_CNDomain_t cn_domain)
     }
 
     /* Find enB with matched TAI */
-    ogs_list_for_each(&mme_self()->enb_list, enb) {
-        for (i = 0; i < enb->num_of_supported_ta_list; i++) {
-
-            if (memcmp(&enb->supported_ta_list[i], &mme_ue->tai,
-                        sizeof(ogs_eps_tai_t)) == 0) {
-
-                if (mme_ue->t3413.pkbuf) {
-                    s1apbuf = mme_ue->t3413.pkbuf;
-                } else {
-                    s1apbuf = s1ap_build_paging(mme_ue, cn_domain);
-                    if (!s1apbuf) {
-                        ogs_error("s1ap_build_paging() failed");
-                        return OGS_ERROR;
-                    }
-                }
-
-                mme_ue->t3413.pkbuf = ogs_pkbuf_copy(s1apbuf);
-                if (!mme_ue->t3413.pkbuf) {
-                    ogs_error("ogs_pkbuf_copy() failed");
-                    ogs_pkbuf_free(s1apbuf);
-                    return OGS_ERROR;
-                }
-
-                rv = s1ap_send_to_enb(enb, s1apbuf, S1AP_NON_UE_SIGNALLING);
-                if (rv != OGS_OK) {
-                    ogs_error("s1ap_send_to_enb() failed");
-                    return rv;
-                }
+    area = mme_paging_area_find(&mme_ue->tai);
+    if (area && ogs_list_first(&area->enb_list)) {
+        /* Encoded once and kept for retransmission on T3413 expiry */
+        if (!mme_ue->t3413.pkbuf) {
+            mme_ue->t3413.pkbuf = s1ap_build_paging(mme_ue, cn_domain);
+            if (!mme_ue->t3413.pkbuf) {
+                ogs_error("s1ap_build_paging() failed");
+                return OGS_ERROR;
+            }
+        }
+
+        ogs_list_for_each(&area->enb_list, node) {
+            rv = s1ap_send_to_enb_without_free(
+                    node->enb, mme_ue->t3413.pkbuf, S1AP_NON_UE_SIGNALLING);
+            if (rv != OGS_OK) {
+                ogs_error("s1ap_send_to_enb_without_free() failed");
+                return rv;
             }
         }
     }
@@ -39,6 +39,8 @@ void s1ap_recv_upcall(short when, ogs_socket_t fd, void *data);
 
 int s1ap_send_to_enb(
         mme_enb_t *enb, ogs_pkbuf_t *pkb, uint16_t stream_no);
+int s1ap_send_to_enb_without_free(
+        mme_enb_t *enb, ogs_pkbuf_t *pkbuf, uint16_t stream_no);
 int s1ap_send_to_enb_ue(enb_ue_t *enb_ue, ogs_pkbuf_t *pkbuf);
 int s1ap_delayed_send_to_enb_ue(enb_ue_t *enb_ue,
         ogs_pkbuf_t *pkbuf, ogs_time_t duration);
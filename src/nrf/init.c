@@ -17,6 +17,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "ogs-metrics.h"
 #include "sbi-path.h"
 
 static ogs_thread_t *thread;
@@ -31,6 +32,9 @@ int nrf_initialize(void)
     rv = ogs_app_parse_local_conf(APP_NAME);
     if (rv != OGS_OK) return rv;
 
+    ogs_metrics_context_init();
+    ogs_sbi_client_metrics_init();
+
     ogs_sbi_context_init(OpenAPI_nf_type_NRF);
     nrf_context_init();
 
@@ -41,9 +45,14 @@ int nrf_initialize(void)
     rv = ogs_sbi_context_parse_config(APP_NAME, NULL, NULL);
     if (rv != OGS_OK) return rv;
 
+    rv = ogs_metrics_context_parse_config(APP_NAME);
+    if (rv != OGS_OK) return rv;
+
     rv = nrf_context_parse_config();
     if (rv != OGS_OK) return rv;
 
+    ogs_metrics_context_open(ogs_metrics_self());
+
     rv = nrf_sbi_open();
     if (rv != OGS_OK) return rv;
 
@@ -84,8 +93,13 @@ void nrf_terminate(void)
 
     nrf_sbi_close();
 
+    ogs_metrics_context_close(ogs_metrics_self());
+
     nrf_context_final();
     ogs_sbi_context_final();
+
+    ogs_sbi_client_metrics_final();
+    ogs_metrics_context_final();
 }
 
 static void nrf_main(void *data)
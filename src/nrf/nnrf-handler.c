@@ -148,6 +148,7 @@ bool nrf_nnrf_handle_nf_register(ogs_sbi_nf_instance_t *nf_instance,
         memcpy(nf_instance->plmn_id, ogs_local_conf()->serving_plmn_id,
                 sizeof(nf_instance->plmn_id));
         nf_instance->num_of_plmn_id = ogs_local_conf()->num_of_serving_plmn_id;
+        ogs_sbi_nf_instance_update_index(nf_instance);
     }
 
     if (OGS_FSM_CHECK(&nf_instance->sm, nrf_nf_state_will_register)) {
@@ -316,6 +317,7 @@ bool nrf_nnrf_handle_nf_update(ogs_sbi_nf_instance_t *nf_instance,
                     memset(nf_instance->plmn_id, 0,
                             sizeof(nf_instance->plmn_id));
                     nf_instance->num_of_plmn_id = 0;
+                    ogs_sbi_nf_instance_update_index(nf_instance);
 
                     /* Iterate through the JSON array of PLMN IDs */
                     cJSON_ArrayForEach(plmn_item, plmn_array) {
@@ -366,6 +368,7 @@ bool nrf_nnrf_handle_nf_update(ogs_sbi_nf_instance_t *nf_instance,
                                     plmn_id[nf_instance->num_of_plmn_id],
                                 &plmn_id);
                         nf_instance->num_of_plmn_id++;
+                        ogs_sbi_nf_instance_update_index(nf_instance);
 
                         /* Compare with the serving PLMN list */
                         for (i = 0;
@@ -944,6 +947,7 @@ bool nrf_nnrf_handle_nf_discover(
     ogs_sbi_message_t sendmsg;
     ogs_sbi_response_t *response = NULL;
     ogs_sbi_nf_instance_t *nf_instance = NULL;
+    ogs_sbi_nf_index_node_t *index_node = NULL;
     ogs_sbi_discovery_option_t *discovery_option = NULL;
 
     OpenAPI_search_result_t *SearchResult = NULL;
@@ -1044,7 +1048,10 @@ bool nrf_nnrf_handle_nf_discover(
     ogs_assert(SearchResult->nf_instances);
 
     i = 0;
-    ogs_list_for_each(&ogs_sbi_self()->nf_instance_list, nf_instance) {
+    ogs_list_for_each(ogs_sbi_nf_instance_index_list(
+                recvmsg->param.target_nf_type, discovery_option), index_node) {
+        nf_instance = index_node->nf_instance;
+
         if (NF_INSTANCE_EXCLUDED_FROM_DISCOVERY(nf_instance))
             continue;
 
@@ -1126,15 +1133,18 @@ bool nrf_nnrf_handle_nf_discover(
 
         nrf_assoc_t *assoc = NULL;
 
-        ogs_list_for_each(&ogs_sbi_self()->nf_instance_list, nf_instance) {
-            if (NF_INSTANCE_ID_IS_SELF(nf_instance->id))
+        ogs_list_for_each(ogs_sbi_nf_instance_index_list(
+                    OpenAPI_nf_type_NRF, discovery_option), index_node) {
+            ogs_sbi_nf_instance_t *home_nrf = index_node->nf_instance;
+
+            if (NF_INSTANCE_ID_IS_SELF(home_nrf->id))
                 continue;
 
-            if (nf_instance->nf_type != OpenAPI_nf_type_NRF)
+            if (home_nrf->nf_type != OpenAPI_nf_type_NRF)
                 continue;
 
             if (ogs_sbi_discovery_option_target_plmn_list_is_matched(
-                        nf_instance, discovery_option) == false)
+                        home_nrf, discovery_option) == false)
                 continue;
 
             /*
@@ -1144,9 +1154,10 @@ bool nrf_nnrf_handle_nf_discover(
              * absence of hnrf-uri, so the following match routine is used.
              */
             if (ogs_sbi_discovery_option_hnrf_uri_is_matched(
-                        nf_instance, discovery_option) == false)
+                        home_nrf, discovery_option) == false)
                 continue;
 
+            nf_instance = home_nrf;
             break;
         }
 
@@ -1167,6 +1178,7 @@ bool nrf_nnrf_handle_nf_discover(
                     sizeof(nf_instance->plmn_id));
             nf_instance->num_of_plmn_id =
                 discovery_option->num_of_target_plmn_list;
+            ogs_sbi_nf_instance_update_index(nf_instance);
 
             /*
              * NRFs with a Home PLMN can use the target_plmn information
@@ -272,6 +272,8 @@ int nssf_context_parse_config(void)
                     /* handle config in sbi library */
                 } else if (!strcmp(nssf_key, "discovery")) {
                     /* handle config in sbi library */
+                } else if (!strcmp(nssf_key, "metrics")) {
+                    /* handle config in metrics library */
                 } else
                     ogs_warn("unknown key `%s`", nssf_key);
             }
@@ -198,6 +198,8 @@ void pcf_metrics_init(void)
 
     pcf_metrics_init_inst_global();
     pcf_metrics_init_by_slice();
+
+    ogs_sbi_client_metrics_init();
 }
 
 void pcf_metrics_final(void)
@@ -220,5 +222,6 @@ void pcf_metrics_final(void)
         ogs_hash_destroy(metrics_hash_by_slice);
     }
 
+    ogs_sbi_client_metrics_final();
     ogs_metrics_context_final();
 }
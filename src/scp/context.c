@@ -148,6 +148,8 @@ int scp_context_parse_config(void)
                     /* handle config in sbi library */
                 } else if (!strcmp(scp_key, "discovery")) {
                     /* handle config in sbi library */
+                } else if (!strcmp(scp_key, "metrics")) {
+                    /* handle config in metrics library */
                 } else if (!strcmp(scp_key, "info")) {
                     ogs_sbi_nf_instance_t *nf_instance = NULL;
                     ogs_sbi_nf_info_t *nf_info = NULL;
@@ -17,6 +17,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "ogs-metrics.h"
 #include "context.h"
 #include "sbi-path.h"
 
@@ -33,6 +34,9 @@ int scp_initialize(void)
     rv = ogs_app_parse_local_conf(APP_NAME);
     if (rv != OGS_OK) return rv;
 
+    ogs_metrics_context_init();
+    ogs_sbi_client_metrics_init();
+
     ogs_sbi_context_init(OpenAPI_nf_type_SCP);
     scp_context_init();
 
@@ -43,9 +47,14 @@ int scp_initialize(void)
     rv = ogs_sbi_context_parse_config(APP_NAME, "nrf", "next_scp");
     if (rv != OGS_OK) return rv;
 
+    rv = ogs_metrics_context_parse_config(APP_NAME);
+    if (rv != OGS_OK) return rv;
+
     rv = scp_context_parse_config();
     if (rv != OGS_OK) return rv;
 
+    ogs_metrics_context_open(ogs_metrics_self());
+
     rv = scp_sbi_open();
     if (rv != 0) return OGS_ERROR;
 
@@ -92,8 +101,13 @@ void scp_terminate(void)
 
     scp_sbi_close();
 
+    ogs_metrics_context_close(ogs_metrics_self());
+
     scp_context_final();
     ogs_sbi_context_final();
+
+    ogs_sbi_client_metrics_final();
+    ogs_metrics_context_final();
 }
 
 static void scp_main(void *data)
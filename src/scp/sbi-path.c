@@ -794,6 +794,8 @@ static int nf_discover_handler(
     }
 
     ogs_nnrf_disc_handle_nf_discover_search_result(message.SearchResult);
+    ogs_sbi_discovery_cache_update(target_nf_type, requester_nf_type,
+            discovery_option, message.SearchResult);
 
     nf_instance = ogs_sbi_nf_instance_find_by_discovery_param(
             target_nf_type, requester_nf_type, discovery_option);
@@ -934,6 +936,8 @@ static int sepp_discover_handler(
     }
 
     ogs_nnrf_disc_handle_nf_discover_search_result(message.SearchResult);
+    ogs_sbi_discovery_cache_update(OpenAPI_nf_type_SEPP,
+            assoc->requester_nf_type, NULL, message.SearchResult);
 
     /*****************************
      * Check if SEPP is discovered
@@ -24,39 +24,29 @@
 
 static ogs_pkbuf_pool_t *packet_pool = NULL;
 
-static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
+/*
+ * Receive buffers for ogs_recvmmsg(). Packets are copied out into
+ * right-sized clusters, and a slot is refilled only when handed over.
+ */
+static ogs_pkbuf_t *rxbuf[OGS_MAX_NUM_OF_MMSG];
+static ogs_sockaddr_t rxfrom[OGS_MAX_NUM_OF_MMSG];
+
+static void sgwu_gtp_handle_packet(ogs_socket_t fd, ogs_sock_t *sock,
+        ogs_pkbuf_t *pkbuf, ogs_sockaddr_t *from)
 {
     int len;
-    ssize_t size;
     char buf1[OGS_ADDRSTRLEN];
     char buf2[OGS_ADDRSTRLEN];
 
     sgwu_sess_t *sess = NULL;
 
-    ogs_pkbuf_t *pkbuf = NULL;
-    ogs_sock_t *sock = NULL;
-    ogs_sockaddr_t from;
-
     ogs_gtp2_header_t *gtp_h = NULL;
     ogs_gtp2_header_desc_t header_desc;
     ogs_pfcp_user_plane_report_t report;
 
     ogs_assert(fd != INVALID_SOCKET);
-    sock = data;
     ogs_assert(sock);
-
-    pkbuf = ogs_pkbuf_alloc(packet_pool, OGS_MAX_PKT_LEN);
-    ogs_assert(pkbuf);
-    ogs_pkbuf_put(pkbuf, OGS_MAX_PKT_LEN);
-
-    size = ogs_recvfrom(fd, pkbuf->data, pkbuf->len, 0, &from);
-    if (size <= 0) {
-        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
-                "ogs_recv() failed");
-        goto cleanup;
-    }
-
-    ogs_pkbuf_trim(pkbuf, size);
+    ogs_assert(from);
 
     ogs_assert(pkbuf);
     ogs_assert(pkbuf->len);
@@ -77,16 +67,16 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
     if (header_desc.type == OGS_GTPU_MSGTYPE_ECHO_REQ) {
         ogs_pkbuf_t *echo_rsp;
 
-        ogs_debug("[RECV] Echo Request from [%s]", OGS_ADDR(&from, buf1));
+        ogs_debug("[RECV] Echo Request from [%s]", OGS_ADDR(from, buf1));
         echo_rsp = ogs_gtp2_handle_echo_req(pkbuf);
         ogs_expect(echo_rsp);
         if (echo_rsp) {
             ssize_t sent;
 
             /* Echo reply */
-            ogs_debug("[SEND] Echo Response to [%s]", OGS_ADDR(&from, buf1));
+            ogs_debug("[SEND] Echo Response to [%s]", OGS_ADDR(from, buf1));
 
-            sent = ogs_sendto(fd, echo_rsp->data, echo_rsp->len, 0, &from);
+            sent = ogs_sendto(fd, echo_rsp->data, echo_rsp->len, 0, from);
             if (sent < 0 || sent != echo_rsp->len) {
                 ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
                         "ogs_sendto() failed");
@@ -104,7 +94,7 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
     }
 
     ogs_trace("[RECV] GPU-U Type [%d] from [%s] : TEID[0x%x]",
-            header_desc.type, OGS_ADDR(&from, buf1), header_desc.teid);
+            header_desc.type, OGS_ADDR(from, buf1), header_desc.teid);
 
     /* Remove GTP header and send packets to peer NF */
     ogs_assert(ogs_pkbuf_pull(pkbuf, len));
@@ -135,9 +125,9 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
                 ogs_error("[%s] Send Error Indication [TEID:0x%x] to [%s]",
                         OGS_ADDR(&sock->local_addr, buf1),
                         header_desc.teid,
-                        OGS_ADDR(&from, buf2));
+                        OGS_ADDR(from, buf2));
                 ogs_gtp1_send_error_indication(
-                        sock, header_desc.teid, 0, &from);
+                        sock, header_desc.teid, 0, from);
             }
             goto cleanup;
         }
@@ -217,9 +207,9 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
                 ogs_error("[%s] Send Error Indication [TEID:0x%x] to [%s]",
                         OGS_ADDR(&sock->local_addr, buf1),
                         header_desc.teid,
-                        OGS_ADDR(&from, buf2));
+                        OGS_ADDR(from, buf2));
                 ogs_gtp1_send_error_indication(
-                        sock, header_desc.teid, 0, &from);
+                        sock, header_desc.teid, 0, from);
             }
             goto cleanup;
         }
@@ -295,12 +285,56 @@ cleanup:
     ogs_pkbuf_free(pkbuf);
 }
 
+static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
+{
+    int i, n;
+    ogs_sock_t *sock = NULL;
+    ogs_gtp_sendbatch_t sendbatch;
+
+    ogs_assert(fd != INVALID_SOCKET);
+    sock = data;
+    ogs_assert(sock);
+
+    for (i = 0; i < OGS_MAX_NUM_OF_MMSG; i++) {
+        if (!rxbuf[i]) {
+            rxbuf[i] = ogs_pkbuf_alloc(packet_pool, OGS_MAX_PKT_LEN);
+            ogs_assert(rxbuf[i]);
+        }
+        ogs_pkbuf_put(rxbuf[i], ogs_pkbuf_tailroom(rxbuf[i]));
+    }
+
+    n = ogs_recvmmsg(fd, rxbuf, rxfrom, OGS_MAX_NUM_OF_MMSG, 0);
+    if (n <= 0) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                "ogs_recvmmsg() failed");
+        return;
+    }
+
+    ogs_gtp_sendbatch_begin(&sendbatch);
+
+    for (i = 0; i < n; i++) {
+        ogs_pkbuf_t *pkbuf = ogs_pkbuf_right_size(packet_pool, &rxbuf[i]);
+
+        sgwu_gtp_handle_packet(fd, sock, pkbuf, &rxfrom[i]);
+    }
+
+    ogs_gtp_sendbatch_end();
+}
+
 int sgwu_gtp_init(void)
 {
     ogs_pkbuf_config_t config;
     memset(&config, 0, sizeof config);
 
-    config.cluster_2048_pool = ogs_app()->pool.gtpu;
+    /*
+     * Received packets are moved into the smallest cluster that fits them,
+     * and buffered packets no longer hold a cluster (see lib/pfcp/buffer.c).
+     */
+    config.cluster_128_pool = ogs_app()->pool.gtpu / 4;
+    config.cluster_256_pool = ogs_app()->pool.gtpu / 4;
+    config.cluster_512_pool = ogs_app()->pool.gtpu / 4;
+    config.cluster_1024_pool = ogs_app()->pool.gtpu / 4;
+    config.cluster_2048_pool = ogs_app()->pool.gtpu / 2;
 
 #if OGS_USE_TALLOC == 1
     /* allocate a talloc pool for GTP to ensure it doesn't have to go back
@@ -345,5 +379,14 @@ int sgwu_gtp_open(void)
 
 void sgwu_gtp_close(void)
 {
+    int i;
+
     ogs_socknode_remove_all(&ogs_gtp_self()->gtpu_list);
+
+    for (i = 0; i < OGS_MAX_NUM_OF_MMSG; i++) {
+        if (rxbuf[i]) {
+            ogs_pkbuf_free(rxbuf[i]);
+            rxbuf[i] = NULL;
+        }
+    }
 }
@@ -36,6 +36,7 @@ int sgwu_initialize(void)
 
     ogs_gtp_context_init(OGS_MAX_NUM_OF_GTPU_RESOURCE);
     ogs_pfcp_context_init();
+    ogs_pfcp_buffer_init();
 
     sgwu_context_init();
     sgwu_event_init();
@@ -84,6 +85,7 @@ void sgwu_terminate(void)
 
     sgwu_context_final();
 
+    ogs_pfcp_buffer_final();
     ogs_pfcp_context_final();
     ogs_gtp_context_final();
 
@@ -83,6 +83,10 @@ void smf_context_init(void)
     ogs_log_install_domain(&__smf_log_domain, "smf", ogs_core()->log.level);
     ogs_log_install_domain(&__gsm_log_domain, "gsm", ogs_core()->log.level);
 
+    /* Setup CP Function Features */
+    ogs_pfcp_self()->cp_function_features.load = 1;
+    ogs_pfcp_self()->cp_function_features.ovrl = 1;
+
     ogs_pool_init(&smf_gtp_node_pool, ogs_app()->pool.nf);
     ogs_pool_init(&smf_ue_pool, ogs_global_conf()->max.ue);
     ogs_pool_init(&smf_bearer_pool, ogs_app()->pool.bearer);
@@ -93,15 +97,15 @@ void smf_context_init(void)
     ogs_pool_init(&smf_n4_seid_pool, ogs_app()->pool.sess);
     ogs_pool_random_id_generate(&smf_n4_seid_pool);
 
-    self.supi_hash = ogs_hash_make();
+    self.supi_hash = ogs_hash_make_size(ogs_global_conf()->max.ue);
     ogs_assert(self.supi_hash);
-    self.imsi_hash = ogs_hash_make();
+    self.imsi_hash = ogs_hash_make_size(ogs_global_conf()->max.ue);
     ogs_assert(self.imsi_hash);
-    self.smf_n4_seid_hash = ogs_hash_make();
+    self.smf_n4_seid_hash = ogs_hash_make_size(ogs_app()->pool.sess);
     ogs_assert(self.smf_n4_seid_hash);
-    self.ipv4_hash = ogs_hash_make();
+    self.ipv4_hash = ogs_hash_make_size(ogs_app()->pool.sess);
     ogs_assert(self.ipv4_hash);
-    self.ipv6_hash = ogs_hash_make();
+    self.ipv6_hash = ogs_hash_make_size(ogs_app()->pool.sess);
     ogs_assert(self.ipv6_hash);
     self.n1n2message_hash = ogs_hash_make();
     ogs_assert(self.n1n2message_hash);
@@ -1181,71 +1185,65 @@ static bool compare_ue_info(ogs_pfcp_node_t *node, smf_sess_t *sess)
     return false;
 }
 
-static ogs_pfcp_node_t *selected_upf_node(
-        ogs_pfcp_node_t *current, smf_sess_t *sess)
+/*
+ * Smooth weighted round-robin: equal weights give the plain round-robin
+ * order of pfcp_peer_list.
+ */
+static ogs_pfcp_node_t *selected_upf_node(smf_sess_t *sess, bool matched)
 {
-    ogs_pfcp_node_t *next, *node;
+    ogs_pfcp_node_t *node = NULL, *selected = NULL;
+    int total = 0;
 
-    ogs_assert(current);
     ogs_assert(sess);
 
-    /* continue search from current position */
-    next = ogs_list_next(current);
-    for (node = next; node; node = ogs_list_next(node)) {
-        if (OGS_FSM_CHECK(&node->sm, smf_pfcp_state_associated) &&
-            compare_ue_info(node, sess) == true) return node;
-    }
-    /* cyclic search from top to current position */
-    for (node = ogs_list_first(&ogs_pfcp_self()->pfcp_peer_list);
-            node != next; node = ogs_list_next(node)) {
-        if (OGS_FSM_CHECK(&node->sm, smf_pfcp_state_associated) &&
-            compare_ue_info(node, sess) == true) return node;
-    }
-
-    if (ogs_global_conf()->parameter.no_pfcp_rr_select == 0) {
-        /* continue search from current position */
-        next = ogs_list_next(current);
-        for (node = next; node; node = ogs_list_next(node)) {
-            if (OGS_FSM_CHECK(&node->sm, smf_pfcp_state_associated))
-                return node;
-        }
-        /* cyclic search from top to current position */
-        for (node = ogs_list_first(&ogs_pfcp_self()->pfcp_peer_list);
-                node != next; node = ogs_list_next(node)) {
-            if (OGS_FSM_CHECK(&node->sm, smf_pfcp_state_associated))
-                return node;
-        }
+    ogs_list_for_each(&ogs_pfcp_self()->pfcp_peer_list, node) {
+        int weight;
+
+        if (!OGS_FSM_CHECK(&node->sm, smf_pfcp_state_associated))
+            continue;
+        if (matched == true && compare_ue_info(node, sess) == false)
+            continue;
+
+        weight = ogs_pfcp_node_weight(node);
+        node->current_weight += weight;
+        total += weight;
+
+        if (!selected || node->current_weight > selected->current_weight)
+            selected = node;
     }
 
-    ogs_error("No UPFs are PFCP associated that are suited to RR");
-    return ogs_list_first(&ogs_pfcp_self()->pfcp_peer_list);
+    if (selected)
+        selected->current_weight -= total;
+
+    return selected;
 }
 
 void smf_sess_select_upf(smf_sess_t *sess)
 {
+    ogs_pfcp_node_t *node = NULL;
+
     ogs_assert(sess);
 
-    /*
-     * When used for the first time, if last node is set,
-     * the search is performed from the first UPF in a round-robin manner.
-     */
-    if (ogs_pfcp_self()->pfcp_node == NULL)
-        ogs_pfcp_self()->pfcp_node =
-            ogs_list_last(&ogs_pfcp_self()->pfcp_peer_list);
-
-    if (ogs_pfcp_self()->pfcp_node) {
-        /* setup GTP session with selected UPF */
-        ogs_pfcp_self()->pfcp_node =
-            selected_upf_node(ogs_pfcp_self()->pfcp_node, sess);
-        ogs_assert(ogs_pfcp_self()->pfcp_node);
-        OGS_SETUP_PFCP_NODE(sess, ogs_pfcp_self()->pfcp_node);
-        ogs_debug("UE using UPF on IP %s",
-                ogs_sockaddr_to_string_static(
-                    ogs_pfcp_self()->pfcp_node->addr_list));
-    } else {
+    if (ogs_list_first(&ogs_pfcp_self()->pfcp_peer_list) == NULL) {
         ogs_error("No suitable UPF found for session");
         ogs_assert(sess->pfcp_node == NULL);
+        return;
+    }
+
+    node = selected_upf_node(sess, true);
+    if (!node && ogs_global_conf()->parameter.no_pfcp_rr_select == 0)
+        node = selected_upf_node(sess, false);
+    if (!node) {
+        ogs_error("No UPFs are PFCP associated that are suited to RR");
+        node = ogs_list_first(&ogs_pfcp_self()->pfcp_peer_list);
     }
+
+    /* setup GTP session with selected UPF */
+    ogs_pfcp_self()->pfcp_node = node;
+    OGS_SETUP_PFCP_NODE(sess, node);
+    ogs_debug("UE using UPF on IP %s [load:%d overload:%d]",
+            ogs_sockaddr_to_string_static(node->addr_list),
+            node->load.metric, node->overload.reduction_metric);
 }
 
 smf_sess_t *smf_sess_add_by_apn(smf_ue_t *smf_ue, char *apn, uint8_t rat_type)
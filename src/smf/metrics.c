@@ -515,6 +515,8 @@ void smf_metrics_init(void)
     smf_metrics_init_by_slice();
     smf_metrics_init_by_5qi();
     smf_metrics_init_by_cause();
+
+    ogs_sbi_client_metrics_init();
 }
 
 void smf_metrics_final(void)
@@ -567,5 +569,6 @@ void smf_metrics_final(void)
         ogs_hash_destroy(metrics_hash_by_cause);
     }
 
+    ogs_sbi_client_metrics_final();
     ogs_metrics_context_final();
 }
@@ -26,6 +26,8 @@
 static void pfcp_restoration(ogs_pfcp_node_t *node);
 static void reselect_upf(ogs_pfcp_node_t *node);
 static void node_timeout(ogs_pfcp_xact_t *xact, void *data);
+static void handle_load_control(
+        ogs_pfcp_node_t *node, ogs_pfcp_message_t *message);
 
 void smf_pfcp_state_initial(ogs_fsm_t *s, smf_event_t *e)
 {
@@ -227,6 +229,8 @@ void smf_pfcp_state_associated(ogs_fsm_t *s, smf_event_t *e)
         if (sess)
             e->sess_id = sess->id;
 
+        handle_load_control(node, message);
+
         switch (message->h.type) {
         case OGS_PFCP_HEARTBEAT_REQUEST_TYPE:
             ogs_expect(true ==
@@ -532,6 +536,48 @@ static void reselect_upf(ogs_pfcp_node_t *node)
     }
 }
 
+static void handle_load_control(
+        ogs_pfcp_node_t *node, ogs_pfcp_message_t *message)
+{
+    ogs_pfcp_tlv_load_control_information_t *lci = NULL;
+    ogs_pfcp_tlv_overload_control_information_t *oci = NULL;
+
+    ogs_assert(node);
+    ogs_assert(message);
+
+    switch (message->h.type) {
+    case OGS_PFCP_SESSION_ESTABLISHMENT_RESPONSE_TYPE:
+        lci = &message->pfcp_session_establishment_response.
+            load_control_information;
+        oci = &message->pfcp_session_establishment_response.
+            overload_control_information;
+        break;
+    case OGS_PFCP_SESSION_MODIFICATION_RESPONSE_TYPE:
+        lci = &message->pfcp_session_modification_response.
+            load_control_information;
+        oci = &message->pfcp_session_modification_response.
+            overload_control_information;
+        break;
+    case OGS_PFCP_SESSION_DELETION_RESPONSE_TYPE:
+        lci = &message->pfcp_session_deletion_response.
+            load_control_information;
+        oci = &message->pfcp_session_deletion_response.
+            overload_control_information;
+        break;
+    case OGS_PFCP_SESSION_REPORT_REQUEST_TYPE:
+        lci = &message->pfcp_session_report_request.
+            load_control_information;
+        oci = &message->pfcp_session_report_request.
+            overload_control_information;
+        break;
+    default:
+        return;
+    }
+
+    ogs_pfcp_cp_handle_load_control_information(node, lci);
+    ogs_pfcp_cp_handle_overload_control_information(node, oci);
+}
+
 static void node_timeout(ogs_pfcp_xact_t *xact, void *data)
 {
     int rv;
@@ -131,6 +131,14 @@ int udm_context_parse_config(void)
                     /* handle config in sbi library */
                 } else if (!strcmp(udm_key, "discovery")) {
                     /* handle config in sbi library */
+                } else if (!strcmp(udm_key, "metrics")) {
+                    /* handle config in metrics library */
+                } else if (!strcmp(udm_key, "av_reserve")) {
+                    const char *v = ogs_yaml_iter_value(&udm_iter);
+                    if (v) self.av_reserve = atoi(v);
+                } else if (!strcmp(udm_key, "suci_worker")) {
+                    const char *v = ogs_yaml_iter_value(&udm_iter);
+                    if (v) self.suci_worker = atoi(v);
                 } else if (!strcmp(udm_key, "hnet")) {
                     rv = ogs_sbi_context_parse_hnet_config(&udm_iter);
                     if (rv != OGS_OK) return rv;
@@ -146,7 +154,8 @@ int udm_context_parse_config(void)
     return OGS_OK;
 }
 
-udm_ue_t *udm_ue_add(char *suci)
+/* 'supi' is given when the SUCI has already been de-concealed */
+udm_ue_t *udm_ue_add(char *suci, char *supi)
 {
     udm_event_t e;
     udm_ue_t *udm_ue = NULL;
@@ -178,7 +187,10 @@ udm_ue_t *udm_ue_add(char *suci)
         return NULL;
     }
 
-    udm_ue->supi = ogs_supi_from_supi_or_suci(udm_ue->suci);
+    if (supi)
+        udm_ue->supi = ogs_strdup(supi);
+    else
+        udm_ue->supi = ogs_supi_from_supi_or_suci(udm_ue->suci);
     if (!udm_ue->supi) {
         ogs_error("No memory for udm_ue->supi [%s]", suci);
         ogs_free(udm_ue->suci);
@@ -241,6 +253,8 @@ void udm_ue_remove(udm_ue_t *udm_ue)
     if (udm_ue->dereg_callback_uri)
         ogs_free(udm_ue->dereg_callback_uri);
 
+    udm_ue_av_clear(udm_ue);
+
     ogs_pool_id_free(&udm_ue_pool, udm_ue);
 }
 
@@ -279,6 +293,76 @@ udm_ue_t *udm_ue_find_by_ctx_id(char *ctx_id)
     return ogs_pool_find(&udm_ue_pool, atoll(ctx_id));
 }
 
+/*
+ * Generates the vectors following udm_ue->sqn. The UDR is then asked
+ * to move its SQN to udm_ue->av_sqn, the last one reserved.
+ */
+int udm_ue_av_reserve(udm_ue_t *udm_ue)
+{
+    uint64_t sqn;
+    int i, num;
+
+    ogs_assert(udm_ue);
+
+    udm_ue_av_clear(udm_ue);
+
+    num = self.av_reserve - 1;
+    if (num <= 0)
+        return OGS_ERROR;
+
+    udm_ue->av = ogs_calloc(num, sizeof(*udm_ue->av));
+    if (!udm_ue->av) {
+        ogs_error("ogs_calloc() failed");
+        return OGS_ERROR;
+    }
+
+    sqn = ogs_buffer_to_uint64(udm_ue->sqn, OGS_SQN_LEN);
+    for (i = 0; i < num; i++) {
+        ogs_random(udm_ue->av[i].rand, OGS_RAND_LEN);
+        ogs_uint64_to_buffer(ogs_auc_sqn_next(sqn, i + 1),
+                OGS_SQN_LEN, udm_ue->av[i].sqn);
+    }
+
+    if (milenage_generate_batch(udm_ue->opc, udm_ue->amf, udm_ue->k,
+                udm_ue->av, num) != 0) {
+        ogs_error("[%s] milenage_generate_batch() failed", udm_ue->suci);
+        udm_ue_av_clear(udm_ue);
+        return OGS_ERROR;
+    }
+
+    udm_ue->num_of_av = num;
+    memcpy(udm_ue->av_sqn, udm_ue->av[num-1].sqn, OGS_SQN_LEN);
+
+    return OGS_OK;
+}
+
+milenage_vector_t *udm_ue_av_get(udm_ue_t *udm_ue)
+{
+    milenage_vector_t *av = NULL;
+
+    ogs_assert(udm_ue);
+
+    if (!udm_ue->av_confirmed || udm_ue->av_next >= udm_ue->num_of_av)
+        return NULL;
+
+    av = &udm_ue->av[udm_ue->av_next++];
+    udm_ue->av_confirmed = false;
+
+    return av;
+}
+
+void udm_ue_av_clear(udm_ue_t *udm_ue)
+{
+    ogs_assert(udm_ue);
+
+    if (udm_ue->av)
+        ogs_free(udm_ue->av);
+    udm_ue->av = NULL;
+    udm_ue->num_of_av = 0;
+    udm_ue->av_next = 0;
+    udm_ue->av_confirmed = false;
+}
+
 udm_sess_t *udm_sess_add(udm_ue_t *udm_ue, uint8_t psi)
 {
     udm_event_t e;
@@ -42,6 +42,8 @@ typedef struct udm_context_s {
     ogs_hash_t      *supi_hash;
     ogs_hash_t      *sdm_subscription_id_hash;
 
+    int             av_reserve;     /* Pre-generated vectors per UE */
+    int             suci_worker;    /* SUCI de-concealment threads */
 } udm_context_t;
 
 struct udm_ue_s {
@@ -68,6 +70,18 @@ struct udm_ue_s {
     uint8_t rand[OGS_RAND_LEN];
     uint8_t sqn[OGS_SQN_LEN];
 
+    /*
+     * Vectors following udm_ue->sqn, whose SQNs are reserved in the UDR.
+     * They are served only while the previous one has been confirmed,
+     * so a failed authentication, e.g. after a key change, goes back
+     * to the UDR.
+     */
+    milenage_vector_t *av;
+    int num_of_av;
+    int av_next;
+    bool av_confirmed;
+    uint8_t av_sqn[OGS_SQN_LEN];
+
     ogs_guami_t guami;
 
     OpenAPI_auth_type_e auth_type;
@@ -107,7 +121,7 @@ udm_context_t *udm_self(void);
 
 int udm_context_parse_config(void);
 
-udm_ue_t *udm_ue_add(char *suci);
+udm_ue_t *udm_ue_add(char *suci, char *supi);
 void udm_ue_remove(udm_ue_t *udm_ue);
 void udm_ue_remove_all(void);
 udm_ue_t *udm_ue_find_by_suci(char *suci);
@@ -115,6 +129,10 @@ udm_ue_t *udm_ue_find_by_supi(char *supi);
 udm_ue_t *udm_ue_find_by_suci_or_supi(char *suci_or_supi);
 udm_ue_t *udm_ue_find_by_ctx_id(char *ctx_id);
 
+int udm_ue_av_reserve(udm_ue_t *udm_ue);
+milenage_vector_t *udm_ue_av_get(udm_ue_t *udm_ue);
+void udm_ue_av_clear(udm_ue_t *udm_ue);
+
 udm_sess_t *udm_sess_add(udm_ue_t *udm_ue, uint8_t psi);
 void udm_sess_remove(udm_sess_t *sess);
 void udm_sess_remove_all(udm_ue_t *udm_ue);
@@ -29,11 +29,24 @@ extern "C" {
 typedef struct udm_ue_s udm_ue_t;
 typedef struct udm_sess_s udm_sess_t;
 
+typedef enum {
+    UDM_EVT_BASE = OGS_MAX_NUM_OF_PROTO_EVENT,
+
+    UDM_EVT_SUCI_COMPLETE,
+
+    UDM_EVT_TOP,
+
+} udm_event_e;
+
 typedef struct udm_event_s {
     ogs_event_t h;
 
     ogs_pool_id_t udm_ue_id;
     ogs_pool_id_t sess_id;
+
+    /* UDM_EVT_SUCI_COMPLETE : SUPI is NULL if de-concealment failed */
+    char *suci;
+    char *supi;
 } udm_event_t;
 
 OGS_STATIC_ASSERT(OGS_EVENT_SIZE >= sizeof(udm_event_t));
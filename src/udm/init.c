@@ -17,7 +17,9 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "ogs-metrics.h"
 #include "sbi-path.h"
+#include "suci.h"
 
 static ogs_thread_t *thread;
 static void udm_main(void *data);
@@ -31,6 +33,9 @@ int udm_initialize(void)
     rv = ogs_app_parse_local_conf(APP_NAME);
     if (rv != OGS_OK) return rv;
 
+    ogs_metrics_context_init();
+    ogs_sbi_client_metrics_init();
+
     ogs_sbi_context_init(OpenAPI_nf_type_UDM);
     udm_context_init();
 
@@ -41,9 +46,17 @@ int udm_initialize(void)
     rv = ogs_sbi_context_parse_config(APP_NAME, "nrf", "scp");
     if (rv != OGS_OK) return rv;
 
+    rv = ogs_metrics_context_parse_config(APP_NAME);
+    if (rv != OGS_OK) return rv;
+
     rv = udm_context_parse_config();
     if (rv != OGS_OK) return rv;
 
+    rv = udm_suci_init(udm_self()->suci_worker);
+    if (rv != OGS_OK) return rv;
+
+    ogs_metrics_context_open(ogs_metrics_self());
+
     rv = udm_sbi_open();
     if (rv != OGS_OK) return rv;
 
@@ -88,10 +101,17 @@ void udm_terminate(void)
     ogs_thread_destroy(thread);
     ogs_timer_delete(t_termination_holding);
 
+    udm_suci_final();
+
     udm_sbi_close();
 
+    ogs_metrics_context_close(ogs_metrics_self());
+
     udm_context_final();
     ogs_sbi_context_final();
+
+    ogs_sbi_client_metrics_final();
+    ogs_metrics_context_final();
 }
 
 static void udm_main(void *data)
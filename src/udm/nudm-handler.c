@@ -72,6 +72,17 @@ bool udm_nudm_ueau_handle_get(
 
     ResynchronizationInfo = AuthenticationInfoRequest->resynchronization_info;
     if (!ResynchronizationInfo) {
+        milenage_vector_t *av = udm_ue_av_get(udm_ue);
+
+        if (av) {
+            memcpy(udm_ue->rand, av->rand, OGS_RAND_LEN);
+            memcpy(udm_ue->sqn, av->sqn, OGS_SQN_LEN);
+
+            udm_nudm_ueau_send_authentication_info(udm_ue, stream,
+                    av->autn, av->ik, av->ck, av->res, sizeof(av->res));
+
+            return true;
+        }
 
         r = udm_ue_sbi_discover_and_send(OGS_SBI_SERVICE_TYPE_NUDR_DR, NULL,
                 udm_nudr_dr_build_authentication_subscription,
@@ -139,6 +150,9 @@ bool udm_nudm_ueau_handle_get(
 
         }
 
+        /* Vectors reserved from the old SQN are no longer usable */
+        udm_ue_av_clear(udm_ue);
+
         sqn = ogs_buffer_to_uint64(sqn_ms, OGS_SQN_LEN);
 
         /* 33.102 C.3.4 Guide : IND + 1
@@ -173,6 +187,79 @@ bool udm_nudm_ueau_handle_get(
     return true;
 }
 
+void udm_nudm_ueau_send_authentication_info(
+        udm_ue_t *udm_ue, ogs_sbi_stream_t *stream,
+        uint8_t *autn, uint8_t *ik, uint8_t *ck,
+        uint8_t *xres, size_t xres_len)
+{
+    ogs_sbi_message_t sendmsg;
+    ogs_sbi_response_t *response = NULL;
+
+    uint8_t xres_star[OGS_MAX_RES_LEN];
+    uint8_t kausf[OGS_SHA256_DIGEST_SIZE];
+
+    char rand_string[OGS_KEYSTRLEN(OGS_RAND_LEN)];
+    char autn_string[OGS_KEYSTRLEN(OGS_AUTN_LEN)];
+    char kausf_string[OGS_KEYSTRLEN(OGS_SHA256_DIGEST_SIZE)];
+    char xres_star_string[OGS_KEYSTRLEN(OGS_MAX_RES_LEN)];
+
+    OpenAPI_authentication_info_result_t AuthenticationInfoResult;
+    OpenAPI_authentication_vector_t AuthenticationVector;
+
+    ogs_assert(udm_ue);
+    ogs_assert(stream);
+    ogs_assert(autn);
+    ogs_assert(ik);
+    ogs_assert(ck);
+    ogs_assert(xres);
+
+    memset(&AuthenticationInfoResult, 0, sizeof(AuthenticationInfoResult));
+
+    AuthenticationInfoResult.supi = udm_ue->supi;
+    AuthenticationInfoResult.auth_type = udm_ue->auth_type;
+
+    ogs_assert(udm_ue->serving_network_name);
+
+    /* TS33.501 Annex A.2 : Kausf derviation function */
+    ogs_kdf_kausf(
+            ck, ik,
+            udm_ue->serving_network_name, autn,
+            kausf);
+
+    /* TS33.501 Annex A.4 : RES* and XRES* derivation function */
+    ogs_kdf_xres_star(
+            ck, ik,
+            udm_ue->serving_network_name, udm_ue->rand, xres, xres_len,
+            xres_star);
+
+    memset(&AuthenticationVector, 0, sizeof(AuthenticationVector));
+    AuthenticationVector.av_type = OpenAPI_av_type_5G_HE_AKA;
+
+    ogs_hex_to_ascii(udm_ue->rand, sizeof(udm_ue->rand),
+            rand_string, sizeof(rand_string));
+    AuthenticationVector.rand = rand_string;
+    ogs_hex_to_ascii(xres_star, sizeof(xres_star),
+            xres_star_string, sizeof(xres_star_string));
+    AuthenticationVector.xres_star = xres_star_string;
+    ogs_hex_to_ascii(autn, OGS_AUTN_LEN,
+            autn_string, sizeof(autn_string));
+    AuthenticationVector.autn = autn_string;
+    ogs_hex_to_ascii(kausf, sizeof(kausf),
+            kausf_string, sizeof(kausf_string));
+    AuthenticationVector.kausf = kausf_string;
+
+    AuthenticationInfoResult.authentication_vector = &AuthenticationVector;
+
+    memset(&sendmsg, 0, sizeof(sendmsg));
+
+    ogs_assert(AuthenticationInfoResult.auth_type);
+    sendmsg.AuthenticationInfoResult = &AuthenticationInfoResult;
+
+    response = ogs_sbi_build_response(&sendmsg, OGS_SBI_HTTP_STATUS_OK);
+    ogs_assert(response);
+    ogs_assert(true == ogs_sbi_server_send_response(stream, response));
+}
+
 bool udm_nudm_ueau_handle_result_confirmation_inform(
     udm_ue_t *udm_ue, ogs_sbi_stream_t *stream, ogs_sbi_message_t *message)
 {
@@ -234,6 +321,7 @@ bool udm_nudm_ueau_handle_result_confirmation_inform(
 
     udm_ue->auth_event = OpenAPI_auth_event_copy(
             udm_ue->auth_event, message->AuthEvent);
+    udm_ue->av_confirmed = !udm_ue->auth_event->auth_removal_ind;
 
     r = udm_ue_sbi_discover_and_send(OGS_SBI_SERVICE_TYPE_NUDR_DR, NULL,
             udm_nudr_dr_build_update_authentication_status,
@@ -28,6 +28,10 @@ extern "C" {
 
 bool udm_nudm_ueau_handle_get(
     udm_ue_t *udm_ue, ogs_sbi_stream_t *stream, ogs_sbi_message_t *recvmsg);
+void udm_nudm_ueau_send_authentication_info(
+        udm_ue_t *udm_ue, ogs_sbi_stream_t *stream,
+        uint8_t *autn, uint8_t *ik, uint8_t *ck,
+        uint8_t *xres, size_t xres_len);
 bool udm_nudm_ueau_handle_result_confirmation_inform(
     udm_ue_t *udm_ue, ogs_sbi_stream_t *stream, ogs_sbi_message_t *message);
 
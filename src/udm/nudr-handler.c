@@ -18,6 +18,7 @@
  */
 
 #include "nudr-handler.h"
+#include "nudm-handler.h"
 #include "sbi-path.h"
 
 bool udm_nudr_dr_handle_subscription_authentication(
@@ -55,17 +56,9 @@ bool udm_nudr_dr_handle_subscription_authentication(
     uint8_t ak[OGS_AK_LEN];
     uint8_t xres[OGS_MAX_RES_LEN];
     size_t xres_len = 8;
-    uint8_t xres_star[OGS_MAX_RES_LEN];
-    uint8_t kausf[OGS_SHA256_DIGEST_SIZE];
-
-    char rand_string[OGS_KEYSTRLEN(OGS_RAND_LEN)];
-    char autn_string[OGS_KEYSTRLEN(OGS_AUTN_LEN)];
-    char kausf_string[OGS_KEYSTRLEN(OGS_SHA256_DIGEST_SIZE)];
-    char xres_star_string[OGS_KEYSTRLEN(OGS_MAX_RES_LEN)];
+    int r;
 
     OpenAPI_authentication_subscription_t *AuthenticationSubscription = NULL;
-    OpenAPI_authentication_info_result_t AuthenticationInfoResult;
-    OpenAPI_authentication_vector_t AuthenticationVector;
 
     ogs_assert(udm_ue);
     ogs_assert(stream);
@@ -185,9 +178,25 @@ bool udm_nudr_dr_handle_subscription_authentication(
                 strlen(AuthenticationSubscription->sequence_number->sqn),
                 udm_ue->sqn, sizeof(udm_ue->sqn));
 
+            /*
+             * The vector for udm_ue->sqn is served once the UDR has
+             * moved its SQN past the ones reserved here.
+             */
+            if (udm_ue_av_reserve(udm_ue) == OGS_OK) {
+                r = udm_ue_sbi_discover_and_send(
+                        OGS_SBI_SERVICE_TYPE_NUDR_DR, NULL,
+                        udm_nudr_dr_build_authentication_subscription,
+                        udm_ue, stream, UDM_SBI_NO_STATE, udm_ue->av_sqn);
+                ogs_expect(r == OGS_OK);
+                ogs_assert(r != OGS_ERROR);
+                break;
+            }
+
         CASE(OGS_SBI_HTTP_METHOD_PATCH)
             if (recvmsg->res_status != OGS_SBI_HTTP_STATUS_OK &&
                 recvmsg->res_status != OGS_SBI_HTTP_STATUS_NO_CONTENT) {
+                udm_ue_av_clear(udm_ue);
+
                 strerror = ogs_msprintf("[%s] HTTP response error [%d]",
                         udm_ue->suci, recvmsg->res_status);
                 ogs_assert(strerror);
@@ -202,12 +211,6 @@ bool udm_nudr_dr_handle_subscription_authentication(
                 return false;
             }
 
-            memset(&AuthenticationInfoResult,
-                    0, sizeof(AuthenticationInfoResult));
-
-            AuthenticationInfoResult.supi = udm_ue->supi;
-            AuthenticationInfoResult.auth_type = udm_ue->auth_type;
-
             ogs_random(udm_ue->rand, OGS_RAND_LEN);
 #if 0
             OGS_HEX(tmp[step], strlen(tmp[step]), udm_ue->rand);
@@ -220,47 +223,8 @@ bool udm_nudr_dr_handle_subscription_authentication(
             milenage_generate(udm_ue->opc, udm_ue->amf, udm_ue->k, udm_ue->sqn,
                     udm_ue->rand, autn, ik, ck, ak, xres, &xres_len);
 
-            ogs_assert(udm_ue->serving_network_name);
-
-            /* TS33.501 Annex A.2 : Kausf derviation function */
-            ogs_kdf_kausf(
-                    ck, ik,
-                    udm_ue->serving_network_name, autn,
-                    kausf);
-
-            /* TS33.501 Annex A.4 : RES* and XRES* derivation function */
-            ogs_kdf_xres_star(
-                    ck, ik,
-                    udm_ue->serving_network_name, udm_ue->rand, xres, xres_len,
-                    xres_star);
-
-            memset(&AuthenticationVector, 0, sizeof(AuthenticationVector));
-            AuthenticationVector.av_type = OpenAPI_av_type_5G_HE_AKA;
-
-            ogs_hex_to_ascii(udm_ue->rand, sizeof(udm_ue->rand),
-                    rand_string, sizeof(rand_string));
-            AuthenticationVector.rand = rand_string;
-            ogs_hex_to_ascii(xres_star, sizeof(xres_star),
-                    xres_star_string, sizeof(xres_star_string));
-            AuthenticationVector.xres_star = xres_star_string;
-            ogs_hex_to_ascii(autn, sizeof(autn),
-                    autn_string, sizeof(autn_string));
-            AuthenticationVector.autn = autn_string;
-            ogs_hex_to_ascii(kausf, sizeof(kausf),
-                    kausf_string, sizeof(kausf_string));
-            AuthenticationVector.kausf = kausf_string;
-
-            AuthenticationInfoResult.authentication_vector =
-                &AuthenticationVector;
-
-            memset(&sendmsg, 0, sizeof(sendmsg));
-
-            ogs_assert(AuthenticationInfoResult.auth_type);
-            sendmsg.AuthenticationInfoResult = &AuthenticationInfoResult;
-
-            response = ogs_sbi_build_response(&sendmsg, OGS_SBI_HTTP_STATUS_OK);
-            ogs_assert(response);
-            ogs_assert(true == ogs_sbi_server_send_response(stream, response));
+            udm_nudm_ueau_send_authentication_info(
+                    udm_ue, stream, autn, ik, ck, xres, xres_len);
 
             break;
 
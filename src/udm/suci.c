@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2019-2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "suci.h"
+
+static int num_of_worker = 0;
+static ogs_thread_t **workers = NULL;
+static ogs_queue_t *suci_queue = NULL;
+
+/* suci-0-<mcc>-<mnc>-<routing>-<scheme>-<pki>-<output> */
+static bool suci_is_concealed(char *suci)
+{
+    char *p = suci;
+    int i;
+
+    ogs_assert(suci);
+
+    if (strncmp(suci, "suci-0-", strlen("suci-0-")) != 0)
+        return false;
+
+    for (i = 0; i < 5; i++) {
+        p = strchr(p, '-');
+        if (!p)
+            return false;
+        p++;
+    }
+
+    return atoi(p) == OGS_PROTECTION_SCHEME_PROFILE_A ||
+        atoi(p) == OGS_PROTECTION_SCHEME_PROFILE_B;
+}
+
+static void worker_main(void *data)
+{
+    udm_event_t *e = NULL;
+    int rv;
+
+    for ( ;; ) {
+        rv = ogs_queue_pop(suci_queue, (void **)&e);
+        if (rv == OGS_DONE)
+            break;
+        if (rv != OGS_OK)
+            continue;
+
+        /* NULL is pushed once per worker by udm_suci_final() */
+        if (!e)
+            break;
+
+        ogs_assert(e->suci);
+        e->supi = ogs_supi_from_suci(e->suci);
+
+        rv = ogs_queue_push(ogs_app()->queue, e);
+        if (rv != OGS_OK) {
+            ogs_error("ogs_queue_push() failed:%d", (int)rv);
+            ogs_free(e->suci);
+            if (e->supi)
+                ogs_free(e->supi);
+            ogs_event_free(e);
+            continue;
+        }
+        ogs_pollset_notify(ogs_app()->pollset);
+    }
+}
+
+int udm_suci_init(int num)
+{
+    int i;
+
+    ogs_assert(num_of_worker == 0);
+
+    if (num <= 0)
+        return OGS_OK;
+
+    suci_queue = ogs_queue_create(ogs_global_conf()->max.ue);
+    ogs_assert(suci_queue);
+
+    workers = ogs_calloc(num, sizeof(ogs_thread_t *));
+    ogs_assert(workers);
+
+    for (i = 0; i < num; i++) {
+        workers[i] = ogs_thread_create(worker_main, NULL);
+        ogs_assert(workers[i]);
+    }
+    num_of_worker = num;
+
+    ogs_info("SUCI worker started [num:%d]", num_of_worker);
+
+    return OGS_OK;
+}
+
+void udm_suci_final(void)
+{
+    udm_event_t *e = NULL;
+    int i;
+
+    if (!num_of_worker)
+        return;
+
+    for (i = 0; i < num_of_worker; i++)
+        ogs_assert(OGS_OK == ogs_queue_push(suci_queue, NULL));
+
+    for (i = 0; i < num_of_worker; i++)
+        ogs_thread_destroy(workers[i]);
+
+    ogs_free(workers);
+    workers = NULL;
+
+    /* Requests left behind a NULL were never started */
+    while (ogs_queue_trypop(suci_queue, (void **)&e) == OGS_OK) {
+        if (!e)
+            continue;
+        ogs_free(e->suci);
+        ogs_event_free(e);
+    }
+
+    ogs_queue_destroy(suci_queue);
+    suci_queue = NULL;
+
+    num_of_worker = 0;
+}
+
+bool udm_suci_enabled(void)
+{
+    return num_of_worker > 0;
+}
+
+bool udm_suci_submit(ogs_sbi_stream_t *stream,
+        ogs_sbi_request_t *request, char *suci)
+{
+    udm_event_t *e = NULL;
+    int rv;
+
+    ogs_assert(stream);
+    ogs_assert(request);
+    ogs_assert(suci);
+
+    if (!num_of_worker || !suci_is_concealed(suci))
+        return false;
+
+    e = udm_event_new(UDM_EVT_SUCI_COMPLETE);
+    ogs_assert(e);
+
+    e->h.sbi.request = request;
+    e->h.sbi.data = OGS_UINT_TO_POINTER(ogs_sbi_id_from_stream(stream));
+    e->suci = ogs_strdup(suci);
+    ogs_assert(e->suci);
+
+    rv = ogs_queue_trypush(suci_queue, e);
+    if (rv != OGS_OK) {
+        ogs_warn("[%s] SUCI queue full, fall back to sync", suci);
+        ogs_free(e->suci);
+        ogs_event_free(e);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2019-2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef UDM_SUCI_H
+#define UDM_SUCI_H
+
+#include "context.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * SUCI de-concealment on worker threads.
+ *
+ * The ECDH of Profile A/B costs far more than the rest of a request, so a
+ * request for an unknown concealed SUCI is handed to a worker. The result
+ * comes back as UDM_EVT_SUCI_COMPLETE carrying the original request and
+ * the SUPI, and the request is then dispatched again.
+ */
+int udm_suci_init(int num);
+void udm_suci_final(void);
+bool udm_suci_enabled(void);
+
+bool udm_suci_submit(ogs_sbi_stream_t *stream,
+        ogs_sbi_request_t *request, char *suci);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UDM_SUCI_H */
@@ -19,6 +19,7 @@
 
 #include "sbi-path.h"
 #include "nnrf-handler.h"
+#include "suci.h"
 
 void udm_state_initial(ogs_fsm_t *s, udm_event_t *e)
 {
@@ -55,6 +56,9 @@ void udm_state_operational(ogs_fsm_t *s, udm_event_t *e)
     udm_sess_t *sess = NULL;
     ogs_pool_id_t sess_id = OGS_INVALID_POOL_ID;
 
+    bool suci_complete = false, suci_submitted = false;
+    char *supi = NULL;
+
     udm_sm_debug(e);
 
     ogs_assert(s);
@@ -67,6 +71,21 @@ void udm_state_operational(ogs_fsm_t *s, udm_event_t *e)
         break;
 
     case OGS_EVENT_SBI_SERVER:
+    case UDM_EVT_SUCI_COMPLETE:
+        /*
+         * UDM_EVT_SUCI_COMPLETE carries the original request back after
+         * a SUCI worker has de-concealed it. From here on it is handled
+         * as the server event it came from.
+         */
+        if (e->h.id == UDM_EVT_SUCI_COMPLETE) {
+            suci_complete = true;
+            supi = e->supi;
+            ogs_free(e->suci);
+            e->suci = NULL;
+            e->supi = NULL;
+            e->h.id = OGS_EVENT_SBI_SERVER;
+        }
+
         request = e->h.sbi.request;
         ogs_assert(request);
 
@@ -179,7 +198,14 @@ void udm_state_operational(ogs_fsm_t *s, udm_event_t *e)
                     SWITCH(message.h.method)
                     CASE(OGS_SBI_HTTP_METHOD_POST)
                     CASE(OGS_SBI_HTTP_METHOD_GET)
-                        udm_ue = udm_ue_add(message.h.resource.component[0]);
+                        if (!suci_complete && udm_suci_submit(stream, request,
+                                    message.h.resource.component[0])) {
+                            suci_submitted = true;
+                            break;
+                        }
+                        if (!suci_complete || supi)
+                            udm_ue = udm_ue_add(
+                                    message.h.resource.component[0], supi);
                         if (!udm_ue) {
                             ogs_error("Invalid Request [%s]",
                                     message.h.resource.component[0]);
@@ -189,6 +215,10 @@ void udm_state_operational(ogs_fsm_t *s, udm_event_t *e)
                     DEFAULT
                         ogs_error("Invalid HTTP method [%s]", message.h.method);
                     END
+
+                    /* Handled again once the SUCI worker is done */
+                    if (suci_submitted)
+                        break;
                 }
             }
 
@@ -640,4 +670,7 @@ void udm_state_operational(ogs_fsm_t *s, udm_event_t *e)
         ogs_error("No handler for event %s", udm_event_get_name(e));
         break;
     }
+
+    if (supi)
+        ogs_free(supi);
 }
@@ -96,6 +96,8 @@ int udr_context_parse_config(void)
                     /* handle config in sbi library */
                 } else if (!strcmp(udr_key, "discovery")) {
                     /* handle config in sbi library */
+                } else if (!strcmp(udr_key, "metrics")) {
+                    /* handle config in metrics library */
                 } else
                     ogs_warn("unknown key `%s`", udr_key);
             }
@@ -26,8 +26,22 @@
 extern "C" {
 #endif
 
+typedef struct ogs_dbi_request_s ogs_dbi_request_t;
+
+typedef enum {
+    UDR_EVT_BASE = OGS_MAX_NUM_OF_PROTO_EVENT,
+
+    UDR_EVT_DBI_COMPLETE,
+    UDR_EVT_DBI_POLL_TIMER,
+
+    UDR_EVT_TOP,
+
+} udr_event_e;
+
 typedef struct udr_event_s {
     ogs_event_t h;
+
+    ogs_dbi_request_t *dbi_request;
 } udr_event_t;
 
 OGS_STATIC_ASSERT(OGS_EVENT_SIZE >= sizeof(udr_event_t));
@@ -17,6 +17,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include "ogs-metrics.h"
 #include "sbi-path.h"
 
 static ogs_thread_t *thread;
@@ -31,6 +32,9 @@ int udr_initialize(void)
     rv = ogs_app_parse_local_conf(APP_NAME);
     if (rv != OGS_OK) return rv;
 
+    ogs_metrics_context_init();
+    ogs_sbi_client_metrics_init();
+
     ogs_sbi_context_init(OpenAPI_nf_type_UDR);
     udr_context_init();
 
@@ -41,12 +45,29 @@ int udr_initialize(void)
     rv = ogs_sbi_context_parse_config(APP_NAME, "nrf", "scp");
     if (rv != OGS_OK) return rv;
 
+    rv = ogs_metrics_context_parse_config(APP_NAME);
+    if (rv != OGS_OK) return rv;
+
     rv = udr_context_parse_config();
     if (rv != OGS_OK) return rv;
 
     rv = ogs_dbi_init(ogs_app()->db_uri);
     if (rv != OGS_OK) return rv;
 
+    if (ogs_global_conf()->dbi.cache) {
+        /* The cache relies on the change stream for invalidation */
+        rv = ogs_dbi_collection_watch_init();
+        if (rv == OGS_OK)
+            ogs_dbi_cache_init(ogs_global_conf()->dbi.cache);
+        else
+            ogs_warn("DBI cache disabled without change streams");
+    }
+
+    rv = ogs_dbi_worker_init(ogs_global_conf()->dbi.worker, NULL);
+    if (rv != OGS_OK) return rv;
+
+    ogs_metrics_context_open(ogs_metrics_self());
+
     rv = udr_sbi_open();
     if (rv != OGS_OK) return rv;
 
@@ -93,10 +114,15 @@ void udr_terminate(void)
 
     udr_sbi_close();
 
+    ogs_metrics_context_close(ogs_metrics_self());
+
     ogs_dbi_final();
 
     udr_context_final();
     ogs_sbi_context_final();
+
+    ogs_sbi_client_metrics_final();
+    ogs_metrics_context_final();
 }
 
 static void udr_main(void *data)
@@ -20,8 +20,248 @@
 #include "sbi-path.h"
 #include "nudr-handler.h"
 
-bool udr_nudr_dr_handle_subscription_authentication(
-        ogs_sbi_stream_t *stream, ogs_sbi_message_t *recvmsg)
+static char *patch_sqn_string(OpenAPI_list_t *PatchItemList)
+{
+    OpenAPI_lnode_t *node = NULL;
+    char *sqn_string = NULL;
+
+    OpenAPI_list_for_each(PatchItemList, node) {
+        if (node->data) {
+            OpenAPI_patch_item_t *patch_item = node->data;
+            if (OpenAPI_IsString(patch_item->value))
+                sqn_string = cJSON_GetStringValue(patch_item->value->json);
+            else
+                ogs_error("Non-string value in patch not implemented");
+        }
+    }
+
+    return sqn_string;
+}
+
+static uint64_t sqn_from_string(char *sqn_string)
+{
+    uint8_t sqn_ms[OGS_SQN_LEN];
+
+    ogs_assert(sqn_string);
+
+    ogs_ascii_to_hex(sqn_string, strlen(sqn_string), sqn_ms, sizeof(sqn_ms));
+    return ogs_buffer_to_uint64(sqn_ms, OGS_SQN_LEN);
+}
+
+/*
+ * With DBI workers, the result of an operation is taken from the request
+ * that has already been executed by the worker. An operation that was not
+ * part of the request falls back to the synchronous call.
+ */
+static int dbi_auth_info(ogs_dbi_request_t *dbi,
+        char *supi, ogs_dbi_auth_info_t *auth_info)
+{
+    if (!dbi || !(dbi->ops & OGS_DBI_REQUEST_AUTH_INFO))
+        return ogs_dbi_auth_info(supi, auth_info);
+
+    if (!(dbi->done & OGS_DBI_REQUEST_AUTH_INFO))
+        return OGS_ERROR;
+
+    memcpy(auth_info, &dbi->auth_info, sizeof(*auth_info));
+    return OGS_OK;
+}
+
+static int dbi_update_sqn(ogs_dbi_request_t *dbi, char *supi, uint64_t sqn)
+{
+    if (!dbi || !(dbi->ops & OGS_DBI_REQUEST_UPDATE_SQN))
+        return ogs_dbi_update_sqn(supi, sqn);
+
+    return (dbi->done & OGS_DBI_REQUEST_UPDATE_SQN) ? OGS_OK : OGS_ERROR;
+}
+
+static int dbi_increment_sqn(ogs_dbi_request_t *dbi, char *supi)
+{
+    if (!dbi || !(dbi->ops & OGS_DBI_REQUEST_INCREMENT_SQN))
+        return ogs_dbi_increment_sqn(supi);
+
+    return (dbi->done & OGS_DBI_REQUEST_INCREMENT_SQN) ? OGS_OK : OGS_ERROR;
+}
+
+static int dbi_subscription_data(ogs_dbi_request_t *dbi,
+        char *supi, ogs_subscription_data_t *subscription_data)
+{
+    if (!dbi || !(dbi->ops & OGS_DBI_REQUEST_SUBSCRIPTION_DATA))
+        return ogs_dbi_subscription_data(supi, subscription_data);
+
+    if (!(dbi->done & OGS_DBI_REQUEST_SUBSCRIPTION_DATA))
+        return OGS_ERROR;
+
+    /* Ownership of the allocated fields moves to the caller */
+    memcpy(subscription_data,
+            &dbi->subscription_data, sizeof(*subscription_data));
+    memset(&dbi->subscription_data, 0, sizeof(dbi->subscription_data));
+    return OGS_OK;
+}
+
+static int dbi_request_ops(ogs_sbi_message_t *recvmsg,
+        char **supi, uint64_t *sqn)
+{
+    char *sqn_string = NULL;
+
+    ogs_assert(recvmsg);
+    ogs_assert(supi);
+    ogs_assert(sqn);
+
+    SWITCH(recvmsg->h.resource.component[0])
+    CASE(OGS_SBI_RESOURCE_NAME_SUBSCRIPTION_DATA)
+        *supi = recvmsg->h.resource.component[1];
+        if (!*supi || strncmp(*supi, OGS_ID_SUPI_TYPE_IMSI,
+                    strlen(OGS_ID_SUPI_TYPE_IMSI)) != 0)
+            return 0;
+
+        SWITCH(recvmsg->h.resource.component[2])
+        CASE(OGS_SBI_RESOURCE_NAME_AUTHENTICATION_DATA)
+            SWITCH(recvmsg->h.resource.component[3])
+            CASE(OGS_SBI_RESOURCE_NAME_AUTHENTICATION_SUBSCRIPTION)
+                SWITCH(recvmsg->h.method)
+                CASE(OGS_SBI_HTTP_METHOD_GET)
+                    return OGS_DBI_REQUEST_AUTH_INFO;
+                CASE(OGS_SBI_HTTP_METHOD_PATCH)
+                    if (!recvmsg->PatchItemList)
+                        return 0;
+                    sqn_string = patch_sqn_string(recvmsg->PatchItemList);
+                    if (!sqn_string)
+                        return 0;
+                    *sqn = sqn_from_string(sqn_string);
+                    return OGS_DBI_REQUEST_AUTH_INFO|
+                        OGS_DBI_REQUEST_UPDATE_SQN|
+                        OGS_DBI_REQUEST_INCREMENT_SQN;
+                DEFAULT
+                END
+                break;
+            CASE(OGS_SBI_RESOURCE_NAME_AUTHENTICATION_STATUS)
+                SWITCH(recvmsg->h.method)
+                CASE(OGS_SBI_HTTP_METHOD_PUT)
+                    if (!recvmsg->AuthEvent)
+                        return 0;
+                    return OGS_DBI_REQUEST_AUTH_INFO|
+                        OGS_DBI_REQUEST_INCREMENT_SQN;
+                CASE(OGS_SBI_HTTP_METHOD_DELETE)
+                    return OGS_DBI_REQUEST_AUTH_INFO|
+                        OGS_DBI_REQUEST_INCREMENT_SQN;
+                DEFAULT
+                END
+                break;
+            DEFAULT
+            END
+            break;
+        DEFAULT
+            SWITCH(recvmsg->h.resource.component[3])
+            CASE(OGS_SBI_RESOURCE_NAME_PROVISIONED_DATA)
+                SWITCH(recvmsg->h.method)
+                CASE(OGS_SBI_HTTP_METHOD_GET)
+                    return OGS_DBI_REQUEST_SUBSCRIPTION_DATA;
+                DEFAULT
+                END
+                break;
+            DEFAULT
+            END
+        END
+        break;
+
+    CASE(OGS_SBI_RESOURCE_NAME_POLICY_DATA)
+        SWITCH(recvmsg->h.resource.component[1])
+        CASE(OGS_SBI_RESOURCE_NAME_UES)
+            *supi = recvmsg->h.resource.component[2];
+            if (!*supi || strncmp(*supi, OGS_ID_SUPI_TYPE_IMSI,
+                        strlen(OGS_ID_SUPI_TYPE_IMSI)) != 0)
+                return 0;
+
+            SWITCH(recvmsg->h.method)
+            CASE(OGS_SBI_HTTP_METHOD_GET)
+                return OGS_DBI_REQUEST_SUBSCRIPTION_DATA;
+            DEFAULT
+            END
+            break;
+        DEFAULT
+        END
+        break;
+
+    DEFAULT
+    END
+
+    return 0;
+}
+
+static void dbi_request_complete(ogs_dbi_request_t *dbi)
+{
+    udr_event_t *e = NULL;
+    int rv;
+
+    /* Called on the DBI worker thread */
+    e = dbi->data;
+    ogs_assert(e);
+
+    /*
+     * The SBI stream can only be answered from the main thread,
+     * so the push is retried until the queue is terminated.
+     */
+    while ((rv = ogs_queue_push(ogs_app()->queue, e)) != OGS_OK) {
+        if (rv == OGS_DONE)
+            break;
+        ogs_warn("ogs_queue_push() failed:%d, retry", (int)rv);
+    }
+    if (rv != OGS_OK) {
+        /* Shutting down, the stream is released with the SBI server */
+        ogs_error("ogs_queue_push() failed:%d", (int)rv);
+        ogs_dbi_request_free(dbi);
+        ogs_event_free(e);
+        return;
+    }
+    ogs_pollset_notify(ogs_app()->pollset);
+}
+
+bool udr_nudr_dr_submit_dbi_request(ogs_sbi_stream_t *stream,
+        ogs_sbi_request_t *request, ogs_sbi_message_t *recvmsg)
+{
+    ogs_dbi_request_t *dbi = NULL;
+    udr_event_t *e = NULL;
+    char *supi = NULL;
+    uint64_t sqn = 0;
+    int ops;
+
+    ogs_assert(stream);
+    ogs_assert(request);
+    ogs_assert(recvmsg);
+
+    if (!ogs_dbi_worker_enabled())
+        return false;
+
+    ops = dbi_request_ops(recvmsg, &supi, &sqn);
+    if (!ops)
+        return false;
+
+    e = udr_event_new(UDR_EVT_DBI_COMPLETE);
+    ogs_assert(e);
+
+    dbi = ogs_dbi_request_new(ops, supi, dbi_request_complete, e);
+    if (!dbi) {
+        ogs_event_free(e);
+        return false;
+    }
+    dbi->sqn = sqn;
+
+    e->h.sbi.request = request;
+    e->h.sbi.data = OGS_UINT_TO_POINTER(ogs_sbi_id_from_stream(stream));
+    e->dbi_request = dbi;
+
+    if (ogs_dbi_request_submit(dbi) != OGS_OK) {
+        ogs_warn("[%s] DBI request queue full, fall back to sync", supi);
+        ogs_dbi_request_free(dbi);
+        ogs_event_free(e);
+        return false;
+    }
+
+    return true;
+}
+
+bool udr_nudr_dr_handle_subscription_authentication(ogs_sbi_stream_t *stream,
+        ogs_sbi_message_t *recvmsg, ogs_dbi_request_t *dbi)
 {
     int rv;
 
@@ -40,7 +280,6 @@ bool udr_nudr_dr_handle_subscription_authentication(
     OpenAPI_authentication_subscription_t AuthenticationSubscription;
     OpenAPI_sequence_number_t SequenceNumber;
     OpenAPI_list_t *PatchItemList = NULL;
-    OpenAPI_lnode_t *node = NULL;
 
     ogs_assert(stream);
     ogs_assert(recvmsg);
@@ -63,7 +302,7 @@ bool udr_nudr_dr_handle_subscription_authentication(
         return false;
     }
 
-    rv = ogs_dbi_auth_info(supi, &auth_info);
+    rv = dbi_auth_info(dbi, supi, &auth_info);
     if (rv != OGS_OK) {
         ogs_warn("[%s] Cannot find SUPI in DB", supi);
         ogs_assert(true ==
@@ -120,7 +359,6 @@ bool udr_nudr_dr_handle_subscription_authentication(
 
         CASE(OGS_SBI_HTTP_METHOD_PATCH)
             char *sqn_string = NULL;
-            uint8_t sqn_ms[OGS_SQN_LEN];
             uint64_t sqn = 0;
 
             PatchItemList = recvmsg->PatchItemList;
@@ -132,16 +370,7 @@ bool udr_nudr_dr_handle_subscription_authentication(
                 return false;
             }
 
-            OpenAPI_list_for_each(PatchItemList, node) {
-                if (node->data) {
-                    OpenAPI_patch_item_t *patch_item = node->data;
-                    if (OpenAPI_IsString(patch_item->value))
-                        sqn_string = cJSON_GetStringValue(patch_item->value->json);
-                    else
-                        ogs_error("Non-string value in patch not implemented");
-                }
-            }
-
+            sqn_string = patch_sqn_string(PatchItemList);
             if (!sqn_string) {
                 ogs_assert(true ==
                     ogs_sbi_server_send_error(stream,
@@ -150,11 +379,9 @@ bool udr_nudr_dr_handle_subscription_authentication(
                 return false;
             }
 
-            ogs_ascii_to_hex(sqn_string, strlen(sqn_string),
-                    sqn_ms, sizeof(sqn_ms));
-            sqn = ogs_buffer_to_uint64(sqn_ms, OGS_SQN_LEN);
+            sqn = sqn_from_string(sqn_string);
 
-            rv = ogs_dbi_update_sqn(supi, sqn);
+            rv = dbi_update_sqn(dbi, supi, sqn);
             if (rv != OGS_OK) {
                 ogs_fatal("[%s] Cannot update SQN", supi);
                 ogs_assert(true ==
@@ -164,7 +391,7 @@ bool udr_nudr_dr_handle_subscription_authentication(
                 return false;
             }
 
-            rv = ogs_dbi_increment_sqn(supi);
+            rv = dbi_increment_sqn(dbi, supi);
             if (rv != OGS_OK) {
                 ogs_fatal("[%s] Cannot increment SQN", supi);
                 ogs_assert(true ==
@@ -211,7 +438,7 @@ bool udr_nudr_dr_handle_subscription_authentication(
             }
 
             memset(&sendmsg, 0, sizeof(sendmsg));
-            rv = ogs_dbi_increment_sqn(supi);
+            rv = dbi_increment_sqn(dbi, supi);
             if (rv != OGS_OK) {
                 ogs_fatal("[%s] Cannot increment SQN", supi);
                 ogs_assert(true ==
@@ -419,8 +646,8 @@ bool udr_nudr_dr_handle_subscription_context(
     return false;
 }
 
-bool udr_nudr_dr_handle_subscription_provisioned(
-        ogs_sbi_stream_t *stream, ogs_sbi_message_t *recvmsg)
+bool udr_nudr_dr_handle_subscription_provisioned(ogs_sbi_stream_t *stream,
+        ogs_sbi_message_t *recvmsg, ogs_dbi_request_t *dbi)
 {
     int rv, status = 0;
     char *strerror = NULL;
@@ -451,7 +678,7 @@ bool udr_nudr_dr_handle_subscription_provisioned(
         goto cleanup;
     }
 
-    rv = ogs_dbi_subscription_data(supi, &subscription_data);
+    rv = dbi_subscription_data(dbi, supi, &subscription_data);
     if (rv != OGS_OK) {
         strerror = ogs_msprintf("[%s] Cannot find SUPI in DB", supi);
         status = OGS_SBI_HTTP_STATUS_NOT_FOUND;
@@ -1099,8 +1326,8 @@ cleanup:
     return false;
 }
 
-bool udr_nudr_dr_handle_policy_data(
-        ogs_sbi_stream_t *stream, ogs_sbi_message_t *recvmsg)
+bool udr_nudr_dr_handle_policy_data(ogs_sbi_stream_t *stream,
+        ogs_sbi_message_t *recvmsg, ogs_dbi_request_t *dbi)
 {
     int rv, i, status = 0;
     char *strerror = NULL;
@@ -1137,7 +1364,7 @@ bool udr_nudr_dr_handle_policy_data(
         CASE(OGS_SBI_HTTP_METHOD_GET)
             OpenAPI_lnode_t *node = NULL, *node2 = NULL;
 
-            rv = ogs_dbi_subscription_data(supi, &subscription_data);
+            rv = dbi_subscription_data(dbi, supi, &subscription_data);
             if (rv != OGS_OK) {
                 strerror = ogs_msprintf("[%s] Cannot find SUPI in DB", supi);
                 status = OGS_SBI_HTTP_STATUS_NOT_FOUND;
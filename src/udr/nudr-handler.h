@@ -26,15 +26,18 @@
 extern "C" {
 #endif
 
-bool udr_nudr_dr_handle_subscription_authentication(
-        ogs_sbi_stream_t *stream, ogs_sbi_message_t *message);
+bool udr_nudr_dr_submit_dbi_request(ogs_sbi_stream_t *stream,
+        ogs_sbi_request_t *request, ogs_sbi_message_t *message);
+
+bool udr_nudr_dr_handle_subscription_authentication(ogs_sbi_stream_t *stream,
+        ogs_sbi_message_t *message, ogs_dbi_request_t *dbi);
 bool udr_nudr_dr_handle_subscription_context(
         ogs_sbi_stream_t *stream, ogs_sbi_message_t *message);
-bool udr_nudr_dr_handle_subscription_provisioned(
-        ogs_sbi_stream_t *stream, ogs_sbi_message_t *message);
+bool udr_nudr_dr_handle_subscription_provisioned(ogs_sbi_stream_t *stream,
+        ogs_sbi_message_t *message, ogs_dbi_request_t *dbi);
 
-bool udr_nudr_dr_handle_policy_data(
-        ogs_sbi_stream_t *stream, ogs_sbi_message_t *message);
+bool udr_nudr_dr_handle_policy_data(ogs_sbi_stream_t *stream,
+        ogs_sbi_message_t *message, ogs_dbi_request_t *dbi);
 
 #ifdef __cplusplus
 }
@@ -20,12 +20,39 @@
 #include "sbi-path.h"
 #include "nudr-handler.h"
 
+#define DB_POLLING_TIME ogs_time_from_msec(100)
+
+static ogs_timer_t *t_db_polling = NULL;
+
+static void timer_dbi_poll(void *data)
+{
+    udr_event_t *e = NULL;
+    int rv;
+
+    e = udr_event_new(UDR_EVT_DBI_POLL_TIMER);
+    ogs_assert(e);
+
+    rv = ogs_queue_push(ogs_app()->queue, e);
+    if (rv != OGS_OK) {
+        ogs_error("ogs_queue_push() failed:%d", (int)rv);
+        ogs_event_free(e);
+    }
+}
+
 void udr_state_initial(ogs_fsm_t *s, udr_event_t *e)
 {
     udr_sm_debug(e);
 
     ogs_assert(s);
 
+    /* Cache invalidation from the change stream and SQN write-back */
+    if (ogs_dbi_cache_enabled()) {
+        t_db_polling = ogs_timer_add(
+                ogs_app()->timer_mgr, timer_dbi_poll, NULL);
+        ogs_assert(t_db_polling);
+        ogs_timer_start(t_db_polling, DB_POLLING_TIME);
+    }
+
     OGS_FSM_TRAN(s, &udr_state_operational);
 }
 
@@ -33,6 +60,9 @@ void udr_state_final(ogs_fsm_t *s, udr_event_t *e)
 {
     udr_sm_debug(e);
 
+    if (t_db_polling)
+        ogs_timer_delete(t_db_polling);
+
     ogs_assert(s);
 }
 
@@ -49,6 +79,8 @@ void udr_state_operational(ogs_fsm_t *s, udr_event_t *e)
     ogs_sbi_response_t *response = NULL;
     ogs_sbi_message_t message;
 
+    ogs_dbi_request_t *dbi = NULL;
+
     udr_sm_debug(e);
 
     ogs_assert(s);
@@ -61,6 +93,17 @@ void udr_state_operational(ogs_fsm_t *s, udr_event_t *e)
         break;
 
     case OGS_EVENT_SBI_SERVER:
+    case UDR_EVT_DBI_COMPLETE:
+        /*
+         * UDR_EVT_DBI_COMPLETE carries the original request back
+         * after the DBI worker has executed the DB operations,
+         * and is dispatched again with the prefetched result.
+         */
+        if (e->h.id == UDR_EVT_DBI_COMPLETE) {
+            dbi = e->dbi_request;
+            ogs_assert(dbi);
+        }
+
         request = e->h.sbi.request;
         ogs_assert(request);
 
@@ -95,6 +138,12 @@ void udr_state_operational(ogs_fsm_t *s, udr_event_t *e)
             break;
         }
 
+        if (!dbi && udr_nudr_dr_submit_dbi_request(
+                    stream, request, &message)) {
+            ogs_sbi_message_free(&message);
+            break;
+        }
+
         SWITCH(message.h.service.name)
         CASE(OGS_SBI_SERVICE_NAME_NNRF_NFM)
 
@@ -133,7 +182,7 @@ void udr_state_operational(ogs_fsm_t *s, udr_event_t *e)
                 SWITCH(message.h.resource.component[2])
                 CASE(OGS_SBI_RESOURCE_NAME_AUTHENTICATION_DATA)
                     udr_nudr_dr_handle_subscription_authentication(
-                            stream, &message);
+                            stream, &message, dbi);
                     break;
 
                 CASE(OGS_SBI_RESOURCE_NAME_CONTEXT_DATA)
@@ -146,7 +195,7 @@ void udr_state_operational(ogs_fsm_t *s, udr_event_t *e)
                         SWITCH(message.h.method)
                         CASE(OGS_SBI_HTTP_METHOD_GET)
                             udr_nudr_dr_handle_subscription_provisioned(
-                                    stream, &message);
+                                    stream, &message, dbi);
                             break;
                         DEFAULT
                             ogs_error("Invalid HTTP method [%s]",
@@ -171,7 +220,7 @@ void udr_state_operational(ogs_fsm_t *s, udr_event_t *e)
                 break;
 
             CASE(OGS_SBI_RESOURCE_NAME_POLICY_DATA)
-                udr_nudr_dr_handle_policy_data(stream, &message);
+                udr_nudr_dr_handle_policy_data(stream, &message, dbi);
                 break;
 
             DEFAULT
@@ -369,8 +418,17 @@ void udr_state_operational(ogs_fsm_t *s, udr_event_t *e)
         }
         break;
 
+    case UDR_EVT_DBI_POLL_TIMER:
+        ogs_dbi_poll_change_stream();
+        ogs_dbi_cache_flush();
+        ogs_timer_start(t_db_polling, DB_POLLING_TIME);
+        break;
+
     default:
         ogs_error("No handler for event %s", udr_event_get_name(e));
         break;
     }
+
+    if (dbi)
+        ogs_dbi_request_free(dbi);
 }
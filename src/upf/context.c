@@ -20,6 +20,10 @@
 #include "context.h"
 #include "pfcp-path.h"
 
+#if HAVE_SYS_RESOURCE_H
+#include <sys/resource.h>
+#endif
+
 static upf_context_t self;
 
 int __upf_log_domain;
@@ -53,29 +57,24 @@ void upf_context_init(void)
     ogs_pool_init(&upf_n4_seid_pool, ogs_app()->pool.sess);
     ogs_pool_random_id_generate(&upf_n4_seid_pool);
 
-    self.upf_n4_seid_hash = ogs_hash_make();
+    self.upf_n4_seid_hash = ogs_hash_make_size(ogs_app()->pool.sess);
     ogs_assert(self.upf_n4_seid_hash);
-    self.smf_n4_seid_hash = ogs_hash_make();
+    self.smf_n4_seid_hash = ogs_hash_make_size(ogs_app()->pool.sess);
     ogs_assert(self.smf_n4_seid_hash);
-    self.smf_n4_f_seid_hash = ogs_hash_make();
+    self.smf_n4_f_seid_hash = ogs_hash_make_size(ogs_app()->pool.sess);
     ogs_assert(self.smf_n4_f_seid_hash);
-    self.ipv4_hash = ogs_hash_make();
-    ogs_assert(self.ipv4_hash);
-    self.ipv6_hash = ogs_hash_make();
-    ogs_assert(self.ipv6_hash);
+    self.ipv4_table = ogs_lpm_create(AF_INET);
+    ogs_assert(self.ipv4_table);
+    self.ipv6_table = ogs_lpm_create(AF_INET6);
+    ogs_assert(self.ipv6_table);
+    self.ipv4_framed_routes = ogs_lpm_create(AF_INET);
+    ogs_assert(self.ipv4_framed_routes);
+    self.ipv6_framed_routes = ogs_lpm_create(AF_INET6);
+    ogs_assert(self.ipv6_framed_routes);
 
     context_initialized = 1;
 }
 
-static void free_upf_route_trie_node(struct upf_route_trie_node *node)
-{
-    if (!node)
-        return;
-    free_upf_route_trie_node(node->left);
-    free_upf_route_trie_node(node->right);
-    ogs_free(node);
-}
-
 void upf_context_final(void)
 {
     ogs_assert(context_initialized == 1);
@@ -88,13 +87,14 @@ void upf_context_final(void)
     ogs_hash_destroy(self.smf_n4_seid_hash);
     ogs_assert(self.smf_n4_f_seid_hash);
     ogs_hash_destroy(self.smf_n4_f_seid_hash);
-    ogs_assert(self.ipv4_hash);
-    ogs_hash_destroy(self.ipv4_hash);
-    ogs_assert(self.ipv6_hash);
-    ogs_hash_destroy(self.ipv6_hash);
-
-    free_upf_route_trie_node(self.ipv4_framed_routes);
-    free_upf_route_trie_node(self.ipv6_framed_routes);
+    ogs_assert(self.ipv4_table);
+    ogs_lpm_destroy(self.ipv4_table);
+    ogs_assert(self.ipv6_table);
+    ogs_lpm_destroy(self.ipv6_table);
+    ogs_assert(self.ipv4_framed_routes);
+    ogs_lpm_destroy(self.ipv4_framed_routes);
+    ogs_assert(self.ipv6_framed_routes);
+    ogs_lpm_destroy(self.ipv6_framed_routes);
 
     ogs_pool_final(&upf_sess_pool);
     ogs_pool_final(&upf_n4_seid_pool);
@@ -122,6 +122,13 @@ static int upf_context_validation(void)
         ogs_error("No upf.session.subnet: in '%s'", ogs_app()->file);
         return OGS_ERROR;
     }
+    if (self.dataplane.num_of_worker < 0 ||
+        self.dataplane.num_of_worker > UPF_MAX_NUM_OF_DATAPLANE_WORKER) {
+        ogs_error("Invalid upf.dataplane.worker: %d (0..%d) in '%s'",
+                self.dataplane.num_of_worker,
+                UPF_MAX_NUM_OF_DATAPLANE_WORKER, ogs_app()->file);
+        return OGS_ERROR;
+    }
     return OGS_OK;
 }
 
@@ -159,6 +166,20 @@ int upf_context_parse_config(void)
                     /* handle config in pfcp library */
                 } else if (!strcmp(upf_key, "metrics")) {
                     /* handle config in metrics library */
+                } else if (!strcmp(upf_key, "dataplane")) {
+                    ogs_yaml_iter_t dataplane_iter;
+                    ogs_yaml_iter_recurse(&upf_iter, &dataplane_iter);
+                    while (ogs_yaml_iter_next(&dataplane_iter)) {
+                        const char *dataplane_key =
+                            ogs_yaml_iter_key(&dataplane_iter);
+                        ogs_assert(dataplane_key);
+                        if (!strcmp(dataplane_key, "worker")) {
+                            const char *v = ogs_yaml_iter_value(
+                                    &dataplane_iter);
+                            if (v) self.dataplane.num_of_worker = atoi(v);
+                        } else
+                            ogs_warn("unknown key `%s`", dataplane_key);
+                    }
                 } else
                     ogs_warn("unknown key `%s`", upf_key);
             }
@@ -184,6 +205,7 @@ upf_sess_t *upf_sess_add(ogs_pfcp_f_seid_t *cp_f_seid)
     }
 
     ogs_pfcp_pool_init(&sess->pfcp);
+    ogs_thread_mutex_init(&sess->urr_acc_mutex);
 
     /* Set UPF-N4-SEID */
     ogs_pool_alloc(&upf_n4_seid_pool, &sess->upf_n4_seid_node);
@@ -233,12 +255,13 @@ int upf_sess_remove(upf_sess_t *sess)
             sizeof(sess->smf_n4_f_seid), NULL);
 
     if (sess->ipv4) {
-        ogs_hash_set(self.ipv4_hash, sess->ipv4->addr, OGS_IPV4_LEN, NULL);
+        ogs_lpm_delete(self.ipv4_table,
+                sess->ipv4->addr, OGS_IPV4_LEN*8);
         ogs_pfcp_ue_ip_free(sess->ipv4);
     }
     if (sess->ipv6) {
-        ogs_hash_set(self.ipv6_hash,
-                sess->ipv6->addr, OGS_IPV6_DEFAULT_PREFIX_LEN >> 3, NULL);
+        ogs_lpm_delete(self.ipv6_table,
+                sess->ipv6->addr, OGS_IPV6_DEFAULT_PREFIX_LEN);
         ogs_pfcp_ue_ip_free(sess->ipv6);
     }
 
@@ -246,6 +269,7 @@ int upf_sess_remove(upf_sess_t *sess)
     upf_sess_set_ue_ipv6_framed_routes(sess, NULL);
 
     ogs_pfcp_pool_final(&sess->pfcp);
+    ogs_thread_mutex_destroy(&sess->urr_acc_mutex);
 
     ogs_pool_free(&upf_n4_seid_pool, sess->upf_n4_seid_node);
     ogs_pool_id_free(&upf_sess_pool, sess);
@@ -295,70 +319,102 @@ upf_sess_t *upf_sess_find_by_upf_n4_seid(uint64_t seid)
 upf_sess_t *upf_sess_find_by_ipv4(uint32_t addr)
 {
     upf_sess_t *ret;
-    struct upf_route_trie_node *trie = self.ipv4_framed_routes;
-    const int nbits = sizeof(addr) << 3;
-    int i;
 
-    ogs_assert(self.ipv4_hash);
+    ogs_assert(self.ipv4_table);
 
-    ret = ogs_hash_get(self.ipv4_hash, &addr, OGS_IPV4_LEN);
+    ret = ogs_lpm_find(self.ipv4_table, &addr, OGS_IPV4_LEN*8);
     if (ret)
         return ret;
 
-    for (i =  0; i <= nbits; i++) {
-        int bit = nbits - i - 1;
-
-        if (!trie)
-            break;
-        if (trie->sess)
-            ret = trie->sess;
-        if (i == nbits)
-            break;
-
-        if ((1 << bit) & be32toh(addr))
-            trie = trie->right;
-        else
-            trie = trie->left;
-    }
-    return ret;
+    return ogs_lpm_lookup(self.ipv4_framed_routes, &addr);
 }
 
 upf_sess_t *upf_sess_find_by_ipv6(uint32_t *addr6)
 {
-    upf_sess_t *ret = NULL;
-    struct upf_route_trie_node *trie = self.ipv6_framed_routes;
-    int i;
-    const int chunk_size = sizeof(*addr6) << 3;
+    upf_sess_t *ret;
 
-    ogs_assert(self.ipv6_hash);
+    ogs_assert(self.ipv6_table);
     ogs_assert(addr6);
-    ret = ogs_hash_get(
-            self.ipv6_hash, addr6, OGS_IPV6_DEFAULT_PREFIX_LEN >> 3);
+
+    ret = ogs_lpm_find(self.ipv6_table, addr6, OGS_IPV6_DEFAULT_PREFIX_LEN);
     if (ret)
         return ret;
 
-    for (i = 0; i <= OGS_IPV6_128_PREFIX_LEN; i++) {
-        int part = i / chunk_size;
-        int bit = (OGS_IPV6_128_PREFIX_LEN - i - 1) % chunk_size;
+    return ogs_lpm_lookup(self.ipv6_framed_routes, addr6);
+}
 
-        if (!trie)
-            break;
-        if (trie->sess)
-            ret = trie->sess;
-        if (i == OGS_IPV6_128_PREFIX_LEN)
-            break;
+upf_sess_t *upf_sess_find_by_id(ogs_pool_id_t id)
+{
+    return ogs_pool_find_by_id(&upf_sess_pool, id);
+}
 
-        if ((1 << bit) & be32toh(addr6[part]))
-            trie = trie->right;
-        else
-            trie = trie->left;
+/* Process CPU time spread over the PFCP thread and data-plane workers */
+static uint8_t cpu_load(void)
+{
+#if HAVE_SYS_RESOURCE_H
+    struct rusage usage;
+    ogs_time_t now, cpu_time, elapsed;
+
+    now = ogs_get_monotonic_time();
+    if (self.load.sampled &&
+        now - self.load.sampled < ogs_time_from_sec(1))
+        return self.load.cpu_metric;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        ogs_log_message(OGS_LOG_WARN, ogs_errno, "getrusage() failed");
+        return self.load.cpu_metric;
+    }
+
+    cpu_time = ogs_time_from_sec(usage.ru_utime.tv_sec) +
+        usage.ru_utime.tv_usec +
+        ogs_time_from_sec(usage.ru_stime.tv_sec) + usage.ru_stime.tv_usec;
+
+    if (self.load.sampled) {
+        elapsed = (now - self.load.sampled) *
+            (self.dataplane.num_of_worker + 1);
+        self.load.cpu_metric =
+            ogs_min((cpu_time - self.load.cpu_time) * 100 / elapsed, 100);
     }
-    return ret;
+
+    self.load.sampled = now;
+    self.load.cpu_time = cpu_time;
+#endif
+
+    return self.load.cpu_metric;
 }
 
-upf_sess_t *upf_sess_find_by_id(ogs_pool_id_t id)
+/*
+ * TS29.244 Ch 6.2.3 Load Control and 6.2.4 Overload Control
+ *
+ * The load metric is the higher of session pool occupancy and CPU usage.
+ * At UPF_OVERLOAD_THRESHOLD and above, the SMF is asked to reduce new
+ * sessions by 50% rising to 100% at full load.
+ * Each sequence number moves only when its value changes.
+ */
+void upf_load_update(void)
 {
-    return ogs_pool_find_by_id(&upf_sess_pool, id);
+    uint8_t metric, reduction_metric;
+    int size = ogs_pool_size(&upf_sess_pool);
+
+    ogs_assert(size);
+
+    metric = (size - ogs_pool_avail(&upf_sess_pool)) * 100 / size;
+    metric = ogs_max(metric, cpu_load());
+
+    if (!self.load.sequence_number || metric != self.load.metric) {
+        self.load.metric = metric;
+        self.load.sequence_number++;
+    }
+
+    reduction_metric = 0;
+    if (metric >= UPF_OVERLOAD_THRESHOLD)
+        reduction_metric = ogs_min((metric - 80) * 5, 100);
+
+    if (!self.overload.sequence_number ||
+        reduction_metric != self.overload.reduction_metric) {
+        self.overload.reduction_metric = reduction_metric;
+        self.overload.sequence_number++;
+    }
 }
 
 upf_sess_t *upf_sess_add_by_message(ogs_pfcp_message_t *message)
@@ -409,13 +465,13 @@ uint8_t upf_sess_set_ue_ip(upf_sess_t *sess,
     ogs_assert(ue_ip);
 
     if (sess->ipv4) {
-        ogs_hash_set(self.ipv4_hash,
-                sess->ipv4->addr, OGS_IPV4_LEN, NULL);
+        ogs_lpm_delete(self.ipv4_table,
+                sess->ipv4->addr, OGS_IPV4_LEN*8);
         ogs_pfcp_ue_ip_free(sess->ipv4);
     }
     if (sess->ipv6) {
-        ogs_hash_set(self.ipv6_hash,
-                sess->ipv6->addr, OGS_IPV6_DEFAULT_PREFIX_LEN >> 3, NULL);
+        ogs_lpm_delete(self.ipv6_table,
+                sess->ipv6->addr, OGS_IPV6_DEFAULT_PREFIX_LEN);
         ogs_pfcp_ue_ip_free(sess->ipv6);
     }
 
@@ -429,7 +485,8 @@ uint8_t upf_sess_set_ue_ip(upf_sess_t *sess,
                 ogs_assert(cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED);
                 return cause_value;
             }
-            ogs_hash_set(self.ipv4_hash, sess->ipv4->addr, OGS_IPV4_LEN, sess);
+            ogs_assert(ogs_lpm_add(self.ipv4_table,
+                    sess->ipv4->addr, OGS_IPV4_LEN*8, sess) == OGS_OK);
         } else {
             ogs_warn("Cannot support PDN-Type[%d], [IPv4:%d IPv6:%d DNN:%s]",
                 session_type, ue_ip->ipv4, ue_ip->ipv6,
@@ -444,8 +501,8 @@ uint8_t upf_sess_set_ue_ip(upf_sess_t *sess,
                 ogs_assert(cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED);
                 return cause_value;
             }
-            ogs_hash_set(self.ipv6_hash, sess->ipv6->addr,
-                    OGS_IPV6_DEFAULT_PREFIX_LEN >> 3, sess);
+            ogs_assert(ogs_lpm_add(self.ipv6_table, sess->ipv6->addr,
+                    OGS_IPV6_DEFAULT_PREFIX_LEN, sess) == OGS_OK);
         } else {
             ogs_warn("Cannot support PDN-Type[%d], [IPv4:%d IPv6:%d DNN:%s]",
                 session_type, ue_ip->ipv4, ue_ip->ipv6,
@@ -460,7 +517,8 @@ uint8_t upf_sess_set_ue_ip(upf_sess_t *sess,
                 ogs_assert(cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED);
                 return cause_value;
             }
-            ogs_hash_set(self.ipv4_hash, sess->ipv4->addr, OGS_IPV4_LEN, sess);
+            ogs_assert(ogs_lpm_add(self.ipv4_table,
+                    sess->ipv4->addr, OGS_IPV4_LEN*8, sess) == OGS_OK);
         } else {
             ogs_warn("Cannot support PDN-Type[%d], [IPv4:%d IPv6:%d DNN:%s]",
                 session_type, ue_ip->ipv4, ue_ip->ipv6,
@@ -474,15 +532,15 @@ uint8_t upf_sess_set_ue_ip(upf_sess_t *sess,
                 ogs_error("ogs_pfcp_ue_ip_alloc() failed[%d]", cause_value);
                 ogs_assert(cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED);
                 if (sess->ipv4) {
-                    ogs_hash_set(self.ipv4_hash,
-                            sess->ipv4->addr, OGS_IPV4_LEN, NULL);
+                    ogs_lpm_delete(self.ipv4_table,
+                            sess->ipv4->addr, OGS_IPV4_LEN*8);
                     ogs_pfcp_ue_ip_free(sess->ipv4);
                     sess->ipv4 = NULL;
                 }
                 return cause_value;
             }
-            ogs_hash_set(self.ipv6_hash, sess->ipv6->addr,
-                    OGS_IPV6_DEFAULT_PREFIX_LEN >> 3, sess);
+            ogs_assert(ogs_lpm_add(self.ipv6_table, sess->ipv6->addr,
+                    OGS_IPV6_DEFAULT_PREFIX_LEN, sess) == OGS_OK);
         } else {
             ogs_warn("Cannot support PDN-Type[%d], [IPv4:%d IPv6:%d DNN:%s]",
                 session_type, ue_ip->ipv4, ue_ip->ipv6,
@@ -505,83 +563,37 @@ uint8_t upf_sess_set_ue_ip(upf_sess_t *sess,
     return cause_value;
 }
 
-/* Remove amd free framed ROUTE from TRIE. It isn't an error if the framed
-   route doesn't exist in TRIE. */
-static void free_framed_route_from_trie(ogs_ipsubnet_t *route)
+static int framed_route_prefixlen(ogs_ipsubnet_t *route)
 {
-    const int chunk_size = sizeof(route->sub[0]) << 3;
-    const int is_ipv4 = route->family == AF_INET;
-    const int nbits = is_ipv4 ? chunk_size : OGS_IPV6_128_PREFIX_LEN;
-    struct upf_route_trie_node **trie =
-        is_ipv4 ? &self.ipv4_framed_routes : &self.ipv6_framed_routes;
-
-    struct upf_route_trie_node **to_free_tries[OGS_IPV6_128_PREFIX_LEN + 1];
-    int free_from = 0;
-    int i = 0;
+    int i, prefixlen = 0;
 
-    for (i = 0; i <= nbits; i++) {
-        int part = i / chunk_size;
-        int bit = (nbits - i - 1) % chunk_size;
+    for (i = 0; i < 4; i++) {
+        uint32_t mask = be32toh(route->mask[i]);
 
-        if (!*trie)
-            break;
-        to_free_tries[i] = trie;
-
-        if (i == nbits ||
-            ((1 << bit) & be32toh(route->mask[part])) == 0) {
-            (*trie)->sess = NULL;
-            if ((*trie)->left || (*trie)->right)
-                free_from = i + 1;
-            i++;
-            break;
-        }
-
-        if ((1 << bit) & be32toh(route->sub[part])) {
-            if ((*trie)->left || (*trie)->sess)
-                free_from = i + 1;
-            trie = &(*trie)->right;
-        } else {
-            if ((*trie)->right || (*trie)->sess)
-                free_from = i + 1;
-            trie = &(*trie)->left;
+        while (mask & 0x80000000) {
+            prefixlen++;
+            mask <<= 1;
         }
+        if (prefixlen != (i + 1) * 32)
+            break;
     }
 
-    for (i = i - 1; i >= free_from; i--) {
-        trie = to_free_tries[i];
-        ogs_free(*trie);
-        *trie = NULL;
-    }
+    return prefixlen;
 }
 
-static void add_framed_route_to_trie(ogs_ipsubnet_t *route, upf_sess_t *sess)
+/* It isn't an error if the framed route doesn't exist. */
+static void free_framed_route_from_table(ogs_ipsubnet_t *route)
 {
-    const int chunk_size = sizeof(route->sub[0]) << 3;
-    const int is_ipv4 = route->family == AF_INET;
-    const int nbits = is_ipv4 ? chunk_size : OGS_IPV6_128_PREFIX_LEN;
-    struct upf_route_trie_node **trie =
-        is_ipv4 ? &self.ipv4_framed_routes : &self.ipv6_framed_routes;
-    int i = 0;
-
-    for (i = 0; i <= nbits; i++) {
-        int part = i / chunk_size;
-        int bit = (nbits - i - 1) % chunk_size;
-
-        if (!*trie)
-            *trie = ogs_calloc(1, sizeof(**trie));
-
-        if (i == nbits ||
-            ((1 << bit) & be32toh(route->mask[part])) == 0) {
-            (*trie)->sess = sess;
-            break;
-        }
+    ogs_lpm_delete(route->family == AF_INET ?
+            self.ipv4_framed_routes : self.ipv6_framed_routes,
+            route->sub, framed_route_prefixlen(route));
+}
 
-        if ((1 << bit) & be32toh(route->sub[part])) {
-            trie = &(*trie)->right;
-        } else {
-            trie = &(*trie)->left;
-        }
-    }
+static void add_framed_route_to_table(ogs_ipsubnet_t *route, upf_sess_t *sess)
+{
+    ogs_assert(ogs_lpm_add(route->family == AF_INET ?
+            self.ipv4_framed_routes : self.ipv6_framed_routes,
+            route->sub, framed_route_prefixlen(route), sess) == OGS_OK);
 }
 
 static int parse_framed_route(ogs_ipsubnet_t *subnet, const char *framed_route)
@@ -606,7 +618,7 @@ uint8_t upf_sess_set_ue_ipv4_framed_routes(upf_sess_t *sess,
     for (i = 0; i < OGS_MAX_NUM_OF_FRAMED_ROUTES_IN_PDI; i++) {
         if (!sess->ipv4_framed_routes || !sess->ipv4_framed_routes[i].family)
             break;
-        free_framed_route_from_trie(&sess->ipv4_framed_routes[i]);
+        free_framed_route_from_table(&sess->ipv4_framed_routes[i]);
         memset(&sess->ipv4_framed_routes[i], 0,
                sizeof(sess->ipv4_framed_routes[i]));
     }
@@ -629,7 +641,7 @@ uint8_t upf_sess_set_ue_ipv4_framed_routes(upf_sess_t *sess,
                    sizeof(sess->ipv4_framed_routes[j]));
             continue;
         }
-        add_framed_route_to_trie(&sess->ipv4_framed_routes[j], sess);
+        add_framed_route_to_table(&sess->ipv4_framed_routes[j], sess);
         j++;
     }
     if (j == 0 && sess->ipv4_framed_routes) {
@@ -651,7 +663,7 @@ uint8_t upf_sess_set_ue_ipv6_framed_routes(upf_sess_t *sess,
     for (i = 0; i < OGS_MAX_NUM_OF_FRAMED_ROUTES_IN_PDI; i++) {
         if (!sess->ipv6_framed_routes || !sess->ipv6_framed_routes[i].family)
             break;
-        free_framed_route_from_trie(&sess->ipv6_framed_routes[i]);
+        free_framed_route_from_table(&sess->ipv6_framed_routes[i]);
     }
 
     for (i = 0, j = 0; i < OGS_MAX_NUM_OF_FRAMED_ROUTES_IN_PDI; i++) {
@@ -672,7 +684,7 @@ uint8_t upf_sess_set_ue_ipv6_framed_routes(upf_sess_t *sess,
                    sizeof(sess->ipv6_framed_routes[j]));
             continue;
         }
-        add_framed_route_to_trie(&sess->ipv6_framed_routes[j], sess);
+        add_framed_route_to_table(&sess->ipv6_framed_routes[j], sess);
         j++;
     }
     if (j == 0 && sess->ipv6_framed_routes) {
@@ -684,6 +696,12 @@ uint8_t upf_sess_set_ue_ipv6_framed_routes(upf_sess_t *sess,
 }
 
 void upf_sess_urr_acc_add(upf_sess_t *sess, ogs_pfcp_urr_t *urr, size_t size, bool is_uplink)
+{
+    if (upf_sess_urr_acc_update(sess, urr, size, is_uplink) == true)
+        upf_sess_urr_acc_check_volume(sess, urr);
+}
+
+static bool urr_acc_volume_reached(upf_sess_t *sess, ogs_pfcp_urr_t *urr)
 {
     upf_sess_urr_acc_t *urr_acc = NULL;
     uint64_t vol;
@@ -691,6 +709,25 @@ void upf_sess_urr_acc_add(upf_sess_t *sess, ogs_pfcp_urr_t *urr, size_t size, bo
     ogs_assert(urr->id > 0 && urr->id <= OGS_MAX_NUM_OF_URR);
     urr_acc = &sess->urr_acc[urr->id-1];
 
+    vol = urr_acc->total_octets - urr_acc->last_report.total_octets;
+    return (urr->rep_triggers.volume_quota && urr->vol_quota.tovol &&
+                vol >= urr->vol_quota.total_volume) ||
+           (urr->rep_triggers.volume_threshold && urr->vol_threshold.tovol &&
+                vol >= urr->vol_threshold.total_volume);
+}
+
+/*
+ * Only updates the counters, so that it can be called
+ * from the data-plane workers with sess->urr_acc_mutex held.
+ * Returns true if the volume threshold/quota has been reached.
+ */
+bool upf_sess_urr_acc_update(upf_sess_t *sess, ogs_pfcp_urr_t *urr, size_t size, bool is_uplink)
+{
+    upf_sess_urr_acc_t *urr_acc = NULL;
+
+    ogs_assert(urr->id > 0 && urr->id <= OGS_MAX_NUM_OF_URR);
+    urr_acc = &sess->urr_acc[urr->id-1];
+
     /* Increment total & ul octets + pkts */
     urr_acc->total_octets += size;
     urr_acc->total_pkts++;
@@ -706,16 +743,31 @@ void upf_sess_urr_acc_add(upf_sess_t *sess, ogs_pfcp_urr_t *urr, size_t size, bo
     if (urr_acc->time_of_first_packet == 0)
         urr_acc->time_of_first_packet = urr_acc->time_of_last_packet;
 
+    return urr_acc_volume_reached(sess, urr);
+}
+
+void upf_sess_urr_acc_check_volume(upf_sess_t *sess, ogs_pfcp_urr_t *urr)
+{
+    ogs_pfcp_user_plane_report_t report;
+    bool reached;
+
+    ogs_assert(urr->id > 0 && urr->id <= OGS_MAX_NUM_OF_URR);
+
+    /* The data-plane workers update the counters concurrently */
+    ogs_thread_mutex_lock(&sess->urr_acc_mutex);
+    sess->urr_acc[urr->id-1].volume_report_posted = false;
+
     /* generate report if volume threshold/quota is reached */
-    vol = urr_acc->total_octets - urr_acc->last_report.total_octets;
-    if ((urr->rep_triggers.volume_quota && urr->vol_quota.tovol && vol >= urr->vol_quota.total_volume) ||
-        (urr->rep_triggers.volume_threshold && urr->vol_threshold.tovol && vol >= urr->vol_threshold.total_volume)) {
-        ogs_pfcp_user_plane_report_t report;
+    reached = urr_acc_volume_reached(sess, urr);
+    if (reached == true) {
         memset(&report, 0, sizeof(report));
         upf_sess_urr_acc_fill_usage_report(sess, urr, &report, 0);
         report.num_of_usage_report = 1;
         upf_sess_urr_acc_snapshot(sess, urr);
+    }
+    ogs_thread_mutex_unlock(&sess->urr_acc_mutex);
 
+    if (reached == true) {
         ogs_assert(OGS_OK ==
             upf_pfcp_send_session_report_request(sess, &report));
         /* Start new report period/iteration: */
@@ -45,29 +45,39 @@ extern int __upf_log_domain;
 #undef OGS_LOG_DOMAIN
 #define OGS_LOG_DOMAIN __upf_log_domain
 
-struct upf_route_trie_node;
-
 typedef struct upf_context_s {
     ogs_hash_t *upf_n4_seid_hash;   /* hash table (UPF-N4-SEID) */
     ogs_hash_t *smf_n4_seid_hash;   /* hash table (SMF-N4-SEID) */
     ogs_hash_t *smf_n4_f_seid_hash; /* hash table (SMF-N4-F-SEID) */
-    ogs_hash_t *ipv4_hash;  /* hash table (IPv4 Address) */
-    ogs_hash_t *ipv6_hash;  /* hash table (IPv6 Address) */
+    ogs_lpm_t *ipv4_table;  /* LPM table (UE IPv4 Address) */
+    ogs_lpm_t *ipv6_table;  /* LPM table (UE IPv6 /64 Prefix) */
 
-    /* IPv4 framed routes trie */
-    struct upf_route_trie_node *ipv4_framed_routes;
-    /* IPv6 framed routes trie */
-    struct upf_route_trie_node *ipv6_framed_routes;
+    /* LPM table (IPv4 framed routes) */
+    ogs_lpm_t *ipv4_framed_routes;
+    /* LPM table (IPv6 framed routes) */
+    ogs_lpm_t *ipv6_framed_routes;
 
     ogs_list_t sess_list;
-} upf_context_t;
 
-/* trie mapping from IP framed routes to session. */
-struct upf_route_trie_node {
-    struct upf_route_trie_node *left;
-    struct upf_route_trie_node *right;
-    upf_sess_t *sess;
-};
+    struct {
+#define UPF_MAX_NUM_OF_DATAPLANE_WORKER 64
+        int num_of_worker;  /* GTP-U/TUN worker threads (0: PFCP thread) */
+    } dataplane;
+
+    /* Load/Overload Control Information sent to the SMF */
+    struct {
+        uint32_t sequence_number;
+        uint8_t metric;             /* 0 ~ 100 */
+
+        ogs_time_t sampled;         /* Last CPU sample */
+        ogs_time_t cpu_time;        /* Process CPU time at last sample */
+        uint8_t cpu_metric;
+    } load;
+    struct {
+        uint32_t sequence_number;
+        uint8_t reduction_metric;   /* 0 ~ 100 */
+    } overload;
+} upf_context_t;
 
 /* Accounting: */
 typedef struct upf_sess_urr_acc_s {
@@ -85,6 +95,7 @@ typedef struct upf_sess_urr_acc_s {
     uint64_t dl_pkts;
     ogs_time_t time_of_first_packet;
     ogs_time_t time_of_last_packet;
+    bool volume_report_posted; /* Volume report posted by a worker */
     /* Snapshot of measurement when last report was sent: */
     struct {
         uint64_t total_octets;
@@ -123,6 +134,7 @@ typedef struct upf_sess_s {
 
     /* Accounting: */
     upf_sess_urr_acc_t urr_acc[OGS_MAX_NUM_OF_URR]; /* FIXME: This probably needs to be mved to a hashtable or alike */
+    ogs_thread_mutex_t urr_acc_mutex;   /* Shared by data-plane workers */
     char            *apn_dnn;            /* APN/DNN Item */
 } upf_sess_t;
 
@@ -144,6 +156,9 @@ upf_sess_t *upf_sess_find_by_ipv4(uint32_t addr);
 upf_sess_t *upf_sess_find_by_ipv6(uint32_t *addr6);
 upf_sess_t *upf_sess_find_by_id(ogs_pool_id_t id);
 
+#define UPF_OVERLOAD_THRESHOLD 90
+void upf_load_update(void);
+
 uint8_t upf_sess_set_ue_ip(upf_sess_t *sess,
         uint8_t session_type, ogs_pfcp_pdr_t *pdr);
 uint8_t upf_sess_set_ue_ipv4_framed_routes(upf_sess_t *sess,
@@ -152,6 +167,8 @@ uint8_t upf_sess_set_ue_ipv6_framed_routes(upf_sess_t *sess,
         char *framed_routes[]);
 
 void upf_sess_urr_acc_add(upf_sess_t *sess, ogs_pfcp_urr_t *urr, size_t size, bool is_uplink);
+bool upf_sess_urr_acc_update(upf_sess_t *sess, ogs_pfcp_urr_t *urr, size_t size, bool is_uplink);
+void upf_sess_urr_acc_check_volume(upf_sess_t *sess, ogs_pfcp_urr_t *urr);
 void upf_sess_urr_acc_fill_usage_report(upf_sess_t *sess, const ogs_pfcp_urr_t *urr,
                                         ogs_pfcp_user_plane_report_t *report, unsigned int idx);
 void upf_sess_urr_acc_snapshot(upf_sess_t *sess, ogs_pfcp_urr_t *urr);
@@ -59,36 +59,80 @@ const uint8_t proxy_mac_addr[] = { 0x0e, 0x00, 0x00, 0x00, 0x00, 0x01 };
 
 static ogs_pkbuf_pool_t *packet_pool = NULL;
 
-static void upf_gtp_handle_multicast(ogs_pkbuf_t *recvbuf);
+/*
+ * Data-plane workers
+ *
+ * When upf.dataplane.worker is configured, each worker thread owns
+ * one SO_REUSEPORT GTP-U socket per address and one IFF_MULTI_QUEUE
+ * queue per TUN/TAP device. Worker 0 takes over the primary sockets
+ * and queues opened by upf_gtp_open().
+ *
+ * Sessions, PDRs and FARs are only modified by the PFCP thread, which
+ * holds dataplane_rwlock for writing while it processes events and
+ * timers. The workers hold it for reading while they handle a packet.
+ * Anything that needs the PFCP thread (Session Report, URR reports)
+ * is posted to ogs_app()->queue.
+ */
+typedef struct upf_gtp_worker_s upf_gtp_worker_t;
 
-static int check_framed_routes(upf_sess_t *sess, int family, uint32_t *addr)
-{
-    int i = 0;
-    ogs_ipsubnet_t *routes = family == AF_INET ?
-        sess->ipv4_framed_routes : sess->ipv6_framed_routes;
+/*
+ * Receive buffers for ogs_recvmmsg(). Packets are copied out into
+ * right-sized clusters, so a slot is usually reused. It is set to NULL
+ * only when its buffer is handed over, and refilled before the next
+ * receive.
+ */
+typedef struct upf_gtp_rxbatch_s {
+    ogs_pkbuf_t         *pkbuf[OGS_MAX_NUM_OF_MMSG];
+    ogs_sockaddr_t      from[OGS_MAX_NUM_OF_MMSG];
+} upf_gtp_rxbatch_t;
 
-    if (!routes)
-        return false;
+typedef struct upf_gtp_port_s {
+    ogs_lnode_t         lnode;
+    upf_gtp_worker_t    *worker;
 
-    for (i = 0; i < OGS_MAX_NUM_OF_FRAMED_ROUTES_IN_PDI; i++) {
-        uint32_t *sub = routes[i].sub;
-        uint32_t *mask = routes[i].mask;
+    ogs_sock_t          *sock;      /* GTP-U socket */
+    ogs_pfcp_dev_t      *dev;       /* TUN/TAP device */
+    ogs_socket_t        fd;
+    bool                owned;      /* Not a primary socket/queue */
 
-        if (!routes[i].family)
-            break;
+    ogs_poll_t          *poll;
+} upf_gtp_port_t;
 
-        if (family == AF_INET) {
-            if (sub[0] == (addr[0] & mask[0]))
-                return true;
-        } else {
-            if (sub[0] == (addr[0] & mask[0]) &&
-                sub[1] == (addr[1] & mask[1]) &&
-                sub[2] == (addr[2] & mask[2]) &&
-                sub[3] == (addr[3] & mask[3]))
-                return true;
-        }
+typedef struct upf_gtp_worker_s {
+    int                 index;
+
+    ogs_thread_t        *thread;
+    ogs_pollset_t       *pollset;
+    bool                terminated;
+
+    ogs_list_t          port_list;
+
+    upf_gtp_rxbatch_t   rxbatch;
+} upf_gtp_worker_t;
+
+static int num_of_worker = 0;
+static upf_gtp_worker_t *workers = NULL;
+
+static upf_gtp_rxbatch_t rxbatch;
+
+static ogs_thread_rwlock_t dataplane_rwlock;
+static ogs_thread_mutex_t buffering_mutex;
+
+static void upf_gtp_handle_multicast(
+        upf_gtp_worker_t *worker, ogs_pkbuf_t *recvbuf);
+
+/* The shared table maps each framed route to the session it belongs to */
+static bool check_framed_routes(upf_sess_t *sess, int family, uint32_t *addr)
+{
+    if (family == AF_INET) {
+        if (!sess->ipv4_framed_routes)
+            return false;
+        return ogs_lpm_lookup(upf_self()->ipv4_framed_routes, addr) == sess;
+    } else {
+        if (!sess->ipv6_framed_routes)
+            return false;
+        return ogs_lpm_lookup(upf_self()->ipv6_framed_routes, addr) == sess;
     }
-    return false;
 }
 
 static uint16_t _get_eth_type(uint8_t *data, uint len) {
@@ -99,17 +143,170 @@ static uint16_t _get_eth_type(uint8_t *data, uint len) {
     return 0;
 }
 
-static void _gtpv1_tun_recv_common_cb(
-        short when, ogs_socket_t fd, bool has_eth, void *data)
+static int upf_gtp_post_event(upf_event_t *e)
+{
+    int rv;
+
+    ogs_assert(e);
+
+    /* Never block the data plane on a full event queue */
+    rv = ogs_queue_trypush(ogs_app()->queue, e);
+    if (rv != OGS_OK) {
+        ogs_error("ogs_queue_trypush() failed:%d", (int)rv);
+        if (e->report)
+            ogs_free(e->report);
+        upf_event_free(e);
+        return OGS_ERROR;
+    }
+
+    ogs_pollset_notify(ogs_app()->pollset);
+
+    return OGS_OK;
+}
+
+static void upf_gtp_send_session_report(upf_gtp_worker_t *worker,
+        upf_sess_t *sess, ogs_pfcp_user_plane_report_t *report)
+{
+    upf_event_t *e = NULL;
+
+    ogs_assert(sess);
+    ogs_assert(report);
+
+    if (!worker) {
+        ogs_assert(OGS_OK ==
+            upf_pfcp_send_session_report_request(sess, report));
+        return;
+    }
+
+    e = upf_event_new(UPF_EVT_SESSION_REPORT);
+    ogs_assert(e);
+    e->sess_id = sess->id;
+    e->report = ogs_memdup(report, sizeof(*report));
+    ogs_assert(e->report);
+
+    upf_gtp_post_event(e);
+}
+
+static void upf_gtp_urr_acc_add(upf_gtp_worker_t *worker,
+        upf_sess_t *sess, ogs_pfcp_pdr_t *pdr, size_t size, bool is_uplink)
+{
+    int i;
+
+    ogs_assert(sess);
+    ogs_assert(pdr);
+
+    for (i = 0; i < pdr->num_of_urr; i++) {
+        ogs_pfcp_urr_t *urr = pdr->urr[i];
+        upf_sess_urr_acc_t *urr_acc = NULL;
+        upf_event_t *e = NULL;
+        bool post = false;
+
+        if (!worker) {
+            upf_sess_urr_acc_add(sess, urr, size, is_uplink);
+            continue;
+        }
+
+        ogs_assert(urr->id > 0 && urr->id <= OGS_MAX_NUM_OF_URR);
+        urr_acc = &sess->urr_acc[urr->id-1];
+
+        ogs_thread_mutex_lock(&sess->urr_acc_mutex);
+        if (upf_sess_urr_acc_update(sess, urr, size, is_uplink) == true &&
+            urr_acc->volume_report_posted == false) {
+            urr_acc->volume_report_posted = true;
+            post = true;
+        }
+        ogs_thread_mutex_unlock(&sess->urr_acc_mutex);
+
+        if (post == true) {
+            e = upf_event_new(UPF_EVT_URR_VOLUME_REPORT);
+            ogs_assert(e);
+            e->sess_id = sess->id;
+            e->urr_id = urr->id;
+
+            if (upf_gtp_post_event(e) != OGS_OK) {
+                ogs_thread_mutex_lock(&sess->urr_acc_mutex);
+                urr_acc->volume_report_posted = false;
+                ogs_thread_mutex_unlock(&sess->urr_acc_mutex);
+            }
+        }
+    }
+}
+
+static void upf_gtp_handle_pdr(upf_gtp_worker_t *worker,
+        ogs_pfcp_pdr_t *pdr, uint8_t type, int len,
+        ogs_gtp2_header_desc_t *recvhdr, ogs_pkbuf_t *sendbuf,
+        ogs_pfcp_user_plane_report_t *report)
+{
+    ogs_pfcp_far_t *far = NULL;
+
+    ogs_assert(pdr);
+    far = pdr->far;
+    ogs_assert(far);
+
+    if (worker &&
+        (!far->gnode || !(far->apply_action & OGS_PFCP_APPLY_ACTION_FORW))) {
+        /* Buffering updates the FAR, so it is serialized among workers */
+        ogs_thread_mutex_lock(&buffering_mutex);
+        ogs_assert(true == ogs_pfcp_up_handle_pdr(
+                    pdr, type, len, recvhdr, sendbuf, report));
+        ogs_thread_mutex_unlock(&buffering_mutex);
+        return;
+    }
+
+    ogs_assert(true == ogs_pfcp_up_handle_pdr(
+                pdr, type, len, recvhdr, sendbuf, report));
+}
+
+static bool downlink_pdr_filter(ogs_pfcp_pdr_t *pdr, void *data)
+{
+    ogs_pfcp_far_t *far = pdr->far;
+    ogs_assert(far);
+
+    /* Check if PDR is Downlink */
+    if (pdr->src_if != OGS_PFCP_INTERFACE_CORE)
+        return false;
+
+    /* Check if FAR is Downlink */
+    if (far->dst_if != OGS_PFCP_INTERFACE_ACCESS)
+        return false;
+
+    /* Check if Outer header creation */
+    if (far->outer_header_creation.ip4 == 0 &&
+        far->outer_header_creation.ip6 == 0 &&
+        far->outer_header_creation.udp4 == 0 &&
+        far->outer_header_creation.udp6 == 0 &&
+        far->outer_header_creation.gtpu4 == 0 &&
+        far->outer_header_creation.gtpu6 == 0)
+        return false;
+
+    return true;
+}
+
+static bool uplink_pdr_filter(ogs_pfcp_pdr_t *pdr, void *data)
+{
+    ogs_gtp2_header_desc_t *header_desc = data;
+    ogs_assert(header_desc);
+
+    /* Check if TEID */
+    if (header_desc->teid != pdr->f_teid.teid)
+        return false;
+
+    /* Check if QFI */
+    if (pdr->qfi && pdr->qfi != header_desc->qos_flow_identifier)
+        return false;
+
+    return true;
+}
+
+static void upf_gtp_handle_tun(
+        upf_gtp_worker_t *worker, ogs_socket_t fd, bool has_eth)
 {
     ogs_pkbuf_t *recvbuf = NULL;
 
     upf_sess_t *sess = NULL;
     ogs_pfcp_pdr_t *pdr = NULL;
     ogs_pfcp_pdr_t *fallback_pdr = NULL;
-    ogs_pfcp_far_t *far = NULL;
     ogs_pfcp_user_plane_report_t report;
-    int i;
 
     recvbuf = ogs_tun_read(fd, packet_pool);
     if (!recvbuf) {
@@ -167,67 +364,40 @@ static void _gtpv1_tun_recv_common_cb(
     if (!sess)
         goto cleanup;
 
-    ogs_list_for_each(&sess->pfcp.pdr_list, pdr) {
-        far = pdr->far;
-        ogs_assert(far);
-
-        /* Check if PDR is Downlink */
-        if (pdr->src_if != OGS_PFCP_INTERFACE_CORE)
-            continue;
-
-        /* Save the Fallback PDR : Lowest precedence downlink PDR */
-        fallback_pdr = pdr;
-
-        /* Check if FAR is Downlink */
-        if (far->dst_if != OGS_PFCP_INTERFACE_ACCESS)
-            continue;
-
-        /* Check if Outer header creation */
-        if (far->outer_header_creation.ip4 == 0 &&
-            far->outer_header_creation.ip6 == 0 &&
-            far->outer_header_creation.udp4 == 0 &&
-            far->outer_header_creation.udp6 == 0 &&
-            far->outer_header_creation.gtpu4 == 0 &&
-            far->outer_header_creation.gtpu6 == 0)
-            continue;
-
-        /* Check if Rule List in PDR */
-        if (ogs_list_first(&pdr->rule_list) &&
-            ogs_pfcp_pdr_rule_find_by_packet(pdr, recvbuf) == NULL)
-            continue;
-
-        break;
+    pdr = ogs_pfcp_classifier_find(
+            &sess->pfcp, recvbuf, downlink_pdr_filter, NULL);
+    if (!pdr) {
+        /* Fallback PDR : Lowest precedence downlink PDR */
+        ogs_list_for_each(&sess->pfcp.pdr_list, fallback_pdr) {
+            if (fallback_pdr->src_if == OGS_PFCP_INTERFACE_CORE)
+                pdr = fallback_pdr;
+        }
     }
 
-    if (!pdr)
-        pdr = fallback_pdr;
-
     if (!pdr) {
         if (ogs_global_conf()->parameter.multicast) {
-            upf_gtp_handle_multicast(recvbuf);
+            upf_gtp_handle_multicast(worker, recvbuf);
         }
         goto cleanup;
     }
 
     /* Increment total & dl octets + pkts */
-    for (i = 0; i < pdr->num_of_urr; i++)
-        upf_sess_urr_acc_add(sess, pdr->urr[i], recvbuf->len, false);
+    upf_gtp_urr_acc_add(worker, sess, pdr, recvbuf->len, false);
 
-    ogs_assert(true == ogs_pfcp_up_handle_pdr(
-                pdr, OGS_GTPU_MSGTYPE_GPDU, 0, NULL, recvbuf, &report));
+    upf_gtp_handle_pdr(worker,
+            pdr, OGS_GTPU_MSGTYPE_GPDU, 0, NULL, recvbuf, &report);
 
     /*
      * Issue #2210, Discussion #2208, #2209
      *
-     * Metrics reduce data plane performance.
-     * It should not be used on the UPF/SGW-U data plane
-     * until this issue is resolved.
+     * Counters and gauges are updated in per-thread slots and only
+     * folded into the Prometheus registry when /metrics is scraped,
+     * so they can be used on the data plane.
      */
-#if 0
     upf_metrics_inst_global_inc(UPF_METR_GLOB_CTR_GTP_OUTDATAPKTN3UPF);
-    upf_metrics_inst_by_qfi_add(pdr->qer->qfi,
-        UPF_METR_CTR_GTP_OUTDATAVOLUMEQOSLEVELN3UPF, recvbuf->len);
-#endif
+    if (pdr->qer && pdr->qer->qfi)
+        upf_metrics_inst_by_qfi_add(pdr->qer->qfi,
+            UPF_METR_CTR_GTP_OUTDATAVOLUMEQOSLEVELN3UPF, recvbuf->len);
 
     if (report.type.downlink_data_report) {
         ogs_assert(pdr->sess);
@@ -238,8 +408,7 @@ static void _gtpv1_tun_recv_common_cb(
         if (pdr->qer && pdr->qer->qfi)
             report.downlink_data.qfi = pdr->qer->qfi; /* for 5GC */
 
-        ogs_assert(OGS_OK ==
-            upf_pfcp_send_session_report_request(sess, &report));
+        upf_gtp_send_session_report(worker, sess, &report);
     }
 
     /*
@@ -254,48 +423,31 @@ cleanup:
 
 static void _gtpv1_tun_recv_cb(short when, ogs_socket_t fd, void *data)
 {
-    _gtpv1_tun_recv_common_cb(when, fd, false, data);
+    upf_gtp_handle_tun(NULL, fd, false);
 }
 
 static void _gtpv1_tun_recv_eth_cb(short when, ogs_socket_t fd, void *data)
 {
-    _gtpv1_tun_recv_common_cb(when, fd, true, data);
+    upf_gtp_handle_tun(NULL, fd, true);
 }
 
-static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
+static void upf_gtp_handle_gtpu_packet(
+        upf_gtp_worker_t *worker, ogs_socket_t fd, ogs_sock_t *sock,
+        ogs_pkbuf_t *pkbuf, ogs_sockaddr_t *from)
 {
     int len;
-    ssize_t size;
     char buf1[OGS_ADDRSTRLEN];
     char buf2[OGS_ADDRSTRLEN];
 
     upf_sess_t *sess = NULL;
 
-    ogs_pkbuf_t *pkbuf = NULL;
-    ogs_sock_t *sock = NULL;
-    ogs_sockaddr_t from;
-
     ogs_gtp2_header_t *gtp_h = NULL;
     ogs_gtp2_header_desc_t header_desc;
     ogs_pfcp_user_plane_report_t report;
 
     ogs_assert(fd != INVALID_SOCKET);
-    sock = data;
     ogs_assert(sock);
-
-    pkbuf = ogs_pkbuf_alloc(packet_pool, OGS_MAX_PKT_LEN);
-    ogs_assert(pkbuf);
-    ogs_pkbuf_reserve(pkbuf, OGS_TUN_MAX_HEADROOM);
-    ogs_pkbuf_put(pkbuf, OGS_MAX_PKT_LEN-OGS_TUN_MAX_HEADROOM);
-
-    size = ogs_recvfrom(fd, pkbuf->data, pkbuf->len, 0, &from);
-    if (size <= 0) {
-        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
-                "ogs_recv() failed");
-        goto cleanup;
-    }
-
-    ogs_pkbuf_trim(pkbuf, size);
+    ogs_assert(from);
 
     ogs_assert(pkbuf);
     ogs_assert(pkbuf->len);
@@ -316,16 +468,16 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
     if (header_desc.type == OGS_GTPU_MSGTYPE_ECHO_REQ) {
         ogs_pkbuf_t *echo_rsp;
 
-        ogs_info("[RECV] Echo Request from [%s]", OGS_ADDR(&from, buf1));
+        ogs_info("[RECV] Echo Request from [%s]", OGS_ADDR(from, buf1));
         echo_rsp = ogs_gtp2_handle_echo_req(pkbuf);
         ogs_expect(echo_rsp);
         if (echo_rsp) {
             ssize_t sent;
 
             /* Echo reply */
-            ogs_info("[SEND] Echo Response to [%s]", OGS_ADDR(&from, buf1));
+            ogs_info("[SEND] Echo Response to [%s]", OGS_ADDR(from, buf1));
 
-            sent = ogs_sendto(fd, echo_rsp->data, echo_rsp->len, 0, &from);
+            sent = ogs_sendto(fd, echo_rsp->data, echo_rsp->len, 0, from);
             if (sent < 0 || sent != echo_rsp->len) {
                 ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
                         "ogs_sendto() failed");
@@ -343,7 +495,7 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
     }
 
     ogs_trace("[RECV] GPU-U Type [%d] from [%s] : TEID[0x%x]",
-            header_desc.type, OGS_ADDR(&from, buf1), header_desc.teid);
+            header_desc.type, OGS_ADDR(from, buf1), header_desc.teid);
 
     /* Remove GTP header and send packets to TUN interface */
     ogs_assert(ogs_pkbuf_pull(pkbuf, len));
@@ -364,8 +516,7 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
                 sess = UPF_SESS(far->sess);
                 ogs_assert(sess);
 
-                ogs_assert(OGS_OK ==
-                    upf_pfcp_send_session_report_request(sess, &report));
+                upf_gtp_send_session_report(worker, sess, &report);
             }
 
         } else {
@@ -383,23 +534,14 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
 
         ogs_pfcp_subnet_t *subnet = NULL;
         ogs_pfcp_dev_t *dev = NULL;
-        int i;
 
         ip_h = (struct ip *)pkbuf->data;
         ogs_assert(ip_h);
 
-        /*
-         * Issue #2210, Discussion #2208, #2209
-         *
-         * Metrics reduce data plane performance.
-         * It should not be used on the UPF/SGW-U data plane
-         * until this issue is resolved.
-         */
-#if 0
         upf_metrics_inst_global_inc(UPF_METR_GLOB_CTR_GTP_INDATAPKTN3UPF);
-        upf_metrics_inst_by_qfi_add(header_desc.qos_flow_identifier,
-                UPF_METR_CTR_GTP_INDATAVOLUMEQOSLEVELN3UPF, pkbuf->len);
-#endif
+        if (header_desc.qos_flow_identifier)
+            upf_metrics_inst_by_qfi_add(header_desc.qos_flow_identifier,
+                    UPF_METR_CTR_GTP_INDATAVOLUMEQOSLEVELN3UPF, pkbuf->len);
 
         pfcp_object = ogs_pfcp_object_find_by_teid(header_desc.teid);
         if (!pfcp_object) {
@@ -419,10 +561,10 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
                 ogs_error("[%s] Send Error Indication [TEID:0x%x] to [%s]",
                         OGS_ADDR(&sock->local_addr, buf1),
                         header_desc.teid,
-                        OGS_ADDR(&from, buf2));
+                        OGS_ADDR(from, buf2));
                 ogs_gtp1_send_error_indication(
                         sock, header_desc.teid,
-                        header_desc.qos_flow_identifier, &from);
+                        header_desc.qos_flow_identifier, from);
             }
             goto cleanup;
         }
@@ -438,41 +580,27 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
             pfcp_sess = (ogs_pfcp_sess_t *)pfcp_object;
             ogs_assert(pfcp_sess);
 
-            ogs_list_for_each(&pfcp_sess->pdr_list, pdr) {
-
-                /*
-                 * Originally, we checked the Source Interface
-                 * for packets received with a TEID.
-                 *
-                 * However, in the case of Home Routed Roaming,
-                 * packets arriving at the V-UPF from the Core
-                 * do not come through a TUN interface
-                 * but as standard GTP-U packets.
-                 *
-                 * Therefore, this code has been removed to support
-                 * the roaming functionality.
-                 */
+            /*
+             * Originally, we checked the Source Interface
+             * for packets received with a TEID.
+             *
+             * However, in the case of Home Routed Roaming,
+             * packets arriving at the V-UPF from the Core
+             * do not come through a TUN interface
+             * but as standard GTP-U packets.
+             *
+             * Therefore, this code has been removed to support
+             * the roaming functionality.
+             */
 #if 0 /* <DEPRECATED> */
-                if (pdr->src_if != OGS_PFCP_INTERFACE_ACCESS &&
-                    pdr->src_if != OGS_PFCP_INTERFACE_CP_FUNCTION)
-                    continue;
+            if (pdr->src_if != OGS_PFCP_INTERFACE_ACCESS &&
+                pdr->src_if != OGS_PFCP_INTERFACE_CP_FUNCTION)
+                continue;
 #endif
 
-                /* Check if TEID */
-                if (header_desc.teid != pdr->f_teid.teid)
-                    continue;
-
-                /* Check if QFI */
-                if (pdr->qfi && pdr->qfi != header_desc.qos_flow_identifier)
-                    continue;
-
-                /* Check if Rule List in PDR */
-                if (ogs_list_first(&pdr->rule_list) &&
-                    ogs_pfcp_pdr_rule_find_by_packet(pdr, pkbuf) == NULL)
-                    continue;
-
-                break;
-            }
+            /* Match TEID, QFI and Rule List in PDR */
+            pdr = ogs_pfcp_classifier_find(
+                    pfcp_sess, pkbuf, uplink_pdr_filter, &header_desc);
 
             if (!pdr) {
                 /*
@@ -492,10 +620,10 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
                             "[%s] Send Error Indication [TEID:0x%x] to [%s]",
                             OGS_ADDR(&sock->local_addr, buf1),
                             header_desc.teid,
-                            OGS_ADDR(&from, buf2));
+                            OGS_ADDR(from, buf2));
                     ogs_gtp1_send_error_indication(
                             sock, header_desc.teid,
-                            header_desc.qos_flow_identifier, &from);
+                            header_desc.qos_flow_identifier, from);
                 }
                 goto cleanup;
             }
@@ -716,8 +844,7 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
             ogs_assert(dev);
 
             /* Increment total & ul octets + pkts */
-            for (i = 0; i < pdr->num_of_urr; i++)
-                upf_sess_urr_acc_add(sess, pdr->urr[i], pkbuf->len, true);
+            upf_gtp_urr_acc_add(worker, sess, pdr, pkbuf->len, true);
 
             if (dev->is_tap) {
                 ogs_assert(eth_type);
@@ -755,9 +882,8 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
             }
 #endif
 
-            ogs_assert(true == ogs_pfcp_up_handle_pdr(
-                        pdr, header_desc.type, len, &header_desc,
-                        pkbuf, &report));
+            upf_gtp_handle_pdr(worker,
+                    pdr, header_desc.type, len, &header_desc, pkbuf, &report);
 
 #if 0 /* <DEPRECATED> */
             if (far->dst_if == OGS_PFCP_INTERFACE_CP_FUNCTION) {
@@ -772,8 +898,7 @@ static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
                 if (pdr->qer && pdr->qer->qfi)
                     report.downlink_data.qfi = pdr->qer->qfi; /* for 5GC */
 
-                ogs_assert(OGS_OK ==
-                    upf_pfcp_send_session_report_request(sess, &report));
+                upf_gtp_send_session_report(worker, sess, &report);
             }
 
             /*
@@ -791,12 +916,103 @@ cleanup:
     ogs_pkbuf_free(pkbuf);
 }
 
+static void upf_gtp_rxbatch_clear(upf_gtp_rxbatch_t *batch)
+{
+    int i;
+
+    ogs_assert(batch);
+
+    for (i = 0; i < OGS_MAX_NUM_OF_MMSG; i++) {
+        if (batch->pkbuf[i]) {
+            ogs_pkbuf_free(batch->pkbuf[i]);
+            batch->pkbuf[i] = NULL;
+        }
+    }
+}
+
+static void upf_gtp_handle_gtpu(
+        upf_gtp_worker_t *worker, ogs_socket_t fd, ogs_sock_t *sock)
+{
+    int i, n;
+    upf_gtp_rxbatch_t *batch = worker ? &worker->rxbatch : &rxbatch;
+    ogs_gtp_sendbatch_t sendbatch;
+
+    ogs_assert(fd != INVALID_SOCKET);
+    ogs_assert(sock);
+
+    for (i = 0; i < OGS_MAX_NUM_OF_MMSG; i++) {
+        ogs_pkbuf_t *pkbuf = batch->pkbuf[i];
+
+        if (!pkbuf) {
+            pkbuf = ogs_pkbuf_alloc(packet_pool, OGS_MAX_PKT_LEN);
+            ogs_assert(pkbuf);
+            ogs_pkbuf_reserve(pkbuf, OGS_TUN_MAX_HEADROOM);
+            batch->pkbuf[i] = pkbuf;
+        }
+        ogs_pkbuf_put(pkbuf, ogs_pkbuf_tailroom(pkbuf));
+    }
+
+    n = ogs_recvmmsg(fd, batch->pkbuf, batch->from, OGS_MAX_NUM_OF_MMSG, 0);
+    if (n <= 0) {
+        ogs_log_message(OGS_LOG_ERROR, ogs_socket_errno,
+                "ogs_recvmmsg() failed");
+        return;
+    }
+
+    /* Forwarded G-PDUs are flushed together with ogs_sendmmsg() */
+    ogs_gtp_sendbatch_begin(&sendbatch);
+
+    for (i = 0; i < n; i++) {
+        ogs_pkbuf_t *pkbuf = ogs_pkbuf_right_size(
+                packet_pool, &batch->pkbuf[i]);
+
+        upf_gtp_handle_gtpu_packet(
+                worker, fd, sock, pkbuf, &batch->from[i]);
+    }
+
+    ogs_gtp_sendbatch_end();
+}
+
+static void _gtpv1_u_recv_cb(short when, ogs_socket_t fd, void *data)
+{
+    upf_gtp_handle_gtpu(NULL, fd, data);
+}
+
+static void _gtpv1_u_worker_recv_cb(short when, ogs_socket_t fd, void *data)
+{
+    upf_gtp_port_t *port = data;
+    ogs_assert(port);
+
+    ogs_thread_rwlock_rdlock(&dataplane_rwlock);
+    upf_gtp_handle_gtpu(port->worker, fd, port->sock);
+    ogs_thread_rwlock_rdunlock(&dataplane_rwlock);
+}
+
+static void _gtpv1_tun_worker_recv_cb(short when, ogs_socket_t fd, void *data)
+{
+    upf_gtp_port_t *port = data;
+    ogs_assert(port);
+    ogs_assert(port->dev);
+
+    ogs_thread_rwlock_rdlock(&dataplane_rwlock);
+    upf_gtp_handle_tun(port->worker, fd, port->dev->is_tap);
+    ogs_thread_rwlock_rdunlock(&dataplane_rwlock);
+}
+
 int upf_gtp_init(void)
 {
     ogs_pkbuf_config_t config;
     memset(&config, 0, sizeof config);
 
-    config.cluster_2048_pool = ogs_app()->pool.gtpu;
+    /*
+     * Received packets are moved into the smallest cluster that fits them,
+     * and buffered packets no longer hold a cluster (see lib/pfcp/buffer.c).
+     */
+    config.cluster_128_pool = ogs_app()->pool.gtpu / 4;
+    config.cluster_256_pool = ogs_app()->pool.gtpu / 4;
+    config.cluster_512_pool = ogs_app()->pool.gtpu / 4;
+    config.cluster_1024_pool = ogs_app()->pool.gtpu / 4;
+    config.cluster_2048_pool = ogs_app()->pool.gtpu / 2;
 
 #if OGS_USE_TALLOC == 1
     /* allocate a talloc pool for GTP to ensure it doesn't have to go back
@@ -807,12 +1023,204 @@ int upf_gtp_init(void)
     packet_pool = ogs_pkbuf_pool_create(&config);
 #endif
 
+    ogs_thread_rwlock_init(&dataplane_rwlock);
+    ogs_thread_mutex_init(&buffering_mutex);
+
     return OGS_OK;
 }
 
 void upf_gtp_final(void)
 {
     ogs_pkbuf_pool_destroy(packet_pool);
+
+    ogs_thread_mutex_destroy(&buffering_mutex);
+    ogs_thread_rwlock_destroy(&dataplane_rwlock);
+}
+
+/*
+ * Called by the PFCP thread around event and timer processing
+ * so that the workers never see a session while it is being changed.
+ */
+void upf_gtp_dataplane_lock(void)
+{
+    if (workers)
+        ogs_thread_rwlock_wrlock(&dataplane_rwlock);
+}
+
+void upf_gtp_dataplane_unlock(void)
+{
+    if (workers)
+        ogs_thread_rwlock_wrunlock(&dataplane_rwlock);
+}
+
+static void upf_gtp_port_add(upf_gtp_worker_t *worker,
+        ogs_sock_t *sock, ogs_pfcp_dev_t *dev, ogs_socket_t fd, bool owned)
+{
+    upf_gtp_port_t *port = NULL;
+
+    ogs_assert(worker);
+    ogs_assert(sock || dev);
+    ogs_assert(fd != INVALID_SOCKET);
+
+    port = ogs_calloc(1, sizeof(*port));
+    ogs_assert(port);
+
+    port->worker = worker;
+    port->sock = sock;
+    port->dev = dev;
+    port->fd = fd;
+    port->owned = owned;
+
+    if (sock)
+        port->poll = ogs_pollset_add(worker->pollset,
+                OGS_POLLIN, fd, _gtpv1_u_worker_recv_cb, port);
+    else
+        port->poll = ogs_pollset_add(worker->pollset,
+                OGS_POLLIN, fd, _gtpv1_tun_worker_recv_cb, port);
+    ogs_assert(port->poll);
+
+    ogs_list_add(&worker->port_list, port);
+}
+
+static void upf_gtp_port_remove_all(upf_gtp_worker_t *worker)
+{
+    upf_gtp_port_t *port = NULL, *next_port = NULL;
+
+    ogs_assert(worker);
+
+    ogs_list_for_each_safe(&worker->port_list, next_port, port) {
+        ogs_list_remove(&worker->port_list, port);
+
+        if (port->poll)
+            ogs_pollset_remove(port->poll);
+
+        if (port->owned) {
+            if (port->sock)
+                ogs_sock_destroy(port->sock);
+            else
+                ogs_closesocket(port->fd);
+        }
+
+        ogs_free(port);
+    }
+}
+
+static void upf_gtp_worker_main(void *data)
+{
+    upf_gtp_worker_t *worker = data;
+    ogs_assert(worker);
+
+    ogs_debug("[%d] data-plane worker started", worker->index);
+
+    while (__atomic_load_n(&worker->terminated, __ATOMIC_ACQUIRE) == false)
+        ogs_pollset_poll(worker->pollset, OGS_INFINITE_TIME);
+
+    ogs_debug("[%d] data-plane worker terminated", worker->index);
+}
+
+static int upf_gtp_worker_open(void)
+{
+    ogs_socknode_t *node = NULL;
+    ogs_pfcp_dev_t *dev = NULL;
+    unsigned int capacity;
+    int i;
+
+    ogs_assert(num_of_worker > 0);
+
+    /* One poll per socket and TUN/TAP queue, and one for notification */
+    capacity = ogs_list_count(&ogs_gtp_self()->gtpu_list) +
+                ogs_list_count(&ogs_pfcp_self()->dev_list) + 1;
+
+    workers = ogs_calloc(num_of_worker, sizeof(*workers));
+    ogs_assert(workers);
+
+    for (i = 0; i < num_of_worker; i++) {
+        upf_gtp_worker_t *worker = &workers[i];
+
+        worker->index = i;
+        ogs_list_init(&worker->port_list);
+
+        worker->pollset = ogs_pollset_create(capacity);
+        ogs_assert(worker->pollset);
+
+        ogs_list_for_each(&ogs_gtp_self()->gtpu_list, node) {
+            ogs_sock_t *sock = NULL;
+
+            ogs_assert(node->sock);
+
+            if (i == 0) {
+                sock = node->sock;
+            } else {
+                sock = ogs_udp_server(node->addr, node->option);
+                if (!sock) {
+                    ogs_error("[%d] ogs_udp_server() failed", i);
+                    return OGS_ERROR;
+                }
+            }
+
+            upf_gtp_port_add(worker, sock, NULL, sock->fd, i != 0);
+        }
+
+        ogs_list_for_each(&ogs_pfcp_self()->dev_list, dev) {
+            ogs_socket_t fd = INVALID_SOCKET;
+
+            if (i == 0) {
+                fd = dev->fd;
+            } else {
+                fd = ogs_tun_open_queue(
+                        dev->ifname, OGS_MAX_IFNAME_LEN, dev->is_tap);
+                if (fd == INVALID_SOCKET) {
+                    ogs_error("[%d] tun_open_queue(dev:%s) failed",
+                            i, dev->ifname);
+                    return OGS_ERROR;
+                }
+            }
+
+            upf_gtp_port_add(worker, NULL, dev, fd, i != 0);
+        }
+    }
+
+    for (i = 0; i < num_of_worker; i++) {
+        workers[i].thread = ogs_thread_create(upf_gtp_worker_main, &workers[i]);
+        if (!workers[i].thread) {
+            ogs_error("[%d] ogs_thread_create() failed", i);
+            return OGS_ERROR;
+        }
+    }
+
+    ogs_info("Data-plane workers [%d] started", num_of_worker);
+
+    return OGS_OK;
+}
+
+static void upf_gtp_worker_close(void)
+{
+    int i;
+
+    if (!workers)
+        return;
+
+    for (i = 0; i < num_of_worker; i++) {
+        upf_gtp_worker_t *worker = &workers[i];
+
+        if (worker->thread) {
+            __atomic_store_n(&worker->terminated, true, __ATOMIC_RELEASE);
+            ogs_pollset_notify(worker->pollset);
+            ogs_thread_destroy(worker->thread);
+        }
+    }
+
+    for (i = 0; i < num_of_worker; i++) {
+        upf_gtp_worker_t *worker = &workers[i];
+
+        upf_gtp_port_remove_all(worker);
+        upf_gtp_rxbatch_clear(&worker->rxbatch);
+        if (worker->pollset)
+            ogs_pollset_destroy(worker->pollset);
+    }
+
+    ogs_free(workers);
+    workers = NULL;
 }
 
 static void _get_dev_mac_addr(char *ifname, uint8_t *mac_addr)
@@ -849,7 +1257,19 @@ int upf_gtp_open(void)
     ogs_sock_t *sock = NULL;
     int rc;
 
+    num_of_worker = upf_self()->dataplane.num_of_worker;
+
     ogs_list_for_each(&ogs_gtp_self()->gtpu_list, node) {
+        if (num_of_worker) {
+            /* Every worker binds its own socket to the same address */
+            if (!node->option) {
+                node->option = ogs_calloc(1, sizeof(ogs_sockopt_t));
+                ogs_assert(node->option);
+                ogs_sockopt_init(node->option);
+            }
+            node->option->so_reuseport = true;
+        }
+
         sock = ogs_gtp_server(node);
         if (!sock) return OGS_ERROR;
 
@@ -858,6 +1278,10 @@ int upf_gtp_open(void)
         else if (sock->family == AF_INET6)
             ogs_gtp_self()->gtpu_sock6 = sock;
 
+        /* The sockets are polled by the workers */
+        if (num_of_worker)
+            continue;
+
         node->poll = ogs_pollset_add(ogs_app()->pollset,
                 OGS_POLLIN, sock->fd, _gtpv1_u_recv_cb, sock);
         ogs_assert(node->poll);
@@ -879,14 +1303,25 @@ int upf_gtp_open(void)
     /* Open Tun interface */
     ogs_list_for_each(&ogs_pfcp_self()->dev_list, dev) {
         dev->is_tap = strstr(dev->ifname, "tap");
-        dev->fd = ogs_tun_open(dev->ifname, OGS_MAX_IFNAME_LEN, dev->is_tap);
+        if (num_of_worker)
+            dev->fd = ogs_tun_open_queue(
+                    dev->ifname, OGS_MAX_IFNAME_LEN, dev->is_tap);
+        else
+            dev->fd = ogs_tun_open(
+                    dev->ifname, OGS_MAX_IFNAME_LEN, dev->is_tap);
         if (dev->fd == INVALID_SOCKET) {
             ogs_error("tun_open(dev:%s) failed", dev->ifname);
             return OGS_ERROR;
         }
 
-        if (dev->is_tap) {
+        if (dev->is_tap)
             _get_dev_mac_addr(dev->ifname, dev->mac_addr);
+
+        /* The queues are polled by the workers */
+        if (num_of_worker)
+            continue;
+
+        if (dev->is_tap) {
             dev->poll = ogs_pollset_add(ogs_app()->pollset,
                     OGS_POLLIN, dev->fd, _gtpv1_tun_recv_eth_cb, NULL);
             ogs_assert(dev->poll);
@@ -919,6 +1354,14 @@ int upf_gtp_open(void)
         }
     }
 
+    if (num_of_worker) {
+        rc = upf_gtp_worker_open();
+        if (rc != OGS_OK) {
+            ogs_error("upf_gtp_worker_open() failed");
+            return OGS_ERROR;
+        }
+    }
+
     return OGS_OK;
 }
 
@@ -926,6 +1369,9 @@ void upf_gtp_close(void)
 {
     ogs_pfcp_dev_t *dev = NULL;
 
+    upf_gtp_worker_close();
+    upf_gtp_rxbatch_clear(&rxbatch);
+
     ogs_socknode_remove_all(&ogs_gtp_self()->gtpu_list);
 
     ogs_list_for_each(&ogs_pfcp_self()->dev_list, dev) {
@@ -935,7 +1381,8 @@ void upf_gtp_close(void)
     }
 }
 
-static void upf_gtp_handle_multicast(ogs_pkbuf_t *recvbuf)
+static void upf_gtp_handle_multicast(
+        upf_gtp_worker_t *worker, ogs_pkbuf_t *recvbuf)
 {
     struct ip *ip_h =  NULL;
     struct ip6_hdr *ip6_h = NULL;
@@ -965,10 +1412,9 @@ static void upf_gtp_handle_multicast(ogs_pkbuf_t *recvbuf)
                         if (pdr->src_if == OGS_PFCP_INTERFACE_CORE) {
                             ogs_pkbuf_t *sendbuf = ogs_pkbuf_copy(recvbuf);
                             ogs_assert(sendbuf);
-                            ogs_assert(true ==
-                                ogs_pfcp_up_handle_pdr(
+                            upf_gtp_handle_pdr(worker,
                                     pdr, OGS_GTPU_MSGTYPE_GPDU, 0,
-                                    NULL, sendbuf, &report));
+                                    NULL, sendbuf, &report);
                             break;
                         }
                     }
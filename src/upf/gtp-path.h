@@ -33,6 +33,9 @@ void upf_gtp_final(void);
 int upf_gtp_open(void);
 void upf_gtp_close(void);
 
+void upf_gtp_dataplane_lock(void);
+void upf_gtp_dataplane_unlock(void);
+
 #ifdef __cplusplus
 }
 #endif
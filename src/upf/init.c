@@ -39,6 +39,7 @@ int upf_initialize(void)
 
     ogs_gtp_context_init(OGS_MAX_NUM_OF_GTPU_RESOURCE);
     ogs_pfcp_context_init();
+    ogs_pfcp_buffer_init();
 
     upf_context_init();
     upf_event_init();
@@ -97,6 +98,7 @@ void upf_terminate(void)
 
     upf_context_final();
 
+    ogs_pfcp_buffer_final();
     ogs_pfcp_context_final();
     ogs_gtp_context_final();
 
@@ -119,6 +121,12 @@ static void upf_main(void *data)
         ogs_pollset_poll(ogs_app()->pollset,
                 ogs_timer_mgr_next(ogs_app()->timer_mgr));
 
+        /*
+         * With data-plane workers, sessions must not be changed
+         * while a worker is forwarding a packet.
+         */
+        upf_gtp_dataplane_lock();
+
         /*
          * After ogs_pollset_poll(), ogs_timer_mgr_expire() must be called.
          *
@@ -138,8 +146,10 @@ static void upf_main(void *data)
             rv = ogs_queue_trypop(ogs_app()->queue, (void**)&e);
             ogs_assert(rv != OGS_ERROR);
 
-            if (rv == OGS_DONE)
+            if (rv == OGS_DONE) {
+                upf_gtp_dataplane_unlock();
                 goto done;
+            }
 
             if (rv == OGS_RETRY)
                 break;
@@ -148,6 +158,8 @@ static void upf_main(void *data)
             ogs_fsm_dispatch(&upf_sm, e);
             upf_event_free(e);
         }
+
+        upf_gtp_dataplane_unlock();
     }
 done:
 
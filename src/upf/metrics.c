@@ -111,7 +111,15 @@ const char *labels_qfi[] = {
         .labels = labels_qfi, \
     },
 ogs_metrics_spec_t *upf_metrics_spec_by_qfi[_UPF_METR_BY_QFI_MAX];
-ogs_hash_t *metrics_hash_by_qfi = NULL;   /* hash table for QFI label */
+/*
+ * Updated by the data-plane workers, so the instances are kept in a
+ * table indexed by the 6-bit QFI instead of a hash. An instance is
+ * created once under the mutex and then read without locking.
+ */
+#define UPF_METR_MAX_QFI 64
+static ogs_metrics_inst_t *metrics_inst_by_qfi
+    [UPF_METR_MAX_QFI][_UPF_METR_BY_QFI_MAX];
+static ogs_thread_mutex_t metrics_mutex_by_qfi;
 upf_metrics_spec_def_t upf_metrics_spec_def_by_qfi[_UPF_METR_BY_QFI_MAX] = {
 /* Counters: */
 UPF_METR_BY_QFI_CTR_ENTRY(
@@ -124,45 +132,47 @@ UPF_METR_BY_QFI_CTR_ENTRY(
     "Data volume of outgoing GTP data packets per QoS level on the N3 interface")
 };
 void upf_metrics_init_by_qfi(void);
+void upf_metrics_final_by_qfi(void);
 int upf_metrics_free_inst_by_qfi(ogs_metrics_inst_t **inst);
-typedef struct upf_metric_key_by_qfi_s {
-    uint8_t                     qfi;
-    upf_metric_type_by_qfi_t    t;
-} upf_metric_key_by_qfi_t;
 
 void upf_metrics_init_by_qfi(void)
 {
-    metrics_hash_by_qfi = ogs_hash_make();
-    ogs_assert(metrics_hash_by_qfi);
+    memset(metrics_inst_by_qfi, 0, sizeof(metrics_inst_by_qfi));
+    ogs_thread_mutex_init(&metrics_mutex_by_qfi);
+}
+void upf_metrics_final_by_qfi(void)
+{
+    /* don't free instances -
+     * they will be free'd by ogs_metrics_context_final() */
+    memset(metrics_inst_by_qfi, 0, sizeof(metrics_inst_by_qfi));
+    ogs_thread_mutex_destroy(&metrics_mutex_by_qfi);
 }
 void upf_metrics_inst_by_qfi_add(uint8_t qfi,
         upf_metric_type_by_qfi_t t, int val)
 {
     ogs_metrics_inst_t *metrics = NULL;
-    upf_metric_key_by_qfi_t *qfi_key;
-
-    qfi_key = ogs_calloc(1, sizeof(*qfi_key));
-    ogs_assert(qfi_key);
 
-    qfi_key->qfi = qfi;
-    qfi_key->t = t;
-
-    metrics = ogs_hash_get(metrics_hash_by_qfi,
-            qfi_key, sizeof(*qfi_key));
+    ogs_assert(t < _UPF_METR_BY_QFI_MAX);
+    if (qfi >= UPF_METR_MAX_QFI)
+        return;
 
+    metrics = __atomic_load_n(&metrics_inst_by_qfi[qfi][t], __ATOMIC_ACQUIRE);
     if (!metrics) {
-        char qfi_str[4];
-        ogs_snprintf(qfi_str, sizeof(qfi_str), "%d", qfi);
-
-        metrics = ogs_metrics_inst_new(upf_metrics_spec_by_qfi[t],
-                upf_metrics_spec_def_by_qfi->num_labels,
-                (const char *[]){ qfi_str });
-
-        ogs_assert(metrics);
-        ogs_hash_set(metrics_hash_by_qfi,
-                qfi_key, sizeof(*qfi_key), metrics);
-    } else {
-        ogs_free(qfi_key);
+        ogs_thread_mutex_lock(&metrics_mutex_by_qfi);
+        metrics = metrics_inst_by_qfi[qfi][t];
+        if (!metrics) {
+            char qfi_str[4];
+            ogs_snprintf(qfi_str, sizeof(qfi_str), "%d", qfi);
+
+            metrics = ogs_metrics_inst_new(upf_metrics_spec_by_qfi[t],
+                    upf_metrics_spec_def_by_qfi->num_labels,
+                    (const char *[]){ qfi_str });
+            ogs_assert(metrics);
+
+            __atomic_store_n(&metrics_inst_by_qfi[qfi][t],
+                    metrics, __ATOMIC_RELEASE);
+        }
+        ogs_thread_mutex_unlock(&metrics_mutex_by_qfi);
     }
 
     ogs_metrics_inst_add(metrics, val);
@@ -345,21 +355,8 @@ void upf_metrics_final(void)
 {
     ogs_hash_index_t *hi;
 
-    if (metrics_hash_by_qfi) {
-        for (hi = ogs_hash_first(metrics_hash_by_qfi); hi; hi = ogs_hash_next(hi)) {
-            upf_metric_key_by_qfi_t *key =
-                (upf_metric_key_by_qfi_t *)ogs_hash_this_key(hi);
-            //void *val = ogs_hash_this_val(hi);
-
-            ogs_hash_set(metrics_hash_by_qfi, key, sizeof(*key), NULL);
+    upf_metrics_final_by_qfi();
 
-            ogs_free(key);
-            /* don't free val (metric itself) -
-             * it will be free'd by ogs_metrics_context_final() */
-            //ogs_free(val);
-        }
-        ogs_hash_destroy(metrics_hash_by_qfi);
-    }
     if (metrics_hash_by_cause) {
         for (hi = ogs_hash_first(metrics_hash_by_cause); hi; hi = ogs_hash_next(hi)) {
             upf_metric_key_by_cause_t *key =
@@ -20,6 +20,74 @@
 #include "context.h"
 #include "n4-build.h"
 
+/* Referenced by the Load/Overload Control IEs until the message is built */
+static struct {
+    uint32_t load_sequence_number;
+    uint8_t load_metric;
+    uint32_t overload_sequence_number;
+    uint8_t overload_reduction_metric;
+    uint8_t period_of_validity;
+    ogs_pfcp_oci_flags_t oci_flags;
+} load_control;
+
+static void build_load_control_information(
+        ogs_pfcp_tlv_load_control_information_t *lci,
+        ogs_pfcp_tlv_overload_control_information_t *oci)
+{
+    ogs_assert(lci);
+    ogs_assert(oci);
+
+    upf_load_update();
+
+    if (ogs_pfcp_self()->cp_function_features.load) {
+        load_control.load_sequence_number =
+            htobe32(upf_self()->load.sequence_number);
+        load_control.load_metric = upf_self()->load.metric;
+
+        lci->presence = 1;
+        lci->load_control_sequence_number.presence = 1;
+        lci->load_control_sequence_number.data =
+            &load_control.load_sequence_number;
+        lci->load_control_sequence_number.len =
+            sizeof(load_control.load_sequence_number);
+        lci->load_metric.presence = 1;
+        lci->load_metric.data = &load_control.load_metric;
+        lci->load_metric.len = sizeof(load_control.load_metric);
+    }
+
+    /* Refreshed by every response while overloaded, expires otherwise */
+    if (ogs_pfcp_self()->cp_function_features.ovrl &&
+        upf_self()->overload.reduction_metric) {
+        load_control.overload_sequence_number =
+            htobe32(upf_self()->overload.sequence_number);
+        load_control.overload_reduction_metric =
+            upf_self()->overload.reduction_metric;
+        load_control.period_of_validity = ogs_pfcp_encode_timer(10);
+        load_control.oci_flags.value = 0;
+        load_control.oci_flags.aoci = 1;
+
+        oci->presence = 1;
+        oci->overload_control_sequence_number.presence = 1;
+        oci->overload_control_sequence_number.data =
+            &load_control.overload_sequence_number;
+        oci->overload_control_sequence_number.len =
+            sizeof(load_control.overload_sequence_number);
+        oci->overload_reduction_metric.presence = 1;
+        oci->overload_reduction_metric.data =
+            &load_control.overload_reduction_metric;
+        oci->overload_reduction_metric.len =
+            sizeof(load_control.overload_reduction_metric);
+        oci->period_of_validity.presence = 1;
+        oci->period_of_validity.data = &load_control.period_of_validity;
+        oci->period_of_validity.len = sizeof(load_control.period_of_validity);
+        oci->overload_control_information_flags.presence = 1;
+        oci->overload_control_information_flags.data =
+            &load_control.oci_flags;
+        oci->overload_control_information_flags.len =
+            sizeof(load_control.oci_flags);
+    }
+}
+
 ogs_pkbuf_t *upf_n4_build_session_establishment_response(uint8_t type,
     upf_sess_t *sess, ogs_pfcp_pdr_t *created_pdr[], int num_of_created_pdr)
 {
@@ -69,6 +137,9 @@ ogs_pkbuf_t *upf_n4_build_session_establishment_response(uint8_t type,
         if (pdr_presence == true) j++;
     }
 
+    build_load_control_information(&rsp->load_control_information,
+            &rsp->overload_control_information);
+
     pfcp_message->h.type = type;
     pkbuf = ogs_pfcp_build_msg(pfcp_message);
     ogs_expect(pkbuf);
@@ -111,6 +182,9 @@ ogs_pkbuf_t *upf_n4_build_session_modification_response(uint8_t type,
         if (pdr_presence == true) j++;
     }
 
+    build_load_control_information(&rsp->load_control_information,
+            &rsp->overload_control_information);
+
     pfcp_message->h.type = type;
     pkbuf = ogs_pfcp_build_msg(pfcp_message);
     ogs_expect(pkbuf);
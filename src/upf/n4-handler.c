@@ -89,6 +89,7 @@ void upf_n4_handle_session_establishment_request(
             break;
     }
     num_of_created_pdr = i;
+    ogs_pfcp_classifier_compile(&sess->pfcp);
     if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
         goto cleanup;
 
@@ -286,6 +287,7 @@ void upf_n4_handle_session_modification_request(
                 &cause_value, &offending_ie_value) == false)
             break;
     }
+    ogs_pfcp_classifier_compile(&sess->pfcp);
     if (cause_value != OGS_PFCP_CAUSE_REQUEST_ACCEPTED)
         goto cleanup;
 
@@ -48,6 +48,9 @@ void upf_state_operational(ogs_fsm_t *s, upf_event_t *e)
     ogs_pfcp_node_t *node = NULL;
     ogs_pfcp_xact_t *xact = NULL;
 
+    upf_sess_t *sess = NULL;
+    ogs_pfcp_urr_t *urr = NULL;
+
     upf_sm_debug(e);
 
     ogs_assert(s);
@@ -93,6 +96,35 @@ void upf_state_operational(ogs_fsm_t *s, upf_event_t *e)
 
         ogs_fsm_dispatch(&node->sm, e);
         break;
+    case UPF_EVT_SESSION_REPORT:
+        ogs_assert(e->report);
+
+        sess = upf_sess_find_by_id(e->sess_id);
+        if (!sess) {
+            ogs_warn("Session has already been removed");
+            ogs_free(e->report);
+            break;
+        }
+
+        ogs_assert(OGS_OK ==
+            upf_pfcp_send_session_report_request(sess, e->report));
+        ogs_free(e->report);
+        break;
+    case UPF_EVT_URR_VOLUME_REPORT:
+        sess = upf_sess_find_by_id(e->sess_id);
+        if (!sess) {
+            ogs_warn("Session has already been removed");
+            break;
+        }
+
+        urr = ogs_pfcp_urr_find(&sess->pfcp, e->urr_id);
+        if (!urr) {
+            ogs_warn("URR has already been removed [%d]", e->urr_id);
+            break;
+        }
+
+        upf_sess_urr_acc_check_volume(sess, urr);
+        break;
     default:
         ogs_error("No handler for event %s", upf_event_get_name(e));
         break;
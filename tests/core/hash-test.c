@@ -386,6 +386,242 @@ static void hash_count_5(abts_case *tc, void *data)
     ogs_hash_destroy(h);
 }
 
+#define NUM_OF_RESIZE_KEY 100000
+
+static void hash_resize_test(abts_case *tc, void *data)
+{
+    ogs_hash_t *h;
+    ogs_hash_index_t *hi;
+    uint32_t *key;
+    int i, c;
+
+    key = ogs_calloc(NUM_OF_RESIZE_KEY, sizeof(*key));
+    ABTS_PTR_NOTNULL(tc, key);
+
+    h = ogs_hash_make();
+    ABTS_PTR_NOTNULL(tc, h);
+
+    /* Every key stays reachable while the table is being resized */
+    for (i = 0; i < NUM_OF_RESIZE_KEY; i++) {
+        key[i] = i * 7919;
+        ogs_hash_set(h, &key[i], sizeof(key[i]), &key[i]);
+        if ((i & 0x3ff) == 0) {
+            for (c = 0; c <= i; c += 97)
+                ABTS_PTR_EQUAL(tc, &key[c],
+                        ogs_hash_get(h, &key[c], sizeof(key[c])));
+        }
+    }
+    ABTS_INT_EQUAL(tc, NUM_OF_RESIZE_KEY, ogs_hash_count(h));
+
+    /* Remove every other key while iterating */
+    c = 0;
+    for (hi = ogs_hash_first(h); hi; hi = ogs_hash_next(hi)) {
+        uint32_t *k = ogs_hash_this_val(hi);
+        if (((k - key) & 1) == 0)
+            ogs_hash_set(h, k, sizeof(*k), NULL);
+        c++;
+    }
+    ABTS_INT_EQUAL(tc, NUM_OF_RESIZE_KEY, c);
+    ABTS_INT_EQUAL(tc, NUM_OF_RESIZE_KEY/2, ogs_hash_count(h));
+
+    for (i = 0; i < NUM_OF_RESIZE_KEY; i++) {
+        if (i & 1)
+            ABTS_PTR_EQUAL(tc, &key[i],
+                    ogs_hash_get(h, &key[i], sizeof(key[i])));
+        else
+            ABTS_PTR_EQUAL(tc, NULL,
+                    ogs_hash_get(h, &key[i], sizeof(key[i])));
+    }
+
+    /* Tombstones left by the removal are reused */
+    for (i = 0; i < NUM_OF_RESIZE_KEY; i += 2)
+        ABTS_PTR_EQUAL(tc, &key[i],
+                ogs_hash_get_or_set(h, &key[i], sizeof(key[i]), &key[i]));
+    ABTS_INT_EQUAL(tc, NUM_OF_RESIZE_KEY, ogs_hash_count(h));
+
+    c = 0;
+    for (hi = ogs_hash_first(h); hi; hi = ogs_hash_next(hi))
+        c++;
+    ABTS_INT_EQUAL(tc, NUM_OF_RESIZE_KEY, c);
+
+    ogs_hash_destroy(h);
+    ogs_free(key);
+}
+
+static void hash_size_test(abts_case *tc, void *data)
+{
+    ogs_hash_t *h;
+    char buf[NUM_OF_RESIZE_KEY/100][16];
+    ogs_time_t start, usec;
+    int i;
+
+    h = ogs_hash_make_size(NUM_OF_RESIZE_KEY/100);
+    ABTS_PTR_NOTNULL(tc, h);
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < NUM_OF_RESIZE_KEY/100; i++) {
+        ogs_snprintf(buf[i], sizeof(buf[i]), "imsi-%010d", i);
+        ogs_hash_set(h, buf[i], OGS_HASH_KEY_STRING, buf[i]);
+    }
+    for (i = 0; i < NUM_OF_RESIZE_KEY/100; i++)
+        ABTS_STR_EQUAL(tc, buf[i],
+                ogs_hash_get(h, buf[i], OGS_HASH_KEY_STRING));
+    usec = ogs_get_monotonic_time() - start;
+
+    ABTS_INT_EQUAL(tc, NUM_OF_RESIZE_KEY/100, ogs_hash_count(h));
+
+    ogs_debug("%d string keys: set and get %lld usec",
+            NUM_OF_RESIZE_KEY/100, (long long)usec);
+
+    ogs_hash_destroy(h);
+}
+
+/*
+ * A synthetic gNB holding 10k UEs: per-message RAN-UE-NGAP-ID lookup
+ * through the per-gNB list versus the per-gNB hash.
+ */
+#define NUM_OF_RAN_UE 10000
+
+typedef struct ran_ue_s {
+    ogs_lnode_t lnode;
+    uint64_t ran_ue_ngap_id;
+} ran_ue_t;
+
+static void hash_ran_ue_test(abts_case *tc, void *data)
+{
+    ogs_list_t ran_ue_list;
+    ogs_hash_t *ran_ue_hash;
+    ran_ue_t *ran_ue, *found;
+    ogs_time_t start, list_usec, hash_usec;
+    int i, j;
+
+    ran_ue = ogs_calloc(NUM_OF_RAN_UE, sizeof(*ran_ue));
+    ABTS_PTR_NOTNULL(tc, ran_ue);
+
+    ogs_list_init(&ran_ue_list);
+    ran_ue_hash = ogs_hash_make();
+    ABTS_PTR_NOTNULL(tc, ran_ue_hash);
+
+    for (i = 0; i < NUM_OF_RAN_UE; i++) {
+        ran_ue[i].ran_ue_ngap_id = (uint64_t)i * 7919 + 1;
+        ogs_list_add(&ran_ue_list, &ran_ue[i]);
+        ogs_hash_set(ran_ue_hash, &ran_ue[i].ran_ue_ngap_id,
+                sizeof(ran_ue[i].ran_ue_ngap_id), &ran_ue[i]);
+    }
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < NUM_OF_RAN_UE; i++) {
+        uint64_t ran_ue_ngap_id =
+            ran_ue[(i * 31) % NUM_OF_RAN_UE].ran_ue_ngap_id;
+
+        ogs_list_for_each(&ran_ue_list, found)
+            if (found->ran_ue_ngap_id == ran_ue_ngap_id)
+                break;
+        ABTS_PTR_EQUAL(tc, &ran_ue[(i * 31) % NUM_OF_RAN_UE], found);
+    }
+    list_usec = ogs_get_monotonic_time() - start;
+
+    start = ogs_get_monotonic_time();
+    for (j = 0; j < 10; j++) {
+        for (i = 0; i < NUM_OF_RAN_UE; i++) {
+            uint64_t ran_ue_ngap_id =
+                ran_ue[(i * 31) % NUM_OF_RAN_UE].ran_ue_ngap_id;
+
+            found = ogs_hash_get(ran_ue_hash,
+                    &ran_ue_ngap_id, sizeof(ran_ue_ngap_id));
+            ABTS_PTR_EQUAL(tc, &ran_ue[(i * 31) % NUM_OF_RAN_UE], found);
+        }
+    }
+    hash_usec = (ogs_get_monotonic_time() - start) / 10;
+
+    ogs_debug("%d RAN UEs: list lookup %lld usec, hash lookup %lld usec",
+            NUM_OF_RAN_UE, (long long)list_usec, (long long)hash_usec);
+
+    ogs_hash_destroy(ran_ue_hash);
+    ogs_free(ran_ue);
+}
+
+/* Same add/remove/re-key sequence as the AMF and MME RAN UE contexts */
+typedef struct chain_ue_s {
+    uint64_t id;
+    ogs_hash_chain_t hash_chain;
+} chain_ue_t;
+
+static chain_ue_t *chain_ue_find(ogs_hash_t *h, uint64_t id)
+{
+    ogs_hash_chain_t *node = ogs_hash_get(h, &id, sizeof(id));
+    return node ? ogs_container_of(node, chain_ue_t, hash_chain) : NULL;
+}
+
+static void chain_ue_set_id(ogs_hash_t *h, chain_ue_t *ue, uint64_t id)
+{
+    ogs_hash_chain_remove(h, &ue->hash_chain);
+    ue->id = id;
+    ogs_hash_chain_add(h, &ue->hash_chain, &ue->id, sizeof(ue->id));
+}
+
+static void hash_chain_test(abts_case *tc, void *data)
+{
+    ogs_hash_t *h = NULL;
+    chain_ue_t ue[4];
+    int i;
+
+    h = ogs_hash_make();
+    ABTS_PTR_NOTNULL(tc, h);
+
+    memset(ue, 0, sizeof(ue));
+    for (i = 0; i < 4; i++) {
+        ue[i].id = i < 3 ? 7 : 8;
+        ogs_hash_chain_add(h, &ue[i].hash_chain, &ue[i].id, sizeof(ue[i].id));
+    }
+
+    /* A reused id keeps resolving to the oldest context */
+    ABTS_INT_EQUAL(tc, 2, ogs_hash_count(h));
+    ABTS_PTR_EQUAL(tc, &ue[0], chain_ue_find(h, 7));
+    ABTS_PTR_EQUAL(tc, &ue[1].hash_chain, ue[0].hash_chain.next);
+    ABTS_PTR_EQUAL(tc, &ue[2].hash_chain, ue[1].hash_chain.next);
+    ABTS_PTR_EQUAL(tc, NULL, ue[2].hash_chain.next);
+    ABTS_PTR_EQUAL(tc, &ue[3], chain_ue_find(h, 8));
+
+    /* Removing from the middle of the chain */
+    ogs_hash_chain_remove(h, &ue[1].hash_chain);
+    ABTS_PTR_EQUAL(tc, &ue[0], chain_ue_find(h, 7));
+    ABTS_PTR_EQUAL(tc, &ue[2].hash_chain, ue[0].hash_chain.next);
+    ABTS_PTR_EQUAL(tc, NULL, ue[1].hash_chain.next);
+
+    /* Removing twice is harmless */
+    ogs_hash_chain_remove(h, &ue[1].hash_chain);
+    ABTS_INT_EQUAL(tc, 2, ogs_hash_count(h));
+
+    /*
+     * Removing the head moves the key to the next context, so that the
+     * entry no longer refers to the id of the removed one.
+     */
+    ogs_hash_chain_remove(h, &ue[0].hash_chain);
+    ue[0].id = 0xdeadbeef;
+    ABTS_PTR_EQUAL(tc, &ue[2], chain_ue_find(h, 7));
+    ABTS_PTR_EQUAL(tc, NULL, chain_ue_find(h, 0xdeadbeef));
+    ABTS_INT_EQUAL(tc, 2, ogs_hash_count(h));
+
+    /* Re-keying, e.g. a new RAN-UE-NGAP-ID after path switch */
+    chain_ue_set_id(h, &ue[2], 9);
+    ABTS_PTR_EQUAL(tc, NULL, chain_ue_find(h, 7));
+    ABTS_PTR_EQUAL(tc, &ue[2], chain_ue_find(h, 9));
+
+    /* Re-keying onto an id in use chains behind the current holder */
+    chain_ue_set_id(h, &ue[2], 8);
+    ABTS_PTR_EQUAL(tc, NULL, chain_ue_find(h, 9));
+    ABTS_PTR_EQUAL(tc, &ue[3], chain_ue_find(h, 8));
+    ABTS_PTR_EQUAL(tc, &ue[2].hash_chain, ue[3].hash_chain.next);
+
+    ogs_hash_chain_remove(h, &ue[3].hash_chain);
+    ABTS_PTR_EQUAL(tc, &ue[2], chain_ue_find(h, 8));
+    ogs_hash_chain_remove(h, &ue[2].hash_chain);
+    ABTS_INT_EQUAL(tc, 0, ogs_hash_count(h));
+
+    ogs_hash_destroy(h);
+}
+
 abts_suite *test_hash(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -406,6 +642,10 @@ abts_suite *test_hash(abts_suite *suite)
     abts_run_test(suite, hash_clear_test, NULL);
     abts_run_test(suite, hash_traverse, NULL);
     abts_run_test(suite, summation_test, NULL);
+    abts_run_test(suite, hash_resize_test, NULL);
+    abts_run_test(suite, hash_size_test, NULL);
+    abts_run_test(suite, hash_ran_ue_test, NULL);
+    abts_run_test(suite, hash_chain_test, NULL);
 
     return suite;
 }
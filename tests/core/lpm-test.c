@@ -0,0 +1,283 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-core.h"
+#include "core/abts.h"
+
+#define NUM_OF_PREFIX 1000
+#define NUM_OF_LOOKUP 10000
+
+#define NUM_OF_BENCH_ENTRY 100000
+#define NUM_OF_BENCH_LOOKUP 1000000
+
+static uint32_t lpm_rand(void)
+{
+    static uint32_t seed = 0x12345678;
+
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    return seed;
+}
+
+static void test1_func(abts_case *tc, void *data)
+{
+    ogs_lpm_t *lpm = NULL;
+    uint32_t addr;
+    int rv;
+
+    lpm = ogs_lpm_create(AF_INET);
+    ABTS_PTR_NOTNULL(tc, lpm);
+
+    addr = htobe32(0x0a2d0000); /* 10.45.0.0 */
+    rv = ogs_lpm_add(lpm, &addr, 16, (void *)1);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    addr = htobe32(0x0a2d0100); /* 10.45.1.0 */
+    rv = ogs_lpm_add(lpm, &addr, 24, (void *)2);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    addr = htobe32(0x0a2d0101); /* 10.45.1.1 */
+    rv = ogs_lpm_add(lpm, &addr, 32, (void *)3);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    addr = 0;
+    rv = ogs_lpm_add(lpm, &addr, 0, (void *)4);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ABTS_INT_EQUAL(tc, 4, ogs_lpm_count(lpm));
+
+    addr = htobe32(0x0a2d0101);
+    ABTS_PTR_EQUAL(tc, (void *)3, ogs_lpm_lookup(lpm, &addr));
+    addr = htobe32(0x0a2d0102);
+    ABTS_PTR_EQUAL(tc, (void *)2, ogs_lpm_lookup(lpm, &addr));
+    addr = htobe32(0x0a2d0201);
+    ABTS_PTR_EQUAL(tc, (void *)1, ogs_lpm_lookup(lpm, &addr));
+    addr = htobe32(0x08080808);
+    ABTS_PTR_EQUAL(tc, (void *)4, ogs_lpm_lookup(lpm, &addr));
+
+    /* Host bits are ignored */
+    addr = htobe32(0x0a2d01ff);
+    ABTS_PTR_EQUAL(tc, (void *)2, ogs_lpm_find(lpm, &addr, 24));
+    ABTS_PTR_EQUAL(tc, NULL, ogs_lpm_find(lpm, &addr, 32));
+
+    addr = htobe32(0x0a2d0100);
+    rv = ogs_lpm_delete(lpm, &addr, 24);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    rv = ogs_lpm_delete(lpm, &addr, 24);
+    ABTS_INT_EQUAL(tc, OGS_ERROR, rv);
+    addr = htobe32(0x0a2d0102);
+    ABTS_PTR_EQUAL(tc, (void *)1, ogs_lpm_lookup(lpm, &addr));
+
+    addr = 0;
+    rv = ogs_lpm_delete(lpm, &addr, 0);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    addr = htobe32(0x08080808);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_lpm_lookup(lpm, &addr));
+    ABTS_INT_EQUAL(tc, 2, ogs_lpm_count(lpm));
+
+    ogs_lpm_destroy(lpm);
+}
+
+static void test2_func(abts_case *tc, void *data)
+{
+    ogs_lpm_t *lpm = NULL;
+    uint8_t addr[16];
+    int rv;
+
+    lpm = ogs_lpm_create(AF_INET6);
+    ABTS_PTR_NOTNULL(tc, lpm);
+
+    ogs_assert(inet_pton(AF_INET6, "2001:db8:cafe::", addr) == 1);
+    rv = ogs_lpm_add(lpm, addr, 64, (void *)1);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ogs_assert(inet_pton(AF_INET6, "2001:db8::", addr) == 1);
+    rv = ogs_lpm_add(lpm, addr, 32, (void *)2);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ogs_assert(inet_pton(AF_INET6, "2001:db8:cafe::1", addr) == 1);
+    rv = ogs_lpm_add(lpm, addr, 128, (void *)3);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    ogs_assert(inet_pton(AF_INET6, "2001:db8:cafe::1", addr) == 1);
+    ABTS_PTR_EQUAL(tc, (void *)3, ogs_lpm_lookup(lpm, addr));
+    ogs_assert(inet_pton(AF_INET6, "2001:db8:cafe::2", addr) == 1);
+    ABTS_PTR_EQUAL(tc, (void *)1, ogs_lpm_lookup(lpm, addr));
+    ogs_assert(inet_pton(AF_INET6, "2001:db8:beef::2", addr) == 1);
+    ABTS_PTR_EQUAL(tc, (void *)2, ogs_lpm_lookup(lpm, addr));
+    ogs_assert(inet_pton(AF_INET6, "2001:db9::1", addr) == 1);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_lpm_lookup(lpm, addr));
+
+    ogs_lpm_destroy(lpm);
+}
+
+static struct {
+    uint32_t addr;
+    int prefixlen;
+    bool used;
+} prefix[NUM_OF_PREFIX];
+
+static void *linear_lookup(uint32_t addr)
+{
+    int i, best = -1;
+
+    for (i = 0; i < NUM_OF_PREFIX; i++) {
+        uint32_t mask = prefix[i].prefixlen ?
+            0xffffffff << (32 - prefix[i].prefixlen) : 0;
+
+        if (!prefix[i].used)
+            continue;
+        if ((be32toh(addr) & mask) != prefix[i].addr)
+            continue;
+        if (best < 0 || prefix[i].prefixlen > prefix[best].prefixlen)
+            best = i;
+    }
+
+    return best < 0 ? NULL : &prefix[best];
+}
+
+static void test3_func(abts_case *tc, void *data)
+{
+    ogs_lpm_t *lpm = NULL;
+    uint32_t addr;
+    int i, rv, mismatch;
+
+    lpm = ogs_lpm_create(AF_INET);
+    ABTS_PTR_NOTNULL(tc, lpm);
+
+    memset(prefix, 0, sizeof(prefix));
+    for (i = 0; i < NUM_OF_PREFIX; i++) {
+        int j;
+
+        /* Keep prefixes inside 10.0.0.0/8 so that lookups hit often */
+        prefix[i].prefixlen = 8 + lpm_rand() % 25;
+        prefix[i].addr = (0x0a000000 | (lpm_rand() & 0x00ffffff)) &
+            (0xffffffff << (32 - prefix[i].prefixlen));
+
+        for (j = 0; j < i; j++) {
+            if (prefix[j].used &&
+                prefix[j].addr == prefix[i].addr &&
+                prefix[j].prefixlen == prefix[i].prefixlen)
+                break;
+        }
+        if (j != i)
+            continue;
+
+        prefix[i].used = true;
+        addr = htobe32(prefix[i].addr);
+        rv = ogs_lpm_add(lpm, &addr, prefix[i].prefixlen, &prefix[i]);
+        ogs_assert(rv == OGS_OK);
+    }
+
+    mismatch = 0;
+    for (i = 0; i < NUM_OF_LOOKUP; i++) {
+        addr = htobe32(0x0a000000 | (lpm_rand() & 0x00ffffff));
+        if (linear_lookup(addr) != ogs_lpm_lookup(lpm, &addr))
+            mismatch++;
+    }
+    ABTS_INT_EQUAL(tc, 0, mismatch);
+
+    /* Remove every other prefix and check again */
+    for (i = 0; i < NUM_OF_PREFIX; i += 2) {
+        if (!prefix[i].used)
+            continue;
+        prefix[i].used = false;
+        addr = htobe32(prefix[i].addr);
+        rv = ogs_lpm_delete(lpm, &addr, prefix[i].prefixlen);
+        ogs_assert(rv == OGS_OK);
+    }
+
+    mismatch = 0;
+    for (i = 0; i < NUM_OF_LOOKUP; i++) {
+        addr = htobe32(0x0a000000 | (lpm_rand() & 0x00ffffff));
+        if (linear_lookup(addr) != ogs_lpm_lookup(lpm, &addr))
+            mismatch++;
+    }
+    ABTS_INT_EQUAL(tc, 0, mismatch);
+
+    ogs_lpm_destroy(lpm);
+}
+
+static void test4_func(abts_case *tc, void *data)
+{
+    ogs_lpm_t *lpm = NULL;
+    ogs_hash_t *hash = NULL;
+    ogs_time_t start, lpm_usec, hash_usec;
+    uint32_t addr;
+    uintptr_t found = 0;
+    int i, rv;
+
+    lpm = ogs_lpm_create(AF_INET);
+    ABTS_PTR_NOTNULL(tc, lpm);
+    hash = ogs_hash_make();
+    ABTS_PTR_NOTNULL(tc, hash);
+
+    /* UE addresses in 10.45.0.0/16 .. 10.46.0.0/16 */
+    for (i = 0; i < NUM_OF_BENCH_ENTRY; i++) {
+        addr = htobe32(0x0a2d0000 + i);
+        rv = ogs_lpm_add(lpm, &addr, 32, (void *)(uintptr_t)(i + 1));
+        ogs_assert(rv == OGS_OK);
+        ogs_hash_set(hash, &addr, sizeof(addr), (void *)(uintptr_t)(i + 1));
+    }
+    /* A few framed routes */
+    for (i = 0; i < 64; i++) {
+        addr = htobe32(0xc0a80000 + (i << 8));
+        rv = ogs_lpm_add(lpm, &addr, 24, (void *)(uintptr_t)(i + 1));
+        ogs_assert(rv == OGS_OK);
+    }
+    ABTS_INT_EQUAL(tc, NUM_OF_BENCH_ENTRY + 64, ogs_lpm_count(lpm));
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < NUM_OF_BENCH_LOOKUP; i++) {
+        addr = htobe32(0x0a2d0000 + (lpm_rand() % NUM_OF_BENCH_ENTRY));
+        found += (uintptr_t)ogs_lpm_lookup(lpm, &addr);
+    }
+    lpm_usec = ogs_get_monotonic_time() - start;
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < NUM_OF_BENCH_LOOKUP; i++) {
+        addr = htobe32(0x0a2d0000 + (lpm_rand() % NUM_OF_BENCH_ENTRY));
+        found += (uintptr_t)ogs_hash_get(hash, &addr, sizeof(addr));
+    }
+    hash_usec = ogs_get_monotonic_time() - start;
+
+    ABTS_TRUE(tc, found != 0);
+
+    ogs_debug("LPM %d lookups in %d entries: lpm %lld usec, hash %lld usec",
+            NUM_OF_BENCH_LOOKUP, NUM_OF_BENCH_ENTRY + 64,
+            (long long)lpm_usec, (long long)hash_usec);
+
+    for (i = 0; i < NUM_OF_BENCH_ENTRY; i++) {
+        addr = htobe32(0x0a2d0000 + i);
+        rv = ogs_lpm_delete(lpm, &addr, 32);
+        ogs_assert(rv == OGS_OK);
+    }
+    ABTS_INT_EQUAL(tc, 64, ogs_lpm_count(lpm));
+
+    ogs_hash_destroy(hash);
+    ogs_lpm_destroy(lpm);
+}
+
+abts_suite *test_lpm(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, test1_func, NULL);
+    abts_run_test(suite, test2_func, NULL);
+    abts_run_test(suite, test3_func, NULL);
+    abts_run_test(suite, test4_func, NULL);
+
+    return suite;
+}
@@ -70,12 +70,147 @@ static void test2_func(abts_case *tc, void *data)
     ogs_pkbuf_free(p3);
 }
 
+#if OGS_USE_TALLOC == 0
+#define TEST3_NUM 1024
+
+static ogs_pkbuf_t *test3_pkbuf[TEST3_NUM];
+
+static void test3_thread(void *data)
+{
+    ogs_pkbuf_pool_t *pool = data;
+    int i;
+
+    for (i = 0; i < TEST3_NUM; i++) {
+        test3_pkbuf[i] = ogs_pkbuf_alloc(pool, 1500);
+        ogs_assert(test3_pkbuf[i]);
+    }
+
+    /* Leave a refilled cache behind */
+    ogs_pkbuf_free(ogs_pkbuf_alloc(pool, 1500));
+}
+
+static void test3_func(abts_case *tc, void *data)
+{
+    ogs_pkbuf_config_t config;
+    ogs_pkbuf_pool_t *pool = NULL;
+    ogs_pkbuf_pool_stat_t stat[OGS_PKBUF_NUM_OF_CLUSTER];
+    ogs_pkbuf_t *pkbuf = NULL, *p2 = NULL;
+    ogs_thread_t *thread = NULL;
+    uint64_t miss;
+    int i, cached;
+
+    memset(&config, 0, sizeof config);
+    config.cluster_2048_pool = 2048;
+
+    pool = ogs_pkbuf_pool_create(&config);
+    ABTS_PTR_NOTNULL(tc, pool);
+
+    for (i = 0; i < 1000; i++) {
+        pkbuf = ogs_pkbuf_alloc(pool, 1500);
+        ogs_assert(pkbuf);
+        ogs_pkbuf_free(pkbuf);
+    }
+
+    ogs_pkbuf_pool_stat(pool, stat);
+    ABTS_INT_EQUAL(tc, 2048, stat[4].cluster_size);
+    ABTS_INT_EQUAL(tc, 2048, stat[4].size);
+    ABTS_INT_EQUAL(tc, 1, (int)stat[4].miss);
+    ABTS_INT_EQUAL(tc, 999, (int)stat[4].hit);
+    ABTS_INT_EQUAL(tc, 2048, stat[4].avail + stat[4].cached);
+
+    /* A shared cluster is released only by its last user */
+    pkbuf = ogs_pkbuf_alloc(pool, 1500);
+    ABTS_PTR_NOTNULL(tc, pkbuf);
+    p2 = ogs_pkbuf_copy(pkbuf);
+    ABTS_PTR_NOTNULL(tc, p2);
+    ogs_pkbuf_free(pkbuf);
+    ogs_pkbuf_pool_stat(pool, stat);
+    ABTS_INT_EQUAL(tc, 2047, stat[4].avail + stat[4].cached);
+    ogs_pkbuf_free(p2);
+    ogs_pkbuf_pool_stat(pool, stat);
+    cached = stat[4].cached;
+    miss = stat[4].miss;
+
+    /* Allocated in another thread, freed in this thread */
+    thread = ogs_thread_create(test3_thread, pool);
+    ABTS_PTR_NOTNULL(tc, thread);
+    ogs_thread_destroy(thread);
+
+    /* The cache of the exited thread is back in the pool */
+    ogs_pkbuf_pool_stat(pool, stat);
+    ABTS_INT_EQUAL(tc, cached, stat[4].cached);
+    ABTS_INT_EQUAL(tc, 2048 - TEST3_NUM - cached, stat[4].avail);
+    ABTS_TRUE(tc, stat[4].miss > miss);
+
+    for (i = 0; i < TEST3_NUM; i++)
+        ogs_pkbuf_free(test3_pkbuf[i]);
+
+    ogs_pkbuf_pool_stat(pool, stat);
+    ABTS_INT_EQUAL(tc, 2048, stat[4].avail + stat[4].cached);
+
+    /* The cache of this thread is flushed back to the pool */
+    ogs_pkbuf_pool_destroy(pool);
+}
+
+static void test4_func(abts_case *tc, void *data)
+{
+    ogs_pkbuf_config_t config;
+    ogs_pkbuf_pool_t *pool = NULL;
+    ogs_pkbuf_t *scratch = NULL, *pkbuf = NULL, *p2 = NULL;
+    int i;
+
+    memset(&config, 0, sizeof config);
+    config.cluster_128_pool = 64;
+    config.cluster_2048_pool = 64;
+
+    pool = ogs_pkbuf_pool_create(&config);
+    ABTS_PTR_NOTNULL(tc, pool);
+
+    scratch = ogs_pkbuf_alloc(pool, 2048);
+    ABTS_PTR_NOTNULL(tc, scratch);
+    ogs_pkbuf_reserve(scratch, 16);
+    ogs_pkbuf_put(scratch, ogs_pkbuf_tailroom(scratch));
+
+    /* A small packet is copied, keeping the headroom */
+    ogs_pkbuf_trim(scratch, 60);
+    for (i = 0; i < 60; i++)
+        scratch->data[i] = i;
+
+    pkbuf = ogs_pkbuf_right_size(pool, &scratch);
+    ABTS_PTR_NOTNULL(tc, pkbuf);
+    ABTS_PTR_NOTNULL(tc, scratch);
+    ABTS_TRUE(tc, pkbuf != scratch);
+    ABTS_INT_EQUAL(tc, 128, pkbuf->cluster->size);
+    ABTS_INT_EQUAL(tc, 16, ogs_pkbuf_headroom(pkbuf));
+    ABTS_INT_EQUAL(tc, 60, pkbuf->len);
+    ABTS_TRUE(tc, memcmp(pkbuf->data, scratch->data, 60) == 0);
+    ogs_pkbuf_free(pkbuf);
+
+    /* A large packet takes over the scratch buffer */
+    ogs_pkbuf_put(scratch, ogs_pkbuf_tailroom(scratch));
+    ogs_pkbuf_trim(scratch, 1500);
+    p2 = scratch;
+
+    pkbuf = ogs_pkbuf_right_size(pool, &scratch);
+    ABTS_PTR_EQUAL(tc, p2, pkbuf);
+    ABTS_PTR_EQUAL(tc, NULL, scratch);
+    ABTS_INT_EQUAL(tc, 1500, pkbuf->len);
+    ogs_pkbuf_free(pkbuf);
+
+    ogs_pkbuf_pool_destroy(pool);
+}
+#endif
+
 abts_suite *test_pkbuf(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
 
     abts_run_test(suite, test1_func, NULL);
     abts_run_test(suite, test2_func, NULL);
+#if OGS_USE_TALLOC == 0
+    abts_run_test(suite, test3_func, NULL);
+    abts_run_test(suite, test4_func, NULL);
+#endif
 
     return suite;
 }
@@ -228,6 +228,56 @@ static void test3_func(abts_case *tc, void *data)
     ogs_pool_final(&testpool);
 }
 
+typedef struct {
+    ogs_pool_id_t id;
+    int value;
+} idnode_t;
+
+static OGS_POOL(idpool, idnode_t);
+
+static void test4_func(abts_case *tc, void *data)
+{
+    idnode_t *node[5] = {NULL, };
+    idnode_t *reused = NULL;
+    ogs_pool_id_t id[5], stale;
+    int i;
+
+    ogs_pool_init(&idpool, 5);
+
+    for (i = 0; i < 5; i++) {
+        ogs_pool_id_calloc(&idpool, &node[i]);
+        ABTS_PTR_NOTNULL(tc, node[i]);
+        id[i] = node[i]->id;
+        ABTS_TRUE(tc, id[i] >= OGS_MIN_POOL_ID);
+    }
+
+    for (i = 0; i < 5; i++)
+        ABTS_PTR_EQUAL(tc, node[i], ogs_pool_find_by_id(&idpool, id[i]));
+
+    stale = OGS_INVALID_POOL_ID;
+    ABTS_PTR_EQUAL(tc, NULL, ogs_pool_find_by_id(&idpool, stale));
+
+    stale = id[2];
+    ogs_pool_id_free(&idpool, node[2]);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_pool_find_by_id(&idpool, stale));
+
+    /* The same slot is handed out again with a new generation */
+    ogs_pool_id_calloc(&idpool, &reused);
+    ABTS_PTR_EQUAL(tc, node[2], reused);
+    ABTS_TRUE(tc, reused->id != stale);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_pool_find_by_id(&idpool, stale));
+    ABTS_PTR_EQUAL(tc, reused, ogs_pool_find_by_id(&idpool, reused->id));
+    id[2] = reused->id;
+
+    for (i = 0; i < 5; i++) {
+        ABTS_PTR_EQUAL(tc, node[i], ogs_pool_find_by_id(&idpool, id[i]));
+        ogs_pool_id_free(&idpool, node[i]);
+        ABTS_PTR_EQUAL(tc, NULL, ogs_pool_find_by_id(&idpool, id[i]));
+    }
+
+    ogs_pool_final(&idpool);
+}
+
 abts_suite *test_pool(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -235,6 +285,7 @@ abts_suite *test_pool(abts_suite *suite)
     abts_run_test(suite, test1_func, NULL);
     abts_run_test(suite, test2_func, NULL);
     abts_run_test(suite, test3_func, NULL);
+    abts_run_test(suite, test4_func, NULL);
 
     return suite;
 }
@@ -424,6 +424,57 @@ static void test8_func(abts_case *tc, void *data)
     ABTS_INT_EQUAL(tc, OGS_OK, rv);
 }
 
+static void test9_func(abts_case *tc, void *data)
+{
+    int rv, i, n;
+    ogs_sock_t *udp, *client;
+    ogs_sockaddr_t *addr;
+    ogs_pkbuf_t *sendbuf[3], *recvbuf[4];
+    ogs_sockaddr_t to[3], from[4];
+    char buf[OGS_ADDRSTRLEN];
+
+    rv = ogs_getaddrinfo(&addr, AF_INET, "127.0.0.1", PORT, 0);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    udp = ogs_udp_server(addr, NULL);
+    ABTS_PTR_NOTNULL(tc, udp);
+    client = ogs_udp_client(addr, NULL);
+    ABTS_PTR_NOTNULL(tc, client);
+
+    for (i = 0; i < 3; i++) {
+        sendbuf[i] = ogs_pkbuf_alloc(NULL, STRLEN);
+        ABTS_PTR_NOTNULL(tc, sendbuf[i]);
+        ogs_pkbuf_put_data(sendbuf[i], DATASTR, strlen(DATASTR) - i);
+        memcpy(&to[i], addr, sizeof to[i]);
+    }
+    n = ogs_sendmmsg(client->fd, sendbuf, to, 3, 0);
+    ABTS_INT_EQUAL(tc, 3, n);
+
+    for (i = 0; i < 4; i++) {
+        recvbuf[i] = ogs_pkbuf_alloc(NULL, STRLEN);
+        ABTS_PTR_NOTNULL(tc, recvbuf[i]);
+        ogs_pkbuf_put(recvbuf[i], STRLEN);
+    }
+    n = ogs_recvmmsg(udp->fd, recvbuf, from, 4, 0);
+    ABTS_INT_EQUAL(tc, 3, n);
+    for (i = 0; i < n; i++) {
+        ABTS_INT_EQUAL(tc, strlen(DATASTR) - i, recvbuf[i]->len);
+        ABTS_TRUE(tc,
+                memcmp(recvbuf[i]->data, DATASTR, recvbuf[i]->len) == 0);
+        ABTS_STR_EQUAL(tc, "127.0.0.1", OGS_ADDR(&from[i], buf));
+    }
+
+    for (i = 0; i < 3; i++)
+        ogs_pkbuf_free(sendbuf[i]);
+    for (i = 0; i < 4; i++)
+        ogs_pkbuf_free(recvbuf[i]);
+
+    ogs_sock_destroy(client);
+    ogs_sock_destroy(udp);
+
+    rv = ogs_freeaddrinfo(addr);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+}
+
 abts_suite *test_socket(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -436,6 +487,7 @@ abts_suite *test_socket(abts_suite *suite)
     abts_run_test(suite, test6_func, NULL);
     abts_run_test(suite, test7_func, NULL);
     abts_run_test(suite, test8_func, NULL);
+    abts_run_test(suite, test9_func, NULL);
 
     return suite;
 }
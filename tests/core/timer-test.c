@@ -51,7 +51,7 @@ static void test1_func(abts_case *tc, void *data)
 
     memset(expire_check, 0, TEST_DURATION/TEST_TIMER_PRECISION);
 
-    timer = ogs_timer_mgr_create(512);
+    timer = ogs_timer_mgr_create_backend(512, (uintptr_t)data);
     pollset = ogs_pollset_create(512);
     ogs_assert(timer);
     for(n = 0; n < sizeof(timer_duration)/sizeof(ogs_time_t); n++) {
@@ -126,7 +126,7 @@ static void test2_func(abts_case *tc, void *data)
     memset(expire_check, 0, TEST_DURATION/TEST_TIMER_PRECISION);
     memset(tm_num, 0, sizeof(int)*(TEST_DURATION/TEST_TIMER_PRECISION));
 
-    timer = ogs_timer_mgr_create(512);
+    timer = ogs_timer_mgr_create_backend(512, (uintptr_t)data);
     ogs_assert(timer);
 
     for(n = 0; n < TEST_TIMER_NUM; n++) {
@@ -168,7 +168,7 @@ static void test3_func(abts_case *tc, void *data)
     memset(expire_check, 0, TEST_DURATION/TEST_TIMER_PRECISION);
     memset(tm_num, 0, sizeof(int)*(TEST_DURATION/TEST_TIMER_PRECISION));
 
-    timer = ogs_timer_mgr_create(512);
+    timer = ogs_timer_mgr_create_backend(512, (uintptr_t)data);
     ogs_assert(timer);
 
     for(n = 0; n < TEST_TIMER_NUM; n++) {
@@ -208,13 +208,95 @@ static void test3_func(abts_case *tc, void *data)
     ogs_timer_mgr_destroy(timer);
 }
 
+#define TEST_BENCH_TIMER_NUM    100000
+#define TEST_BENCH_RESTART      10
+
+static void test_expire_func_3(void *data)
+{
+    int *count = data;
+
+    (*count)++;
+}
+
+static ogs_time_t bench_timer(ogs_timer_backend_e backend, int *count)
+{
+    int n, i;
+    ogs_timer_mgr_t *timer = NULL;
+    ogs_timer_t **timer_array = NULL;
+    ogs_time_t start, elapsed;
+
+    timer = ogs_timer_mgr_create_backend(TEST_BENCH_TIMER_NUM, backend);
+    ogs_assert(timer);
+    timer_array = ogs_calloc(TEST_BENCH_TIMER_NUM, sizeof(ogs_timer_t *));
+    ogs_assert(timer_array);
+
+    for (n = 0; n < TEST_BENCH_TIMER_NUM; n++) {
+        timer_array[n] = ogs_timer_add(timer, test_expire_func_3, count);
+        ogs_assert(timer_array[n]);
+    }
+
+    start = ogs_get_monotonic_time();
+
+    /* Restart the same timers again and again like NAS/xact timers */
+    for (i = 0; i < TEST_BENCH_RESTART; i++) {
+        for (n = 0; n < TEST_BENCH_TIMER_NUM; n++)
+            ogs_timer_start(timer_array[n],
+                    ogs_time_from_sec(1) + (ogs_random32() % 30000000));
+        ogs_timer_mgr_expire(timer);
+    }
+
+    /* Short timers to check expiry */
+    for (n = 0; n < TEST_BENCH_TIMER_NUM; n += 100)
+        ogs_timer_start(timer_array[n], 1000 + (n % 10000));
+
+    while (*count < TEST_BENCH_TIMER_NUM / 100) {
+        ogs_usleep(ogs_timer_mgr_next(timer));
+        ogs_timer_mgr_expire(timer);
+    }
+
+    for (n = 0; n < TEST_BENCH_TIMER_NUM; n++)
+        ogs_timer_stop(timer_array[n]);
+
+    elapsed = ogs_get_monotonic_time() - start;
+
+    ogs_assert(ogs_timer_mgr_next(timer) == OGS_INFINITE_TIME);
+
+    for (n = 0; n < TEST_BENCH_TIMER_NUM; n++)
+        ogs_timer_delete(timer_array[n]);
+
+    ogs_free(timer_array);
+    ogs_timer_mgr_destroy(timer);
+
+    return elapsed;
+}
+
+static void test4_func(abts_case *tc, void *data)
+{
+    int rbtree_count = 0, wheel_count = 0;
+    ogs_time_t rbtree_usec, wheel_usec;
+
+    rbtree_usec = bench_timer(OGS_TIMER_BACKEND_RBTREE, &rbtree_count);
+    wheel_usec = bench_timer(OGS_TIMER_BACKEND_WHEEL, &wheel_count);
+
+    ABTS_INT_EQUAL(tc, TEST_BENCH_TIMER_NUM / 100, rbtree_count);
+    ABTS_INT_EQUAL(tc, TEST_BENCH_TIMER_NUM / 100, wheel_count);
+
+    ogs_debug("Timer %d x %d restarts: rbtree %lld usec, wheel %lld usec",
+            TEST_BENCH_TIMER_NUM, TEST_BENCH_RESTART,
+            (long long)rbtree_usec, (long long)wheel_usec);
+}
+
 abts_suite *test_timer(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
 
-    abts_run_test(suite, test1_func, NULL);
-    abts_run_test(suite, test2_func, NULL);
-    abts_run_test(suite, test3_func, NULL);
+    abts_run_test(suite, test1_func, (void *)OGS_TIMER_BACKEND_RBTREE);
+    abts_run_test(suite, test2_func, (void *)OGS_TIMER_BACKEND_RBTREE);
+    abts_run_test(suite, test3_func, (void *)OGS_TIMER_BACKEND_RBTREE);
+    abts_run_test(suite, test1_func, (void *)OGS_TIMER_BACKEND_WHEEL);
+    abts_run_test(suite, test2_func, (void *)OGS_TIMER_BACKEND_WHEEL);
+    abts_run_test(suite, test3_func, (void *)OGS_TIMER_BACKEND_WHEEL);
+    abts_run_test(suite, test4_func, NULL);
 
     return suite;
 }
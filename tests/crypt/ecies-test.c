@@ -371,6 +371,130 @@ static void hmac_sha_256(abts_case *tc, void *data)
     }
 }
 
+/* TS33.501 Annex C.4.3 and C.4.4 : scheme output on the home network side */
+static const char *decrypt_k[] = {
+    "c53c22208b61860b06c62e5406a7b330c2b577aa5558981510d128247d38bd1d",
+    "F1AB1074477EBCC7F554EA1C5FC368B1616730155E0041AC447D6301975FECDA",
+};
+static const char *decrypt_pubkey[] = {
+    "b2e92f836055a255837debf850b528997ce0201cb82adfe4be1f587d07d8457d",
+    "039AAB8376597021E855679A9778EA0B67396E68C66DF32C0F41E9ACCA2DA9B9D1",
+};
+static const char *decrypt_cipher[] = {
+    "cb02352410",
+    "46A33FC271",
+};
+static const char *decrypt_mactag[] = {
+    "cddd9e730ef3fa87",
+    "6AC7DAE96AA30A4D",
+};
+static const uint8_t decrypt_scheme[] = {
+    OGS_PROTECTION_SCHEME_PROFILE_A,
+    OGS_PROTECTION_SCHEME_PROFILE_B,
+};
+
+static void ecies_decrypt(abts_case *tc, void *data)
+{
+    ogs_aes_backend_e backend[] = {
+        OGS_AES_BACKEND_SOFTWARE,
+        OGS_AES_BACKEND_OPENSSL,
+    };
+    ogs_aes_backend_e saved = ogs_aes_get_backend();
+
+    ogs_ecies_key_t key;
+    uint8_t k[OGS_ECCKEY_LEN];
+    uint8_t pubkey[OGS_ECCKEY_LEN+1];
+    uint8_t cipher[5], mactag[OGS_MACTAG_LEN], plain[5];
+    uint8_t tmp[5];
+
+    int b, i, rv;
+
+    for (b = 0; b < OGS_ARRAY_SIZE(backend); b++) {
+        if (ogs_aes_set_backend(backend[b]) != OGS_OK)
+            continue;
+
+        for (i = 0; i < OGS_ARRAY_SIZE(decrypt_scheme); i++) {
+            rv = ogs_ecies_key_setup(&key, decrypt_scheme[i],
+                    ogs_hex_from_string(decrypt_k[i], k, sizeof(k)));
+            ABTS_INT_EQUAL(tc, OGS_OK, rv);
+            ABTS_INT_EQUAL(tc, backend[b], key.backend);
+
+            ogs_hex_from_string(decrypt_pubkey[i], pubkey, sizeof(pubkey));
+            ogs_hex_from_string(decrypt_cipher[i], cipher, sizeof(cipher));
+            ogs_hex_from_string(decrypt_mactag[i], mactag, sizeof(mactag));
+
+            rv = ogs_ecies_decrypt(&key, pubkey,
+                    cipher, sizeof(cipher), mactag, plain);
+            ABTS_INT_EQUAL(tc, OGS_OK, rv);
+            ABTS_TRUE(tc, memcmp(plain,
+                ogs_hex_from_string("00012080f6", tmp, sizeof(tmp)),
+                sizeof(plain)) == 0);
+
+            /* The key is reusable and a bad MAC-tag is rejected */
+            mactag[0] ^= 1;
+            rv = ogs_ecies_decrypt(&key, pubkey,
+                    cipher, sizeof(cipher), mactag, plain);
+            ABTS_INT_EQUAL(tc, OGS_ERROR, rv);
+
+            ogs_ecies_key_clear(&key);
+        }
+    }
+
+    ogs_aes_set_backend(saved);
+}
+
+static void ecies_benchmark(abts_case *tc, void *data)
+{
+#define ECIES_BENCHMARK_LOOP 1000
+    ogs_aes_backend_e backend[] = {
+        OGS_AES_BACKEND_SOFTWARE,
+        OGS_AES_BACKEND_OPENSSL,
+    };
+    ogs_aes_backend_e saved = ogs_aes_get_backend();
+
+    ogs_ecies_key_t key;
+    uint8_t k[OGS_ECCKEY_LEN];
+    uint8_t pubkey[OGS_ECCKEY_LEN+1];
+    uint8_t cipher[5], mactag[OGS_MACTAG_LEN], plain[5];
+    ogs_time_t start, usec;
+
+    int b, i, j, rv;
+
+    for (b = 0; b < OGS_ARRAY_SIZE(backend); b++) {
+        if (ogs_aes_set_backend(backend[b]) != OGS_OK)
+            continue;
+
+        for (i = 0; i < OGS_ARRAY_SIZE(decrypt_scheme); i++) {
+            rv = ogs_ecies_key_setup(&key, decrypt_scheme[i],
+                    ogs_hex_from_string(decrypt_k[i], k, sizeof(k)));
+            ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+            ogs_hex_from_string(decrypt_pubkey[i], pubkey, sizeof(pubkey));
+            ogs_hex_from_string(decrypt_cipher[i], cipher, sizeof(cipher));
+            ogs_hex_from_string(decrypt_mactag[i], mactag, sizeof(mactag));
+
+            start = ogs_get_monotonic_time();
+            for (j = 0; j < ECIES_BENCHMARK_LOOP; j++) {
+                rv = ogs_ecies_decrypt(&key, pubkey,
+                        cipher, sizeof(cipher), mactag, plain);
+                ABTS_INT_EQUAL(tc, OGS_OK, rv);
+            }
+            usec = ogs_get_monotonic_time() - start;
+            if (usec <= 0)
+                usec = 1;
+
+            ogs_debug("Profile %c [backend:%d]: %lld SUCI/sec per core",
+                    'A' + i, key.backend,
+                    (long long)ECIES_BENCHMARK_LOOP *
+                        OGS_USEC_PER_SEC / usec);
+
+            ogs_ecies_key_clear(&key);
+        }
+    }
+
+    ogs_aes_set_backend(saved);
+}
+
 abts_suite *test_ecies(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -380,6 +504,8 @@ abts_suite *test_ecies(abts_suite *suite)
     abts_run_test(suite, ansi_x963_kdf, NULL);
     abts_run_test(suite, aes_128ctr, NULL);
     abts_run_test(suite, hmac_sha_256, NULL);
+    abts_run_test(suite, ecies_decrypt, NULL);
+    abts_run_test(suite, ecies_benchmark, NULL);
 
     return suite;
 }
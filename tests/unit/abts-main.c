@@ -24,30 +24,46 @@ extern int __ogs_s1ap_domain;
 extern int __ogs_ngap_domain;
 extern int __ogs_nas_domain;
 extern int __ogs_gtp_domain;
+extern int __ogs_pfcp_domain;
 extern int __ogs_sbi_domain;
+extern int __ogs_dbi_domain;
 
 void ogs_sbi_message_init(int num_of_request_pool, int num_of_response_pool);
 void ogs_sbi_message_final(void);
 
 abts_suite *test_proto_message(abts_suite *suite);
+abts_suite *test_event(abts_suite *suite);
 abts_suite *test_s1ap_message(abts_suite *suite);
 abts_suite *test_nas_message(abts_suite *suite);
 abts_suite *test_gtp_message(abts_suite *suite);
 abts_suite *test_ngap_message(abts_suite *suite);
 abts_suite *test_sbi_message(abts_suite *suite);
+abts_suite *test_sbi_discovery(abts_suite *suite);
 abts_suite *test_security(abts_suite *suite);
+abts_suite *test_pfcp_message(abts_suite *suite);
+abts_suite *test_pfcp_rule(abts_suite *suite);
+abts_suite *test_pfcp_buffer(abts_suite *suite);
+abts_suite *test_pfcp_load(abts_suite *suite);
+abts_suite *test_dbi(abts_suite *suite);
 abts_suite *test_crash(abts_suite *suite);
 
 const struct testlist {
     abts_suite *(*func)(abts_suite *suite);
 } alltests[] = {
     {test_proto_message},
+    {test_event},
     {test_s1ap_message},
     {test_nas_message},
     {test_gtp_message},
     {test_ngap_message},
     {test_sbi_message},
+    {test_sbi_discovery},
     {test_security},
+    {test_pfcp_message},
+    {test_pfcp_rule},
+    {test_pfcp_buffer},
+    {test_pfcp_load},
+    {test_dbi},
     {test_crash},
     {NULL},
 };
@@ -106,7 +122,9 @@ int main(int argc, const char *const argv[])
     ogs_log_install_domain(&__ogs_ngap_domain, "ngap", OGS_LOG_ERROR);
     ogs_log_install_domain(&__ogs_nas_domain, "nas", OGS_LOG_ERROR);
     ogs_log_install_domain(&__ogs_gtp_domain, "gtp", OGS_LOG_ERROR);
+    ogs_log_install_domain(&__ogs_pfcp_domain, "pfcp", OGS_LOG_ERROR);
     ogs_log_install_domain(&__ogs_sbi_domain, "sbi", OGS_LOG_ERROR);
+    ogs_log_install_domain(&__ogs_dbi_domain, "dbi", OGS_LOG_ERROR);
 
     atexit(terminate);
 
@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2019-2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-dbi.h"
+#include "core/abts.h"
+
+#define NUM_OF_WORKER 4
+#define NUM_OF_REQUEST 32
+#define FAILED_SUPI "imsi-001010000000013"
+
+static ogs_thread_mutex_t mock_mutex;
+static int in_flight, max_in_flight;
+static int thread_init_count, thread_final_count;
+
+static void mock_enter(void)
+{
+    ogs_thread_mutex_lock(&mock_mutex);
+    in_flight++;
+    if (in_flight > max_in_flight)
+        max_in_flight = in_flight;
+    ogs_thread_mutex_unlock(&mock_mutex);
+
+    /* Emulate the DB round-trip */
+    ogs_usleep(20000);
+
+    ogs_thread_mutex_lock(&mock_mutex);
+    in_flight--;
+    ogs_thread_mutex_unlock(&mock_mutex);
+}
+
+static int mock_thread_init(void)
+{
+    ogs_thread_mutex_lock(&mock_mutex);
+    thread_init_count++;
+    ogs_thread_mutex_unlock(&mock_mutex);
+    return OGS_OK;
+}
+
+static void mock_thread_final(void)
+{
+    ogs_thread_mutex_lock(&mock_mutex);
+    thread_final_count++;
+    ogs_thread_mutex_unlock(&mock_mutex);
+}
+
+static int mock_auth_info(char *supi, ogs_dbi_auth_info_t *auth_info)
+{
+    mock_enter();
+
+    if (!strcmp(supi, FAILED_SUPI))
+        return OGS_ERROR;
+
+    memset(auth_info, 0, sizeof(*auth_info));
+    memcpy(auth_info->k, supi + strlen(supi) - 4, 4);
+    auth_info->sqn = 32;
+    return OGS_OK;
+}
+
+static int mock_update_sqn(char *supi, uint64_t sqn)
+{
+    mock_enter();
+    return sqn == 64 ? OGS_OK : OGS_ERROR;
+}
+
+static int mock_increment_sqn(char *supi)
+{
+    mock_enter();
+    return OGS_OK;
+}
+
+static int mock_subscription_data(char *supi,
+        ogs_subscription_data_t *subscription_data)
+{
+    mock_enter();
+
+    subscription_data->ambr.uplink = 1024;
+    subscription_data->ambr.downlink = 2048;
+    subscription_data->imsi = ogs_strdup(supi);
+    ogs_assert(subscription_data->imsi);
+    return OGS_OK;
+}
+
+static const ogs_dbi_backend_t mock_backend = {
+    .thread_init = mock_thread_init,
+    .thread_final = mock_thread_final,
+
+    .auth_info = mock_auth_info,
+    .update_sqn = mock_update_sqn,
+    .increment_sqn = mock_increment_sqn,
+    .subscription_data = mock_subscription_data,
+};
+
+static void complete(ogs_dbi_request_t *request)
+{
+    ogs_queue_t *queue = request->data;
+    ogs_assert(OGS_OK == ogs_queue_push(queue, request));
+}
+
+static void test1_func(abts_case *tc, void *data)
+{
+    ogs_queue_t *queue = NULL;
+    ogs_dbi_request_t *request = NULL;
+    char supi[OGS_MAX_IMSI_BCD_LEN+6];
+    int i, rv, num_of_failed = 0;
+
+    ogs_thread_mutex_init(&mock_mutex);
+    in_flight = max_in_flight = 0;
+    thread_init_count = thread_final_count = 0;
+
+    queue = ogs_queue_create(NUM_OF_REQUEST);
+    ABTS_PTR_NOTNULL(tc, queue);
+
+    ABTS_TRUE(tc, !ogs_dbi_worker_enabled());
+    rv = ogs_dbi_worker_init(NUM_OF_WORKER, &mock_backend);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    ABTS_TRUE(tc, ogs_dbi_worker_enabled());
+
+    for (i = 0; i < NUM_OF_REQUEST; i++) {
+        int ops = OGS_DBI_REQUEST_AUTH_INFO;
+
+        ogs_snprintf(supi, sizeof(supi), "imsi-0010100000000%02d", i);
+        if (i % 2)
+            ops |= OGS_DBI_REQUEST_UPDATE_SQN|OGS_DBI_REQUEST_INCREMENT_SQN;
+        else
+            ops |= OGS_DBI_REQUEST_SUBSCRIPTION_DATA;
+
+        request = ogs_dbi_request_new(ops, supi, complete, queue);
+        ABTS_PTR_NOTNULL(tc, request);
+        request->sqn = 64;
+
+        rv = ogs_dbi_request_submit(request);
+        ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    }
+
+    for (i = 0; i < NUM_OF_REQUEST; i++) {
+        rv = ogs_queue_pop(queue, (void **)&request);
+        ABTS_INT_EQUAL(tc, OGS_OK, rv);
+        ABTS_PTR_NOTNULL(tc, request);
+
+        if (!strcmp(request->supi, FAILED_SUPI)) {
+            /* Execution stops at the first failed operation */
+            ABTS_INT_EQUAL(tc, OGS_DBI_REQUEST_AUTH_INFO, request->failed);
+            ABTS_INT_EQUAL(tc, 0, request->done);
+            num_of_failed++;
+        } else {
+            ABTS_INT_EQUAL(tc, 0, request->failed);
+            ABTS_INT_EQUAL(tc, request->ops, request->done);
+            ABTS_TRUE(tc, memcmp(request->auth_info.k,
+                    request->supi + strlen(request->supi) - 4, 4) == 0);
+            ABTS_TRUE(tc, request->auth_info.sqn == 32);
+
+            if (request->ops & OGS_DBI_REQUEST_SUBSCRIPTION_DATA) {
+                ABTS_TRUE(tc, request->subscription_data.ambr.uplink == 1024);
+                ABTS_STR_EQUAL(tc,
+                        request->supi, request->subscription_data.imsi);
+            }
+        }
+
+        ogs_dbi_request_free(request);
+    }
+    ABTS_INT_EQUAL(tc, 1, num_of_failed);
+
+    ogs_dbi_worker_final();
+    ABTS_TRUE(tc, !ogs_dbi_worker_enabled());
+
+    ABTS_INT_EQUAL(tc, NUM_OF_WORKER, thread_init_count);
+    ABTS_INT_EQUAL(tc, NUM_OF_WORKER, thread_final_count);
+
+    /* The DB round-trips overlap across the workers */
+    ABTS_TRUE(tc, max_in_flight > 1);
+    ABTS_TRUE(tc, max_in_flight <= NUM_OF_WORKER);
+
+    ogs_queue_destroy(queue);
+    ogs_thread_mutex_destroy(&mock_mutex);
+}
+
+static void test2_func(abts_case *tc, void *data)
+{
+    ogs_dbi_auth_info_t auth_info;
+    ogs_subscription_data_t subscription_data;
+    char *supi[3] = {
+        (char *)"imsi-001010000000001",
+        (char *)"imsi-001010000000002",
+        (char *)"imsi-001010000000003",
+    };
+    int i;
+
+    ogs_dbi_cache_init(2);
+    ABTS_TRUE(tc, ogs_dbi_cache_enabled());
+
+    ABTS_TRUE(tc, !ogs_dbi_cache_get_auth_info(supi[0], &auth_info));
+
+    for (i = 0; i < 2; i++) {
+        memset(&auth_info, 0, sizeof(auth_info));
+        auth_info.k[0] = i + 1;
+        auth_info.sqn = (i + 1) * 32;
+        ogs_dbi_cache_set_auth_info(supi[i], &auth_info);
+    }
+
+    /* An entry already loaded is not overwritten by an older read */
+    auth_info.sqn = 0;
+    ogs_dbi_cache_set_auth_info(supi[1], &auth_info);
+    ABTS_TRUE(tc, ogs_dbi_cache_get_auth_info(supi[1], &auth_info));
+    ABTS_INT_EQUAL(tc, 2, auth_info.k[0]);
+    ABTS_TRUE(tc, auth_info.sqn == 64);
+
+    /* supi[0] is now the least recently used and gets evicted */
+    ogs_dbi_cache_set_auth_info(supi[2], &auth_info);
+    ABTS_TRUE(tc, !ogs_dbi_cache_get_auth_info(supi[0], &auth_info));
+    ABTS_TRUE(tc, ogs_dbi_cache_get_auth_info(supi[1], &auth_info));
+    ABTS_TRUE(tc, ogs_dbi_cache_get_auth_info(supi[2], &auth_info));
+
+    /* Subscription data is deep-copied in and out of the cache */
+    memset(&subscription_data, 0, sizeof(subscription_data));
+    subscription_data.ambr.downlink = 1024;
+    subscription_data.imsi = ogs_strdup("001010000000002");
+    subscription_data.num_of_slice = 1;
+    subscription_data.slice[0].num_of_session = 1;
+    subscription_data.slice[0].session[0].name = ogs_strdup("internet");
+    ogs_dbi_cache_set_subscription_data(supi[1], &subscription_data);
+    ogs_subscription_data_free(&subscription_data);
+
+    memset(&subscription_data, 0, sizeof(subscription_data));
+    ABTS_TRUE(tc, ogs_dbi_cache_get_subscription_data(
+                supi[1], &subscription_data));
+    ABTS_TRUE(tc, subscription_data.ambr.downlink == 1024);
+    ABTS_STR_EQUAL(tc, "001010000000002", subscription_data.imsi);
+    ABTS_STR_EQUAL(tc, "internet",
+            subscription_data.slice[0].session[0].name);
+    ogs_subscription_data_free(&subscription_data);
+
+    ogs_dbi_cache_remove(supi[1]);
+    ABTS_TRUE(tc, !ogs_dbi_cache_get_auth_info(supi[1], &auth_info));
+    ABTS_TRUE(tc, !ogs_dbi_cache_get_subscription_data(
+                supi[1], &subscription_data));
+
+    ogs_dbi_cache_final();
+    ABTS_TRUE(tc, !ogs_dbi_cache_enabled());
+}
+
+/* Change stream event for an update of security.sqn */
+static void sqn_change_event(const char *imsi, int64_t sqn)
+{
+    bson_t *document = BCON_NEW(
+            "fullDocument", "{",
+                "imsi", BCON_UTF8(imsi),
+                "security", "{", "sqn", BCON_INT64(sqn), "}",
+            "}",
+            "updateDescription", "{",
+                "updatedFields", "{", "security.sqn", BCON_INT64(sqn), "}",
+                "removedFields", "[", "]",
+            "}");
+    ogs_assert(document);
+
+    ogs_dbi_cache_handle_change(document);
+    bson_destroy(document);
+}
+
+static void test3_func(abts_case *tc, void *data)
+{
+    ogs_dbi_auth_info_t auth_info;
+    char *supi = (char *)"imsi-001010000000001";
+    const char *imsi = "001010000000001";
+
+    /*
+     * No DB is connected, so ogs_dbi_cache_final() would crash
+     * if a dirty SQN were left to be written back.
+     */
+    ogs_dbi_cache_init(2);
+
+    memset(&auth_info, 0, sizeof(auth_info));
+    auth_info.sqn = 64;
+    ogs_dbi_cache_set_auth_info(supi, &auth_info);
+    ABTS_TRUE(tc, ogs_dbi_cache_increment_sqn(supi));
+
+    /* The SQN the entry was loaded with is not an external change */
+    sqn_change_event(imsi, 64);
+    ABTS_TRUE(tc, ogs_dbi_cache_get_auth_info(supi, &auth_info));
+    ABTS_TRUE(tc, auth_info.sqn == 96);
+
+    /* External SQN change while dirty: the DB value wins */
+    sqn_change_event(imsi, 0);
+    ABTS_TRUE(tc, !ogs_dbi_cache_get_auth_info(supi, &auth_info));
+
+    memset(&auth_info, 0, sizeof(auth_info));
+    ogs_dbi_cache_set_auth_info(supi, &auth_info);
+    ABTS_TRUE(tc, ogs_dbi_cache_get_auth_info(supi, &auth_info));
+    ABTS_TRUE(tc, auth_info.sqn == 0);
+
+    /* Another field changed: the dirty SQN survives the reload */
+    ABTS_TRUE(tc, ogs_dbi_cache_increment_sqn(supi));
+    ogs_dbi_cache_remove(supi);
+    ABTS_TRUE(tc, !ogs_dbi_cache_get_auth_info(supi, &auth_info));
+
+    memset(&auth_info, 0, sizeof(auth_info));
+    auth_info.k[0] = 1;
+    ogs_dbi_cache_set_auth_info(supi, &auth_info);
+    ABTS_TRUE(tc, ogs_dbi_cache_get_auth_info(supi, &auth_info));
+    ABTS_INT_EQUAL(tc, 1, auth_info.k[0]);
+    ABTS_TRUE(tc, auth_info.sqn == 32);
+
+    /* Reloaded after an external change, the dirty SQN is dropped */
+    ogs_dbi_cache_remove(supi);
+    memset(&auth_info, 0, sizeof(auth_info));
+    auth_info.sqn = 1024;
+    ogs_dbi_cache_set_auth_info(supi, &auth_info);
+    ABTS_TRUE(tc, ogs_dbi_cache_get_auth_info(supi, &auth_info));
+    ABTS_TRUE(tc, auth_info.sqn == 1024);
+
+    ogs_dbi_cache_final();
+}
+
+abts_suite *test_dbi(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, test1_func, NULL);
+    abts_run_test(suite, test2_func, NULL);
+    abts_run_test(suite, test3_func, NULL);
+
+    return suite;
+}
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2019-2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-proto.h"
+#include "core/abts.h"
+
+#define NUM_OF_EVENT 1024
+#define NUM_OF_THREAD 4
+
+static void test1_func(abts_case *tc, void *data)
+{
+    ogs_event_stat_t stat[OGS_EVENT_NUM_OF_SIZE_CLASS];
+    ogs_event_t *e[NUM_OF_EVENT];
+    uint64_t num_of_block[OGS_EVENT_NUM_OF_SIZE_CLASS];
+    uint64_t num_of_alloc = 0;
+    size_t size[] = { 8, 64, 65, 128, 200, OGS_EVENT_SIZE };
+    int i, j, round;
+
+    ogs_event_init();
+
+    for (round = 0; round < 3; round++) {
+        for (i = 0; i < NUM_OF_EVENT; i++) {
+            e[i] = ogs_event_size(i, size[i % OGS_ARRAY_SIZE(size)]);
+            if (size[i % OGS_ARRAY_SIZE(size)] <= 64)
+                num_of_alloc++;
+            ABTS_PTR_NOTNULL(tc, e[i]);
+            ABTS_INT_EQUAL(tc, i, e[i]->id);
+            ABTS_INT_EQUAL(tc, 0, e[i]->timer_id);
+            ABTS_INT_EQUAL(tc, 0, ((uintptr_t)e[i]) % 16);
+        }
+
+        ogs_event_stat(stat);
+        for (j = 0; j < OGS_EVENT_NUM_OF_SIZE_CLASS; j++) {
+            ABTS_TRUE(tc, stat[j].num_of_used > 0);
+            if (round == 0)
+                num_of_block[j] = stat[j].num_of_block;
+            else
+                /* Steady state : no more blocks from the heap */
+                ABTS_TRUE(tc, stat[j].num_of_block == num_of_block[j]);
+        }
+
+        for (i = 0; i < NUM_OF_EVENT; i++)
+            ogs_event_free(e[i]);
+
+        ogs_event_stat(stat);
+        for (j = 0; j < OGS_EVENT_NUM_OF_SIZE_CLASS; j++)
+            ABTS_TRUE(tc, stat[j].num_of_used == 0);
+    }
+
+    ogs_event_stat(stat);
+    ABTS_TRUE(tc, stat[0].size == 64);
+    ABTS_TRUE(tc, stat[OGS_EVENT_NUM_OF_SIZE_CLASS-1].size == OGS_EVENT_SIZE);
+    ABTS_TRUE(tc, stat[0].num_of_alloc == num_of_alloc);
+
+    ogs_event_final();
+}
+
+static ogs_queue_t *queue;
+
+static void producer_main(void *data)
+{
+    int i;
+
+    for (i = 0; i < NUM_OF_EVENT; i++) {
+        ogs_event_t *e = ogs_event_new(i);
+        ogs_assert(e);
+        ogs_assert(OGS_OK == ogs_queue_push(queue, e));
+    }
+}
+
+static void test2_func(abts_case *tc, void *data)
+{
+    ogs_event_stat_t stat[OGS_EVENT_NUM_OF_SIZE_CLASS];
+    ogs_thread_t *thread[NUM_OF_THREAD];
+    uint64_t num_of_block = 0;
+    ogs_event_t *e = NULL;
+    int i, round, rv;
+
+    ogs_event_init();
+
+    queue = ogs_queue_create(NUM_OF_THREAD * NUM_OF_EVENT);
+    ABTS_PTR_NOTNULL(tc, queue);
+
+    /* Events are produced by other threads and freed on this one */
+    for (round = 0; round < 3; round++) {
+        for (i = 0; i < NUM_OF_THREAD; i++) {
+            thread[i] = ogs_thread_create(producer_main, NULL);
+            ABTS_PTR_NOTNULL(tc, thread[i]);
+        }
+
+        for (i = 0; i < NUM_OF_THREAD * NUM_OF_EVENT; i++) {
+            rv = ogs_queue_pop(queue, (void **)&e);
+            ABTS_INT_EQUAL(tc, OGS_OK, rv);
+            ogs_event_free(e);
+        }
+
+        for (i = 0; i < NUM_OF_THREAD; i++)
+            ogs_thread_destroy(thread[i]);
+
+        ogs_event_stat(stat);
+        ABTS_TRUE(tc, stat[OGS_EVENT_NUM_OF_SIZE_CLASS-1].num_of_used == 0);
+        if (round == 0)
+            num_of_block =
+                stat[OGS_EVENT_NUM_OF_SIZE_CLASS-1].num_of_block;
+    }
+
+    /* Blocks freed here are handed back to the producers */
+    ABTS_TRUE(tc, stat[OGS_EVENT_NUM_OF_SIZE_CLASS-1].num_of_block <
+            3 * num_of_block);
+
+    ogs_queue_destroy(queue);
+    ogs_event_final();
+}
+
+static void consumer_main(void *data)
+{
+    ogs_event_t *e = NULL;
+    int i;
+
+    for (i = 0; i < NUM_OF_EVENT; i++) {
+        ogs_assert(OGS_OK == ogs_queue_pop(queue, (void **)&e));
+        ogs_event_free(e);
+    }
+}
+
+static void test3_func(abts_case *tc, void *data)
+{
+    ogs_event_stat_t stat[OGS_EVENT_NUM_OF_SIZE_CLASS];
+    ogs_thread_t *thread = NULL;
+    ogs_event_t *e[NUM_OF_EVENT];
+    uint64_t num_of_block = 0;
+    int i, round;
+
+    ogs_event_init();
+
+    queue = ogs_queue_create(NUM_OF_EVENT);
+    ABTS_PTR_NOTNULL(tc, queue);
+
+    /* Events are freed by a thread that exits afterwards */
+    for (round = 0; round < 2; round++) {
+        for (i = 0; i < NUM_OF_EVENT; i++) {
+            e[i] = ogs_event_new(i);
+            ABTS_PTR_NOTNULL(tc, e[i]);
+        }
+
+        ogs_event_stat(stat);
+        if (round == 0)
+            num_of_block = stat[OGS_EVENT_NUM_OF_SIZE_CLASS-1].num_of_block;
+        else
+            /* The blocks kept by the exited thread are reused */
+            ABTS_TRUE(tc, stat[OGS_EVENT_NUM_OF_SIZE_CLASS-1].num_of_block ==
+                    num_of_block);
+
+        thread = ogs_thread_create(consumer_main, NULL);
+        ABTS_PTR_NOTNULL(tc, thread);
+
+        for (i = 0; i < NUM_OF_EVENT; i++)
+            ABTS_INT_EQUAL(tc, OGS_OK, ogs_queue_push(queue, e[i]));
+
+        ogs_thread_destroy(thread);
+    }
+
+    ogs_queue_destroy(queue);
+    ogs_event_final();
+}
+
+abts_suite *test_event(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, test1_func, NULL);
+    abts_run_test(suite, test2_func, NULL);
+    abts_run_test(suite, test3_func, NULL);
+
+    return suite;
+}
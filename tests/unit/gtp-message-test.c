@@ -20,19 +20,21 @@
 #include "ogs-gtp.h"
 #include "core/abts.h"
 
+/* Create Session Request */
+static const char *create_session_request_payload =
+    "0100080055153011 340010f44c000600 9471527600414b00 0800536120009178"
+    "840056000d001855 f501102255f50100 019d015300030055 f501520001000657"
+    "0009008a80000084 0a32360a57000901 87000000000a3236 254700220005766f"
+    "6c7465036e673204 6d6e6574066d6e63 303130066d636335 3535046770727380"
+    "000100fc63000100 014f000500010000 00007f0001000048 000800000003e800"
+    "0007d04e001a0080 8021100100001081 0600000000830600 000000000d00000a"
+    "005d001f00490001 0005500016004505 0000000000000000 0000000000000000"
+    "0000000072000200 40005f0002005400";
+
 static void gtp_message_test1(abts_case *tc, void *data)
 {
     int rv;
-    /* Create Session Request */
-    const char *_payload =
-        "0100080055153011 340010f44c000600 9471527600414b00 0800536120009178"
-        "840056000d001855 f501102255f50100 019d015300030055 f501520001000657"
-        "0009008a80000084 0a32360a57000901 87000000000a3236 254700220005766f"
-        "6c7465036e673204 6d6e6574066d6e63 303130066d636335 3535046770727380"
-        "000100fc63000100 014f000500010000 00007f0001000048 000800000003e800"
-        "0007d04e001a0080 8021100100001081 0600000000830600 000000000d00000a"
-        "005d001f00490001 0005500016004505 0000000000000000 0000000000000000"
-        "0000000072000200 40005f0002005400";
+    const char *_payload = create_session_request_payload;
     char *_value = NULL;
     char hexbuf[OGS_HUGE_LEN];
 
@@ -313,11 +315,60 @@ static void gtp_message_test1(abts_case *tc, void *data)
     ogs_pkbuf_free(pkbuf);
 }
 
+static void gtp_message_benchmark(abts_case *tc, void *data)
+{
+#define GTP_MESSAGE_BENCHMARK_LOOP 100000
+    char hexbuf[OGS_HUGE_LEN];
+    ogs_gtp2_create_session_request_t req;
+    ogs_pkbuf_t *pkbuf = NULL, *built = NULL;
+    ogs_time_t start, parse_usec, build_usec;
+    int i, rv, len;
+
+    len = ogs_ascii_to_hex((char *)create_session_request_payload,
+            strlen(create_session_request_payload), hexbuf, sizeof(hexbuf));
+    pkbuf = ogs_pkbuf_alloc(NULL, len);
+    ogs_assert(pkbuf);
+    ogs_pkbuf_put_data(pkbuf, hexbuf, len);
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < GTP_MESSAGE_BENCHMARK_LOOP; i++) {
+        memset(&req, 0, sizeof(req));
+        rv = ogs_tlv_parse_msg(&req, &ogs_gtp2_tlv_desc_create_session_request,
+                pkbuf, OGS_TLV_MODE_T1_L2_I1);
+        ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    }
+    parse_usec = ogs_get_monotonic_time() - start;
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < GTP_MESSAGE_BENCHMARK_LOOP; i++) {
+        built = ogs_tlv_build_msg(&ogs_gtp2_tlv_desc_create_session_request,
+                &req, OGS_TLV_MODE_T1_L2_I1);
+        ABTS_PTR_NOTNULL(tc, built);
+        ogs_pkbuf_free(built);
+    }
+    build_usec = ogs_get_monotonic_time() - start;
+
+    if (parse_usec <= 0)
+        parse_usec = 1;
+    if (build_usec <= 0)
+        build_usec = 1;
+
+    ogs_debug("Create Session Request [%d bytes]: "
+            "%lld parsed/sec, %lld built/sec", len,
+            (long long)GTP_MESSAGE_BENCHMARK_LOOP *
+                OGS_USEC_PER_SEC / parse_usec,
+            (long long)GTP_MESSAGE_BENCHMARK_LOOP *
+                OGS_USEC_PER_SEC / build_usec);
+
+    ogs_pkbuf_free(pkbuf);
+}
+
 abts_suite *test_gtp_message(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
 
     abts_run_test(suite, gtp_message_test1, NULL);
+    abts_run_test(suite, gtp_message_benchmark, NULL);
 
     return suite;
 }
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "app/ogs-app.h"
+#include "ogs-pfcp.h"
+#include "core/abts.h"
+
+static ogs_pkbuf_t *build_packet(int len)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+    uint8_t *p = NULL;
+    int i;
+
+    pkbuf = ogs_pkbuf_alloc(NULL, len);
+    ogs_assert(pkbuf);
+    p = ogs_pkbuf_put(pkbuf, len);
+    for (i = 0; i < len; i++)
+        p[i] = (uint8_t)(i + len);
+
+    return pkbuf;
+}
+
+static bool packet_is_equal(ogs_pkbuf_t *pkbuf, int len)
+{
+    ogs_pkbuf_t *expected = build_packet(len);
+    bool rv = pkbuf->len == expected->len &&
+        memcmp(pkbuf->data, expected->data, len) == 0;
+
+    ogs_pkbuf_free(expected);
+    return rv;
+}
+
+static void test1_func(abts_case *tc, void *data)
+{
+    ogs_pfcp_sess_t sess;
+    ogs_pfcp_bar_t bar;
+    ogs_pfcp_far_t far;
+    const ogs_pfcp_buffer_stat_t *stat = NULL;
+    ogs_pkbuf_t *pkbuf = NULL;
+    int pool_gtpu;
+
+    memset(&sess, 0, sizeof(sess));
+    memset(&bar, 0, sizeof(bar));
+    memset(&far, 0, sizeof(far));
+
+    bar.suggested_buffering_packets_count = 3;
+    sess.bar = &bar;
+    far.sess = &sess;
+
+    /* 4 packets and 8 clusters */
+    pool_gtpu = ogs_app()->pool.gtpu;
+    ogs_app()->pool.gtpu = 4;
+    ogs_pfcp_buffer_init();
+    stat = ogs_pfcp_buffer_stat();
+
+    ABTS_TRUE(tc, ogs_pfcp_buffer_push(&far, build_packet(40)));
+    ABTS_TRUE(tc, ogs_pfcp_buffer_push(&far, build_packet(600)));
+
+    /* 6 clusters needed, 4 left */
+    ABTS_TRUE(tc, !ogs_pfcp_buffer_push(&far, build_packet(1400)));
+    ABTS_INT_EQUAL(tc, 1, stat->dropped_by_memory);
+
+    ABTS_TRUE(tc, ogs_pfcp_buffer_push(&far, build_packet(300)));
+
+    /* Suggested Buffering Packets Count */
+    ABTS_TRUE(tc, !ogs_pfcp_buffer_push(&far, build_packet(40)));
+    ABTS_INT_EQUAL(tc, 1, stat->dropped_by_quota);
+
+    ABTS_INT_EQUAL(tc, 3, far.num_of_buffered_gtpu);
+    ABTS_INT_EQUAL(tc, 3, sess.num_of_buffered_gtpu);
+    ABTS_INT_EQUAL(tc, 3, stat->buffered);
+
+    pkbuf = ogs_pfcp_buffer_pop(&far);
+    ABTS_PTR_NOTNULL(tc, pkbuf);
+    ABTS_TRUE(tc, packet_is_equal(pkbuf, 40));
+    ogs_pkbuf_free(pkbuf);
+
+    pkbuf = ogs_pfcp_buffer_pop(&far);
+    ABTS_PTR_NOTNULL(tc, pkbuf);
+    ABTS_TRUE(tc, packet_is_equal(pkbuf, 600));
+    ogs_pkbuf_free(pkbuf);
+
+    /* Freed clusters are reused by the next packet */
+    ABTS_TRUE(tc, ogs_pfcp_buffer_push(&far, build_packet(1400)));
+
+    pkbuf = ogs_pfcp_buffer_pop(&far);
+    ABTS_PTR_NOTNULL(tc, pkbuf);
+    ABTS_TRUE(tc, packet_is_equal(pkbuf, 300));
+    ogs_pkbuf_free(pkbuf);
+
+    ABTS_INT_EQUAL(tc, 3, stat->flushed);
+
+    ogs_pfcp_buffer_discard(&far);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_pfcp_buffer_pop(&far));
+    ABTS_INT_EQUAL(tc, 1, stat->discarded);
+    ABTS_INT_EQUAL(tc, 0, far.num_of_buffered_gtpu);
+    ABTS_INT_EQUAL(tc, 0, sess.num_of_buffered_gtpu);
+
+    ogs_pfcp_buffer_final();
+    ogs_app()->pool.gtpu = pool_gtpu;
+}
+
+static void test2_func(abts_case *tc, void *data)
+{
+    ogs_pfcp_sess_t sess;
+    ogs_pfcp_bar_t bar;
+    ogs_pfcp_far_t far;
+    ogs_pfcp_pdr_t pdr;
+    ogs_pfcp_user_plane_report_t report;
+    ogs_pkbuf_t *pkbuf = NULL;
+    int pool_gtpu, i;
+
+    memset(&sess, 0, sizeof(sess));
+    memset(&bar, 0, sizeof(bar));
+    memset(&far, 0, sizeof(far));
+    memset(&pdr, 0, sizeof(pdr));
+
+    bar.suggested_buffering_packets_count = 1;
+    sess.bar = &bar;
+    far.sess = &sess;
+    far.apply_action = OGS_PFCP_APPLY_ACTION_BUFF;
+    pdr.far = &far;
+
+    pool_gtpu = ogs_app()->pool.gtpu;
+    ogs_app()->pool.gtpu = 4;
+    ogs_pfcp_buffer_init();
+
+    /* Only the first packet is reported, even when the others are dropped */
+    for (i = 0; i < 3; i++) {
+        pkbuf = ogs_pkbuf_alloc(NULL, OGS_GTPV1U_5GC_HEADER_LEN + 100);
+        ogs_assert(pkbuf);
+        ogs_pkbuf_reserve(pkbuf, OGS_GTPV1U_5GC_HEADER_LEN);
+        ogs_pkbuf_put(pkbuf, 100);
+
+        ogs_pfcp_up_handle_pdr(&pdr, OGS_GTPU_MSGTYPE_GPDU, 0,
+                NULL, pkbuf, &report);
+        ABTS_INT_EQUAL(tc, i == 0, report.type.downlink_data_report);
+    }
+    ABTS_INT_EQUAL(tc, 1, far.num_of_buffered_gtpu);
+
+    /* Still reported once when nothing could be buffered */
+    ogs_pfcp_buffer_discard(&far);
+    far.downlink_data_reported = false;
+    bar.suggested_buffering_packets_count = 0;
+    sess.num_of_buffered_gtpu = OGS_MAX_NUM_OF_GTPU_BUFFER;
+    for (i = 0; i < 3; i++) {
+        pkbuf = ogs_pkbuf_alloc(NULL, OGS_GTPV1U_5GC_HEADER_LEN + 100);
+        ogs_assert(pkbuf);
+        ogs_pkbuf_reserve(pkbuf, OGS_GTPV1U_5GC_HEADER_LEN);
+        ogs_pkbuf_put(pkbuf, 100);
+
+        ogs_pfcp_up_handle_pdr(&pdr, OGS_GTPU_MSGTYPE_GPDU, 0,
+                NULL, pkbuf, &report);
+        ABTS_INT_EQUAL(tc, i == 0, report.type.downlink_data_report);
+    }
+    ABTS_INT_EQUAL(tc, 0, far.num_of_buffered_gtpu);
+
+    ogs_pfcp_buffer_final();
+    ogs_app()->pool.gtpu = pool_gtpu;
+}
+
+abts_suite *test_pfcp_buffer(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, test1_func, NULL);
+    abts_run_test(suite, test2_func, NULL);
+
+    return suite;
+}
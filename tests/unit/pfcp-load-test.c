@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-pfcp.h"
+#include "core/abts.h"
+
+static uint32_t sequence_number;
+static uint8_t metric;
+static uint8_t timer;
+
+static void load_control_information(
+        ogs_pfcp_tlv_load_control_information_t *message,
+        uint32_t seq, uint8_t load)
+{
+    memset(message, 0, sizeof(*message));
+    message->presence = 1;
+
+    sequence_number = htobe32(seq);
+    message->load_control_sequence_number.presence = 1;
+    message->load_control_sequence_number.data = &sequence_number;
+    message->load_control_sequence_number.len = sizeof(sequence_number);
+
+    metric = load;
+    message->load_metric.presence = 1;
+    message->load_metric.data = &metric;
+    message->load_metric.len = sizeof(metric);
+}
+
+static void overload_control_information(
+        ogs_pfcp_tlv_overload_control_information_t *message,
+        uint32_t seq, uint8_t reduction, uint8_t validity)
+{
+    memset(message, 0, sizeof(*message));
+    message->presence = 1;
+
+    sequence_number = htobe32(seq);
+    message->overload_control_sequence_number.presence = 1;
+    message->overload_control_sequence_number.data = &sequence_number;
+    message->overload_control_sequence_number.len = sizeof(sequence_number);
+
+    metric = reduction;
+    message->overload_reduction_metric.presence = 1;
+    message->overload_reduction_metric.data = &metric;
+    message->overload_reduction_metric.len = sizeof(metric);
+
+    timer = validity;
+    message->period_of_validity.presence = 1;
+    message->period_of_validity.data = &timer;
+    message->period_of_validity.len = sizeof(timer);
+}
+
+static void pfcp_load_test1(abts_case *tc, void *data)
+{
+    ogs_pfcp_timer_t t;
+    uint32_t sec[] = { 0, 1, 2, 61, 62, 63, 1860, 1861, 18600, 18601,
+        111600, 111601, 1116000 };
+    int i;
+
+    /* Exact values */
+    ABTS_TRUE(tc, ogs_pfcp_decode_timer(ogs_pfcp_encode_timer(0)) == 0);
+    ABTS_TRUE(tc, ogs_pfcp_decode_timer(ogs_pfcp_encode_timer(62)) ==
+            ogs_time_from_sec(62));
+    ABTS_TRUE(tc, ogs_pfcp_decode_timer(ogs_pfcp_encode_timer(1860)) ==
+            ogs_time_from_sec(1860));
+
+    /* Rounded up within a unit and into the next unit */
+    t.octet = ogs_pfcp_encode_timer(1);
+    ABTS_INT_EQUAL(tc, OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_2_SS, t.unit);
+    ABTS_INT_EQUAL(tc, 1, t.value);
+
+    t.octet = ogs_pfcp_encode_timer(63);
+    ABTS_INT_EQUAL(tc, OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_1_MM, t.unit);
+    ABTS_INT_EQUAL(tc, 2, t.value);
+
+    t.octet = ogs_pfcp_encode_timer(1861);
+    ABTS_INT_EQUAL(tc, OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_10_MM, t.unit);
+    ABTS_INT_EQUAL(tc, 4, t.value);
+
+    t.octet = ogs_pfcp_encode_timer(1116000);
+    ABTS_INT_EQUAL(tc, OGS_PFCP_TIMER_UNIT_MULTIPLES_OF_10_HH, t.unit);
+    ABTS_INT_EQUAL(tc, 31, t.value);
+
+    /* Beyond 310 hours */
+    t.octet = ogs_pfcp_encode_timer(1116001);
+    ABTS_INT_EQUAL(tc, OGS_PFCP_TIMER_UNIT_INFINITE, t.unit);
+    ABTS_TRUE(tc, ogs_pfcp_decode_timer(t.octet) == OGS_INFINITE_TIME);
+
+    /* A decoded timer never expires before the encoded one */
+    for (i = 0; i < (int)OGS_ARRAY_SIZE(sec); i++) {
+        ogs_time_t decoded = ogs_pfcp_decode_timer(
+                ogs_pfcp_encode_timer(sec[i]));
+        ABTS_TRUE(tc, decoded >= ogs_time_from_sec(sec[i]));
+    }
+
+    /* Unknown units are interpreted as multiples of 1 minute */
+    t.unit = 5;
+    t.value = 3;
+    ABTS_TRUE(tc, ogs_pfcp_decode_timer(t.octet) == ogs_time_from_sec(180));
+}
+
+static void pfcp_load_test2(abts_case *tc, void *data)
+{
+    ogs_pfcp_node_t node;
+    ogs_pfcp_tlv_load_control_information_t message;
+
+    memset(&node, 0, sizeof(node));
+
+    load_control_information(&message, 10, 30);
+    ogs_pfcp_cp_handle_load_control_information(&node, &message);
+    ABTS_INT_EQUAL(tc, 10, node.load.sequence_number);
+    ABTS_INT_EQUAL(tc, 30, node.load.metric);
+
+    /* Same and older sequence numbers are ignored */
+    load_control_information(&message, 10, 50);
+    ogs_pfcp_cp_handle_load_control_information(&node, &message);
+    ABTS_INT_EQUAL(tc, 30, node.load.metric);
+
+    load_control_information(&message, 9, 50);
+    ogs_pfcp_cp_handle_load_control_information(&node, &message);
+    ABTS_INT_EQUAL(tc, 10, node.load.sequence_number);
+    ABTS_INT_EQUAL(tc, 30, node.load.metric);
+
+    /* The metric is capped at 100 */
+    load_control_information(&message, 11, 150);
+    ogs_pfcp_cp_handle_load_control_information(&node, &message);
+    ABTS_INT_EQUAL(tc, 11, node.load.sequence_number);
+    ABTS_INT_EQUAL(tc, 100, node.load.metric);
+
+    /* Wrap-around : a small number follows a large one */
+    node.load.sequence_number = 0xfffffff0;
+    load_control_information(&message, 5, 20);
+    ogs_pfcp_cp_handle_load_control_information(&node, &message);
+    ABTS_INT_EQUAL(tc, 5, node.load.sequence_number);
+    ABTS_INT_EQUAL(tc, 20, node.load.metric);
+
+    load_control_information(&message, 0xfffffff8, 40);
+    ogs_pfcp_cp_handle_load_control_information(&node, &message);
+    ABTS_INT_EQUAL(tc, 5, node.load.sequence_number);
+    ABTS_INT_EQUAL(tc, 20, node.load.metric);
+
+    /* A missing sequence number is rejected */
+    load_control_information(&message, 6, 60);
+    message.load_control_sequence_number.presence = 0;
+    ogs_pfcp_cp_handle_load_control_information(&node, &message);
+    ABTS_INT_EQUAL(tc, 20, node.load.metric);
+}
+
+static void pfcp_load_test3(abts_case *tc, void *data)
+{
+    ogs_pfcp_node_t node;
+    ogs_pfcp_tlv_overload_control_information_t message;
+    ogs_time_t now;
+
+    memset(&node, 0, sizeof(node));
+
+    ABTS_INT_EQUAL(tc, 100, ogs_pfcp_node_weight(&node));
+
+    node.load.metric = 50;
+    ABTS_INT_EQUAL(tc, 50, ogs_pfcp_node_weight(&node));
+
+    /* A valid overload reduction cuts the spare capacity */
+    now = ogs_get_monotonic_time();
+    overload_control_information(
+            &message, 1, 40, ogs_pfcp_encode_timer(10));
+    ogs_pfcp_cp_handle_overload_control_information(&node, &message);
+    ABTS_INT_EQUAL(tc, 1, node.overload.sequence_number);
+    ABTS_INT_EQUAL(tc, 40, node.overload.reduction_metric);
+    ABTS_TRUE(tc, node.overload.expires >= now + ogs_time_from_sec(10));
+    ABTS_INT_EQUAL(tc, 30, ogs_pfcp_node_weight(&node));
+
+    /* Stale overload information is ignored */
+    overload_control_information(
+            &message, 1, 90, ogs_pfcp_encode_timer(10));
+    ogs_pfcp_cp_handle_overload_control_information(&node, &message);
+    ABTS_INT_EQUAL(tc, 40, node.overload.reduction_metric);
+
+    /* An expired reduction no longer applies */
+    node.overload.expires = now - 1;
+    ABTS_INT_EQUAL(tc, 50, ogs_pfcp_node_weight(&node));
+
+    /* An infinite period of validity lasts until superseded */
+    overload_control_information(
+            &message, 2, 40, ogs_pfcp_encode_timer(UINT32_MAX));
+    ogs_pfcp_cp_handle_overload_control_information(&node, &message);
+    ABTS_INT_EQUAL(tc, 2, node.overload.sequence_number);
+    ABTS_TRUE(tc, node.overload.expires == 0);
+    ABTS_INT_EQUAL(tc, 30, ogs_pfcp_node_weight(&node));
+
+    /* A saturated node keeps a minimal weight */
+    node.load.metric = 100;
+    ABTS_INT_EQUAL(tc, 1, ogs_pfcp_node_weight(&node));
+}
+
+abts_suite *test_pfcp_load(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, pfcp_load_test1, NULL);
+    abts_run_test(suite, pfcp_load_test2, NULL);
+    abts_run_test(suite, pfcp_load_test3, NULL);
+
+    return suite;
+}
@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2019-2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-pfcp.h"
+#include "core/abts.h"
+
+#define NUM_OF_PDR 4
+
+/* IPv4 Node ID 10.0.0.1 */
+static uint8_t node_id[] = { 0x00, 0x0a, 0x00, 0x00, 0x01 };
+/* SEID 1, IPv4 10.0.0.1 */
+static uint8_t cp_f_seid[] = {
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x0a, 0x00, 0x00, 0x01 };
+/* CHOOSE, IPv4 */
+static uint8_t local_f_teid[] = { 0x05 };
+/* Source IPv4 10.45.0.2 */
+static uint8_t ue_ip_address[] = { 0x02, 0x0a, 0x2d, 0x00, 0x02 };
+/* GTP-U/UDP/IPv4 */
+static uint8_t outer_header_removal[] = { 0x00 };
+/* GTP-U/UDP/IPv4, TEID 1, 10.0.0.2 */
+static uint8_t outer_header_creation[] = {
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x01, 0x0a, 0x00, 0x00, 0x02 };
+/* UL/DL 1000/2000 Kbps */
+static uint8_t maximum_bitrate[] = {
+    0x00, 0x00, 0x00, 0x03, 0xe8, 0x00, 0x00, 0x00, 0x07, 0xd0 };
+static uint8_t dnn[] = { 0x08, 'i', 'n', 't', 'e', 'r', 'n', 'e', 't' };
+
+#define SET_OCTET(__iE, __dATA) \
+    do { \
+        (__iE).presence = 1; \
+        (__iE).data = (__dATA); \
+        (__iE).len = sizeof(__dATA); \
+    } while(0)
+
+static void build_session_establishment_request(
+        ogs_pfcp_session_establishment_request_t *req)
+{
+    int i;
+
+    memset(req, 0, sizeof(*req));
+
+    SET_OCTET(req->node_id, node_id);
+    SET_OCTET(req->cp_f_seid, cp_f_seid);
+
+    for (i = 0; i < NUM_OF_PDR; i++) {
+        ogs_pfcp_tlv_create_pdr_t *pdr = &req->create_pdr[i];
+        ogs_pfcp_tlv_create_far_t *far = &req->create_far[i];
+
+        pdr->presence = 1;
+        pdr->pdr_id.presence = 1;
+        pdr->pdr_id.u16 = i + 1;
+        pdr->precedence.presence = 1;
+        pdr->precedence.u32 = 0xfff0 + i;
+        pdr->pdi.presence = 1;
+        pdr->pdi.source_interface.presence = 1;
+        pdr->pdi.source_interface.u8 = (i % 2) ?
+            OGS_PFCP_INTERFACE_CORE : OGS_PFCP_INTERFACE_ACCESS;
+        SET_OCTET(pdr->pdi.network_instance, dnn);
+        SET_OCTET(pdr->pdi.local_f_teid, local_f_teid);
+        SET_OCTET(pdr->pdi.ue_ip_address, ue_ip_address);
+        pdr->pdi.qfi.presence = 1;
+        pdr->pdi.qfi.u8 = 9;
+        SET_OCTET(pdr->outer_header_removal, outer_header_removal);
+        pdr->far_id.presence = 1;
+        pdr->far_id.u32 = i + 1;
+        pdr->urr_id[0].presence = 1;
+        pdr->urr_id[0].u32 = 1;
+        pdr->qer_id.presence = 1;
+        pdr->qer_id.u32 = 1;
+
+        far->presence = 1;
+        far->far_id.presence = 1;
+        far->far_id.u32 = i + 1;
+        far->apply_action.presence = 1;
+        far->apply_action.u16 = OGS_PFCP_APPLY_ACTION_FORW;
+        far->forwarding_parameters.presence = 1;
+        far->forwarding_parameters.destination_interface.presence = 1;
+        far->forwarding_parameters.destination_interface.u8 = (i % 2) ?
+            OGS_PFCP_INTERFACE_ACCESS : OGS_PFCP_INTERFACE_CORE;
+        SET_OCTET(far->forwarding_parameters.outer_header_creation,
+                outer_header_creation);
+    }
+
+    req->create_urr[0].presence = 1;
+    req->create_urr[0].urr_id.presence = 1;
+    req->create_urr[0].urr_id.u32 = 1;
+    req->create_urr[0].measurement_method.presence = 1;
+    req->create_urr[0].measurement_method.u8 = 2;
+    req->create_urr[0].reporting_triggers.presence = 1;
+    req->create_urr[0].reporting_triggers.u24 = 0x010203;
+
+    req->create_qer[0].presence = 1;
+    req->create_qer[0].qer_id.presence = 1;
+    req->create_qer[0].qer_id.u32 = 1;
+    req->create_qer[0].gate_status.presence = 1;
+    SET_OCTET(req->create_qer[0].maximum_bitrate, maximum_bitrate);
+
+    req->pdn_type.presence = 1;
+    req->pdn_type.u8 = OGS_PDU_SESSION_TYPE_IPV4;
+    SET_OCTET(req->apn_dnn, dnn);
+}
+
+static void pfcp_message_test1(abts_case *tc, void *data)
+{
+    ogs_pfcp_session_establishment_request_t *req = NULL, *req2 = NULL;
+    ogs_pkbuf_t *pkbuf = NULL, *pkbuf2 = NULL;
+    int i, rv;
+
+    req = ogs_calloc(1, sizeof(*req));
+    ogs_assert(req);
+    req2 = ogs_calloc(1, sizeof(*req2));
+    ogs_assert(req2);
+
+    build_session_establishment_request(req);
+
+    pkbuf = ogs_tlv_build_msg(
+            &ogs_pfcp_msg_desc_pfcp_session_establishment_request,
+            req, OGS_TLV_MODE_T2_L2);
+    ABTS_PTR_NOTNULL(tc, pkbuf);
+
+    /* Building must leave the message untouched */
+    ABTS_INT_EQUAL(tc, 1, req->create_pdr[0].pdr_id.u16);
+    ABTS_INT_EQUAL(tc, 0xfff0, req->create_pdr[0].precedence.u32);
+    ABTS_INT_EQUAL(tc, 0x010203, req->create_urr[0].reporting_triggers.u24);
+
+    rv = ogs_tlv_parse_msg(req2,
+            &ogs_pfcp_msg_desc_pfcp_session_establishment_request,
+            pkbuf, OGS_TLV_MODE_T2_L2);
+    ABTS_INT_EQUAL(tc, OGS_OK, rv);
+
+    ABTS_INT_EQUAL(tc, 1, req2->node_id.presence);
+    ABTS_INT_EQUAL(tc, sizeof(node_id), req2->node_id.len);
+    ABTS_TRUE(tc, memcmp(node_id, req2->node_id.data, sizeof(node_id)) == 0);
+
+    for (i = 0; i < NUM_OF_PDR; i++) {
+        ogs_pfcp_tlv_create_pdr_t *pdr = &req2->create_pdr[i];
+        ogs_pfcp_tlv_create_far_t *far = &req2->create_far[i];
+
+        ABTS_INT_EQUAL(tc, 1, pdr->presence);
+        ABTS_INT_EQUAL(tc, i + 1, pdr->pdr_id.u16);
+        ABTS_INT_EQUAL(tc, 0xfff0 + i, pdr->precedence.u32);
+        ABTS_INT_EQUAL(tc, 1, pdr->pdi.presence);
+        ABTS_INT_EQUAL(tc, i % 2, pdr->pdi.source_interface.u8);
+        ABTS_INT_EQUAL(tc, sizeof(dnn), pdr->pdi.network_instance.len);
+        ABTS_INT_EQUAL(tc, 9, pdr->pdi.qfi.u8);
+        ABTS_INT_EQUAL(tc, i + 1, pdr->far_id.u32);
+        ABTS_INT_EQUAL(tc, 1, pdr->urr_id[0].presence);
+        ABTS_INT_EQUAL(tc, 0, pdr->urr_id[1].presence);
+
+        ABTS_INT_EQUAL(tc, 1, far->presence);
+        ABTS_INT_EQUAL(tc, OGS_PFCP_APPLY_ACTION_FORW, far->apply_action.u16);
+        ABTS_INT_EQUAL(tc, sizeof(outer_header_creation),
+                far->forwarding_parameters.outer_header_creation.len);
+    }
+    ABTS_INT_EQUAL(tc, 0, req2->create_pdr[NUM_OF_PDR].presence);
+    ABTS_INT_EQUAL(tc, 0, req2->create_far[NUM_OF_PDR].presence);
+
+    ABTS_INT_EQUAL(tc, 0x010203, req2->create_urr[0].reporting_triggers.u24);
+    ABTS_INT_EQUAL(tc, sizeof(maximum_bitrate),
+            req2->create_qer[0].maximum_bitrate.len);
+    ABTS_INT_EQUAL(tc, OGS_PDU_SESSION_TYPE_IPV4, req2->pdn_type.u8);
+    ABTS_INT_EQUAL(tc, 0, req2->user_id.presence);
+
+    /* And encode back to the same octets */
+    pkbuf2 = ogs_tlv_build_msg(
+            &ogs_pfcp_msg_desc_pfcp_session_establishment_request,
+            req2, OGS_TLV_MODE_T2_L2);
+    ABTS_PTR_NOTNULL(tc, pkbuf2);
+    ABTS_INT_EQUAL(tc, pkbuf->len, pkbuf2->len);
+    ABTS_TRUE(tc, memcmp(pkbuf->data, pkbuf2->data, pkbuf->len) == 0);
+
+    /* Truncated message */
+    ogs_pkbuf_trim(pkbuf2, pkbuf2->len - 1);
+    memset(req2, 0, sizeof(*req2));
+    rv = ogs_tlv_parse_msg(req2,
+            &ogs_pfcp_msg_desc_pfcp_session_establishment_request,
+            pkbuf2, OGS_TLV_MODE_T2_L2);
+    ABTS_INT_EQUAL(tc, OGS_ERROR, rv);
+
+    ogs_pkbuf_free(pkbuf2);
+    ogs_pkbuf_free(pkbuf);
+
+    ogs_free(req2);
+    ogs_free(req);
+}
+
+static void pfcp_message_benchmark(abts_case *tc, void *data)
+{
+#define PFCP_MESSAGE_BENCHMARK_LOOP 100000
+    ogs_pfcp_session_establishment_request_t *req = NULL;
+    ogs_pkbuf_t *pkbuf = NULL, *built = NULL;
+    ogs_time_t start, parse_usec, build_usec;
+    int i, rv;
+
+    req = ogs_calloc(1, sizeof(*req));
+    ogs_assert(req);
+
+    build_session_establishment_request(req);
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < PFCP_MESSAGE_BENCHMARK_LOOP; i++) {
+        built = ogs_tlv_build_msg(
+                &ogs_pfcp_msg_desc_pfcp_session_establishment_request,
+                req, OGS_TLV_MODE_T2_L2);
+        ABTS_PTR_NOTNULL(tc, built);
+        if (pkbuf)
+            ogs_pkbuf_free(built);
+        else
+            pkbuf = built;
+    }
+    build_usec = ogs_get_monotonic_time() - start;
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < PFCP_MESSAGE_BENCHMARK_LOOP; i++) {
+        memset(req, 0, sizeof(*req));
+        rv = ogs_tlv_parse_msg(req,
+                &ogs_pfcp_msg_desc_pfcp_session_establishment_request,
+                pkbuf, OGS_TLV_MODE_T2_L2);
+        ABTS_INT_EQUAL(tc, OGS_OK, rv);
+    }
+    parse_usec = ogs_get_monotonic_time() - start;
+
+    if (build_usec <= 0)
+        build_usec = 1;
+    if (parse_usec <= 0)
+        parse_usec = 1;
+
+    ogs_debug("Session Establishment Request [%d bytes]: "
+            "%lld built/sec, %lld parsed/sec", pkbuf->len,
+            (long long)PFCP_MESSAGE_BENCHMARK_LOOP *
+                OGS_USEC_PER_SEC / build_usec,
+            (long long)PFCP_MESSAGE_BENCHMARK_LOOP *
+                OGS_USEC_PER_SEC / parse_usec);
+
+    ogs_pkbuf_free(pkbuf);
+    ogs_free(req);
+}
+
+abts_suite *test_pfcp_message(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, pfcp_message_test1, NULL);
+    abts_run_test(suite, pfcp_message_benchmark, NULL);
+
+    return suite;
+}
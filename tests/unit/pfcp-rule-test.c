@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2019 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-pfcp.h"
+#include "core/abts.h"
+
+#define NUM_OF_PDR 8
+
+static const char *flow_description[NUM_OF_PDR] = {
+    "permit out udp from 10.45.0.0/16 5060 to any 5060-5070",
+    "permit out tcp from 10.45.0.0/16 to any 80",
+    "permit out udp from 10.45.1.1 to any 10000-20000",
+    "permit out ip from 10.45.2.0/24 to any",
+    "permit out udp from any 53 to any",
+    "permit out tcp from 8.8.8.8 443 to any",
+    "permit out 58 from 2001:db8::/32 to any",
+    NULL, /* Match-all PDR */
+};
+
+static ogs_pkbuf_t *build_ipv4(uint8_t proto,
+        const char *src, const char *dst, uint16_t sport, uint16_t dport)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+    uint8_t *p = NULL;
+    uint16_t port;
+
+    pkbuf = ogs_pkbuf_alloc(NULL, 40);
+    ogs_assert(pkbuf);
+    p = ogs_pkbuf_put(pkbuf, 40);
+    memset(p, 0, 40);
+
+    p[0] = 0x45;
+    p[9] = proto;
+    ogs_assert(inet_pton(AF_INET, src, p + 12) == 1);
+    ogs_assert(inet_pton(AF_INET, dst, p + 16) == 1);
+
+    port = htobe16(sport);
+    memcpy(p + 20, &port, 2);
+    port = htobe16(dport);
+    memcpy(p + 22, &port, 2);
+
+    return pkbuf;
+}
+
+static ogs_pkbuf_t *build_ipv6(uint8_t proto, const char *src, const char *dst)
+{
+    ogs_pkbuf_t *pkbuf = NULL;
+    uint8_t *p = NULL;
+
+    pkbuf = ogs_pkbuf_alloc(NULL, 48);
+    ogs_assert(pkbuf);
+    p = ogs_pkbuf_put(pkbuf, 48);
+    memset(p, 0, 48);
+
+    p[0] = 0x60;
+    p[5] = 8;   /* Payload Length */
+    p[6] = proto;
+    ogs_assert(inet_pton(AF_INET6, src, p + 8) == 1);
+    ogs_assert(inet_pton(AF_INET6, dst, p + 24) == 1);
+
+    return pkbuf;
+}
+
+static bool odd_pdr_filter(ogs_pfcp_pdr_t *pdr, void *data)
+{
+    return (pdr->id % 2) == 1;
+}
+
+static void test1_func(abts_case *tc, void *data)
+{
+    ogs_pfcp_sess_t sess;
+    ogs_pfcp_pdr_t pdr[NUM_OF_PDR];
+    ogs_pfcp_rule_t rule[NUM_OF_PDR];
+    ogs_pkbuf_t *pkbuf[8];
+    ogs_pfcp_pdr_t *expected[8];
+    int i, j, rv;
+
+    memset(&sess, 0, sizeof(sess));
+    memset(pdr, 0, sizeof(pdr));
+    memset(rule, 0, sizeof(rule));
+
+    for (i = 0; i < NUM_OF_PDR; i++) {
+        pdr[i].id = i + 1;
+        pdr[i].precedence = (i + 1) * 10;
+        pdr[i].sess = &sess;
+        ogs_list_add(&sess.pdr_list, &pdr[i]);
+
+        if (flow_description[i]) {
+            char *fd = ogs_strdup(flow_description[i]);
+            ogs_assert(fd);
+            rv = ogs_ipfw_compile_rule(&rule[i].ipfw, fd);
+            ABTS_INT_EQUAL(tc, OGS_OK, rv);
+            ogs_free(fd);
+
+            rule[i].pdr = &pdr[i];
+            ogs_list_add(&pdr[i].rule_list, &rule[i]);
+        }
+    }
+
+    pkbuf[0] = build_ipv4(IPPROTO_UDP, "10.45.0.3", "1.2.3.4", 5060, 5065);
+    expected[0] = &pdr[0];
+    pkbuf[1] = build_ipv4(IPPROTO_UDP, "10.45.0.3", "1.2.3.4", 5060, 5071);
+    expected[1] = &pdr[7];
+    pkbuf[2] = build_ipv4(IPPROTO_TCP, "10.45.9.9", "1.2.3.4", 1234, 80);
+    expected[2] = &pdr[1];
+    pkbuf[3] = build_ipv4(IPPROTO_UDP, "10.45.1.1", "1.2.3.4", 1, 15000);
+    expected[3] = &pdr[2];
+    pkbuf[4] = build_ipv4(IPPROTO_ICMP, "10.45.2.7", "1.2.3.4", 0, 0);
+    expected[4] = &pdr[3];
+    pkbuf[5] = build_ipv4(IPPROTO_UDP, "10.45.2.7", "1.2.3.4", 53, 9);
+    expected[5] = &pdr[3];
+    pkbuf[6] = build_ipv4(IPPROTO_TCP, "8.8.8.8", "10.45.0.3", 443, 5555);
+    expected[6] = &pdr[5];
+    pkbuf[7] = build_ipv6(58, "2001:db8::1", "2001:db8::2");
+    expected[7] = &pdr[6];
+
+    /* Linear walk */
+    for (i = 0; i < 8; i++)
+        ABTS_PTR_EQUAL(tc, expected[i],
+                ogs_pfcp_classifier_find(&sess, pkbuf[i], NULL, NULL));
+
+    ogs_pfcp_classifier_compile(&sess);
+    ABTS_PTR_NOTNULL(tc, sess.classifier);
+
+    for (i = 0; i < 8; i++)
+        ABTS_PTR_EQUAL(tc, expected[i],
+                ogs_pfcp_classifier_find(&sess, pkbuf[i], NULL, NULL));
+
+    /* The filter must give the same result as the linear walk */
+    for (i = 0; i < 8; i++) {
+        ogs_pfcp_pdr_t *compiled = ogs_pfcp_classifier_find(
+                &sess, pkbuf[i], odd_pdr_filter, NULL);
+        ogs_pfcp_pdr_t *linear = NULL;
+
+        for (j = 0; j < NUM_OF_PDR; j++) {
+            if (!odd_pdr_filter(&pdr[j], NULL))
+                continue;
+            if (ogs_list_first(&pdr[j].rule_list) &&
+                ogs_pfcp_pdr_rule_find_by_packet(&pdr[j], pkbuf[i]) == NULL)
+                continue;
+            linear = &pdr[j];
+            break;
+        }
+        ABTS_PTR_EQUAL(tc, linear, compiled);
+    }
+
+    ogs_pfcp_classifier_clear(&sess);
+    ABTS_PTR_EQUAL(tc, NULL, sess.classifier);
+
+    for (i = 0; i < 8; i++)
+        ogs_pkbuf_free(pkbuf[i]);
+}
+
+abts_suite *test_pfcp_rule(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, test1_func, NULL);
+
+    return suite;
+}
@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2025 by Sukchan Lee <acetcom@gmail.com>
+ *
+ * This file is part of Open5GS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ogs-sbi.h"
+#include "core/abts.h"
+
+static OpenAPI_nf_profile_t nf_profile[3];
+static OpenAPI_search_result_t search_result;
+
+/* SearchResult with the first `num` UDM profiles */
+static OpenAPI_search_result_t *search_result_build(int num)
+{
+    static char *id[] = {
+        (char *)"nf-instance-1",
+        (char *)"nf-instance-2",
+        (char *)"nf-instance-3",
+    };
+    int i;
+
+    memset(&search_result, 0, sizeof(search_result));
+    search_result.nf_instances = OpenAPI_list_create();
+    ogs_assert(search_result.nf_instances);
+
+    for (i = 0; i < num; i++) {
+        memset(&nf_profile[i], 0, sizeof(nf_profile[i]));
+        nf_profile[i].nf_instance_id = id[i];
+        nf_profile[i].nf_type = OpenAPI_nf_type_UDM;
+        OpenAPI_list_add(search_result.nf_instances, &nf_profile[i]);
+    }
+
+    return &search_result;
+}
+
+static void search_result_free(OpenAPI_search_result_t *SearchResult)
+{
+    OpenAPI_list_free(SearchResult->nf_instances);
+}
+
+static void sbi_discovery_test1(abts_case *tc, void *data)
+{
+    ogs_sbi_discovery_option_t *option1 = NULL, *option2 = NULL;
+    ogs_s_nssai_t s_nssai1, s_nssai2;
+    char *key1 = NULL, *key2 = NULL;
+
+    memset(&s_nssai1, 0, sizeof(s_nssai1));
+    s_nssai1.sst = 1;
+    s_nssai1.sd.v = OGS_S_NSSAI_NO_SD_VALUE;
+    memset(&s_nssai2, 0, sizeof(s_nssai2));
+    s_nssai2.sst = 2;
+    s_nssai2.sd.v = 0x000080;
+
+    option1 = ogs_sbi_discovery_option_new();
+    ABTS_PTR_NOTNULL(tc, option1);
+    ogs_sbi_discovery_option_add_service_names(option1,
+            (char *)OGS_SBI_SERVICE_NAME_NUDM_UECM);
+    ogs_sbi_discovery_option_add_service_names(option1,
+            (char *)OGS_SBI_SERVICE_NAME_NUDM_SDM);
+    ogs_sbi_discovery_option_add_snssais(option1, &s_nssai1);
+    ogs_sbi_discovery_option_add_snssais(option1, &s_nssai2);
+
+    option2 = ogs_sbi_discovery_option_new();
+    ABTS_PTR_NOTNULL(tc, option2);
+    ogs_sbi_discovery_option_add_service_names(option2,
+            (char *)OGS_SBI_SERVICE_NAME_NUDM_SDM);
+    ogs_sbi_discovery_option_add_service_names(option2,
+            (char *)OGS_SBI_SERVICE_NAME_NUDM_UECM);
+    ogs_sbi_discovery_option_add_snssais(option2, &s_nssai2);
+    ogs_sbi_discovery_option_add_snssais(option2, &s_nssai1);
+
+    /* The order in which options were added does not matter */
+    key1 = ogs_sbi_discovery_cache_key(
+            OpenAPI_nf_type_UDM, OpenAPI_nf_type_AMF, option1);
+    key2 = ogs_sbi_discovery_cache_key(
+            OpenAPI_nf_type_UDM, OpenAPI_nf_type_AMF, option2);
+    ABTS_STR_EQUAL(tc, key1, key2);
+    ogs_free(key2);
+
+    ogs_sbi_discovery_option_set_dnn(option2, (char *)"internet");
+    key2 = ogs_sbi_discovery_cache_key(
+            OpenAPI_nf_type_UDM, OpenAPI_nf_type_AMF, option2);
+    ABTS_TRUE(tc, strcmp(key1, key2) != 0);
+    ogs_free(key2);
+
+    key2 = ogs_sbi_discovery_cache_key(
+            OpenAPI_nf_type_UDM, OpenAPI_nf_type_SMF, option1);
+    ABTS_TRUE(tc, strcmp(key1, key2) != 0);
+    ogs_free(key2);
+
+    ogs_free(key1);
+
+    ogs_sbi_discovery_option_free(option1);
+    ogs_sbi_discovery_option_free(option2);
+}
+
+static void sbi_discovery_test2(abts_case *tc, void *data)
+{
+    ogs_sbi_discovery_cache_t *cache = NULL;
+    OpenAPI_search_result_t *SearchResult = NULL;
+    int validity_duration, negative_duration;
+
+    validity_duration = ogs_local_conf()->time.discovery.validity_duration;
+    negative_duration = ogs_local_conf()->time.discovery.negative_duration;
+    ogs_local_conf()->time.discovery.validity_duration = 30;
+    ogs_local_conf()->time.discovery.negative_duration = 5;
+
+    ogs_sbi_discovery_cache_init(4);
+
+    ABTS_PTR_EQUAL(tc, NULL, ogs_sbi_discovery_cache_find(
+                OpenAPI_nf_type_UDM, OpenAPI_nf_type_AMF, NULL));
+
+    /* Lookup */
+    SearchResult = search_result_build(2);
+    nf_profile[1].nf_type = OpenAPI_nf_type_AUSF;
+    cache = ogs_sbi_discovery_cache_update(
+            OpenAPI_nf_type_UDM, OpenAPI_nf_type_AMF, NULL, SearchResult);
+    search_result_free(SearchResult);
+    ABTS_PTR_NOTNULL(tc, cache);
+
+    ABTS_PTR_EQUAL(tc, cache, ogs_sbi_discovery_cache_find(
+                OpenAPI_nf_type_UDM, OpenAPI_nf_type_AMF, NULL));
+    ABTS_PTR_EQUAL(tc, NULL, ogs_sbi_discovery_cache_find(
+                OpenAPI_nf_type_UDM, OpenAPI_nf_type_SMF, NULL));
+
+    /* Only profiles of the target NF type are kept */
+    ABTS_INT_EQUAL(tc, 1, cache->num_of_nf_instance_id);
+    ABTS_STR_EQUAL(tc, "nf-instance-1", cache->nf_instance_id[0]);
+
+    /* Expiry */
+    cache->expires = ogs_get_monotonic_time();
+    ABTS_PTR_EQUAL(tc, NULL, ogs_sbi_discovery_cache_find(
+                OpenAPI_nf_type_UDM, OpenAPI_nf_type_AMF, NULL));
+
+    /* validityPeriod overrides time.discovery.validity */
+    SearchResult = search_result_build(1);
+    SearchResult->is_validity_period = true;
+    SearchResult->validity_period = 3600;
+    cache = ogs_sbi_discovery_cache_update(
+            OpenAPI_nf_type_UDM, OpenAPI_nf_type_AMF, NULL, SearchResult);
+    search_result_free(SearchResult);
+    ABTS_PTR_NOTNULL(tc, cache);
+    ABTS_TRUE(tc, cache->expires >
+            ogs_get_monotonic_time() + ogs_time_from_sec(30));
+
+    /* Negative entry */
+    SearchResult = search_result_build(0);
+    cache = ogs_sbi_discovery_cache_update(
+            OpenAPI_nf_type_PCF, OpenAPI_nf_type_AMF, NULL, SearchResult);
+    search_result_free(SearchResult);
+    ABTS_PTR_NOTNULL(tc, cache);
+    ABTS_INT_EQUAL(tc, 0, cache->num_of_nf_instance_id);
+    ABTS_TRUE(tc, cache->expires <=
+            ogs_get_monotonic_time() + ogs_time_from_sec(5));
+
+    ogs_sbi_discovery_cache_remove_negative(OpenAPI_nf_type_PCF);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_sbi_discovery_cache_find(
+                OpenAPI_nf_type_PCF, OpenAPI_nf_type_AMF, NULL));
+
+    /* Negative caching disabled */
+    ogs_local_conf()->time.discovery.negative_duration = 0;
+    SearchResult = search_result_build(0);
+    ABTS_PTR_EQUAL(tc, NULL, ogs_sbi_discovery_cache_update(
+            OpenAPI_nf_type_PCF, OpenAPI_nf_type_AMF, NULL, SearchResult));
+    search_result_free(SearchResult);
+
+    /* Removing an NF instance drops the entries referencing it */
+    ogs_sbi_discovery_cache_remove_by_nf_instance_id(
+            (char *)"nf-instance-1");
+    ABTS_PTR_EQUAL(tc, NULL, ogs_sbi_discovery_cache_find(
+                OpenAPI_nf_type_UDM, OpenAPI_nf_type_AMF, NULL));
+
+    ogs_sbi_discovery_cache_final();
+
+    ogs_local_conf()->time.discovery.validity_duration = validity_duration;
+    ogs_local_conf()->time.discovery.negative_duration = negative_duration;
+}
+
+static void sbi_discovery_test3(abts_case *tc, void *data)
+{
+    ogs_sbi_discovery_cache_t *cache = NULL;
+    OpenAPI_search_result_t *SearchResult = NULL;
+    int validity_duration;
+
+    validity_duration = ogs_local_conf()->time.discovery.validity_duration;
+    ogs_local_conf()->time.discovery.validity_duration = 30;
+
+    ogs_sbi_discovery_cache_init(2);
+
+    SearchResult = search_result_build(1);
+
+    ABTS_PTR_NOTNULL(tc, ogs_sbi_discovery_cache_update(
+            OpenAPI_nf_type_UDM, OpenAPI_nf_type_AMF, NULL, SearchResult));
+    ABTS_PTR_NOTNULL(tc, ogs_sbi_discovery_cache_update(
+            OpenAPI_nf_type_UDM, OpenAPI_nf_type_SMF, NULL, SearchResult));
+
+    /* An update moves the entry to the tail of the eviction order */
+    ABTS_PTR_NOTNULL(tc, ogs_sbi_discovery_cache_update(
+            OpenAPI_nf_type_UDM, OpenAPI_nf_type_AMF, NULL, SearchResult));
+
+    /* The pool is full, the oldest entry is evicted */
+    cache = ogs_sbi_discovery_cache_update(
+            OpenAPI_nf_type_UDM, OpenAPI_nf_type_AUSF, NULL, SearchResult);
+    ABTS_PTR_NOTNULL(tc, cache);
+
+    ABTS_PTR_EQUAL(tc, NULL, ogs_sbi_discovery_cache_find(
+                OpenAPI_nf_type_UDM, OpenAPI_nf_type_SMF, NULL));
+    ABTS_PTR_NOTNULL(tc, ogs_sbi_discovery_cache_find(
+                OpenAPI_nf_type_UDM, OpenAPI_nf_type_AMF, NULL));
+    ABTS_PTR_EQUAL(tc, cache, ogs_sbi_discovery_cache_find(
+                OpenAPI_nf_type_UDM, OpenAPI_nf_type_AUSF, NULL));
+
+    search_result_free(SearchResult);
+
+    ogs_sbi_discovery_cache_final();
+
+    ogs_local_conf()->time.discovery.validity_duration = validity_duration;
+}
+
+abts_suite *test_sbi_discovery(abts_suite *suite)
+{
+    suite = ADD_SUITE(suite)
+
+    abts_run_test(suite, sbi_discovery_test1, NULL);
+    abts_run_test(suite, sbi_discovery_test2, NULL);
+    abts_run_test(suite, sbi_discovery_test3, NULL);
+
+    return suite;
+}
@@ -186,20 +186,11 @@ static void security_test5(abts_case *tc, void *data)
     uint8_t tmp[SECURITY_TEST5_LEN];
     ogs_pkbuf_t *pkbuf = NULL;
 
-#if 0 /* Issue #2581 : snow_3g_f8 have memory problem */
     snow_3g_f8(
         ogs_hex_from_string(_ck, ck, sizeof(ck)),
         0x72a4f20f, 0x0c, 1,
         ogs_hex_from_string(_plain, plain, sizeof(plain)),
         SECURITY_TEST5_BIT_LEN);
-#else
-    SNOW_CTX ctx;
-
-    ogs_hex_from_string(_plain, plain, sizeof(plain));
-    SNOW_init(0x72a4f20f, 0x0c, 1,
-        ogs_hex_from_string(_ck, ck, sizeof(ck)), &ctx);
-    SNOW(SECURITY_TEST5_LEN, plain, plain, &ctx);
-#endif
     ABTS_TRUE(tc, memcmp(plain, 
         ogs_hex_from_string(_cipher, tmp, sizeof(tmp)),
         SECURITY_TEST5_LEN) == 0);
@@ -407,6 +398,307 @@ static void security_test9(abts_case *tc, void *data)
     ogs_pkbuf_free(pkbuf);
 }
 
+static void security_test10(abts_case *tc, void *data)
+{
+    /* SNOW 3G Test Set 1 and 2, ZUC Test Set 1, 2 and 3 */
+    uint32_t snow_k[2][4] = {
+        { 0x2bd6459f, 0x82c5b300, 0x952c4910, 0x4881ff48 },
+        { 0x8ce33e2c, 0xc3c0b5fc, 0x1f3de8a6, 0xdc66b1f3 },
+    };
+    uint32_t snow_iv[2][4] = {
+        { 0xea024714, 0xad5c4d84, 0xdf1f9b25, 0x1c0bf45f },
+        { 0xd3c5d592, 0x327fb11c, 0xde551988, 0xceb2f9b7 },
+    };
+    uint32_t snow_z[2][2] = {
+        { 0xabee9704, 0x7ac31373 },
+        { 0xeff8a342, 0xf751480f },
+    };
+    const char *_zuc_k[3] = {
+        "00000000 00000000 00000000 00000000",
+        "ffffffff ffffffff ffffffff ffffffff",
+        "3d4c4be9 6a82fdae b58f641d b17b455b",
+    };
+    const char *_zuc_iv[3] = {
+        "00000000 00000000 00000000 00000000",
+        "ffffffff ffffffff ffffffff ffffffff",
+        "84319aa8 de6915ca 1f6bda6b fbd8c766",
+    };
+    uint32_t zuc_z[3][2] = {
+        { 0x27bede74, 0x018082da },
+        { 0x0657cfa0, 0x7096398b },
+        { 0x14f1c272, 0x3279c419 },
+    };
+    snow_3g_ctx_t snow_ctx[2];
+    zuc_ctx_t zuc_ctx[3];
+    uint8_t k[16], iv[16];
+    uint32_t z[2];
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        snow_3g_initialize(&snow_ctx[0], snow_k[i], snow_iv[i]);
+        snow_3g_generate_key_stream(&snow_ctx[0], 2, z);
+        ABTS_TRUE(tc, z[0] == snow_z[i][0]);
+        ABTS_TRUE(tc, z[1] == snow_z[i][1]);
+
+        snow_3g_initialize(&snow_ctx[0], snow_k[i], snow_iv[i]);
+        ABTS_TRUE(tc, snow_3g_generate_word64(&snow_ctx[0]) ==
+                (((uint64_t)snow_z[i][0] << 32) | snow_z[i][1]));
+    }
+
+    /* Contexts do not share state */
+    snow_3g_initialize(&snow_ctx[0], snow_k[0], snow_iv[0]);
+    snow_3g_initialize(&snow_ctx[1], snow_k[1], snow_iv[1]);
+    for (i = 0; i < 2; i++) {
+        ABTS_TRUE(tc, snow_3g_generate_word32(&snow_ctx[0]) == snow_z[0][i]);
+        ABTS_TRUE(tc, snow_3g_generate_word32(&snow_ctx[1]) == snow_z[1][i]);
+    }
+
+    for (i = 0; i < 3; i++)
+        zuc_initialize(&zuc_ctx[i],
+                ogs_hex_from_string(_zuc_k[i], k, sizeof(k)),
+                ogs_hex_from_string(_zuc_iv[i], iv, sizeof(iv)));
+    for (i = 0; i < 3; i++) {
+        zuc_generate_key_stream(&zuc_ctx[i], z, 2);
+        ABTS_TRUE(tc, z[0] == zuc_z[i][0]);
+        ABTS_TRUE(tc, z[1] == zuc_z[i][1]);
+    }
+}
+
+#define SECURITY_TEST11_LEN 256
+#define SECURITY_TEST11_LOOP 20000
+
+static void security_test11(abts_case *tc, void *data)
+{
+    static uint8_t f9_mac[SECURITY_TEST11_LOOP][4];
+    static uint32_t eia3_mac[SECURITY_TEST11_LOOP];
+    uint8_t key[16];
+    uint8_t message[SECURITY_TEST11_LEN], plain[SECURITY_TEST11_LEN];
+    uint8_t mac[4];
+    uint32_t mac32;
+    ogs_time_t start, f8_usec, f9_usec, eea3_usec, eia3_usec;
+    int i;
+
+    for (i = 0; i < sizeof(key); i++)
+        key[i] = i;
+    for (i = 0; i < sizeof(message); i++)
+        message[i] = i * 7;
+    memcpy(plain, message, sizeof(plain));
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < SECURITY_TEST11_LOOP; i++)
+        snow_3g_f8(key, i, 0x0c, 1, message, SECURITY_TEST11_LEN << 3);
+    f8_usec = ogs_get_monotonic_time() - start;
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < SECURITY_TEST11_LOOP; i++)
+        snow_3g_f9(key, i, 0x0c << 27, 1,
+                message, SECURITY_TEST11_LEN << 3, f9_mac[i]);
+    f9_usec = ogs_get_monotonic_time() - start;
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < SECURITY_TEST11_LOOP; i++)
+        zuc_eea3(key, i, 0x0c, 1,
+                SECURITY_TEST11_LEN << 3, message, message);
+    eea3_usec = ogs_get_monotonic_time() - start;
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < SECURITY_TEST11_LOOP; i++)
+        zuc_eia3(key, i, 0x0c, 1,
+                SECURITY_TEST11_LEN << 3, message, &eia3_mac[i]);
+    eia3_usec = ogs_get_monotonic_time() - start;
+
+    /*
+     * Each output only depends on its COUNT, so computing it again
+     * in the reverse order gives the same MAC and undoes the ciphering.
+     */
+    for (i = SECURITY_TEST11_LOOP - 1; i >= 0; i--) {
+        zuc_eia3(key, i, 0x0c, 1,
+                SECURITY_TEST11_LEN << 3, message, &mac32);
+        if (mac32 != eia3_mac[i])
+            break;
+    }
+    ABTS_INT_EQUAL(tc, -1, i);
+
+    for (i = SECURITY_TEST11_LOOP - 1; i >= 0; i--)
+        zuc_eea3(key, i, 0x0c, 1,
+                SECURITY_TEST11_LEN << 3, message, message);
+
+    for (i = SECURITY_TEST11_LOOP - 1; i >= 0; i--) {
+        snow_3g_f9(key, i, 0x0c << 27, 1,
+                message, SECURITY_TEST11_LEN << 3, mac);
+        if (memcmp(mac, f9_mac[i], sizeof(mac)) != 0)
+            break;
+    }
+    ABTS_INT_EQUAL(tc, -1, i);
+
+    for (i = SECURITY_TEST11_LOOP - 1; i >= 0; i--)
+        snow_3g_f8(key, i, 0x0c, 1, message, SECURITY_TEST11_LEN << 3);
+    ABTS_TRUE(tc, memcmp(message, plain, sizeof(plain)) == 0);
+
+    ogs_debug("%d x %d bytes: EEA1 %lld usec, EIA1 %lld usec, "
+            "EEA3 %lld usec, EIA3 %lld usec",
+            SECURITY_TEST11_LOOP, SECURITY_TEST11_LEN,
+            (long long)f8_usec, (long long)f9_usec,
+            (long long)eea3_usec, (long long)eia3_usec);
+}
+
+static void security_test12(abts_case *tc, void *data)
+{
+#define SECURITY_TEST12_NUM 40
+    ogs_aes_backend_e backend[] = {
+        OGS_AES_BACKEND_SOFTWARE, OGS_AES_BACKEND_OPENSSL };
+    ogs_aes_backend_e saved = ogs_aes_get_backend();
+    milenage_vector_t vector[OGS_ARRAY_SIZE(backend)][SECURITY_TEST12_NUM];
+    uint8_t cipher[OGS_ARRAY_SIZE(backend)][100];
+    uint8_t ivec[OGS_ARRAY_SIZE(backend)][16];
+    uint8_t k[16], opc[16], amf[2] = { 0x80, 0x00 };
+    uint8_t mac_a[8], res[8], ck[16], ik[16], ak[6];
+    uint8_t autn[16];
+    size_t res_len;
+    int b, i, j, len;
+
+    for (i = 0; i < 16; i++) {
+        k[i] = i * 3;
+        opc[i] = 0xff - i;
+    }
+    for (i = 0; i < SECURITY_TEST12_NUM; i++) {
+        for (j = 0; j < 16; j++)
+            vector[0][i].rand[j] = i * 16 + j;
+        for (j = 0; j < 6; j++)
+            vector[0][i].sqn[j] = i + j;
+    }
+
+    for (b = 0; b < OGS_ARRAY_SIZE(backend); b++) {
+        if (ogs_aes_set_backend(backend[b]) != OGS_OK)
+            continue;
+
+        /* Known answers must not depend on the backend */
+        security_test1(tc, NULL);
+        security_test6(tc, NULL);
+        security_test7(tc, NULL);
+
+        memcpy(vector[b], vector[0], sizeof(vector[0]));
+        ABTS_INT_EQUAL(tc, 0, milenage_generate_batch(
+                    opc, amf, k, vector[b], SECURITY_TEST12_NUM));
+
+        for (i = 0; i < SECURITY_TEST12_NUM; i++) {
+            milenage_vector_t *v = &vector[b][i];
+
+            milenage_f1(opc, k, v->rand, v->sqn, amf, mac_a, NULL);
+            milenage_f2345(opc, k, v->rand, res, ck, ik, ak, NULL);
+            ABTS_TRUE(tc, memcmp(v->autn + 8, mac_a, 8) == 0);
+            ABTS_TRUE(tc, memcmp(v->res, res, 8) == 0);
+            ABTS_TRUE(tc, memcmp(v->ck, ck, 16) == 0);
+            ABTS_TRUE(tc, memcmp(v->ik, ik, 16) == 0);
+            ABTS_TRUE(tc, memcmp(v->ak, ak, 6) == 0);
+
+            res_len = sizeof(res);
+            milenage_generate(opc, amf, k, v->sqn, v->rand,
+                    autn, ik, ck, ak, res, &res_len);
+            ABTS_INT_EQUAL(tc, 8, res_len);
+            ABTS_TRUE(tc, memcmp(v->autn, autn, 16) == 0);
+            ABTS_TRUE(tc, memcmp(v->res, res, 8) == 0);
+        }
+
+        /* CTR keystream and the returned counter over partial blocks */
+        memset(ivec[b], 0xff, sizeof(ivec[b]));
+        ivec[b][0] = 0;
+        memset(cipher[b], 0, sizeof(cipher[b]));
+        for (i = 0, len = 1; i + len <= sizeof(cipher[b]); i += len++)
+            ogs_aes_ctr128_encrypt(k, ivec[b],
+                    cipher[b] + i, len, cipher[b] + i);
+
+        if (b > 0) {
+            ABTS_TRUE(tc,
+                    memcmp(vector[b], vector[0], sizeof(vector[0])) == 0);
+            ABTS_TRUE(tc,
+                    memcmp(cipher[b], cipher[0], sizeof(cipher[0])) == 0);
+            ABTS_TRUE(tc, memcmp(ivec[b], ivec[0], sizeof(ivec[0])) == 0);
+        }
+    }
+
+    ogs_aes_set_backend(saved);
+}
+
+static void security_test13(abts_case *tc, void *data)
+{
+#define SECURITY_TEST13_LOOP 2000
+#define SECURITY_TEST13_BATCH 32
+    milenage_vector_t vector[SECURITY_TEST13_BATCH];
+    uint8_t k[16], opc[16], amf[2] = { 0x80, 0x00 };
+    uint8_t autn[SECURITY_TEST13_BATCH][16], ik[16], ck[16], ak[6];
+    uint8_t res[SECURITY_TEST13_BATCH][8];
+    size_t res_len;
+    ogs_time_t start, single_usec, batch_usec;
+    int i, j;
+
+    for (i = 0; i < 16; i++) {
+        k[i] = i;
+        opc[i] = i * 5;
+    }
+    memset(vector, 0, sizeof(vector));
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < SECURITY_TEST13_LOOP; i++) {
+        for (j = 0; j < SECURITY_TEST13_BATCH; j++) {
+            res_len = sizeof(res[j]);
+            vector[j].rand[0] = i;
+            vector[j].rand[1] = j;
+            milenage_generate(opc, amf, k, vector[j].sqn, vector[j].rand,
+                    autn[j], ik, ck, ak, res[j], &res_len);
+            ABTS_INT_EQUAL(tc, 8, res_len);
+        }
+    }
+    single_usec = ogs_get_monotonic_time() - start;
+
+    start = ogs_get_monotonic_time();
+    for (i = 0; i < SECURITY_TEST13_LOOP; i++) {
+        for (j = 0; j < SECURITY_TEST13_BATCH; j++)
+            vector[j].rand[0] = i;
+        ABTS_INT_EQUAL(tc, 0, milenage_generate_batch(
+                    opc, amf, k, vector, SECURITY_TEST13_BATCH));
+    }
+    batch_usec = ogs_get_monotonic_time() - start;
+
+    /* Both paths produce the same vectors for the last RAND */
+    for (j = 0; j < SECURITY_TEST13_BATCH; j++) {
+        ABTS_TRUE(tc, memcmp(vector[j].autn, autn[j], 16) == 0);
+        ABTS_TRUE(tc, memcmp(vector[j].res, res[j], 8) == 0);
+    }
+    ABTS_TRUE(tc, memcmp(vector[0].res, vector[1].res, 8) != 0);
+
+    ogs_debug("%d x %d vectors [backend:%d]: "
+            "single %lld usec, batch %lld usec",
+            SECURITY_TEST13_LOOP, SECURITY_TEST13_BATCH,
+            ogs_aes_get_backend(),
+            (long long)single_usec, (long long)batch_usec);
+}
+
+static void security_test14(abts_case *tc, void *data)
+{
+    uint64_t sqn, next;
+    int i;
+
+    /* Vectors reserved from SQN 0x1e5 with IND 5 */
+    sqn = 0x1e5;
+    for (i = 0; i < 8; i++) {
+        next = ogs_auc_sqn_next(sqn, i);
+        ABTS_TRUE(tc, next == sqn + 32 * i);
+        ABTS_INT_EQUAL(tc, 5, (int)(next & 0x1f));
+    }
+
+    /* The DB moves past the last reserved vector */
+    ABTS_TRUE(tc, ogs_auc_sqn_next(sqn, 8) == 0x2e5);
+    ABTS_TRUE(tc, ogs_auc_sqn_next(sqn, 8) > ogs_auc_sqn_next(sqn, 7));
+    ABTS_TRUE(tc, ogs_auc_sqn_next(sqn, 0) == sqn);
+
+    /* SEQ wraps around within 48 bits and IND is kept */
+    sqn = OGS_MAX_SQN - 0x1f + 7;
+    ABTS_TRUE(tc, ogs_auc_sqn_next(sqn, 1) == 7);
+    ABTS_TRUE(tc, ogs_auc_sqn_next(sqn, 3) == 0x47);
+    ABTS_TRUE(tc, ogs_auc_sqn_next(OGS_MAX_SQN, 1) == 0x1f);
+}
+
 abts_suite *test_security(abts_suite *suite)
 {
     suite = ADD_SUITE(suite)
@@ -420,6 +712,11 @@ abts_suite *test_security(abts_suite *suite)
     abts_run_test(suite, security_test7, NULL);
     abts_run_test(suite, security_test8, NULL);
     abts_run_test(suite, security_test9, NULL);
+    abts_run_test(suite, security_test10, NULL);
+    abts_run_test(suite, security_test11, NULL);
+    abts_run_test(suite, security_test12, NULL);
+    abts_run_test(suite, security_test13, NULL);
+    abts_run_test(suite, security_test14, NULL);
 
     return suite;
 }